@@ -33,6 +33,9 @@ public class CityGenerator : ModuleRules
 				"GeometryFramework",
 				"DynamicMesh",
 				"MeshConversion",
+				"MeshDescription",
+				"StaticMeshDescription",
+				"AssetRegistry",
 				"GeometryScriptingCore"
 			}
 		);
@@ -28,6 +28,13 @@ void UBuildingGeneratorSubsystem::Deinitialize()
 }
 
 void UBuildingGeneratorSubsystem::PlaceBuildingAlongSpline(USplineComponent* TargetSpline)
+{
+	TArray<FPlacedBuilding> PlacedBuildings;
+	PlaceBuildingAlongSplineWithResult(TargetSpline, PlacedBuildings);
+}
+
+void UBuildingGeneratorSubsystem::PlaceBuildingAlongSplineWithResult(USplineComponent* TargetSpline,
+                                                                     TArray<FPlacedBuilding>& OutPlacedBuildings)
 {
 	//0.基础检查
 	if (nullptr == TargetSpline)
@@ -94,6 +101,7 @@ void UBuildingGeneratorSubsystem::PlaceBuildingAlongSpline(USplineComponent* Tar
 		{
 			PlaceBuildingsAtEdge(PlaceableEdges, i, BuildingsExtents, SelectedBuildings);
 		}
+		OutPlacedBuildings.Append(SelectedBuildings);
 	}
 	else
 	{
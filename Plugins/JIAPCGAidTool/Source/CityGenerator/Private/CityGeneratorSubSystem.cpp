@@ -3,6 +3,7 @@
 
 #include "CityGeneratorSubSystem.h"
 
+#include "CityLayoutSerializer.h"
 #include "EditorComponentUtilities.h"
 #include "NotifyUtilities.h"
 #include "Road/RoadGeneratorSubsystem.h"
@@ -93,7 +94,7 @@ void UCityGeneratorSubSystem::CollectAllSplines(const FName OptionalActorTag/*="
 }
 
 void UCityGeneratorSubSystem::SerializeSplines(const FString& FileName, const FString& FilePath, bool bSaveActorTag,
-                                               bool bSaveCompTag)
+                                               bool bSaveCompTag, bool bBinaryFormat)
 {
 	//验证是否包含数据
 	if (bNeedRefreshSplineData)
@@ -114,7 +115,7 @@ void UCityGeneratorSubSystem::SerializeSplines(const FString& FileName, const FS
 		TargetDir.AppendChar('/');
 	}
 	TargetDir += FileName;
-	TargetDir += ".json";
+	TargetDir += bBinaryFormat ? FCityLayoutSerializer::BinaryExtension : FCityLayoutSerializer::JsonExtension;
 	bool bFileExited = false;
 	if (FPaths::FileExists(TargetDir))
 	{
@@ -136,131 +137,61 @@ void UCityGeneratorSubSystem::SerializeSplines(const FString& FileName, const FS
 		return;
 	}
 	//进行数据序列化
-	TSharedPtr<FJsonObject> SceneSplinesData = MakeShareable(new FJsonObject());
-	/*整体结构为
-	 Scene{
-		Splines[
-			SingleSpline{
-				Points[
-					SinglePoint{}
-				]
-			}
-		]
-	 }
-	 */
-	//场景Spline通用数据
-	SceneSplinesData->SetStringField(TEXT("CoordSpace"), "Local");
-	//场景中所有Spline数据
-	TArray<TSharedPtr<FJsonValue>> SplineDataArray;
-	int32 SplineCounter = 0;
+	FCityLayout Layout;
+	const int32 SplineCounter = CaptureCityLayout(Layout, bSaveActorTag, bSaveCompTag);
+	if (!FCityLayoutSerializer::SaveToFile(Layout, TargetDir))
+	{
+		UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Save Data");
+		return;
+	}
+	UNotifyUtilities::ShowPopupMsgAtCorner(FString::Printf(
+		TEXT("Save Scene Spline Data Finished!Save %d,Total %d)"), SplineCounter, CityGeneratorSplineSet.Num()));
+}
+
+int32 UCityGeneratorSubSystem::CaptureCityLayout(FCityLayout& OutLayout, bool bSaveActorTag, bool bSaveCompTag)
+{
+	OutLayout.Reset();
+	TArray<uint8> PointsType;
+	TArray<FVector> PointsLoc;
+	TArray<FVector> PointsTan;
+	TArray<FRotator> PointsRot;
 	for (const TWeakObjectPtr<USplineComponent> SingleSpline : CityGeneratorSplineSet)
 	{
 		if (!SingleSpline.IsValid()) { continue; }
 		TStrongObjectPtr<USplineComponent> TargetSpline = SingleSpline.Pin();
 		AActor* SplineOwner = TargetSpline->GetOwner();
-
-		//单个Spline数据
-		TSharedPtr<FJsonObject> SingleSplineData(new FJsonObject());
-		//SplineOwner信息输入
 		if (nullptr == SplineOwner) { continue; }
-		SingleSplineData->SetStringField(TEXT("OwnerName"), SplineOwner->GetActorNameOrLabel());
-		//用于判定是不是同一个Actor身上的多个SplineComp
-		SingleSplineData->SetStringField(TEXT("OwnerActorID"), SplineOwner->GetActorGuid().ToString());
-		SingleSplineData->SetNumberField(TEXT("Index"), SplineCounter);
-		//ActorTag和CompTag
-		if (bSaveActorTag && !SplineOwner->Tags.IsEmpty())
+
+		FCityLayoutSpline SplineData;
+		SplineData.OwnerName = SplineOwner->GetActorNameOrLabel();
+		SplineData.OwnerActorID = SplineOwner->GetActorGuid();
+		SplineData.Index = OutLayout.Splines.Num();
+		if (bSaveActorTag)
 		{
-			TArray<TSharedPtr<FJsonValue>> ActorTags;
-			int32 ActorTagCounter = 0;
-			for (const FName& ActorTag : SplineOwner->Tags)
-			{
-				TSharedPtr<FJsonObject> SingleTag;
-				FString TagName = "Tag" + ActorTagCounter;
-				SingleTag->SetStringField(TagName, ActorTag.ToString());
-				ActorTags.Emplace(MakeShareable(new FJsonValueObject(SingleTag)));
-				ActorTagCounter++;
-			}
-			SingleSplineData->SetArrayField(TEXT("ActorTags"), ActorTags);
+			SplineData.ActorTags = SplineOwner->Tags;
 		}
-		if (bSaveCompTag && !TargetSpline->ComponentTags.IsEmpty())
+		if (bSaveCompTag)
 		{
-			TArray<TSharedPtr<FJsonValue>> ComponentTags;
-			int32 CompTagCounter = 0;
-			for (const FName& CompTag : TargetSpline->ComponentTags)
-			{
-				TSharedPtr<FJsonObject> SingleTag;
-				FString TagName = "Tag" + CompTagCounter;
-				SingleTag->SetStringField(TagName, CompTag.ToString());
-				ComponentTags.Emplace(MakeShareable(new FJsonValueObject(SingleTag)));
-				CompTagCounter++;
-			}
-			SingleSplineData->SetArrayField(TEXT("CompTags"), ComponentTags);
+			SplineData.CompTags = TargetSpline->ComponentTags;
 		}
-		//ActorTransform
-		FTransform OwnerTransform = SplineOwner->GetActorTransform();
-		SingleSplineData->SetNumberField(TEXT("Location.X"), OwnerTransform.GetLocation().X);
-		SingleSplineData->SetNumberField(TEXT("Location.Y"), OwnerTransform.GetLocation().Y);
-		SingleSplineData->SetNumberField(TEXT("Location.Z"), OwnerTransform.GetLocation().Z);
-
-		SingleSplineData->SetNumberField(TEXT("Rotation.X"), OwnerTransform.GetRotation().X);
-		SingleSplineData->SetNumberField(TEXT("Rotation.Y"), OwnerTransform.GetRotation().Y);
-		SingleSplineData->SetNumberField(TEXT("Rotation.Z"), OwnerTransform.GetRotation().Z);
-		SingleSplineData->SetNumberField(TEXT("Rotation.W"), OwnerTransform.GetRotation().W);
-
-		SingleSplineData->SetNumberField(TEXT("Scale.X"), OwnerTransform.GetScale3D().X);
-		SingleSplineData->SetNumberField(TEXT("Scale.Y"), OwnerTransform.GetScale3D().Y);
-		SingleSplineData->SetNumberField(TEXT("Scale.Z"), OwnerTransform.GetScale3D().Z);
+		SplineData.OwnerTransform = SplineOwner->GetActorTransform();
+		SplineData.bClosedLoop = TargetSpline->IsClosedLoop();
 		//SplineControlPoint信息
-		TArray<TSharedPtr<FJsonValue>> SingleSplinePointsArray;
-		int32 ControlPointCount = TargetSpline->GetNumberOfSplinePoints();
-		TArray<FVector> PointsLoc;
+		const int32 ControlPointCount = TargetSpline->GetNumberOfSplinePoints();
+		PointsType.SetNum(ControlPointCount);
 		PointsLoc.SetNum(ControlPointCount);
-		TArray<FVector> PointsTan;
 		PointsTan.SetNum(ControlPointCount);
-		TArray<FRotator> PointsRot;
 		PointsRot.SetNum(ControlPointCount);
-
-
 		for (int i = 0; i < ControlPointCount; ++i)
 		{
+			PointsType[i] = static_cast<uint8>(TargetSpline->GetSplinePointType(i));
 			TargetSpline->GetLocationAndTangentAtSplinePoint(i, PointsLoc[i], PointsTan[i],
 			                                                 ESplineCoordinateSpace::Local);
 			PointsRot[i] = TargetSpline->GetRotationAtSplinePoint(i, ESplineCoordinateSpace::Local);
 		}
-		for (int i = 0; i < PointsLoc.Num(); ++i)
-		{
-			TSharedPtr<FJsonObject> SinglePointData(new FJsonObject());
-			int32 PointType = TargetSpline->GetSplinePointType(i);
-			SinglePointData->SetNumberField(TEXT("PointType"), PointType);
-
-			SinglePointData->SetNumberField(TEXT("Location.X"), PointsLoc[i].X);
-			SinglePointData->SetNumberField(TEXT("Location.Y"), PointsLoc[i].Y);
-			SinglePointData->SetNumberField(TEXT("Location.Z"), PointsLoc[i].Z);
-
-			SinglePointData->SetNumberField(TEXT("Tangent.X"), PointsTan[i].X);
-			SinglePointData->SetNumberField(TEXT("Tangent.Y"), PointsTan[i].Y);
-			SinglePointData->SetNumberField(TEXT("Tangent.Z"), PointsTan[i].Z);
-
-			SinglePointData->SetNumberField(TEXT("Rotation.Yaw"), PointsRot[i].Yaw);
-			SinglePointData->SetNumberField(TEXT("Rotation.Pitch"), PointsRot[i].Pitch);
-			SinglePointData->SetNumberField(TEXT("Rotation.Roll"), PointsRot[i].Roll);
-			SingleSplinePointsArray.Emplace(MakeShareable(new FJsonValueObject(SinglePointData)));
-		}
-		SingleSplineData->SetArrayField(TEXT("Points"), SingleSplinePointsArray);
-		SingleSplineData->SetBoolField(TEXT("bCloseLoop"), TargetSpline->IsClosedLoop());
-		SplineDataArray.Emplace(MakeShareable(new FJsonValueObject(SingleSplineData)));
-		SplineCounter++;
+		OutLayout.AddSpline(MoveTemp(SplineData), PointsType, PointsLoc, PointsTan, PointsRot);
 	}
-	SceneSplinesData->SetArrayField(TEXT("Splines"), SplineDataArray);
-	FString SerializeStr;
-	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<
-		TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&SerializeStr);
-
-	FJsonSerializer::Serialize(SceneSplinesData.ToSharedRef(), JsonWriter);
-	UE_LOG(LogTemp, Display, TEXT("Json Res:[%s]"), *SerializeStr);
-	FFileHelper::SaveStringToFile(SerializeStr, *TargetDir);
-	UNotifyUtilities::ShowPopupMsgAtCorner(FString::Printf(
-		TEXT("Save Scene Spline Data Finished!Save %d,Total %d)"), SplineCounter, CityGeneratorSplineSet.Num()));
+	return OutLayout.Splines.Num();
 }
 
 void UCityGeneratorSubSystem::DeserializeSplines(const FString& FileFullPath, bool bTryParseActorTag,
@@ -273,155 +204,115 @@ void UCityGeneratorSubSystem::DeserializeSplines(const FString& FileFullPath, bo
 		UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Load Data");
 		return;
 	}
-	if (!FileFullPath.EndsWith(".json") && !FileFullPath.EndsWith(".JSON"))
+	if (!FileFullPath.EndsWith(FCityLayoutSerializer::JsonExtension, ESearchCase::IgnoreCase) &&
+		!FCityLayoutSerializer::IsBinaryPath(FileFullPath))
 	{
 		UNotifyUtilities::ShowMsgDialog(EAppMsgType::Ok, "Invalid Format!Please Check Path", true);
 		UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Load Data");
 		return;
 	}
-	FString DeserializeStr;
-	FFileHelper::LoadFileToString(DeserializeStr, *FileFullPath);
-	if (DeserializeStr.IsEmpty())
+	//反序列化
+	const double StartTime = FPlatformTime::Seconds();
+	TMap<FGuid, TObjectPtr<AActor>> SpawnedActors;
+	int32 SplineNum = 0;
+	int32 PointNum = 0;
+	bool bSucceeded = false;
+	if (FCityLayoutSerializer::IsBinaryPath(FileFullPath))
 	{
-		UNotifyUtilities::ShowMsgDialog(EAppMsgType::Ok, "Read None Data In Given File", true);
-		UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Load Data");
-		return;
+		FCityLayout Layout;
+		bSucceeded = FCityLayoutSerializer::LoadFromFile(FileFullPath, Layout);
+		PointNum = Layout.GetPointNum();
+		SplineNum = SpawnCityLayout(Layout, SpawnedActors, bTryParseActorTag, bTryParseCompTag);
 	}
-	//反序列化
-	TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(DeserializeStr);
-	TSharedPtr<FJsonObject> SceneSplinesData;
-	FJsonSerializer::Deserialize(JsonReader, SceneSplinesData);
-	bool bIsLocalCoord = true;
-	SceneSplinesData->TryGetBoolField(TEXT("CoordSpace"), bIsLocalCoord);
-	//场景中的Spline数据
-	TArray<TSharedPtr<FJsonValue>> SplineDataArray;
-	//需要一个指向数组的指针
-	const TArray<TSharedPtr<FJsonValue>>* SplineDataArrayPtr = &SplineDataArray;
-	bool bGetDataSuccess = SceneSplinesData->TryGetArrayField(TEXT("Splines"), SplineDataArrayPtr);
-	if (!bGetDataSuccess || SplineDataArrayPtr->IsEmpty())
+	else
+	{
+		//Json逐条解析逐条生成，峰值内存只与单条样条有关
+		bSucceeded = FCityLayoutSerializer::ReadJsonFileStreaming(
+			FileFullPath, [&](const FCityLayout& InSplineLayout)
+			{
+				PointNum += InSplineLayout.GetPointNum();
+				SplineNum += SpawnCityLayout(InSplineLayout, SpawnedActors, bTryParseActorTag, bTryParseCompTag);
+				return true;
+			});
+	}
+	if (!bSucceeded || SplineNum == 0)
 	{
 		UNotifyUtilities::ShowMsgDialog(EAppMsgType::Ok, "Read None Data In Given File", true);
 		UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Load Data");
 		return;
 	}
-	//读到了数据开始逐个解析
-	TMap<FGuid, TObjectPtr<AActor>> SpawnedActors;
-	for (const TSharedPtr<FJsonValue>& SingleSplineDataValue : *SplineDataArrayPtr)
+	UE_LOG(LogTemp, Display, TEXT("Load %d Splines,%d Points From %s,Cost %f ms"), SplineNum, PointNum,
+	       *FileFullPath, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	if (bAutoCollectAfterSpawn)
 	{
-		const TSharedPtr<FJsonObject>& SingleSplineData = SingleSplineDataValue->AsObject();
-		FString OwnerActorName = "";
-		SingleSplineData->TryGetStringField(TEXT("OwnerName"), OwnerActorName);
-		FString OwnerActorGuidStr = "";
-		SingleSplineData->TryGetStringField(TEXT("OwnerActorID"), OwnerActorGuidStr);
-		FGuid OwnerActorGuid = FGuid(OwnerActorGuidStr);
-		//解析Tag
-		TArray<FName> ActorTags;
-		if (bTryParseActorTag && SingleSplineData->HasField(TEXT("ActorTags")))
-		{
-			TArray<TSharedPtr<FJsonValue>> ActorTagsJson = SingleSplineData->GetArrayField(TEXT("ActorTags"));
-			int32 ActorTagCounter = 0;
-			for (const TSharedPtr<FJsonValue>& SingleTag : ActorTagsJson)
-			{
-				FString TagName = "Tag" + ActorTagCounter;
-				ActorTags.Emplace(SingleTag->AsObject()->GetStringField(TagName));
-				ActorTagCounter++;
-			}
-		}
-		TArray<FName> SplineCompTags;
-		if (bTryParseCompTag && SingleSplineData->HasField(TEXT("CompTags")))
-		{
-			TArray<TSharedPtr<FJsonValue>> CompTagsJson = SingleSplineData->GetArrayField(TEXT("CompTags"));
-			int32 CompTagCounter = 0;
-			for (const TSharedPtr<FJsonValue>& SingleTag : CompTagsJson)
-			{
-				FString TagName = "Tag" + CompTagCounter;
-				SplineCompTags.Emplace(SingleTag->AsObject()->GetStringField(TagName));
-				CompTagCounter++;
-			}
-		}
-		//解析OwnerTransform
-		FVector OwnerLocation;
-		SingleSplineData->TryGetNumberField(TEXT("Location.X"), OwnerLocation.X);
-		SingleSplineData->TryGetNumberField(TEXT("Location.Y"), OwnerLocation.Y);
-		SingleSplineData->TryGetNumberField(TEXT("Location.Z"), OwnerLocation.Z);
-		FQuat OwnerRotation;
-		SingleSplineData->TryGetNumberField(TEXT("Rotation.X"), OwnerRotation.X);
-		SingleSplineData->TryGetNumberField(TEXT("Rotation.Y"), OwnerRotation.Y);
-		SingleSplineData->TryGetNumberField(TEXT("Rotation.Z"), OwnerRotation.Z);
-		SingleSplineData->TryGetNumberField(TEXT("Rotation.W"), OwnerRotation.W);
-		FVector OwnerScale;
-		SingleSplineData->TryGetNumberField(TEXT("Scale.X"), OwnerScale.X);
-		SingleSplineData->TryGetNumberField(TEXT("Scale.Y"), OwnerScale.Y);
-		SingleSplineData->TryGetNumberField(TEXT("Scale.Z"), OwnerScale.Z);
-		FTransform OwnerTransform;
-		OwnerTransform.SetLocation(OwnerLocation);
-		OwnerTransform.SetRotation(OwnerRotation);
-		OwnerTransform.SetScale3D(OwnerScale);
-		//解析点信息
-		TArray<int32> PointsType;
-		TArray<FVector> PointsLoc;
-		TArray<FVector> PointsTan;
-		TArray<FRotator> PointsRot;
+		CollectAllSplines();
+	}
+}
 
-		TArray<TSharedPtr<FJsonValue>> SingleSplinePointsArray;
-		const TArray<TSharedPtr<FJsonValue>>* SingleSplinePointsArrayPtr = &SingleSplinePointsArray;
-		bool bGetControlPointSuccess = SingleSplineData->TryGetArrayField(TEXT("Points"), SingleSplinePointsArrayPtr);
+void UCityGeneratorSubSystem::SpawnCityLayout(const FCityLayout& InLayout, bool bTryParseActorTag,
+                                              bool bTryParseCompTag)
+{
+	TMap<FGuid, TObjectPtr<AActor>> SpawnedActors;
+	SpawnCityLayout(InLayout, SpawnedActors, bTryParseActorTag, bTryParseCompTag);
+}
+
+int32 UCityGeneratorSubSystem::SpawnCityLayout(const FCityLayout& InLayout,
+                                               TMap<FGuid, TObjectPtr<AActor>>& SpawnedActors,
+                                               bool bTryParseActorTag, bool bTryParseCompTag)
+{
+	int32 SpawnedSplineNum = 0;
+	TArray<int32> PointsType;
+	for (const FCityLayoutSpline& SplineData : InLayout.Splines)
+	{
 		//没有解析到点信息
-		if (!bGetControlPointSuccess || SingleSplinePointsArrayPtr->IsEmpty())
+		if (SplineData.PointNum <= 0)
 		{
-			UNotifyUtilities::ShowMsgDialog(EAppMsgType::Ok, "Read None Data In Given File", true);
 			UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Load Data");
 			continue;
 		}
-		for (const TSharedPtr<FJsonValue>& SinglePointDataValue : *SingleSplinePointsArrayPtr)
-		{
-			const TSharedPtr<FJsonObject>& SinglePointData = SinglePointDataValue->AsObject();
-			int32 PointType = 0;
-			SinglePointData->TryGetNumberField(TEXT("PointType"), PointType);
-			FVector PointLoc;
-			SinglePointData->TryGetNumberField(TEXT("Location.X"), PointLoc.X);
-			SinglePointData->TryGetNumberField(TEXT("Location.Y"), PointLoc.Y);
-			SinglePointData->TryGetNumberField(TEXT("Location.Z"), PointLoc.Z);
-			FVector PointTan;
-			SinglePointData->TryGetNumberField(TEXT("Tangent.X"), PointTan.X);
-			SinglePointData->TryGetNumberField(TEXT("Tangent.Y"), PointTan.Y);
-			SinglePointData->TryGetNumberField(TEXT("Tangent.Z"), PointTan.Z);
-			FRotator PointRot;
-			SinglePointData->TryGetNumberField(TEXT("Rotation.Yaw"), PointRot.Yaw);
-			SinglePointData->TryGetNumberField(TEXT("Rotation.Pitch"), PointRot.Pitch);
-			SinglePointData->TryGetNumberField(TEXT("Rotation.Roll"), PointRot.Roll);
-			//处理Owner缩放对Spline的影响
-			//PointLoc = UKismetMathLibrary::TransformLocation(OwnerTransform, PointLoc);
-			PointsType.Emplace(PointType);
-			PointsLoc.Emplace(PointLoc);
-			PointsTan.Emplace(PointTan);
-			PointsRot.Emplace(PointRot);
-		}
-		bool bIsCloseLoop = false;
-		SingleSplineData->TryGetBoolField(TEXT("bCloseLoop"), bIsCloseLoop);
 		//@TODO：后续看量改成分帧处理
-		if (!SpawnedActors.Contains(OwnerActorGuid))
+		if (!SpawnedActors.Contains(SplineData.OwnerActorID))
 		{
-			TObjectPtr<AActor> SplineActor = UEditorComponentUtilities::SpawnEmptyActor(OwnerActorName, OwnerTransform);
-			//SplineActor->SetActorTransform(OwnerTransform);
-			if (bTryParseActorTag && !ActorTags.IsEmpty())
+			TObjectPtr<AActor> SplineActor = UEditorComponentUtilities::SpawnEmptyActor(
+				SplineData.OwnerName, SplineData.OwnerTransform);
+			if (bTryParseActorTag && !SplineData.ActorTags.IsEmpty())
 			{
-				SplineActor->Tags = ActorTags;
+				SplineActor->Tags = SplineData.ActorTags;
 			}
-			SpawnedActors.Emplace(OwnerActorGuid, SplineActor);
+			SpawnedActors.Emplace(SplineData.OwnerActorID, SplineActor);
+		}
+		PointsType.Reset();
+		for (int32 i = 0; i < SplineData.PointNum; ++i)
+		{
+			PointsType.Emplace(InLayout.PointTypes[SplineData.FirstPoint + i]);
 		}
 		TObjectPtr<USplineComponent> NewSplineComp = AddSplineCompToExistActor(
-			SpawnedActors[OwnerActorGuid], PointsType, PointsLoc, PointsTan, PointsRot,
-			bIsCloseLoop);
-		if (NewSplineComp != nullptr && bTryParseCompTag && !SplineCompTags.IsEmpty())
+			SpawnedActors[SplineData.OwnerActorID], PointsType,
+			TArray<FVector>(&InLayout.PointLocations[SplineData.FirstPoint], SplineData.PointNum),
+			TArray<FVector>(&InLayout.PointTangents[SplineData.FirstPoint], SplineData.PointNum),
+			TArray<FRotator>(&InLayout.PointRotations[SplineData.FirstPoint], SplineData.PointNum),
+			SplineData.bClosedLoop);
+		if (NewSplineComp == nullptr)
 		{
-			NewSplineComp->ComponentTags = SplineCompTags;
+			continue;
 		}
-	};
-	if (bAutoCollectAfterSpawn)
+		++SpawnedSplineNum;
+		if (bTryParseCompTag && !SplineData.CompTags.IsEmpty())
+		{
+			NewSplineComp->ComponentTags = SplineData.CompTags;
+		}
+	}
+	return SpawnedSplineNum;
+}
+
+void UCityGeneratorSubSystem::ConvertSplineFile(const FString& SourceFullPath, const FString& TargetFullPath)
+{
+	if (!FCityLayoutSerializer::ConvertFile(SourceFullPath, TargetFullPath))
 	{
-		CollectAllSplines();
+		UNotifyUtilities::ShowPopupMsgAtCorner("Failed To Convert Spline File");
+		return;
 	}
+	UNotifyUtilities::ShowPopupMsgAtCorner(FString::Printf(TEXT("Convert Finished:%s"), *TargetFullPath));
 }
 
 
@@ -0,0 +1,964 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CityLayoutSerializer.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+//控制点数组按内存布局直接写出，格式定义为小端序
+static_assert(PLATFORM_LITTLE_ENDIAN, "City layout binary format assumes a little-endian platform");
+
+const TCHAR* FCityLayoutSerializer::BinaryExtension = TEXT(".citylayout");
+const TCHAR* FCityLayoutSerializer::JsonExtension = TEXT(".json");
+
+int32 FCityLayout::AddSpline(FCityLayoutSpline&& InSpline, TConstArrayView<uint8> InTypes,
+                             TConstArrayView<FVector> InLocations, TConstArrayView<FVector> InTangents,
+                             TConstArrayView<FRotator> InRotations)
+{
+	ensureAlwaysMsgf(InTypes.Num() == InLocations.Num() && InLocations.Num() == InTangents.Num() &&
+	                 InTangents.Num() == InRotations.Num(), TEXT("Error:Non-Homogeneous Spline Point Data"));
+	InSpline.FirstPoint = PointLocations.Num();
+	InSpline.PointNum = InLocations.Num();
+	PointTypes.Append(InTypes.GetData(), InTypes.Num());
+	PointLocations.Append(InLocations.GetData(), InLocations.Num());
+	PointTangents.Append(InTangents.GetData(), InTangents.Num());
+	PointRotations.Append(InRotations.GetData(), InRotations.Num());
+	return Splines.Emplace(MoveTemp(InSpline));
+}
+
+void FCityLayout::Reset()
+{
+	Splines.Reset();
+	PointTypes.Reset();
+	PointLocations.Reset();
+	PointTangents.Reset();
+	PointRotations.Reset();
+}
+
+bool FCityLayout::IsValid() const
+{
+	const int32 PointNum = PointLocations.Num();
+	if (PointTypes.Num() != PointNum || PointTangents.Num() != PointNum || PointRotations.Num() != PointNum)
+	{
+		return false;
+	}
+	for (const FCityLayoutSpline& Spline : Splines)
+	{
+		if (Spline.FirstPoint < 0 || Spline.PointNum < 0 || Spline.FirstPoint > PointNum - Spline.PointNum)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+#pragma region Binary
+/**
+ * 二进制文件头，各段偏移从文件起始计算，0表示该段为空
+ */
+struct FCityLayoutFileHeader
+{
+	uint32 Magic = FCityLayoutSerializer::BinaryMagic;
+	uint32 Version = FCityLayoutSerializer::BinaryVersion;
+	int32 StringNum = 0;
+	int32 SplineNum = 0;
+	int32 TagIndexNum = 0;
+	int32 PointNum = 0;
+	int64 StringTableOffset = 0;
+	int64 SplineTableOffset = 0;
+	int64 TagIndexOffset = 0;
+	int64 PointTypeOffset = 0;
+	int64 PointLocationOffset = 0;
+	int64 PointTangentOffset = 0;
+	int64 PointRotationOffset = 0;
+
+	/**
+	 * 序列化后的字节数
+	 */
+	static constexpr int64 SerializedSize = 6 * sizeof(int32) + 7 * sizeof(int64);
+
+	friend FArchive& operator<<(FArchive& Ar, FCityLayoutFileHeader& Header)
+	{
+		Ar << Header.Magic << Header.Version << Header.StringNum << Header.SplineNum << Header.TagIndexNum
+			<< Header.PointNum;
+		Ar << Header.StringTableOffset << Header.SplineTableOffset << Header.TagIndexOffset << Header.PointTypeOffset
+			<< Header.PointLocationOffset << Header.PointTangentOffset << Header.PointRotationOffset;
+		return Ar;
+	}
+};
+
+/**
+ * 样条表中的单条记录，字符串和标签以下标引用字符串表
+ */
+struct FCityLayoutSplineRecord
+{
+	int32 OwnerNameIndex = INDEX_NONE;
+	FGuid OwnerActorID;
+	int32 Index = 0;
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Scale = FVector::OneVector;
+	uint32 bClosedLoop = 0;
+	int32 FirstActorTag = 0;
+	int32 ActorTagNum = 0;
+	int32 FirstCompTag = 0;
+	int32 CompTagNum = 0;
+	int32 FirstPoint = 0;
+	int32 PointNum = 0;
+
+	static constexpr int64 SerializedSize = 8 * sizeof(int32) + sizeof(uint32) + sizeof(FGuid) + 10 * sizeof(double);
+
+	friend FArchive& operator<<(FArchive& Ar, FCityLayoutSplineRecord& Record)
+	{
+		Ar << Record.OwnerNameIndex << Record.OwnerActorID << Record.Index;
+		Ar << Record.Location.X << Record.Location.Y << Record.Location.Z;
+		Ar << Record.Rotation.X << Record.Rotation.Y << Record.Rotation.Z << Record.Rotation.W;
+		Ar << Record.Scale.X << Record.Scale.Y << Record.Scale.Z;
+		Ar << Record.bClosedLoop << Record.FirstActorTag << Record.ActorTagNum << Record.FirstCompTag
+			<< Record.CompTagNum << Record.FirstPoint << Record.PointNum;
+		return Ar;
+	}
+};
+
+/**
+ * 补齐到16字节对齐，返回对齐后的位置
+ */
+static int64 AlignArchive(FArchive& Ar)
+{
+	static constexpr int64 Alignment = 16;
+	uint8 Zero = 0;
+	while (Ar.Tell() % Alignment != 0)
+	{
+		Ar << Zero;
+	}
+	return Ar.Tell();
+}
+
+/**
+ * 把连续数组整体写出，返回该段的起始位置，空数组返回0
+ */
+template <typename ElementType>
+static int64 WriteBulkArray(FArchive& Ar, const TArray<ElementType>& InArray)
+{
+	static_assert(TIsPODType<ElementType>::Value, "Bulk arrays must be POD");
+	if (InArray.IsEmpty())
+	{
+		return 0;
+	}
+	const int64 Offset = AlignArchive(Ar);
+	Ar.Serialize(const_cast<ElementType*>(InArray.GetData()), InArray.Num() * sizeof(ElementType));
+	return Offset;
+}
+
+/**
+ * 校验段范围后整体读入连续数组
+ */
+template <typename ElementType>
+static bool ReadBulkArray(TConstArrayView<uint8> InBytes, int64 Offset, int32 Num, TArray<ElementType>& OutArray)
+{
+	static_assert(TIsPODType<ElementType>::Value, "Bulk arrays must be POD");
+	OutArray.Reset();
+	if (Num == 0)
+	{
+		return true;
+	}
+	const int64 ByteNum = static_cast<int64>(Num) * sizeof(ElementType);
+	if (Num < 0 || Offset <= 0 || Offset > InBytes.Num() - ByteNum)
+	{
+		return false;
+	}
+	OutArray.SetNumUninitialized(Num);
+	FMemory::Memcpy(OutArray.GetData(), InBytes.GetData() + Offset, ByteNum);
+	return true;
+}
+
+bool FCityLayoutSerializer::WriteBinary(const FCityLayout& InLayout, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+	if (!InLayout.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Write Binary Failed,Invalid Layout"));
+		return false;
+	}
+	//字符串表去重，名称和标签共用
+	TArray<FString> StringTable;
+	TMap<FString, int32> StringToIndex;
+	auto AddString = [&StringTable, &StringToIndex](const FString& InString)-> int32
+	{
+		if (const int32* ExistedIndex = StringToIndex.Find(InString))
+		{
+			return *ExistedIndex;
+		}
+		return StringToIndex.Emplace(InString, StringTable.Emplace(InString));
+	};
+	TArray<FCityLayoutSplineRecord> Records;
+	Records.Reserve(InLayout.Splines.Num());
+	TArray<int32> TagIndices;
+	for (const FCityLayoutSpline& Spline : InLayout.Splines)
+	{
+		FCityLayoutSplineRecord& Record = Records.AddDefaulted_GetRef();
+		Record.OwnerNameIndex = AddString(Spline.OwnerName);
+		Record.OwnerActorID = Spline.OwnerActorID;
+		Record.Index = Spline.Index;
+		Record.Location = Spline.OwnerTransform.GetLocation();
+		Record.Rotation = Spline.OwnerTransform.GetRotation();
+		Record.Scale = Spline.OwnerTransform.GetScale3D();
+		Record.bClosedLoop = Spline.bClosedLoop ? 1 : 0;
+		Record.FirstActorTag = TagIndices.Num();
+		Record.ActorTagNum = Spline.ActorTags.Num();
+		for (const FName& Tag : Spline.ActorTags)
+		{
+			TagIndices.Emplace(AddString(Tag.ToString()));
+		}
+		Record.FirstCompTag = TagIndices.Num();
+		Record.CompTagNum = Spline.CompTags.Num();
+		for (const FName& Tag : Spline.CompTags)
+		{
+			TagIndices.Emplace(AddString(Tag.ToString()));
+		}
+		Record.FirstPoint = Spline.FirstPoint;
+		Record.PointNum = Spline.PointNum;
+	}
+
+	FMemoryWriter Writer(OutBytes);
+	FCityLayoutFileHeader Header;
+	Header.StringNum = StringTable.Num();
+	Header.SplineNum = Records.Num();
+	Header.TagIndexNum = TagIndices.Num();
+	Header.PointNum = InLayout.GetPointNum();
+	//先写占位文件头，各段写完后回填偏移
+	Writer << Header;
+	//字符串以UTF8长度前缀存储
+	Header.StringTableOffset = AlignArchive(Writer);
+	for (const FString& String : StringTable)
+	{
+		FTCHARToUTF8 Utf8String(*String);
+		int32 ByteNum = Utf8String.Length();
+		Writer << ByteNum;
+		Writer.Serialize(const_cast<ANSICHAR*>(Utf8String.Get()), ByteNum);
+	}
+	Header.SplineTableOffset = AlignArchive(Writer);
+	for (FCityLayoutSplineRecord& Record : Records)
+	{
+		Writer << Record;
+	}
+	Header.TagIndexOffset = WriteBulkArray(Writer, TagIndices);
+	Header.PointTypeOffset = WriteBulkArray(Writer, InLayout.PointTypes);
+	Header.PointLocationOffset = WriteBulkArray(Writer, InLayout.PointLocations);
+	Header.PointTangentOffset = WriteBulkArray(Writer, InLayout.PointTangents);
+	Header.PointRotationOffset = WriteBulkArray(Writer, InLayout.PointRotations);
+	Writer.Seek(0);
+	Writer << Header;
+	return true;
+}
+
+bool FCityLayoutSerializer::ReadBinary(TConstArrayView<uint8> InBytes, FCityLayout& OutLayout)
+{
+	OutLayout.Reset();
+	//读取前先校验长度，越界读取会由FMemoryReaderView输出错误日志
+	FMemoryReaderView Reader(InBytes);
+	FCityLayoutFileHeader Header;
+	if (InBytes.Num() >= FCityLayoutFileHeader::SerializedSize)
+	{
+		Reader << Header;
+	}
+	if (InBytes.Num() < FCityLayoutFileHeader::SerializedSize || Header.Magic != BinaryMagic)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Not A City Layout File"));
+		return false;
+	}
+	if (Header.Version > BinaryVersion)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Unsupported Version %u,Latest Is %u"),
+		       Header.Version, BinaryVersion);
+		return false;
+	}
+	//数量不可能超过文件字节数，提前拒绝以免分配过大内存
+	if (Header.StringNum < 0 || Header.SplineNum < 0 || Header.TagIndexNum < 0 || Header.PointNum < 0 ||
+		Header.StringNum > InBytes.Num() || Header.SplineNum > InBytes.Num() ||
+		Header.StringTableOffset <= 0 || Header.StringTableOffset > InBytes.Num() ||
+		Header.SplineTableOffset <= 0 ||
+		Header.SplineTableOffset > InBytes.Num() - Header.SplineNum * FCityLayoutSplineRecord::SerializedSize)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Corrupted Header"));
+		return false;
+	}
+	TArray<FString> StringTable;
+	StringTable.Reserve(Header.StringNum);
+	Reader.Seek(Header.StringTableOffset);
+	TArray<ANSICHAR> Utf8Buffer;
+	for (int32 i = 0; i < Header.StringNum; ++i)
+	{
+		int32 ByteNum = -1;
+		if (Reader.Tell() <= InBytes.Num() - static_cast<int64>(sizeof(int32)))
+		{
+			Reader << ByteNum;
+		}
+		if (ByteNum < 0 || ByteNum > InBytes.Num() - Reader.Tell())
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Corrupted String Table"));
+			return false;
+		}
+		Utf8Buffer.SetNumUninitialized(ByteNum);
+		Reader.Serialize(Utf8Buffer.GetData(), ByteNum);
+		StringTable.Emplace(FString(FUTF8ToTCHAR(Utf8Buffer.GetData(), ByteNum)));
+	}
+	TArray<FCityLayoutSplineRecord> Records;
+	Records.SetNum(Header.SplineNum);
+	Reader.Seek(Header.SplineTableOffset);
+	for (FCityLayoutSplineRecord& Record : Records)
+	{
+		Reader << Record;
+	}
+	TArray<int32> TagIndices;
+	if (Reader.IsError() || !ReadBulkArray(InBytes, Header.TagIndexOffset, Header.TagIndexNum, TagIndices) ||
+		!ReadBulkArray(InBytes, Header.PointTypeOffset, Header.PointNum, OutLayout.PointTypes) ||
+		!ReadBulkArray(InBytes, Header.PointLocationOffset, Header.PointNum, OutLayout.PointLocations) ||
+		!ReadBulkArray(InBytes, Header.PointTangentOffset, Header.PointNum, OutLayout.PointTangents) ||
+		!ReadBulkArray(InBytes, Header.PointRotationOffset, Header.PointNum, OutLayout.PointRotations))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Corrupted Data Section"));
+		OutLayout.Reset();
+		return false;
+	}
+	auto IsValidRange = [](int32 First, int32 Num, int32 Total)-> bool
+	{
+		return First >= 0 && Num >= 0 && First <= Total - Num;
+	};
+	OutLayout.Splines.Reserve(Records.Num());
+	for (const FCityLayoutSplineRecord& Record : Records)
+	{
+		if (!StringTable.IsValidIndex(Record.OwnerNameIndex) ||
+			!IsValidRange(Record.FirstActorTag, Record.ActorTagNum, TagIndices.Num()) ||
+			!IsValidRange(Record.FirstCompTag, Record.CompTagNum, TagIndices.Num()))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Corrupted Spline Table"));
+			OutLayout.Reset();
+			return false;
+		}
+		FCityLayoutSpline& Spline = OutLayout.Splines.AddDefaulted_GetRef();
+		Spline.OwnerName = StringTable[Record.OwnerNameIndex];
+		Spline.OwnerActorID = Record.OwnerActorID;
+		Spline.Index = Record.Index;
+		Spline.OwnerTransform = FTransform(Record.Rotation, Record.Location, Record.Scale);
+		Spline.bClosedLoop = Record.bClosedLoop != 0;
+		for (int32 i = 0; i < Record.ActorTagNum; ++i)
+		{
+			const int32 StringIndex = TagIndices[Record.FirstActorTag + i];
+			Spline.ActorTags.Emplace(StringTable.IsValidIndex(StringIndex) ? *StringTable[StringIndex] : TEXT(""));
+		}
+		for (int32 i = 0; i < Record.CompTagNum; ++i)
+		{
+			const int32 StringIndex = TagIndices[Record.FirstCompTag + i];
+			Spline.CompTags.Emplace(StringTable.IsValidIndex(StringIndex) ? *StringTable[StringIndex] : TEXT(""));
+		}
+		Spline.FirstPoint = Record.FirstPoint;
+		Spline.PointNum = Record.PointNum;
+	}
+	if (!OutLayout.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Binary Failed,Point Range Out Of Bounds"));
+		OutLayout.Reset();
+		return false;
+	}
+	return true;
+}
+#pragma endregion Binary
+
+#pragma region Json
+/**
+ * 标签数组，每个元素为{"TagN":Name}
+ */
+static TArray<TSharedPtr<FJsonValue>> MakeJsonTags(const TArray<FName>& InTags)
+{
+	TArray<TSharedPtr<FJsonValue>> JsonTags;
+	for (int32 i = 0; i < InTags.Num(); ++i)
+	{
+		TSharedPtr<FJsonObject> SingleTag = MakeShareable(new FJsonObject());
+		SingleTag->SetStringField(FString::Printf(TEXT("Tag%d"), i), InTags[i].ToString());
+		JsonTags.Emplace(MakeShareable(new FJsonValueObject(SingleTag)));
+	}
+	return JsonTags;
+}
+
+static void ParseJsonTags(const TSharedPtr<FJsonObject>& InSplineData, const TCHAR* FieldName, TArray<FName>& OutTags)
+{
+	const TArray<TSharedPtr<FJsonValue>>* JsonTags = nullptr;
+	if (!InSplineData->TryGetArrayField(FieldName, JsonTags))
+	{
+		return;
+	}
+	for (int32 i = 0; i < JsonTags->Num(); ++i)
+	{
+		const TSharedPtr<FJsonObject>* SingleTag = nullptr;
+		FString TagName;
+		if ((*JsonTags)[i]->TryGetObject(SingleTag) &&
+			(*SingleTag)->TryGetStringField(FString::Printf(TEXT("Tag%d"), i), TagName))
+		{
+			OutTags.Emplace(*TagName);
+		}
+	}
+}
+
+bool FCityLayoutSerializer::WriteJson(const FCityLayout& InLayout, FString& OutJsonStr)
+{
+	OutJsonStr.Reset();
+	if (!InLayout.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Write Json Failed,Invalid Layout"));
+		return false;
+	}
+	TSharedPtr<FJsonObject> SceneSplinesData = MakeShareable(new FJsonObject());
+	SceneSplinesData->SetStringField(TEXT("CoordSpace"), "Local");
+	TArray<TSharedPtr<FJsonValue>> SplineDataArray;
+	for (const FCityLayoutSpline& Spline : InLayout.Splines)
+	{
+		TSharedPtr<FJsonObject> SingleSplineData(new FJsonObject());
+		SingleSplineData->SetStringField(TEXT("OwnerName"), Spline.OwnerName);
+		SingleSplineData->SetStringField(TEXT("OwnerActorID"), Spline.OwnerActorID.ToString());
+		SingleSplineData->SetNumberField(TEXT("Index"), Spline.Index);
+		if (!Spline.ActorTags.IsEmpty())
+		{
+			SingleSplineData->SetArrayField(TEXT("ActorTags"), MakeJsonTags(Spline.ActorTags));
+		}
+		if (!Spline.CompTags.IsEmpty())
+		{
+			SingleSplineData->SetArrayField(TEXT("CompTags"), MakeJsonTags(Spline.CompTags));
+		}
+		const FVector OwnerLocation = Spline.OwnerTransform.GetLocation();
+		const FQuat OwnerRotation = Spline.OwnerTransform.GetRotation();
+		const FVector OwnerScale = Spline.OwnerTransform.GetScale3D();
+		SingleSplineData->SetNumberField(TEXT("Location.X"), OwnerLocation.X);
+		SingleSplineData->SetNumberField(TEXT("Location.Y"), OwnerLocation.Y);
+		SingleSplineData->SetNumberField(TEXT("Location.Z"), OwnerLocation.Z);
+
+		SingleSplineData->SetNumberField(TEXT("Rotation.X"), OwnerRotation.X);
+		SingleSplineData->SetNumberField(TEXT("Rotation.Y"), OwnerRotation.Y);
+		SingleSplineData->SetNumberField(TEXT("Rotation.Z"), OwnerRotation.Z);
+		SingleSplineData->SetNumberField(TEXT("Rotation.W"), OwnerRotation.W);
+
+		SingleSplineData->SetNumberField(TEXT("Scale.X"), OwnerScale.X);
+		SingleSplineData->SetNumberField(TEXT("Scale.Y"), OwnerScale.Y);
+		SingleSplineData->SetNumberField(TEXT("Scale.Z"), OwnerScale.Z);
+		TArray<TSharedPtr<FJsonValue>> SingleSplinePointsArray;
+		SingleSplinePointsArray.Reserve(Spline.PointNum);
+		for (int32 i = Spline.FirstPoint; i < Spline.FirstPoint + Spline.PointNum; ++i)
+		{
+			TSharedPtr<FJsonObject> SinglePointData(new FJsonObject());
+			SinglePointData->SetNumberField(TEXT("PointType"), InLayout.PointTypes[i]);
+
+			SinglePointData->SetNumberField(TEXT("Location.X"), InLayout.PointLocations[i].X);
+			SinglePointData->SetNumberField(TEXT("Location.Y"), InLayout.PointLocations[i].Y);
+			SinglePointData->SetNumberField(TEXT("Location.Z"), InLayout.PointLocations[i].Z);
+
+			SinglePointData->SetNumberField(TEXT("Tangent.X"), InLayout.PointTangents[i].X);
+			SinglePointData->SetNumberField(TEXT("Tangent.Y"), InLayout.PointTangents[i].Y);
+			SinglePointData->SetNumberField(TEXT("Tangent.Z"), InLayout.PointTangents[i].Z);
+
+			SinglePointData->SetNumberField(TEXT("Rotation.Yaw"), InLayout.PointRotations[i].Yaw);
+			SinglePointData->SetNumberField(TEXT("Rotation.Pitch"), InLayout.PointRotations[i].Pitch);
+			SinglePointData->SetNumberField(TEXT("Rotation.Roll"), InLayout.PointRotations[i].Roll);
+			SingleSplinePointsArray.Emplace(MakeShareable(new FJsonValueObject(SinglePointData)));
+		}
+		SingleSplineData->SetArrayField(TEXT("Points"), SingleSplinePointsArray);
+		SingleSplineData->SetBoolField(TEXT("bCloseLoop"), Spline.bClosedLoop);
+		SplineDataArray.Emplace(MakeShareable(new FJsonValueObject(SingleSplineData)));
+	}
+	SceneSplinesData->SetArrayField(TEXT("Splines"), SplineDataArray);
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<
+		TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutJsonStr);
+	return FJsonSerializer::Serialize(SceneSplinesData.ToSharedRef(), JsonWriter);
+}
+
+bool FCityLayoutSerializer::ReadJson(const FString& InJsonStr, FCityLayout& OutLayout)
+{
+	OutLayout.Reset();
+	TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(InJsonStr);
+	TSharedPtr<FJsonObject> SceneSplinesData;
+	const TArray<TSharedPtr<FJsonValue>>* SplineDataArrayPtr = nullptr;
+	if (!FJsonSerializer::Deserialize(JsonReader, SceneSplinesData) || !SceneSplinesData.IsValid() ||
+		!SceneSplinesData->TryGetArrayField(TEXT("Splines"), SplineDataArrayPtr))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Json Failed,%s"), *JsonReader->GetErrorMessage());
+		return false;
+	}
+	TArray<uint8> PointsType;
+	TArray<FVector> PointsLoc;
+	TArray<FVector> PointsTan;
+	TArray<FRotator> PointsRot;
+	for (const TSharedPtr<FJsonValue>& SingleSplineDataValue : *SplineDataArrayPtr)
+	{
+		const TSharedPtr<FJsonObject>* SingleSplineDataPtr = nullptr;
+		if (!SingleSplineDataValue->TryGetObject(SingleSplineDataPtr))
+		{
+			continue;
+		}
+		const TSharedPtr<FJsonObject>& SingleSplineData = *SingleSplineDataPtr;
+		FCityLayoutSpline Spline;
+		SingleSplineData->TryGetStringField(TEXT("OwnerName"), Spline.OwnerName);
+		FString OwnerActorGuidStr;
+		SingleSplineData->TryGetStringField(TEXT("OwnerActorID"), OwnerActorGuidStr);
+		FGuid::Parse(OwnerActorGuidStr, Spline.OwnerActorID);
+		SingleSplineData->TryGetNumberField(TEXT("Index"), Spline.Index);
+		ParseJsonTags(SingleSplineData, TEXT("ActorTags"), Spline.ActorTags);
+		ParseJsonTags(SingleSplineData, TEXT("CompTags"), Spline.CompTags);
+		FVector OwnerLocation = FVector::ZeroVector;
+		SingleSplineData->TryGetNumberField(TEXT("Location.X"), OwnerLocation.X);
+		SingleSplineData->TryGetNumberField(TEXT("Location.Y"), OwnerLocation.Y);
+		SingleSplineData->TryGetNumberField(TEXT("Location.Z"), OwnerLocation.Z);
+		FQuat OwnerRotation = FQuat::Identity;
+		SingleSplineData->TryGetNumberField(TEXT("Rotation.X"), OwnerRotation.X);
+		SingleSplineData->TryGetNumberField(TEXT("Rotation.Y"), OwnerRotation.Y);
+		SingleSplineData->TryGetNumberField(TEXT("Rotation.Z"), OwnerRotation.Z);
+		SingleSplineData->TryGetNumberField(TEXT("Rotation.W"), OwnerRotation.W);
+		FVector OwnerScale = FVector::OneVector;
+		SingleSplineData->TryGetNumberField(TEXT("Scale.X"), OwnerScale.X);
+		SingleSplineData->TryGetNumberField(TEXT("Scale.Y"), OwnerScale.Y);
+		SingleSplineData->TryGetNumberField(TEXT("Scale.Z"), OwnerScale.Z);
+		Spline.OwnerTransform = FTransform(OwnerRotation, OwnerLocation, OwnerScale);
+		SingleSplineData->TryGetBoolField(TEXT("bCloseLoop"), Spline.bClosedLoop);
+
+		PointsType.Reset();
+		PointsLoc.Reset();
+		PointsTan.Reset();
+		PointsRot.Reset();
+		const TArray<TSharedPtr<FJsonValue>>* SingleSplinePointsArrayPtr = nullptr;
+		if (SingleSplineData->TryGetArrayField(TEXT("Points"), SingleSplinePointsArrayPtr))
+		{
+			for (const TSharedPtr<FJsonValue>& SinglePointDataValue : *SingleSplinePointsArrayPtr)
+			{
+				const TSharedPtr<FJsonObject>* SinglePointDataPtr = nullptr;
+				if (!SinglePointDataValue->TryGetObject(SinglePointDataPtr))
+				{
+					continue;
+				}
+				const TSharedPtr<FJsonObject>& SinglePointData = *SinglePointDataPtr;
+				int32 PointType = 0;
+				SinglePointData->TryGetNumberField(TEXT("PointType"), PointType);
+				FVector PointLoc = FVector::ZeroVector;
+				SinglePointData->TryGetNumberField(TEXT("Location.X"), PointLoc.X);
+				SinglePointData->TryGetNumberField(TEXT("Location.Y"), PointLoc.Y);
+				SinglePointData->TryGetNumberField(TEXT("Location.Z"), PointLoc.Z);
+				FVector PointTan = FVector::ZeroVector;
+				SinglePointData->TryGetNumberField(TEXT("Tangent.X"), PointTan.X);
+				SinglePointData->TryGetNumberField(TEXT("Tangent.Y"), PointTan.Y);
+				SinglePointData->TryGetNumberField(TEXT("Tangent.Z"), PointTan.Z);
+				FRotator PointRot = FRotator::ZeroRotator;
+				SinglePointData->TryGetNumberField(TEXT("Rotation.Yaw"), PointRot.Yaw);
+				SinglePointData->TryGetNumberField(TEXT("Rotation.Pitch"), PointRot.Pitch);
+				SinglePointData->TryGetNumberField(TEXT("Rotation.Roll"), PointRot.Roll);
+				PointsType.Emplace(static_cast<uint8>(PointType));
+				PointsLoc.Emplace(PointLoc);
+				PointsTan.Emplace(PointTan);
+				PointsRot.Emplace(PointRot);
+			}
+		}
+		OutLayout.AddSpline(MoveTemp(Spline), PointsType, PointsLoc, PointsTan, PointsRot);
+	}
+	return true;
+}
+#pragma endregion Json
+
+#pragma region JsonStreaming
+/**
+ * 把UTF-8字节流分块转换为TCHAR流供TJsonReader<TCHAR>逐字符读取，只缓存一个分块
+ * TJsonReader直接按CharType读取Archive，不做多字节解码，因此不能直接用于UTF-8文件
+ */
+class FUtf8ToTCharArchive final : public FArchive
+{
+public:
+	explicit FUtf8ToTCharArchive(FArchive& InInner) : Inner(InInner)
+	{
+		SetIsLoading(true);
+		//跳过UTF-8 BOM
+		if (Inner.TotalSize() - Inner.Tell() >= 3)
+		{
+			uint8 Bom[3] = {0, 0, 0};
+			const int64 StartPos = Inner.Tell();
+			Inner.Serialize(Bom, 3);
+			if (Bom[0] != 0xEF || Bom[1] != 0xBB || Bom[2] != 0xBF)
+			{
+				Inner.Seek(StartPos);
+			}
+		}
+	}
+
+	virtual void Serialize(void* Data, int64 Num) override
+	{
+		uint8* Dest = static_cast<uint8*>(Data);
+		while (Num > 0)
+		{
+			if (DecodedOffset >= DecodedBytes.Num() && !DecodeNextChunk())
+			{
+				SetError();
+				return;
+			}
+			const int64 CopyNum = FMath::Min<int64>(Num, DecodedBytes.Num() - DecodedOffset);
+			FMemory::Memcpy(Dest, DecodedBytes.GetData() + DecodedOffset, CopyNum);
+			DecodedOffset += CopyNum;
+			Position += CopyNum;
+			Dest += CopyNum;
+			Num -= CopyNum;
+		}
+	}
+
+	virtual bool AtEnd() override
+	{
+		return DecodedOffset >= DecodedBytes.Num() && Inner.AtEnd() && PendingBytes.IsEmpty();
+	}
+
+	virtual int64 Tell() override { return Position; }
+
+	virtual FString GetArchiveName() const override { return TEXT("FUtf8ToTCharArchive"); }
+
+private:
+	/**
+	 * 读取下一块UTF-8并转换，块尾不完整的多字节字符留到下一块
+	 */
+	bool DecodeNextChunk()
+	{
+		static constexpr int64 ChunkSize = 64 * 1024;
+		const int64 ReadNum = FMath::Min(ChunkSize, Inner.TotalSize() - Inner.Tell());
+		if (ReadNum <= 0 && PendingBytes.IsEmpty())
+		{
+			return false;
+		}
+		const int32 PendingNum = PendingBytes.Num();
+		PendingBytes.SetNumUninitialized(PendingNum + FMath::Max<int64>(ReadNum, 0));
+		if (ReadNum > 0)
+		{
+			Inner.Serialize(PendingBytes.GetData() + PendingNum, ReadNum);
+		}
+		//找到最后一个完整字符的结尾
+		int32 CompleteNum = PendingBytes.Num();
+		for (int32 Back = 1; Back <= 3 && Back <= PendingBytes.Num(); ++Back)
+		{
+			const uint8 Byte = PendingBytes[PendingBytes.Num() - Back];
+			if ((Byte & 0xC0) == 0x80)
+			{
+				continue;
+			}
+			const int32 SequenceLength = Byte >= 0xF0 ? 4 : Byte >= 0xE0 ? 3 : Byte >= 0xC0 ? 2 : 1;
+			if (SequenceLength > Back && !Inner.AtEnd())
+			{
+				CompleteNum = PendingBytes.Num() - Back;
+			}
+			break;
+		}
+		const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(PendingBytes.GetData()), CompleteNum);
+		DecodedBytes.SetNumUninitialized(Converter.Length() * sizeof(TCHAR), EAllowShrinking::No);
+		FMemory::Memcpy(DecodedBytes.GetData(), Converter.Get(), DecodedBytes.Num());
+		DecodedOffset = 0;
+		PendingBytes.RemoveAt(0, CompleteNum, EAllowShrinking::No);
+		return !DecodedBytes.IsEmpty();
+	}
+
+	FArchive& Inner;
+
+	TArray<uint8> PendingBytes;
+
+	TArray<uint8> DecodedBytes;
+
+	int64 DecodedOffset = 0;
+
+	int64 Position = 0;
+};
+
+/**
+ * 流式解析时所在的Json层级
+ */
+enum class ECityLayoutJsonScope : uint8
+{
+	Root,
+	Splines,
+	Spline,
+	Points,
+	Point,
+	Tags,
+	Tag,
+	//未知字段的对象或数组，内容全部跳过
+	Unknown
+};
+
+bool FCityLayoutSerializer::ReadJsonStreaming(FArchive& InArchive, FOnSplineRead OnSplineRead)
+{
+	FUtf8ToTCharArchive TCharArchive(InArchive);
+	TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(&TCharArchive);
+	TArray<ECityLayoutJsonScope> ScopeStack;
+	//当前样条，数组在样条之间复用
+	FCityLayout SplineLayout;
+	FCityLayoutSpline& Spline = SplineLayout.Splines.AddDefaulted_GetRef();
+	FVector OwnerLocation = FVector::ZeroVector;
+	FQuat OwnerRotation = FQuat::Identity;
+	FVector OwnerScale = FVector::OneVector;
+	TArray<FName>* CurrentTags = nullptr;
+	uint8 PointType = 0;
+	FVector PointLoc = FVector::ZeroVector;
+	FVector PointTan = FVector::ZeroVector;
+	FRotator PointRot = FRotator::ZeroRotator;
+
+	EJsonNotation Notation;
+	while (JsonReader->ReadNext(Notation))
+	{
+		const ECityLayoutJsonScope Scope = ScopeStack.IsEmpty() ? ECityLayoutJsonScope::Unknown : ScopeStack.Last();
+		const FString& Identifier = JsonReader->GetIdentifier();
+		switch (Notation)
+		{
+		case EJsonNotation::ObjectStart:
+			if (ScopeStack.IsEmpty())
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Root);
+			}
+			else if (Scope == ECityLayoutJsonScope::Splines)
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Spline);
+				SplineLayout.PointTypes.Reset();
+				SplineLayout.PointLocations.Reset();
+				SplineLayout.PointTangents.Reset();
+				SplineLayout.PointRotations.Reset();
+				Spline = FCityLayoutSpline();
+				OwnerLocation = FVector::ZeroVector;
+				OwnerRotation = FQuat::Identity;
+				OwnerScale = FVector::OneVector;
+			}
+			else if (Scope == ECityLayoutJsonScope::Points)
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Point);
+				PointType = 0;
+				PointLoc = FVector::ZeroVector;
+				PointTan = FVector::ZeroVector;
+				PointRot = FRotator::ZeroRotator;
+			}
+			else
+			{
+				ScopeStack.Push(Scope == ECityLayoutJsonScope::Tags
+					                ? ECityLayoutJsonScope::Tag
+					                : ECityLayoutJsonScope::Unknown);
+			}
+			break;
+		case EJsonNotation::ArrayStart:
+			if (Scope == ECityLayoutJsonScope::Root && Identifier == TEXT("Splines"))
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Splines);
+			}
+			else if (Scope == ECityLayoutJsonScope::Spline && Identifier == TEXT("Points"))
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Points);
+			}
+			else if (Scope == ECityLayoutJsonScope::Spline &&
+				(Identifier == TEXT("ActorTags") || Identifier == TEXT("CompTags")))
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Tags);
+				CurrentTags = Identifier == TEXT("ActorTags") ? &Spline.ActorTags : &Spline.CompTags;
+			}
+			else
+			{
+				ScopeStack.Push(ECityLayoutJsonScope::Unknown);
+			}
+			break;
+		case EJsonNotation::ObjectEnd:
+		case EJsonNotation::ArrayEnd:
+			if (ScopeStack.IsEmpty())
+			{
+				return false;
+			}
+			ScopeStack.Pop(EAllowShrinking::No);
+			if (Scope == ECityLayoutJsonScope::Point)
+			{
+				SplineLayout.PointTypes.Emplace(PointType);
+				SplineLayout.PointLocations.Emplace(PointLoc);
+				SplineLayout.PointTangents.Emplace(PointTan);
+				SplineLayout.PointRotations.Emplace(PointRot);
+			}
+			else if (Scope == ECityLayoutJsonScope::Spline)
+			{
+				Spline.OwnerTransform = FTransform(OwnerRotation, OwnerLocation, OwnerScale);
+				Spline.FirstPoint = 0;
+				Spline.PointNum = SplineLayout.GetPointNum();
+				if (!OnSplineRead(SplineLayout))
+				{
+					return true;
+				}
+			}
+			break;
+		case EJsonNotation::String:
+			if (Scope == ECityLayoutJsonScope::Tag && nullptr != CurrentTags)
+			{
+				CurrentTags->Emplace(*JsonReader->GetValueAsString());
+			}
+			else if (Scope == ECityLayoutJsonScope::Spline && Identifier == TEXT("OwnerName"))
+			{
+				Spline.OwnerName = JsonReader->GetValueAsString();
+			}
+			else if (Scope == ECityLayoutJsonScope::Spline && Identifier == TEXT("OwnerActorID"))
+			{
+				FGuid::Parse(JsonReader->GetValueAsString(), Spline.OwnerActorID);
+			}
+			break;
+		case EJsonNotation::Boolean:
+			if (Scope == ECityLayoutJsonScope::Spline && Identifier == TEXT("bCloseLoop"))
+			{
+				Spline.bClosedLoop = JsonReader->GetValueAsBoolean();
+			}
+			break;
+		case EJsonNotation::Number:
+			{
+				const double Value = JsonReader->GetValueAsNumber();
+				if (Scope == ECityLayoutJsonScope::Point)
+				{
+					if (Identifier == TEXT("PointType")) { PointType = static_cast<uint8>(Value); }
+					else if (Identifier == TEXT("Location.X")) { PointLoc.X = Value; }
+					else if (Identifier == TEXT("Location.Y")) { PointLoc.Y = Value; }
+					else if (Identifier == TEXT("Location.Z")) { PointLoc.Z = Value; }
+					else if (Identifier == TEXT("Tangent.X")) { PointTan.X = Value; }
+					else if (Identifier == TEXT("Tangent.Y")) { PointTan.Y = Value; }
+					else if (Identifier == TEXT("Tangent.Z")) { PointTan.Z = Value; }
+					else if (Identifier == TEXT("Rotation.Yaw")) { PointRot.Yaw = Value; }
+					else if (Identifier == TEXT("Rotation.Pitch")) { PointRot.Pitch = Value; }
+					else if (Identifier == TEXT("Rotation.Roll")) { PointRot.Roll = Value; }
+				}
+				else if (Scope == ECityLayoutJsonScope::Spline)
+				{
+					if (Identifier == TEXT("Index")) { Spline.Index = static_cast<int32>(Value); }
+					else if (Identifier == TEXT("Location.X")) { OwnerLocation.X = Value; }
+					else if (Identifier == TEXT("Location.Y")) { OwnerLocation.Y = Value; }
+					else if (Identifier == TEXT("Location.Z")) { OwnerLocation.Z = Value; }
+					else if (Identifier == TEXT("Rotation.X")) { OwnerRotation.X = Value; }
+					else if (Identifier == TEXT("Rotation.Y")) { OwnerRotation.Y = Value; }
+					else if (Identifier == TEXT("Rotation.Z")) { OwnerRotation.Z = Value; }
+					else if (Identifier == TEXT("Rotation.W")) { OwnerRotation.W = Value; }
+					else if (Identifier == TEXT("Scale.X")) { OwnerScale.X = Value; }
+					else if (Identifier == TEXT("Scale.Y")) { OwnerScale.Y = Value; }
+					else if (Identifier == TEXT("Scale.Z")) { OwnerScale.Z = Value; }
+				}
+			}
+			break;
+		case EJsonNotation::Error:
+			UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Json Failed,%s"), *JsonReader->GetErrorMessage());
+			return false;
+		default:
+			break;
+		}
+	}
+	if (!ScopeStack.IsEmpty() || TCharArchive.IsError())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read Json Failed,%s"), *JsonReader->GetErrorMessage());
+		return false;
+	}
+	return true;
+}
+
+bool FCityLayoutSerializer::ReadJsonFileStreaming(const FString& FileFullPath, FOnSplineRead OnSplineRead)
+{
+	const TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*FileFullPath));
+	if (!FileReader.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read File Failed:%s"), *FileFullPath);
+		return false;
+	}
+	//旧版本SaveStringToFile在含非ASCII字符时保存为UTF-16，回退到DOM解析
+	uint8 Bom[2] = {0, 0};
+	if (FileReader->TotalSize() >= 2)
+	{
+		FileReader->Serialize(Bom, 2);
+		FileReader->Seek(0);
+	}
+	if ((Bom[0] == 0xFF && Bom[1] == 0xFE) || (Bom[0] == 0xFE && Bom[1] == 0xFF))
+	{
+		FileReader->Close();
+		FString JsonStr;
+		FCityLayout Layout;
+		if (!FFileHelper::LoadFileToString(JsonStr, *FileFullPath) || !ReadJson(JsonStr, Layout))
+		{
+			return false;
+		}
+		FCityLayout SplineLayout;
+		for (const FCityLayoutSpline& Spline : Layout.Splines)
+		{
+			SplineLayout.Reset();
+			FCityLayoutSpline SingleSpline = Spline;
+			SplineLayout.AddSpline(MoveTemp(SingleSpline),
+			                       MakeArrayView(Layout.PointTypes).Slice(Spline.FirstPoint, Spline.PointNum),
+			                       MakeArrayView(Layout.PointLocations).Slice(Spline.FirstPoint, Spline.PointNum),
+			                       MakeArrayView(Layout.PointTangents).Slice(Spline.FirstPoint, Spline.PointNum),
+			                       MakeArrayView(Layout.PointRotations).Slice(Spline.FirstPoint, Spline.PointNum));
+			if (!OnSplineRead(SplineLayout))
+			{
+				break;
+			}
+		}
+		return true;
+	}
+	return ReadJsonStreaming(*FileReader, OnSplineRead);
+}
+#pragma endregion JsonStreaming
+
+bool FCityLayoutSerializer::IsBinaryPath(const FString& FileFullPath)
+{
+	return FileFullPath.EndsWith(BinaryExtension, ESearchCase::IgnoreCase);
+}
+
+bool FCityLayoutSerializer::SaveToFile(const FCityLayout& InLayout, const FString& FileFullPath)
+{
+	if (IsBinaryPath(FileFullPath))
+	{
+		TArray<uint8> Bytes;
+		return WriteBinary(InLayout, Bytes) && FFileHelper::SaveArrayToFile(Bytes, *FileFullPath);
+	}
+	FString JsonStr;
+	//固定为UTF-8，保证ReadJsonStreaming可以直接流式读取
+	return WriteJson(InLayout, JsonStr) &&
+		FFileHelper::SaveStringToFile(JsonStr, *FileFullPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+bool FCityLayoutSerializer::LoadFromFile(const FString& FileFullPath, FCityLayout& OutLayout)
+{
+	OutLayout.Reset();
+	if (IsBinaryPath(FileFullPath))
+	{
+		TArray<uint8> Bytes;
+		if (!FFileHelper::LoadFileToArray(Bytes, *FileFullPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityLayout]Read File Failed:%s"), *FileFullPath);
+			return false;
+		}
+		return ReadBinary(Bytes, OutLayout);
+	}
+	if (!FileFullPath.EndsWith(JsonExtension, ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayout]Unsupported File Format:%s"), *FileFullPath);
+		return false;
+	}
+	const bool bSucceeded = ReadJsonFileStreaming(FileFullPath, [&OutLayout](const FCityLayout& InSplineLayout)
+	{
+		FCityLayoutSpline Spline = InSplineLayout.Splines[0];
+		OutLayout.AddSpline(MoveTemp(Spline), InSplineLayout.PointTypes, InSplineLayout.PointLocations,
+		                    InSplineLayout.PointTangents, InSplineLayout.PointRotations);
+		return true;
+	});
+	if (!bSucceeded)
+	{
+		OutLayout.Reset();
+	}
+	return bSucceeded;
+}
+
+bool FCityLayoutSerializer::ConvertFile(const FString& SourceFullPath, const FString& TargetFullPath)
+{
+	FCityLayout Layout;
+	if (!LoadFromFile(SourceFullPath, Layout))
+	{
+		return false;
+	}
+	const bool bSaved = SaveToFile(Layout, TargetFullPath);
+	UE_LOG(LogTemp, Display, TEXT("[CityLayout]Convert %s To %s %s,%d Splines,%d Points"), *SourceFullPath,
+	       *TargetFullPath, bSaved ? TEXT("Finished") : TEXT("Failed"), Layout.Splines.Num(), Layout.GetPointNum());
+	return bSaved;
+}
@@ -0,0 +1,329 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlet/CityGeneratorCommandlet.h"
+
+#include "CityGeneratorSubSystem.h"
+#include "Editor.h"
+#include "FileHelpers.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "Building/BuildingGeneratorSubsystem.h"
+#include "Building/BuildingPlacementStruct.h"
+#include "Components/DynamicMeshComponent.h"
+#include "Components/SplineComponent.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "Road/BlockMeshGenerator.h"
+#include "Road/IntersectionMeshGenerator.h"
+#include "Road/RoadGeneratorSubsystem.h"
+#include "Road/RoadMeshGenerator.h"
+
+UCityGeneratorCommandlet::UCityGeneratorCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	HelpDescription = TEXT("Generate intersections, roads, blocks and buildings from a spline json without UI");
+	HelpUsage = TEXT(
+		"-run=CityGenerator -Splines=<Json> [-Output=<Dir>] [-SaveMap=<LongPackageName>] [-NoBuildings] -nullrhi -unattended");
+}
+
+int32 UCityGeneratorCommandlet::Main(const FString& Params)
+{
+	FString SplineFile;
+	if (!FParse::Value(*Params, TEXT("Splines="), SplineFile))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]Missing -Splines=<Json>,Usage:%s"), *HelpUsage);
+		return 1;
+	}
+	if (FPaths::IsRelative(SplineFile))
+	{
+		SplineFile = FPaths::Combine(FPaths::ProjectDir(), SplineFile);
+	}
+	SplineFile = FPaths::ConvertRelativePathToFull(SplineFile);
+	FString OutputDir;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputDir))
+	{
+		OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CityGenerator"),
+		                            FPaths::GetBaseFilename(SplineFile));
+	}
+	else if (FPaths::IsRelative(OutputDir))
+	{
+		OutputDir = FPaths::Combine(FPaths::ProjectDir(), OutputDir);
+	}
+	OutputDir = FPaths::ConvertRelativePathToFull(OutputDir);
+	const bool bPlaceBuildings = !FParse::Param(*Params, TEXT("NoBuildings"));
+	FString SaveMapPath;
+	FParse::Value(*Params, TEXT("SaveMap="), SaveMapPath);
+
+	if (nullptr == GEditor)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]Requires Editor Engine"));
+		return 1;
+	}
+	UCityGeneratorSubSystem* CitySubsystem = GEditor->GetEditorSubsystem<UCityGeneratorSubSystem>();
+	URoadGeneratorSubsystem* RoadSubsystem = GEditor->GetEditorSubsystem<URoadGeneratorSubsystem>();
+	UBuildingGeneratorSubsystem* BuildingSubsystem = GEditor->GetEditorSubsystem<UBuildingGeneratorSubsystem>();
+	if (nullptr == CitySubsystem || nullptr == RoadSubsystem || nullptr == BuildingSubsystem)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]Find Null CityGenerator Subsystems"));
+		return 1;
+	}
+
+	TArray<FStageReport> Stages;
+	double StageStartTime = FPlatformTime::Seconds();
+	auto FinishStage = [&Stages, &StageStartTime](const FString& StageName, int32 Count)
+	{
+		FStageReport& Stage = Stages.AddDefaulted_GetRef();
+		Stage.Name = StageName;
+		Stage.Seconds = FPlatformTime::Seconds() - StageStartTime;
+		Stage.Count = Count;
+		UE_LOG(LogTemp, Display, TEXT("[CityGeneratorCommandlet]%s:%d,Cost %f s"), *StageName, Count, Stage.Seconds);
+		StageStartTime = FPlatformTime::Seconds();
+	};
+	//失败时记录到最后一个阶段并写出报告，后续阶段不再执行
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+	auto FailStage = [&Stages, &OutputDir, &SplineFile](const FString& Error)-> int32
+	{
+		Stages.Last().Error = Error;
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]%s:%s"), *Stages.Last().Name, *Error);
+		WriteReport(OutputDir / TEXT("Report.json"), SplineFile, Stages, TMap<FString, int32>());
+		return 1;
+	};
+
+	//0.在空白地图中还原样条，生成的Actor都放在该地图中
+	UWorld* World = UEditorLoadingAndSavingUtils::NewBlankMap(false);
+	if (nullptr == World)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]Create Blank Map Failed"));
+		return 1;
+	}
+	CitySubsystem->DeserializeSplines(SplineFile, false, false, true);
+	const int32 SplineNum = CitySubsystem->GetSplines().Num();
+	FinishStage(TEXT("LoadSplines"), SplineNum);
+	if (SplineNum == 0)
+	{
+		return FailStage(FString::Printf(TEXT("Load None Spline From %s"), *SplineFile));
+	}
+	//1.交汇路口→道路→街区，各阶段内部出错时只弹出通知，这里以产出数量判断
+	RoadSubsystem->GenerateIntersections();
+	FinishStage(TEXT("Intersections"), RoadSubsystem->GetIntersectionGenerators().Num());
+	//未完整生成时GenerateRoads会弹窗并把重新生成交给AsyncTask，Commandlet中不会执行
+	if (Stages.Last().Count == 0 || !RoadSubsystem->AreIntersectionsGenerated())
+	{
+		return FailStage(TEXT("Generate None Intersection"));
+	}
+	RoadSubsystem->GenerateRoads();
+	const TArray<TWeakObjectPtr<URoadMeshGenerator>> RoadGenerators = RoadSubsystem->GetRoadGenerators();
+	FinishStage(TEXT("Roads"), RoadGenerators.Num());
+	if (RoadGenerators.IsEmpty())
+	{
+		return FailStage(TEXT("Generate None Road"));
+	}
+	for (const TWeakObjectPtr<URoadMeshGenerator>& RoadGenerator : RoadGenerators)
+	{
+		if (RoadGenerator.IsValid())
+		{
+			Stages.Last().MeshBuildSeconds += RoadGenerator->GetLastMeshBuildSeconds();
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("[CityGeneratorCommandlet]Road Sweep:Cost %f ms,%f ms Per Road"),
+	       Stages.Last().MeshBuildSeconds * 1000.0,
+	       Stages.Last().MeshBuildSeconds * 1000.0 / FMath::Max(1, RoadGenerators.Num()));
+	RoadSubsystem->GenerateCityBlock();
+	const TArray<TWeakObjectPtr<UBlockMeshGenerator>> BlockGenerators = RoadSubsystem->GetBlockGenerators();
+	FinishStage(TEXT("Blocks"), BlockGenerators.Num());
+	if (BlockGenerators.IsEmpty())
+	{
+		return FailStage(TEXT("Generate None Block"));
+	}
+	//2.建筑沿街区内轮廓放置
+	TArray<FPlacedBuilding> PlacedBuildings;
+	if (bPlaceBuildings)
+	{
+		for (const TWeakObjectPtr<UBlockMeshGenerator>& BlockGenerator : BlockGenerators)
+		{
+			if (!BlockGenerator.IsValid())
+			{
+				continue;
+			}
+			BlockGenerator->ExtractLinearContourOfInnerArea();
+			BuildingSubsystem->PlaceBuildingAlongSplineWithResult(BlockGenerator->GetRefSpline(), PlacedBuildings);
+		}
+		FinishStage(TEXT("Buildings"), PlacedBuildings.Num());
+	}
+	//3.导出
+	TMap<FString, int32> TriangleCounts;
+	TriangleCounts.Add(TEXT("Intersections"), ExportGeneratorsToObj(RoadSubsystem->GetIntersectionGenerators(),
+	                                                                 OutputDir / TEXT("Intersections.obj")));
+	TriangleCounts.Add(TEXT("Roads"), ExportGeneratorsToObj(RoadSubsystem->GetRoadGenerators(),
+	                                                         OutputDir / TEXT("Roads.obj")));
+	TriangleCounts.Add(TEXT("Blocks"), ExportGeneratorsToObj(BlockGenerators, OutputDir / TEXT("Blocks.obj")));
+	if (bPlaceBuildings)
+	{
+		FString BuildingObjText = TEXT("# CityGenerator Buildings,Unreal World Space(cm,Z Up)\n");
+		int32 VertexOffset = 0;
+		AppendBuildingsToObj(PlacedBuildings, BuildingObjText, VertexOffset);
+		FFileHelper::SaveStringToFile(BuildingObjText, *(OutputDir / TEXT("Buildings.obj")));
+		TriangleCounts.Add(TEXT("Buildings"), PlacedBuildings.Num() * 12);
+	}
+	const bool bMapSaved = SaveMapPath.IsEmpty() || UEditorLoadingAndSavingUtils::SaveMap(World, SaveMapPath);
+	FinishStage(TEXT("Export"), TriangleCounts.Num());
+	if (!bMapSaved)
+	{
+		Stages.Last().Error = FString::Printf(TEXT("Save Map To %s Failed"), *SaveMapPath);
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]%s"), *Stages.Last().Error);
+	}
+
+	if (!WriteReport(OutputDir / TEXT("Report.json"), SplineFile, Stages, TriangleCounts))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]Write Report Failed"));
+		return 1;
+	}
+	if (!bMapSaved)
+	{
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("[CityGeneratorCommandlet]Finished,Output In %s"), *OutputDir);
+	return 0;
+}
+
+int32 UCityGeneratorCommandlet::AppendDynamicMeshToObj(const UDynamicMeshComponent* MeshComponent,
+                                                       const FString& ObjectName, FString& OutObjText,
+                                                       int32& InOutVertexOffset)
+{
+	if (nullptr == MeshComponent)
+	{
+		return 0;
+	}
+	int32 TriangleCount = 0;
+	const FTransform ComponentTransform = MeshComponent->GetComponentTransform();
+	MeshComponent->ProcessMesh([&](const UE::Geometry::FDynamicMesh3& Mesh)
+	{
+		OutObjText += FString::Printf(TEXT("o %s\n"), *ObjectName);
+		//DynamicMesh顶点ID可能不连续，重新编号
+		TArray<int32> VertexIDToObjIndex;
+		VertexIDToObjIndex.Init(INDEX_NONE, Mesh.MaxVertexID());
+		int32 ObjIndex = InOutVertexOffset;
+		for (const int32 VertexID : Mesh.VertexIndicesItr())
+		{
+			const FVector Location = ComponentTransform.TransformPosition(Mesh.GetVertex(VertexID));
+			OutObjText += FString::Printf(TEXT("v %f %f %f\n"), Location.X, Location.Y, Location.Z);
+			//OBJ顶点编号从1开始
+			VertexIDToObjIndex[VertexID] = ++ObjIndex;
+		}
+		for (const int32 TriangleID : Mesh.TriangleIndicesItr())
+		{
+			const UE::Geometry::FIndex3i Triangle = Mesh.GetTriangle(TriangleID);
+			OutObjText += FString::Printf(TEXT("f %d %d %d\n"), VertexIDToObjIndex[Triangle.A],
+			                              VertexIDToObjIndex[Triangle.B], VertexIDToObjIndex[Triangle.C]);
+			TriangleCount++;
+		}
+		InOutVertexOffset = ObjIndex;
+	});
+	return TriangleCount;
+}
+
+void UCityGeneratorCommandlet::AppendBuildingsToObj(const TArray<FPlacedBuilding>& InBuildings, FString& OutObjText,
+                                                    int32& InOutVertexOffset)
+{
+	//顶点顺序：底面0-3，顶面4-7
+	const TArray<FIntVector> BoxFaces{
+		{1, 3, 2}, {1, 4, 3}, {5, 6, 7}, {5, 7, 8}, {1, 2, 6}, {1, 6, 5},
+		{2, 3, 7}, {2, 7, 6}, {3, 4, 8}, {3, 8, 7}, {4, 1, 5}, {4, 5, 8}
+	};
+	for (int32 i = 0; i < InBuildings.Num(); ++i)
+	{
+		const FPlacedBuilding& Building = InBuildings[i];
+		const FVector AxisX = FVector::CrossProduct(Building.ForwardDir, FVector::UpVector).GetSafeNormal();
+		const FVector AxisY = Building.ForwardDir.GetSafeNormal();
+		OutObjText += FString::Printf(TEXT("o Building_%d\n"), i);
+		for (int32 Level = 0; Level < 2; ++Level)
+		{
+			const FVector Height = FVector::UpVector * ((Level * 2.0 - 1.0) * Building.BuildingExtent.Z);
+			for (const FVector2D& Corner : {
+				     FVector2D(1.0, 1.0), FVector2D(1.0, -1.0), FVector2D(-1.0, -1.0), FVector2D(-1.0, 1.0)
+			     })
+			{
+				const FVector Location = Building.Location + Height + AxisX * Corner.X * Building.BuildingExtent.X +
+					AxisY * Corner.Y * Building.BuildingExtent.Y;
+				OutObjText += FString::Printf(TEXT("v %f %f %f\n"), Location.X, Location.Y, Location.Z);
+			}
+		}
+		for (const FIntVector& Face : BoxFaces)
+		{
+			OutObjText += FString::Printf(TEXT("f %d %d %d\n"), InOutVertexOffset + Face.X,
+			                              InOutVertexOffset + Face.Y, InOutVertexOffset + Face.Z);
+		}
+		InOutVertexOffset += 8;
+	}
+}
+
+template <typename GeneratorType>
+int32 UCityGeneratorCommandlet::ExportGeneratorsToObj(const TArray<TWeakObjectPtr<GeneratorType>>& InGenerators,
+                                                      const FString& FilePath)
+{
+	FString ObjText = TEXT("# CityGenerator Export,Unreal World Space(cm,Z Up)\n");
+	int32 VertexOffset = 0;
+	int32 TriangleCount = 0;
+	for (const TWeakObjectPtr<GeneratorType>& Generator : InGenerators)
+	{
+		if (!Generator.IsValid() || nullptr == Generator->GetOwner())
+		{
+			continue;
+		}
+		const AActor* Owner = Generator->GetOwner();
+		TriangleCount += AppendDynamicMeshToObj(Owner->FindComponentByClass<UDynamicMeshComponent>(),
+		                                        Owner->GetActorNameOrLabel(), ObjText, VertexOffset);
+	}
+	if (!FFileHelper::SaveStringToFile(ObjText, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityGeneratorCommandlet]Write %s Failed"), *FilePath);
+	}
+	return TriangleCount;
+}
+
+bool UCityGeneratorCommandlet::WriteReport(const FString& FilePath, const FString& InSplineFile,
+                                           const TArray<FStageReport>& InStages,
+                                           const TMap<FString, int32>& InTriangleCounts)
+{
+	TSharedPtr<FJsonObject> ReportData = MakeShareable(new FJsonObject());
+	ReportData->SetStringField(TEXT("SplineFile"), InSplineFile);
+	double TotalSeconds = 0.0;
+	bool bSucceeded = true;
+	TArray<TSharedPtr<FJsonValue>> StageDataArray;
+	for (const FStageReport& Stage : InStages)
+	{
+		TSharedPtr<FJsonObject> StageData(new FJsonObject());
+		StageData->SetStringField(TEXT("Name"), Stage.Name);
+		StageData->SetNumberField(TEXT("Seconds"), Stage.Seconds);
+		StageData->SetNumberField(TEXT("Count"), Stage.Count);
+		if (Stage.MeshBuildSeconds > 0.0)
+		{
+			StageData->SetNumberField(TEXT("MeshBuildSeconds"), Stage.MeshBuildSeconds);
+		}
+		if (!Stage.Error.IsEmpty())
+		{
+			StageData->SetStringField(TEXT("Error"), Stage.Error);
+			bSucceeded = false;
+		}
+		StageDataArray.Emplace(MakeShareable(new FJsonValueObject(StageData)));
+		TotalSeconds += Stage.Seconds;
+	}
+	ReportData->SetArrayField(TEXT("Stages"), StageDataArray);
+	ReportData->SetNumberField(TEXT("TotalSeconds"), TotalSeconds);
+	ReportData->SetBoolField(TEXT("Succeeded"), bSucceeded);
+	TSharedPtr<FJsonObject> TriangleData(new FJsonObject());
+	for (const TPair<FString, int32>& TriangleCount : InTriangleCounts)
+	{
+		TriangleData->SetNumberField(TriangleCount.Key, TriangleCount.Value);
+	}
+	ReportData->SetObjectField(TEXT("Triangles"), TriangleData);
+
+	FString ReportStr;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&ReportStr);
+	FJsonSerializer::Serialize(ReportData.ToSharedRef(), JsonWriter);
+	return FFileHelper::SaveStringToFile(ReportStr, *FilePath);
+}
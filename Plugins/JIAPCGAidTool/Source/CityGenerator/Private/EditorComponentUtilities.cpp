@@ -3,6 +3,7 @@
 
 #include "EditorComponentUtilities.h"
 
+#include "EditorSpawnBatch.h"
 #include "NotifyUtilities.h"
 #include "Subsystems/UnrealEditorSubsystem.h"
 
@@ -13,14 +14,36 @@ TObjectPtr<AActor> UEditorComponentUtilities::SpawnEmptyActor(const FString& Act
 	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 	TObjectPtr<AActor> NewActor = GetEditorContext()->SpawnActor<AActor>(
 		AActor::StaticClass(), ActorTrans, SpawnParams);
+	FEditorSpawnBatch* SpawnBatch = FEditorSpawnBatch::GetActive();
+	if (nullptr != SpawnBatch)
+	{
+		SpawnBatch->AddSpawnedActor(NewActor, ActorName);
+	}
 	TObjectPtr<UActorComponent> SceneComp = AddComponentInEditor(NewActor, USceneComponent::StaticClass());
 	TObjectPtr<USceneComponent> RootComp = Cast<USceneComponent>(SceneComp);
 	NewActor->SetRootComponent(RootComp);
-	NewActor->SetActorLabel(ActorName);
+	//批处理时Label在提交时统一设置
+	if (nullptr == SpawnBatch)
+	{
+		NewActor->SetActorLabel(ActorName);
+	}
 	NewActor->SetActorTransform(ActorTrans);
 	return NewActor;
 }
 
+void UEditorComponentUtilities::SetActorLabelInEditor(AActor* TargetActor, const FString& ActorName)
+{
+	if (nullptr == TargetActor)
+	{
+		return;
+	}
+	FEditorSpawnBatch* SpawnBatch = FEditorSpawnBatch::GetActive();
+	if (nullptr == SpawnBatch || !SpawnBatch->SetSpawnedActorLabel(TargetActor, ActorName))
+	{
+		TargetActor->SetActorLabel(ActorName);
+	}
+}
+
 TObjectPtr<UActorComponent> UEditorComponentUtilities::AddComponentInEditor(AActor* TargetActor,
 	TSubclassOf<UActorComponent> TargetComponentClass)
 {
@@ -50,16 +73,36 @@ TObjectPtr<UActorComponent> UEditorComponentUtilities::AddComponentInEditor(AAct
 	GEditor->EndTransaction();
 	return const_cast<UActorComponent*>(ConstNewComp);*/
 	//实现方法2（https://forums.unrealengine.com/t/add-component-to-actor-in-c-the-final-word/646838/9）
-	TargetActor->Modify();
+	//批处理中生成的Actor撤销时整体删除，不需要逐次记录
+	FEditorSpawnBatch* SpawnBatch = FEditorSpawnBatch::GetActive();
+	if (nullptr == SpawnBatch || !SpawnBatch->IsSpawnedInBatch(TargetActor))
+	{
+		TargetActor->Modify();
+	}
 	TObjectPtr<UActorComponent> NewComponent = NewObject<UActorComponent>(TargetActor, TargetComponentClass);
 	NewComponent->OnComponentCreated();
 	TObjectPtr<USceneComponent> NewComponentAsSceneComp = Cast<USceneComponent>(NewComponent);
-	if (nullptr != NewComponentAsSceneComp)
+	if (nullptr != NewComponentAsSceneComp && nullptr != TargetActor->GetRootComponent())
+	{
+		//未注册时只记录挂接关系，注册时完成挂接，相对变换为默认值与SnapToTargetIncludingScale一致
+		if (nullptr != SpawnBatch)
+		{
+			NewComponentAsSceneComp->SetupAttachment(TargetActor->GetRootComponent());
+		}
+		else
+		{
+			NewComponentAsSceneComp->AttachToComponent(TargetActor->GetRootComponent(),
+			                                           FAttachmentTransformRules::SnapToTargetIncludingScale);
+		}
+	}
+	if (nullptr != SpawnBatch)
+	{
+		SpawnBatch->AddPendingComponent(NewComponent);
+	}
+	else
 	{
-		NewComponentAsSceneComp->AttachToComponent(TargetActor->GetRootComponent(),
-												   FAttachmentTransformRules::SnapToTargetIncludingScale);
+		NewComponent->RegisterComponent();
 	}
-	NewComponent->RegisterComponent();
 	TargetActor->AddInstanceComponent(NewComponent);
 	return NewComponent;
 }
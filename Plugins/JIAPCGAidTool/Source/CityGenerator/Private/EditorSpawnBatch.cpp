@@ -0,0 +1,123 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EditorSpawnBatch.h"
+
+#include "ScopedTransaction.h"
+
+static TAutoConsoleVariable<bool> CVarBatchedSpawn(
+	TEXT("CityGenerator.Editor.BatchedSpawn"), true,
+	TEXT("Spawn Generated Actors In One Transaction And Register Components In Bulk,Set To False For A/B Comparison"),
+	ECVF_Default);
+
+FEditorSpawnBatch* FEditorSpawnBatch::ActiveBatch = nullptr;
+
+FEditorSpawnBatch::FEditorSpawnBatch(const FString& InBatchName) : BatchName(InBatchName),
+                                                                   StartTime(FPlatformTime::Seconds())
+{
+	check(IsInGameThread());
+	//关闭时仍然输出耗时，用于对比批处理的收益
+	if (nullptr == ActiveBatch && CVarBatchedSpawn.GetValueOnGameThread())
+	{
+		bIsOwner = true;
+		ActiveBatch = this;
+		Transaction = MakeUnique<FScopedTransaction>(FText::FromString(BatchName));
+	}
+}
+
+FEditorSpawnBatch::~FEditorSpawnBatch()
+{
+	Commit();
+}
+
+FEditorSpawnBatch* FEditorSpawnBatch::GetActive()
+{
+	return ActiveBatch;
+}
+
+void FEditorSpawnBatch::AddSpawnedActor(AActor* InActor, const FString& InActorLabel)
+{
+	if (nullptr == InActor)
+	{
+		return;
+	}
+	SpawnedActors.Emplace(InActor, InActorLabel);
+	SpawnedActorSet.Emplace(InActor);
+}
+
+bool FEditorSpawnBatch::SetSpawnedActorLabel(const AActor* InActor, const FString& InActorLabel)
+{
+	if (!SpawnedActorSet.Contains(InActor))
+	{
+		return false;
+	}
+	for (TPair<TWeakObjectPtr<AActor>, FString>& SpawnedActor : SpawnedActors)
+	{
+		if (SpawnedActor.Key.Get() == InActor)
+		{
+			SpawnedActor.Value = InActorLabel;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FEditorSpawnBatch::AddPendingComponent(UActorComponent* InComponent)
+{
+	if (nullptr == InComponent || nullptr == InComponent->GetOwner())
+	{
+		return;
+	}
+	bool bAlreadyPending = false;
+	PendingActorSet.Emplace(InComponent->GetOwner(), &bAlreadyPending);
+	if (!bAlreadyPending)
+	{
+		PendingActors.Emplace(InComponent->GetOwner());
+	}
+	PendingComponentNum++;
+}
+
+bool FEditorSpawnBatch::IsSpawnedInBatch(const AActor* InActor) const
+{
+	return SpawnedActorSet.Contains(InActor);
+}
+
+void FEditorSpawnBatch::Commit()
+{
+	if (bCommitted)
+	{
+		return;
+	}
+	bCommitted = true;
+	const double RegisterStartTime = FPlatformTime::Seconds();
+	if (bIsOwner)
+	{
+		//先清除再注册，注册过程中触发的回调按非批处理执行
+		ActiveBatch = nullptr;
+		for (const TWeakObjectPtr<AActor>& PendingActor : PendingActors)
+		{
+			if (PendingActor.IsValid())
+			{
+				PendingActor->RegisterAllComponents();
+			}
+		}
+		for (const TPair<TWeakObjectPtr<AActor>, FString>& SpawnedActor : SpawnedActors)
+		{
+			if (SpawnedActor.Key.IsValid())
+			{
+				SpawnedActor.Key->SetActorLabel(SpawnedActor.Value, false);
+			}
+		}
+		Transaction.Reset();
+		const double EndTime = FPlatformTime::Seconds();
+		UE_LOG(LogTemp, Display,
+		       TEXT("[SpawnBatch]%s:%d Actors,%d Components,Spawn %f ms,Register %f ms,Total %f ms(Batched)"),
+		       *BatchName, SpawnedActors.Num(), PendingComponentNum, (RegisterStartTime - StartTime) * 1000.0,
+		       (EndTime - RegisterStartTime) * 1000.0, (EndTime - StartTime) * 1000.0);
+	}
+	else if (nullptr == ActiveBatch)
+	{
+		UE_LOG(LogTemp, Display, TEXT("[SpawnBatch]%s:Total %f ms(Unbatched)"), *BatchName,
+		       (RegisterStartTime - StartTime) * 1000.0);
+	}
+}
@@ -3,5 +3,54 @@
 
 #include "MeshGeneratorInterface.h"
 
+#include "UDynamicMesh.h"
+#include "Components/DynamicMeshComponent.h"
+
 
 // Add default functionality here for any IMeshGeneratorInterface functions that are not pure virtual.
+void IMeshGeneratorInterface::ResetForRegenerate()
+{
+	MeshRevision++;
+	//CommitMesh整体替换Mesh，这里清空是为了复用的Actor在重新生成前不显示旧结果
+	if (MeshComponent.IsValid() && nullptr != MeshComponent->GetDynamicMesh())
+	{
+		MeshComponent->GetDynamicMesh()->Reset();
+	}
+}
+
+bool IMeshGeneratorInterface::GenerateMesh()
+{
+	if (!PrepareBuild())
+	{
+		return false;
+	}
+	FMeshBuildResult BuildResult;
+	if (!BuildMesh(BuildResult))
+	{
+		return false;
+	}
+	CommitMesh(MoveTemp(BuildResult));
+	return true;
+}
+
+void IMeshGeneratorInterface::CommitMesh(FMeshBuildResult&& InResult)
+{
+	MeshRevision++;
+	if (MeshComponent.IsValid())
+	{
+		MeshComponent->SetMesh(MoveTemp(InResult.Mesh));
+	}
+}
+
+void IMeshGeneratorInterface::MoveScratchMeshTo(UDynamicMesh* InScratchMesh, UE::Geometry::FDynamicMesh3& OutMesh)
+{
+	if (nullptr == InScratchMesh)
+	{
+		return;
+	}
+	InScratchMesh->EditMesh([&OutMesh](UE::Geometry::FDynamicMesh3& EditMesh)
+	{
+		OutMesh = MoveTemp(EditMesh);
+		EditMesh.Clear();
+	});
+}
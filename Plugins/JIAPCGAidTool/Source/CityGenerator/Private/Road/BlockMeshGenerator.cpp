@@ -5,6 +5,7 @@
 
 #include "EditorComponentUtilities.h"
 #include "NotifyUtilities.h"
+#include "UDynamicMesh.h"
 #include "Components/DynamicMeshComponent.h"
 #include "Components/SplineComponent.h"
 #include "GeometryScript/MeshNormalsFunctions.h"
@@ -43,6 +44,13 @@ void UBlockMeshGenerator::SetSweepPath(const TArray<FVector>& InSweepPath)
 	}
 }
 
+void UBlockMeshGenerator::ResetForRegenerate()
+{
+	IMeshGeneratorInterface::ResetForRegenerate();
+	ExtrudePath.Reset();
+	ControlPointsOfAmongRoads.Reset();
+}
+
 void UBlockMeshGenerator::SetMeshComponent(class UDynamicMeshComponent* InMeshComponent)
 {
 	if (InMeshComponent != nullptr)
@@ -51,7 +59,7 @@ void UBlockMeshGenerator::SetMeshComponent(class UDynamicMeshComponent* InMeshCo
 	}
 }
 
-bool UBlockMeshGenerator::GenerateMesh()
+bool UBlockMeshGenerator::PrepareBuild()
 {
 	AActor* Owner = GetOwner();
 	ensureAlwaysMsgf(nullptr!=Owner, TEXT("Component Has No Owner"));
@@ -78,8 +86,26 @@ bool UBlockMeshGenerator::GenerateMesh()
 				TEXT("[ERROR]%s Create Block Failed,Extrude Is Not Defined"), *Owner->GetActorLabel()));
 		return false;
 	}
+	if (Materials.IsEmpty())
+	{
+		InitialMaterials();
+	}
+	if (nullptr == BuildScratchMesh)
+	{
+		BuildScratchMesh = NewObject<UDynamicMesh>(this, NAME_None, RF_Transient);
+	}
+	return true;
+}
 
-	UDynamicMesh* MeshPtr = MeshComponent->GetDynamicMesh();
+bool UBlockMeshGenerator::BuildMesh(FMeshBuildResult& OutResult) const
+{
+	if (nullptr == BuildScratchMesh || ExtrudePath.IsEmpty())
+	{
+		return false;
+	}
+	const TArray<FVector2D>& ExtrudeShape = ExtrudePath;
+	UDynamicMesh* MeshPtr = BuildScratchMesh;
+	MeshPtr->Reset();
 	FGeometryScriptPrimitiveOptions GeometryScriptOptions;
 	FTransform ExtrudeMeshTrans = FTransform::Identity;
 	//使用AppendDelaunayTriangulation2D方法创建面，提升成面质量
@@ -142,10 +168,6 @@ bool UBlockMeshGenerator::GenerateMesh()
 	UGeometryScriptLibrary_MeshSelectionFunctions::SelectMeshElementsByNormalAngle(
 		MeshPtr, OtherFaceSelection, FVector::UpVector, 1, EGeometryScriptMeshSelectionType::Triangles, true);
 	UGeometryScriptLibrary_MeshMaterialFunctions::SetMaterialIDForMeshSelection(MeshPtr, OtherFaceSelection, 2);
-	if (Materials.IsEmpty())
-	{
-		InitialMaterials();
-	}
 	//修正拐角处交叉
 	//@TODO:这个方法只能处理部分，后续还是得考虑自定义
 	FGeometryScriptDegenerateTriangleOptions DegenerateTriangleOptions;
@@ -155,10 +177,16 @@ bool UBlockMeshGenerator::GenerateMesh()
 
 	//缩放回原始高度
 	UGeometryScriptLibrary_MeshTransformFunctions::ScaleMesh(MeshPtr, FVector(1.0f, 1.0f, 0.3f));
-	RefreshMatsOnDynamicMeshComp();
+	MoveScratchMeshTo(MeshPtr, OutResult.Mesh);
 	return true;
 }
 
+void UBlockMeshGenerator::CommitMesh(FMeshBuildResult&& InResult)
+{
+	IMeshGeneratorInterface::CommitMesh(MoveTemp(InResult));
+	RefreshMatsOnDynamicMeshComp();
+}
+
 void UBlockMeshGenerator::SetInnerSplinePoints(
 	const TArray<FInterpCurveVector>& InOrderedControlPoints)
 {
@@ -200,10 +228,14 @@ void UBlockMeshGenerator::GenerateInnerRefSpline()
 	{
 		return;
 	}
-	UActorComponent* SplineCompTemp = UEditorComponentUtilities::AddComponentInEditor(
-		Owner, USplineComponent::StaticClass());
-	if (nullptr == SplineCompTemp) { return; }
-	RefSpline = Cast<USplineComponent>(SplineCompTemp);
+	//复用的街区已有参考样条，直接覆盖
+	if (!IsValid(RefSpline))
+	{
+		UActorComponent* SplineCompTemp = UEditorComponentUtilities::AddComponentInEditor(
+			Owner, USplineComponent::StaticClass());
+		if (nullptr == SplineCompTemp) { return; }
+		RefSpline = Cast<USplineComponent>(SplineCompTemp);
+	}
 	RefSpline->ClearSplinePoints();
 	TArray<const FInterpCurvePoint<FVector>*> ControlPoints;
 
@@ -280,10 +312,14 @@ void UBlockMeshGenerator::ExtractLinearContourOfInnerArea()
 	{
 		return;
 	}
-	UActorComponent* SplineCompTemp = UEditorComponentUtilities::AddComponentInEditor(
-		Owner, USplineComponent::StaticClass());
-	if (nullptr == SplineCompTemp) { return; }
-	RefSpline = Cast<USplineComponent>(SplineCompTemp);
+	//复用的街区已有参考样条，直接覆盖
+	if (!IsValid(RefSpline))
+	{
+		UActorComponent* SplineCompTemp = UEditorComponentUtilities::AddComponentInEditor(
+			Owner, USplineComponent::StaticClass());
+		if (nullptr == SplineCompTemp) { return; }
+		RefSpline = Cast<USplineComponent>(SplineCompTemp);
+	}
 	RefSpline->ClearSplinePoints();
 	RefSpline->AddPoints(SimplifiedPoints, false);
 	RefSpline->SetClosedLoop(true, false);
@@ -0,0 +1,77 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/CityModel.h"
+#include "CityLayoutSerializer.h"
+
+FCityModelSpline FCityModelSpline::MakeFromPoints(const TArray<FVector>& InPointsWS, bool bInClosedLoop,
+                                                  bool bInLinear)
+{
+	FCityModelSpline Spline;
+	Spline.bClosedLoop = bInClosedLoop;
+	const EInterpCurveMode InterpMode = bInLinear ? CIM_Linear : CIM_CurveAuto;
+	for (int32 i = 0; i < InPointsWS.Num(); ++i)
+	{
+		Spline.Curves.Position.Points.Emplace(i, InPointsWS[i], FVector::ZeroVector, FVector::ZeroVector, InterpMode);
+		Spline.Curves.Rotation.Points.Emplace(i, FQuat::Identity, FQuat::Identity, FQuat::Identity, CIM_CurveAuto);
+		Spline.Curves.Scale.Points.Emplace(i, FVector(1.0f), FVector::ZeroVector, FVector::ZeroVector, CIM_CurveAuto);
+	}
+	//与USplineComponent默认值一致，每段10步重参数化
+	Spline.Curves.UpdateSpline(bInClosedLoop, false, 10);
+	return Spline;
+}
+
+FCityModelSpline FCityModelSpline::MakeFromLayout(const FCityLayout& InLayout, int32 SplineIndex)
+{
+	FCityModelSpline Spline;
+	if (!InLayout.Splines.IsValidIndex(SplineIndex))
+	{
+		return Spline;
+	}
+	const FCityLayoutSpline& SplineData = InLayout.Splines[SplineIndex];
+	Spline.Transform = SplineData.OwnerTransform;
+	Spline.bClosedLoop = SplineData.bClosedLoop;
+	for (int32 i = 0; i < SplineData.PointNum; ++i)
+	{
+		const int32 PointIndex = SplineData.FirstPoint + i;
+		const EInterpCurveMode InterpMode = ConvertSplinePointTypeToInterpCurveMode(
+			static_cast<ESplinePointType::Type>(InLayout.PointTypes[PointIndex]));
+		const FVector& Tangent = InLayout.PointTangents[PointIndex];
+		Spline.Curves.Position.Points.Emplace(i, InLayout.PointLocations[PointIndex], Tangent, Tangent, InterpMode);
+		Spline.Curves.Rotation.Points.Emplace(i, FQuat::Identity, FQuat::Identity, FQuat::Identity, CIM_CurveAuto);
+		Spline.Curves.Scale.Points.Emplace(i, FVector(1.0f), FVector::ZeroVector, FVector::ZeroVector, CIM_CurveAuto);
+	}
+	Spline.Curves.UpdateSpline(Spline.bClosedLoop, false, 10);
+	return Spline;
+}
+
+int32 FCityModel::AddSpline(FCityModelSpline&& InSpline)
+{
+	InSpline.ID = Splines.Num();
+	return Splines.Emplace(MoveTemp(InSpline));
+}
+
+void FCityModel::ResetGeneratedData()
+{
+	for (FCityModelSpline& Spline : Splines)
+	{
+		Spline.ResamplePoints.Reset();
+		Spline.ResampleDistances.Reset();
+		Spline.SegmentSplineId = INDEX_NONE;
+	}
+	Segments.Empty();
+	SegmentBVH.Empty();
+	StoreSplineToSplineID.Reset();
+	SegmentHits.Reset();
+	Intersections.Reset();
+	Roads.Reset();
+	UnconnectedPoints.Reset();
+	Graph.Reset();
+	Blocks.Reset();
+}
+
+void FCityModel::Reset()
+{
+	ResetGeneratedData();
+	Splines.Reset();
+}
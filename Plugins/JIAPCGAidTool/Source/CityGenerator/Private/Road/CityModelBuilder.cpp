@@ -0,0 +1,824 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/CityModelBuilder.h"
+
+#include "Async/ParallelFor.h"
+#include "Road/CityModel.h"
+#include "Road/RoadGeneratorSubsystem.h"
+#include "Road/RoadGeometryUtilities.h"
+#include "Road/RoadGraphForBlock.h"
+#include "Road/SplineCursorEvaluator.h"
+
+/**
+ * 与USplineComponent::DivideSplineIntoPolylineRecursiveWithDistancesHelper相同的二分细分，
+ * 中点到弦的距离平方不超过MaxSquareDistance时停止，只输出终点距离，起点由调用方写入
+ */
+static void DividePolyLineRecursively(FSplineCursorEvaluator& Evaluator, double StartDistance, double EndDistance,
+                                      double MaxSquareDistance, TArray<double>& OutDistances)
+{
+	if (EndDistance - StartDistance <= 0.0)
+	{
+		return;
+	}
+	const double MiddleDistance = StartDistance + (EndDistance - StartDistance) / 2.0;
+	const FVector StartLocation = Evaluator.Evaluate(StartDistance).Transform.GetLocation();
+	const FVector MiddleLocation = Evaluator.Evaluate(MiddleDistance).Transform.GetLocation();
+	const FVector EndLocation = Evaluator.Evaluate(EndDistance).Transform.GetLocation();
+	if (FMath::PointDistToSegmentSquared(MiddleLocation, StartLocation, EndLocation) > MaxSquareDistance)
+	{
+		DividePolyLineRecursively(Evaluator, StartDistance, MiddleDistance, MaxSquareDistance, OutDistances);
+		DividePolyLineRecursively(Evaluator, MiddleDistance, EndDistance, MaxSquareDistance, OutDistances);
+		return;
+	}
+	//常量样条起止点可能重合，只保留一个
+	if (StartLocation != EndLocation)
+	{
+		OutDistances.Add(EndDistance);
+	}
+}
+
+/**
+ * 定距采样，与ConvertSplineToPolyLineWithDistances(World,MaxSquareDistance)一致，每段先二等分，再分别递归
+ */
+static void SampleDistancesAsPolyLine(const FSplineSnapshot& TargetSpline, double MaxSquareDistance,
+                                      TArray<double>& OutDistances)
+{
+	OutDistances.Reset();
+	FSplineCursorEvaluator Evaluator = TargetSpline.MakeEvaluator();
+	if (!Evaluator.IsValid())
+	{
+		return;
+	}
+	OutDistances.Add(0.0);
+	const int32 SegmentNum = TargetSpline.GetNumberOfSplineSegments();
+	for (int32 SegmentIndex = 0; SegmentIndex < SegmentNum; ++SegmentIndex)
+	{
+		const double StartDistance = TargetSpline.GetDistanceAlongSplineAtSplinePoint(SegmentIndex);
+		const double EndDistance = TargetSpline.GetDistanceAlongSplineAtSplinePoint(SegmentIndex + 1);
+		const double MiddleDistance = StartDistance + (EndDistance - StartDistance) / 2.0;
+		DividePolyLineRecursively(Evaluator, StartDistance, MiddleDistance, MaxSquareDistance, OutDistances);
+		DividePolyLineRecursively(Evaluator, MiddleDistance, EndDistance, MaxSquareDistance, OutDistances);
+	}
+}
+
+/**
+ * 按弦高误差自适应步进，曲率大处加密、直线段放大步长，控制点处一定有采样点
+ */
+static void SampleDistancesAdaptively(const FSplineSnapshot& TargetSpline, float ChordTolerance, float MinStep,
+                                      float MaxStep, TArray<double>& OutDistances)
+{
+	OutDistances.Reset();
+	FSplineCursorEvaluator Evaluator = TargetSpline.MakeEvaluator();
+	if (!Evaluator.IsValid())
+	{
+		return;
+	}
+	const int32 SegmentNum = TargetSpline.GetNumberOfSplineSegments();
+	const int32 PointNum = TargetSpline.GetNumberOfSplinePoints();
+
+	FSplineCursorEvaluator::FSample CurrentSample = Evaluator.Evaluate(0.0f);
+	double CurrentDistance = 0.0;
+	OutDistances.Add(CurrentDistance);
+	float Step = MaxStep;
+	for (int32 SegmentIndex = 0; SegmentIndex < SegmentNum; ++SegmentIndex)
+	{
+		//闭合样条最后一段终点为样条全长
+		const double SegmentEndDistance = SegmentIndex + 1 < PointNum
+			                                  ? TargetSpline.GetDistanceAlongSplineAtSplinePoint(SegmentIndex + 1)
+			                                  : TargetSpline.GetSplineLength();
+		while (SegmentEndDistance - CurrentDistance > KINDA_SMALL_NUMBER)
+		{
+			const double RemainDistance = SegmentEndDistance - CurrentDistance;
+			//剩余长度不足一步的1.25倍时直接走到控制点，避免留下过短的Segment
+			Step = RemainDistance < 1.25 * Step ? static_cast<float>(RemainDistance) : Step;
+			FSplineCursorEvaluator::FSample EndSample;
+			float ChordError = 0.0f;
+			while (true)
+			{
+				const FSplineCursorEvaluator::FSample MidSample = Evaluator.Evaluate(CurrentDistance + 0.5 * Step);
+				EndSample = Evaluator.Evaluate(CurrentDistance + Step);
+				const FVector StartLocation = CurrentSample.Transform.GetLocation();
+				const FVector EndLocation = EndSample.Transform.GetLocation();
+				//弦高误差取中点到弦的距离与由切线夹角估计的圆弧弦高中的较大值，后者可以发现中点恰好落在弦上的S形弯
+				//终点可能是Linear控制点，切线不连续，因此只比较起点和中点的切线：半步转角θ对应弦高约为s*θ/4
+				const float TurnAngle = static_cast<float>(FMath::Acos(FMath::Clamp(
+					CurrentSample.TangentWS.GetSafeNormal() | MidSample.TangentWS.GetSafeNormal(), -1.0, 1.0)));
+				ChordError = FMath::Max(
+					static_cast<float>(FMath::PointDistToSegment(MidSample.Transform.GetLocation(), StartLocation,
+					                                             EndLocation)), Step * TurnAngle / 4.0f);
+				if (ChordError <= ChordTolerance || Step <= MinStep)
+				{
+					break;
+				}
+				//e≈s²κ/8，按误差比例的平方根缩短步长
+				Step = FMath::Max(MinStep, Step * FMath::Clamp(0.9f * FMath::Sqrt(ChordTolerance / ChordError),
+				                                               0.1f, 0.5f));
+			}
+			CurrentDistance += Step;
+			CurrentSample = EndSample;
+			OutDistances.Add(CurrentDistance);
+			//曲率变小时放大下一步，最多翻倍
+			const float GrowScale = ChordError > KINDA_SMALL_NUMBER
+				                        ? FMath::Clamp(0.9f * FMath::Sqrt(ChordTolerance / ChordError), 1.0f, 2.0f)
+				                        : 2.0f;
+			Step = FMath::Clamp(Step * GrowScale, MinStep, MaxStep);
+		}
+		//消除浮点累计误差，保证控制点处的InputKey为整数
+		OutDistances.Last() = SegmentEndDistance;
+		CurrentDistance = SegmentEndDistance;
+	}
+}
+
+FCityModelBuilder::FCityModelBuilder(const FCityModelBuildSettings& InSettings) : Settings(InSettings)
+{
+}
+
+bool FCityModelBuilder::Build(FCityModel& InOutModel) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCityModelBuilder::Build);
+	const double StartTime = FPlatformTime::Seconds();
+	if (!ResampleSplines(InOutModel) || !FindIntersections(InOutModel))
+	{
+		return false;
+	}
+	SplitRoads(InOutModel);
+	BuildGraph(InOutModel);
+	FindBlocks(InOutModel);
+	UE_LOG(LogTemp, Display, TEXT("Build City Model:%d Splines,%d Intersections,%d Roads,%d Blocks,Cost %f ms"),
+	       InOutModel.Splines.Num(), InOutModel.Intersections.Num(), InOutModel.Roads.Num(), InOutModel.Blocks.Num(),
+	       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+#pragma region Resample
+bool FCityModelBuilder::ResampleSplines(FCityModel& InOutModel) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCityModelBuilder::ResampleSplines);
+	InOutModel.ResetGeneratedData();
+	ParallelFor(InOutModel.Splines.Num(), [&](int32 i)
+	{
+		ResampleSpline(InOutModel.Splines[i]);
+	}, Settings.bParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+	//按样条顺序追加，GlobalIndex为Segment数量前缀和，编号与线程调度无关
+	uint32 NextGlobalIndex = 0;
+	for (FCityModelSpline& Spline : InOutModel.Splines)
+	{
+		if (Spline.ResamplePoints.Num() < 2)
+		{
+			continue;
+		}
+		Spline.SegmentSplineId = InOutModel.Segments.AppendSpline(nullptr, Spline.ResamplePoints, NextGlobalIndex);
+		check(Spline.SegmentSplineId == InOutModel.StoreSplineToSplineID.Num());
+		InOutModel.StoreSplineToSplineID.Emplace(Spline.ID);
+		NextGlobalIndex += Spline.ResamplePoints.Num() - 1;
+	}
+	InOutModel.SegmentBVH = URoadGeneratorSubsystem::BuildSegmentBVH(InOutModel.Segments);
+	return !InOutModel.Segments.IsEmpty();
+}
+
+void FCityModelBuilder::ResampleSpline(const FSplineSnapshot& InSpline, TArray<FTransform>& OutPoints,
+                                       TArray<double>* OutDistances) const
+{
+	OutPoints.Reset();
+	TArray<double> PolyLineLengths;
+	if (!InSpline.IsValid() || InSpline.GetNumberOfSplinePoints() <= 1)
+	{
+		if (nullptr != OutDistances)
+		{
+			OutDistances->Reset();
+		}
+		return;
+	}
+	const float SegmentMaxDisThreshold = Settings.SegmentMaxLength;
+	if (Settings.bAdaptiveResample)
+	{
+		//急弯处步长下限，避免尖角处无限细分
+		SampleDistancesAdaptively(InSpline, FMath::Max(0.1f, Settings.AdaptiveChordError),
+		                          0.05f * Settings.SampleDistance, SegmentMaxDisThreshold, PolyLineLengths);
+	}
+	else
+	{
+		//Distance数组是到每一个端点处的长度（类似前缀和）,ControlPoint位置一定会有一个采样点
+		SampleDistancesAsPolyLine(InSpline, Settings.SampleDistance, PolyLineLengths);
+	}
+	//距离单调递增，用游标一次遍历同时得到InputKey和Transform，顺带记录Linear控制点
+	FSplineCursorEvaluator Evaluator = InSpline.MakeEvaluator();
+	TArray<int32> LinearControlPointIndexes;
+	OutPoints.Reserve(PolyLineLengths.Num());
+	for (int32 i = 0; i < PolyLineLengths.Num(); ++i)
+	{
+		const FSplineCursorEvaluator::FSample Sample = Evaluator.Evaluate(PolyLineLengths[i], true);
+		OutPoints.Emplace(Sample.Transform);
+		if (FMath::IsNearlyEqual(Sample.InputKey, FMath::RoundToFloat(Sample.InputKey)))
+		{
+			const int32 ControlPointIndex = static_cast<int32>(Sample.InputKey);
+			if (InSpline.IsLinearPoint(ControlPointIndex) && i > 0 && i < PolyLineLengths.Num() - 1)
+			{
+				LinearControlPointIndexes.Add(i);
+			}
+		}
+	}
+
+	if (!LinearControlPointIndexes.IsEmpty())
+	{
+		TMap<int32, TArray<FTransform>> InterplatePointsOnControlPoints;
+		TMap<int32, TArray<double>> InterplateLengthOnSpline;
+		//值过小会因为被BVH判定为相交，生成交汇路口时报错
+		const float AdditionalSampleDistance = 4 * Settings.SampleDistance;
+		for (const int32 ControlPointIndex : LinearControlPointIndexes)
+		{
+			//相邻采样点在上面的遍历中已经求过，这里只补充额外采样点，求值顺序保持单调
+			const float FrontNeighbourDis = PolyLineLengths[ControlPointIndex] - PolyLineLengths[ControlPointIndex -
+				1];
+			FTransform LastTransform = OutPoints[ControlPointIndex - 1];
+			if (FrontNeighbourDis > AdditionalSampleDistance)
+			{
+				LastTransform = Evaluator.Evaluate(PolyLineLengths[ControlPointIndex] - AdditionalSampleDistance,
+				                                   true).Transform;
+				InterplatePointsOnControlPoints.Emplace(ControlPointIndex - 1).Add(LastTransform);
+				InterplateLengthOnSpline.Emplace(ControlPointIndex - 1).Emplace(
+					PolyLineLengths[ControlPointIndex] - AdditionalSampleDistance);
+			}
+			const float NextNeighbourDis = PolyLineLengths[ControlPointIndex + 1] - PolyLineLengths[ControlPointIndex];
+			FTransform NextTransform = OutPoints[ControlPointIndex + 1];
+			if (NextNeighbourDis > AdditionalSampleDistance)
+			{
+				NextTransform = Evaluator.Evaluate(PolyLineLengths[ControlPointIndex] + AdditionalSampleDistance,
+				                                   true).Transform;
+				InterplatePointsOnControlPoints.Add(ControlPointIndex).Add(NextTransform);
+				InterplateLengthOnSpline.Add(ControlPointIndex).Emplace(
+					PolyLineLengths[ControlPointIndex] + AdditionalSampleDistance);
+			}
+			//FQuat不要使用(A+B)/2计算值不对
+			OutPoints[ControlPointIndex].SetRotation(
+				FQuat::Slerp(LastTransform.GetRotation(), NextTransform.GetRotation(), 0.5));
+		}
+		URoadGeneratorSubsystem::InsertElementsAtIndex(OutPoints, InterplatePointsOnControlPoints);
+		URoadGeneratorSubsystem::InsertElementsAtIndex(PolyLineLengths, InterplateLengthOnSpline);
+	}
+
+	//检测分段长度是否符合设定要求，如果不符合则在记录的位置增加细分，TMap按插入顺序遍历，距离仍单调递增
+	TMap<int32, TArray<FTransform>> SegmentsToSubdivide;
+	TMap<int32, TArray<double>> SubdivisionLengths;
+	Evaluator.Reset();
+	for (int32 i = 1; i < OutPoints.Num(); ++i)
+	{
+		const double OriginalSegmentLength = PolyLineLengths[i] - PolyLineLengths[i - 1];
+		if (OriginalSegmentLength <= SegmentMaxDisThreshold)
+		{
+			continue;
+		}
+		//以该点为起点的位置需要插入元素
+		const int32 TargetSubdivisionNum = FMath::CeilToInt32(OriginalSegmentLength / SegmentMaxDisThreshold);
+		const double TargetSubdivisionLength = OriginalSegmentLength / TargetSubdivisionNum;
+		TArray<FTransform>& SubdivisionPoints = SegmentsToSubdivide.Emplace(i - 1);
+		TArray<double>& SubdivisionDistances = SubdivisionLengths.Emplace(i - 1);
+		for (int32 j = 1; j < TargetSubdivisionNum; j++)
+		{
+			const double DisToSubdivisionPoint = j * TargetSubdivisionLength + PolyLineLengths[i - 1];
+			SubdivisionPoints.Add(Evaluator.Evaluate(DisToSubdivisionPoint).Transform);
+			SubdivisionDistances.Add(DisToSubdivisionPoint);
+		}
+	}
+	//FTransform为非POD对象，不能直接内存拷贝
+	URoadGeneratorSubsystem::InsertElementsAtIndex(OutPoints, SegmentsToSubdivide);
+	if (nullptr != OutDistances)
+	{
+		URoadGeneratorSubsystem::InsertElementsAtIndex(PolyLineLengths, SubdivisionLengths);
+		*OutDistances = MoveTemp(PolyLineLengths);
+	}
+}
+
+void FCityModelBuilder::ResampleSpline(FCityModelSpline& InOutSpline) const
+{
+	ResampleSpline(InOutSpline, InOutSpline.ResamplePoints, &InOutSpline.ResampleDistances);
+}
+#pragma endregion Resample
+
+#pragma region Intersection
+bool FCityModelBuilder::FindIntersections(FCityModel& InOutModel) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCityModelBuilder::FindIntersections);
+	InOutModel.SegmentHits.Reset();
+	InOutModel.Intersections.Reset();
+	InOutModel.Roads.Reset();
+	InOutModel.UnconnectedPoints.Reset();
+	InOutModel.Graph.Reset();
+	InOutModel.Blocks.Reset();
+	const FSplineSegmentStore& Store = InOutModel.Segments;
+	if (Store.IsEmpty())
+	{
+		return false;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	InOutModel.SegmentHits = Settings.bUseSweepLine
+		                         ? URoadGeneratorSubsystem::FindSegmentHitsBySweepLine(Store)
+		                         : URoadGeneratorSubsystem::FindSegmentHitsByBVH(InOutModel.SegmentBVH, Store);
+	UE_LOG(LogTemp, Display, TEXT("Find %d Raw Hits In %d Segments(%s),Cost %f ms"), InOutModel.SegmentHits.Num(),
+	       Store.Num(), Settings.bUseSweepLine ? TEXT("SweepLine") : TEXT("BVH"),
+	       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	TArray<FCityModelIntersection> Intersections = MergeSegmentHits(Store, InOutModel.SegmentHits,
+	                                                                Settings.MergeThreshold);
+	for (FCityModelIntersection& Intersection : Intersections)
+	{
+		for (int32& SplineID : Intersection.SplineIDs)
+		{
+			SplineID = InOutModel.StoreSplineToSplineID[SplineID];
+		}
+	}
+	//切割交点分段，只访问样条快照
+	TArray<bool> bTearSucceeded;
+	bTearSucceeded.Init(false, Intersections.Num());
+	ParallelFor(Intersections.Num(), [&](int32 i)
+	{
+		TArray<const FSplineSnapshot*> IntersectedSplines;
+		IntersectedSplines.Reserve(Intersections[i].SplineIDs.Num());
+		for (const int32 SplineID : Intersections[i].SplineIDs)
+		{
+			IntersectedSplines.Emplace(InOutModel.Splines.IsValidIndex(SplineID)
+				                           ? &InOutModel.Splines[SplineID]
+				                           : nullptr);
+		}
+		bTearSucceeded[i] = TearIntersection(Intersections[i], IntersectedSplines);
+	}, Settings.bParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+	//丢弃拆分失败的交点，ID保持连续
+	InOutModel.Intersections.Reserve(Intersections.Num());
+	for (int32 i = 0; i < Intersections.Num(); ++i)
+	{
+		if (bTearSucceeded[i])
+		{
+			Intersections[i].ID = InOutModel.Intersections.Num();
+			InOutModel.Intersections.Emplace(MoveTemp(Intersections[i]));
+		}
+	}
+	return !InOutModel.Intersections.IsEmpty();
+}
+
+TArray<FCityModelIntersection> FCityModelBuilder::MergeSegmentHits(const FSplineSegmentStore& InStore,
+                                                                   const TArray<FSegmentPairHit>& InHits,
+                                                                   float InMergeThreshold)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCityModelBuilder::MergeSegmentHits);
+	TArray<FCityModelIntersection> Results;
+	TArray<FVector2D> HitLocations;
+	HitLocations.Reserve(InHits.Num());
+	for (const FSegmentPairHit& Hit : InHits)
+	{
+		HitLocations.Emplace(Hit.Location);
+	}
+	//相当于用空间关系进行交点索引，传递合并，编号按类中首个原始交点顺序
+	//@TODO:这里可能需要一个优先级算法确定以谁为终点
+	TArray<int32> ClusterIndices;
+	const int32 ClusterNum = URoadGeometryUtilities::ClusterPoints2D(HitLocations, InMergeThreshold, ClusterIndices);
+	Results.SetNum(ClusterNum);
+	TArray<int32> HitCountOfCluster;
+	HitCountOfCluster.Init(0, ClusterNum);
+	for (int32 i = 0; i < InHits.Num(); ++i)
+	{
+		const FSegmentPairHit& Hit = InHits[i];
+		FCityModelIntersection& Result = Results[ClusterIndices[i]];
+		//同一样条在一个路口只记录一次，避免拆分路口时生成重复的接口
+		//增量更新后SplineId会被重新编号，因此由GlobalIndex查找
+		for (const uint32 GlobalIndex : {Hit.GlobalIndexA, Hit.GlobalIndexB})
+		{
+			Result.SplineIDs.AddUnique(InStore.GetSplineId(InStore.IndexOfGlobalIndex(GlobalIndex)));
+		}
+		Result.SourceHitPairs.Emplace(static_cast<uint64>(Hit.GlobalIndexA) << 32 | Hit.GlobalIndexB);
+		//先累加，最后求质心
+		Result.Location += FVector(Hit.Location, 0.0);
+		HitCountOfCluster[ClusterIndices[i]]++;
+	}
+	for (int32 i = 0; i < ClusterNum; ++i)
+	{
+		Results[i].Location /= HitCountOfCluster[i];
+		Results[i].SourceHitPairs.Sort();
+	}
+	return Results;
+}
+
+bool FCityModelBuilder::TearIntersection(FCityModelIntersection& InOutIntersection,
+                                         const TArray<const FSplineSnapshot*>& InSplines) const
+{
+	TArray<FCityModelEntry>& Entries = InOutIntersection.Entries;
+	Entries.Reset();
+	InOutIntersection.OccupiedBox.Init();
+	if (InOutIntersection.SplineIDs.IsEmpty() || InSplines.Num() != InOutIntersection.SplineIDs.Num())
+	{
+		return false;
+	}
+	const float UniformDistance = Settings.EntryDistance;
+	Entries.Reserve(InSplines.Num() * 2);
+	for (int32 i = 0; i < InSplines.Num(); ++i)
+	{
+		const FSplineSnapshot* TargetSpline = InSplines[i];
+		if (nullptr == TargetSpline || !TargetSpline->IsValid())
+		{
+			return false;
+		}
+		const float Distance = TargetSpline->GetDistanceAlongSplineAtLocation(InOutIntersection.Location);
+		//按距离从小到大求前后两个端点，驶入端的Rotation沿用后一个端点处的值
+		FSplineCursorEvaluator Evaluator = TargetSpline->MakeEvaluator();
+		const float DistanceOfNextPoint = Distance + UniformDistance;
+		FSplineCursorEvaluator::FSample FlowInSample;
+		if (Distance > UniformDistance)
+		{
+			FlowInSample = Evaluator.Evaluate(Distance - UniformDistance);
+		}
+		const FSplineCursorEvaluator::FSample FlowOutSample = Evaluator.Evaluate(DistanceOfNextPoint);
+		const FRotator FlowOutPointRot = FlowOutSample.Transform.Rotator();
+		//判断后边一段是不是在样条上
+		if (DistanceOfNextPoint < Evaluator.GetSplineLength())
+		{
+			FCityModelEntry& Entry = Entries.AddDefaulted_GetRef();
+			Entry.SplineID = InOutIntersection.SplineIDs[i];
+			Entry.EndPoint = FlowOutSample.Transform.GetLocation();
+			Entry.EndRotation = FlowOutPointRot;
+			Entry.bIsFlowIn = false;
+			Entry.RoadWidth = Settings.RoadWidth;
+		}
+		//判断前边一段是不是在样条上
+		if (Distance > UniformDistance)
+		{
+			FCityModelEntry& Entry = Entries.AddDefaulted_GetRef();
+			Entry.SplineID = InOutIntersection.SplineIDs[i];
+			Entry.EndPoint = FlowInSample.Transform.GetLocation();
+			Entry.EndRotation = FlowOutPointRot;
+			Entry.bIsFlowIn = true;
+			Entry.RoadWidth = Settings.RoadWidth;
+		}
+	}
+	if (Entries.IsEmpty())
+	{
+		return false;
+	}
+	//根据顺时针顺序排序，X正方向为0，Y正方向为正，在ParallelFor中调用，比较函数中不输出日志
+	const FVector2D Center(InOutIntersection.Location);
+	Entries.Sort([&Center](const FCityModelEntry& A, const FCityModelEntry& B)
+	{
+		const FVector2D RelA = FVector2D(A.EndPoint) - Center;
+		const FVector2D RelB = FVector2D(B.EndPoint) - Center;
+		float AngleA = FMath::Atan2(RelA.Y, RelA.X);
+		float AngleB = FMath::Atan2(RelB.Y, RelB.X);
+		// Atan2返回范围为[-π,π)转换为[0, 2π)范围
+		if (AngleA < 0) AngleA += 2 * PI;
+		if (AngleB < 0) AngleB += 2 * PI;
+		//极角相同时按距离排序（近的在前）
+		return AngleA != AngleB ? AngleA < AngleB : RelA.SizeSquared() < RelB.SizeSquared();
+	});
+	//衔接点和占用范围与UIntersectionMeshGenerator::CreateExtrudeShape中的道路边线起点一致
+	for (FCityModelEntry& Entry : Entries)
+	{
+		const FVector2D EndPoint2D(Entry.EndPoint);
+		const FVector2D DirToCenter = (Center - EndPoint2D).GetSafeNormal();
+		const FVector2D RightEdge = DirToCenter.GetRotated(90.0) * Entry.RoadWidth * 0.5;
+		InOutIntersection.OccupiedBox += EndPoint2D + RightEdge;
+		InOutIntersection.OccupiedBox += EndPoint2D - RightEdge;
+		Entry.ConnectionPoint = FVector(EndPoint2D + DirToCenter * Settings.ConnectionInset, 0.0);
+	}
+	return true;
+}
+#pragma endregion Intersection
+
+#pragma region Road
+bool FCityModelBuilder::SplitRoads(FCityModel& InOutModel) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCityModelBuilder::SplitRoads);
+	InOutModel.Roads.Reset();
+	InOutModel.UnconnectedPoints.Reset();
+	InOutModel.Graph.Reset();
+	InOutModel.Blocks.Reset();
+	TArray<TArray<int32>> IntersectionsOnSpline;
+	IntersectionsOnSpline.SetNum(InOutModel.Splines.Num());
+	for (const FCityModelIntersection& Intersection : InOutModel.Intersections)
+	{
+		for (const int32 SplineID : Intersection.SplineIDs)
+		{
+			//道路切分前由编辑器数据构建时，路口可能经过不在模型中的样条
+			if (IntersectionsOnSpline.IsValidIndex(SplineID))
+			{
+				IntersectionsOnSpline[SplineID].AddUnique(Intersection.ID);
+			}
+		}
+	}
+	TArray<TArray<FCityModelRoad>> RoadsOnSpline;
+	RoadsOnSpline.SetNum(InOutModel.Splines.Num());
+	TArray<TArray<FVector>> UnconnectedPointsOnSpline;
+	UnconnectedPointsOnSpline.SetNum(InOutModel.Splines.Num());
+	ParallelFor(InOutModel.Splines.Num(), [&](int32 i)
+	{
+		SplitRoadsOnSpline(InOutModel, i, IntersectionsOnSpline[i], RoadsOnSpline[i], UnconnectedPointsOnSpline[i]);
+	}, Settings.bParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+	//按样条顺序分配道路ID，结果与线程调度无关
+	for (int32 i = 0; i < InOutModel.Splines.Num(); ++i)
+	{
+		for (FCityModelRoad& Road : RoadsOnSpline[i])
+		{
+			Road.ID = InOutModel.Roads.Num();
+			InOutModel.Roads.Emplace(MoveTemp(Road));
+		}
+		InOutModel.UnconnectedPoints.Append(UnconnectedPointsOnSpline[i]);
+	}
+	return !InOutModel.Roads.IsEmpty();
+}
+
+void FCityModelBuilder::SplitRoadsOnSpline(const FCityModel& InModel, int32 SplineID,
+                                           const TArray<int32>& InIntersectionIDs,
+                                           TArray<FCityModelRoad>& OutRoads,
+                                           TArray<FVector>& OutUnconnectedPoints) const
+{
+	const FCityModelSpline& TargetSpline = InModel.Splines[SplineID];
+	const FSplineSegmentStore& Store = InModel.Segments;
+	const int32 SplineIdInStore = TargetSpline.SegmentSplineId;
+	if (!TargetSpline.IsValid() || SplineIdInStore == INDEX_NONE)
+	{
+		return;
+	}
+	FSplineCursorEvaluator Evaluator = TargetSpline.MakeEvaluator();
+	//1.找到所有Segment，然后从其中移除被交叉路口占用的，均使用GlobalID作为区分
+	const int32 FirstSegment = Store.GetSplineFirstSegment(SplineIdInStore);
+	const int32 SegmentNum = Store.GetSplineSegmentNum(SplineIdInStore);
+	TArray<uint32> AllSegmentsIndex;
+	AllSegmentsIndex.Reserve(SegmentNum);
+	for (int32 i = 0; i < SegmentNum; ++i)
+	{
+		AllSegmentsIndex.Emplace(Store.GetGlobalIndex(FirstSegment + i));
+	}
+	if (AllSegmentsIndex.IsEmpty())
+	{
+		return;
+	}
+	TArray<uint32> OccupiedSegmentsIndex;
+	TArray<uint32> PotentialSegments;
+	for (const int32 IntersectionID : InIntersectionIDs)
+	{
+		PotentialSegments.Reset();
+		InModel.SegmentBVH.Query(InModel.Intersections[IntersectionID].OccupiedBox, PotentialSegments);
+		for (const uint32 SegmentIndex : PotentialSegments)
+		{
+			if (SplineIdInStore == Store.GetSplineId(SegmentIndex))
+			{
+				OccupiedSegmentsIndex.AddUnique(Store.GetGlobalIndex(SegmentIndex));
+			}
+		}
+	}
+	//切分出的连续分段Segment组
+	TArray<TArray<uint32>> ContinuousSegmentsGroups = URoadGeneratorSubsystem::GetContinuousIndexSeries(
+		AllSegmentsIndex, OccupiedSegmentsIndex);
+	if (ContinuousSegmentsGroups.IsEmpty())
+	{
+		return;
+	}
+
+	//2.判断路口衔接点位于哪个Segment、将其作为附加信息与连续Segments封装到FConnectionInsertInfo结构体
+	TMultiMap<int32, FConnectionInsertInfo> SegmentGroupToConnectionToHead;
+	for (const int32 IntersectionID : InIntersectionIDs)
+	{
+		const TArray<FCityModelEntry>& Entries = InModel.Intersections[IntersectionID].Entries;
+		for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+		{
+			const FCityModelEntry& Entry = Entries[EntryIndex];
+			if (Entry.SplineID != SplineID)
+			{
+				continue;
+			}
+			FBox2D BoxOfConnection(ForceInit);
+			BoxOfConnection += FVector2D(Entry.ConnectionPoint);
+			BoxOfConnection = BoxOfConnection.ExpandBy(Settings.ConnectionSearchRadius);
+			PotentialSegments.Reset();
+			InModel.SegmentBVH.Query(BoxOfConnection, PotentialSegments);
+			//有多个可能性，根据到Segment中点的距离判定究竟属于当前样条的哪个Segment
+			int32 OwnerSegmentIndex = INDEX_NONE;
+			double MinDistance = DBL_MAX;
+			for (const uint32 SegmentIndex : PotentialSegments)
+			{
+				if (SplineIdInStore != Store.GetSplineId(SegmentIndex))
+				{
+					continue;
+				}
+				const FVector2D SegmentCenter = (Store.GetStart(SegmentIndex) + Store.GetEnd(SegmentIndex)) * 0.5;
+				const double DisCenterToConnection = FVector2D::DistSquared(
+					SegmentCenter, FVector2D(Entry.ConnectionPoint));
+				if (DisCenterToConnection < MinDistance)
+				{
+					MinDistance = DisCenterToConnection;
+					OwnerSegmentIndex = SegmentIndex;
+				}
+			}
+			//部分路口外部无衔接道路
+			if (OwnerSegmentIndex == INDEX_NONE)
+			{
+				OutUnconnectedPoints.Emplace(Entry.ConnectionPoint);
+				continue;
+			}
+			FConnectionInsertInfo InsertInfo = FindInsertIndexInExistedContinuousSegments(
+				Store, ContinuousSegmentsGroups, Store.GetGlobalIndex(OwnerSegmentIndex), Entry.ConnectionPoint);
+			if (InsertInfo.GroupIndex == INDEX_NONE)
+			{
+				OutUnconnectedPoints.Emplace(Entry.ConnectionPoint);
+				continue;
+			}
+			InsertInfo.IntersectionGlobalIndex = IntersectionID;
+			//传递顺时针排序给建图用
+			InsertInfo.EntryLocalIndex = EntryIndex;
+			FTransform ConnectionTransform = Evaluator.Evaluate(
+				TargetSpline.GetDistanceAlongSplineAtLocation(Entry.ConnectionPoint)).Transform;
+			ConnectionTransform.SetRotation(Entry.EndRotation.Quaternion());
+			InsertInfo.ConnectionTrans = ConnectionTransform;
+			//不要直接在这里插入（相当于一边遍历一边修改），会破坏上面的算法
+			SegmentGroupToConnectionToHead.Emplace(InsertInfo.GroupIndex, InsertInfo);
+		}
+	}
+
+	//如果是闭合曲线且首尾两组相连，把最后一组合并到第一组之前
+	if (TargetSpline.bClosedLoop && ContinuousSegmentsGroups.Num() > 1 &&
+		AllSegmentsIndex[0] == ContinuousSegmentsGroups[0][0] &&
+		AllSegmentsIndex.Last() == ContinuousSegmentsGroups.Last().Last())
+	{
+		const int32 LastGroupIndex = ContinuousSegmentsGroups.Num() - 1;
+		TArray<uint32> NewFirstGroup = MoveTemp(ContinuousSegmentsGroups[LastGroupIndex]);
+		NewFirstGroup.Append(ContinuousSegmentsGroups[0]);
+		ContinuousSegmentsGroups[0] = MoveTemp(NewFirstGroup);
+		//能衔接的情况必然是第一组元素去除尾部或最后一组元素去除头部；因为是把最后一组元素合并到头部，所以只需要移动一组
+		TArray<FConnectionInsertInfo> InsertsOfLastGroup;
+		SegmentGroupToConnectionToHead.MultiFind(LastGroupIndex, InsertsOfLastGroup);
+		for (FConnectionInsertInfo& Insert : InsertsOfLastGroup)
+		{
+			ensureAlwaysMsgf(Insert.bConnectToGroupHead == true, TEXT("Error Insert Place,Please Check"));
+			Insert.GroupIndex = 0;
+			SegmentGroupToConnectionToHead.Emplace(0, Insert);
+		}
+		SegmentGroupToConnectionToHead.Remove(LastGroupIndex);
+		ContinuousSegmentsGroups.RemoveAt(LastGroupIndex);
+	}
+
+	//3.创建道路，旋转只在这里从SegmentStore侧边数组还原
+	OutRoads.Reserve(OutRoads.Num() + ContinuousSegmentsGroups.Num());
+	TArray<FConnectionInsertInfo> Connections;
+	for (int32 i = 0; i < ContinuousSegmentsGroups.Num(); ++i)
+	{
+		const TArray<uint32>& ContinuousSegments = ContinuousSegmentsGroups[i];
+		TArray<FTransform> RoadSegmentTransforms;
+		RoadSegmentTransforms.Reserve(ContinuousSegments.Num() + 1);
+		RoadSegmentTransforms.Emplace(Store.GetStartTransform(Store.IndexOfGlobalIndex(ContinuousSegments[0])));
+		for (const uint32 GlobalIndex : ContinuousSegments)
+		{
+			RoadSegmentTransforms.Emplace(Store.GetEndTransform(Store.IndexOfGlobalIndex(GlobalIndex)));
+		}
+		FCityModelRoad& Road = OutRoads.AddDefaulted_GetRef();
+		Road.SplineID = SplineID;
+		Road.RoadInfo = FRoadSegmentsGroup(RoadSegmentTransforms);
+		Connections.Reset();
+		SegmentGroupToConnectionToHead.MultiFind(i, Connections);
+		for (const FConnectionInsertInfo& Connection : Connections)
+		{
+			//给连接信息加负载，用于判断走向
+			const int32 EndIndex = Connection.bConnectToGroupHead ? 0 : 1;
+			Road.ConnectedIntersections[EndIndex] = Connection.IntersectionGlobalIndex;
+			Road.EntryIndexOfIntersections[EndIndex] = Connection.EntryLocalIndex;
+			if (Connection.bConnectToGroupHead)
+			{
+				Road.RoadInfo.bHasHeadConnection = true;
+				Road.RoadInfo.HeadConnectionTrans = Connection.ConnectionTrans;
+				Road.RoadInfo.FromIntersectionIndex = Connection.IntersectionGlobalIndex;
+			}
+			else
+			{
+				Road.RoadInfo.bHasTailConnection = true;
+				Road.RoadInfo.TailConnectionTrans = Connection.ConnectionTrans;
+				Road.RoadInfo.ToIntersectionIndex = Connection.IntersectionGlobalIndex;
+			}
+		}
+	}
+}
+
+FConnectionInsertInfo FCityModelBuilder::FindInsertIndexInExistedContinuousSegments(
+	const FSplineSegmentStore& InStore, const TArray<TArray<uint32>>& InContinuousSegmentsGroups,
+	uint32 OwnerSegmentID, const FVector& PointTransWS)
+{
+	FConnectionInsertInfo Result;
+	//利用连续特性,寻找是不是在端点
+	if (OwnerSegmentID < InContinuousSegmentsGroups[0][0])
+	{
+		Result.GroupIndex = 0;
+		Result.bConnectToGroupHead = true;
+		return Result;
+	}
+	if (OwnerSegmentID > InContinuousSegmentsGroups.Last().Last())
+	{
+		Result.GroupIndex = InContinuousSegmentsGroups.Num() - 1;
+		Result.bConnectToGroupHead = false;
+		return Result;
+	}
+	//@TODO：可以使用二分查找优化
+	for (int32 i = 1; i < InContinuousSegmentsGroups.Num(); ++i)
+	{
+		const uint32 LastEnd = InContinuousSegmentsGroups[i - 1].Last();
+		const uint32 NextStart = InContinuousSegmentsGroups[i][0];
+		if (LastEnd >= OwnerSegmentID || OwnerSegmentID > NextStart)
+		{
+			continue;
+		}
+		const uint32 IndexGapToLastEnd = OwnerSegmentID - LastEnd;
+		const uint32 IndexGapToNextStart = NextStart - OwnerSegmentID;
+		bool bConnectToLastEnd = IndexGapToLastEnd < IndexGapToNextStart;
+		//距离两端序号距离一样时比较空间距离，序号为GlobalIndex，需要在SegmentStore中查找
+		if (IndexGapToLastEnd == IndexGapToNextStart)
+		{
+			const FVector2D LocOfLastEnd = InStore.GetEnd(InStore.IndexOfGlobalIndex(LastEnd));
+			const FVector2D LocOfNextStart = InStore.GetStart(InStore.IndexOfGlobalIndex(NextStart));
+			bConnectToLastEnd = FVector2D::DistSquared(LocOfLastEnd, FVector2D(PointTransWS)) <=
+				FVector2D::DistSquared(LocOfNextStart, FVector2D(PointTransWS));
+		}
+		Result.GroupIndex = bConnectToLastEnd ? i - 1 : i;
+		Result.bConnectToGroupHead = !bConnectToLastEnd;
+		break;
+	}
+	return Result;
+}
+#pragma endregion Road
+
+#pragma region Block
+void FCityModelBuilder::BuildGraph(FCityModel& InOutModel) const
+{
+	InOutModel.Blocks.Reset();
+	TArray<TArray<FRoadGraphEdge>>& Graph = InOutModel.Graph;
+	Graph.Reset();
+	Graph.SetNum(InOutModel.Intersections.Num());
+	for (const FCityModelIntersection& Intersection : InOutModel.Intersections)
+	{
+		Graph[Intersection.ID].SetNum(Intersection.Entries.Num());
+	}
+	//双向边放在各自入口局部ID的槽位，邻接表即按极角有序
+	for (const FCityModelRoad& Road : InOutModel.Roads)
+	{
+		const int32 FromID = Road.ConnectedIntersections[0];
+		const int32 ToID = Road.ConnectedIntersections[1];
+		if (!Graph.IsValidIndex(FromID) || !Graph.IsValidIndex(ToID))
+		{
+			continue;
+		}
+		URoadGraph::AddEdgeInGivenSlot(Graph, FromID, ToID, Road.ID, Road.EntryIndexOfIntersections[0]);
+		URoadGraph::AddEdgeInGivenSlot(Graph, ToID, FromID, Road.ID, Road.EntryIndexOfIntersections[1]);
+	}
+}
+
+bool FCityModelBuilder::FindBlocks(FCityModel& InOutModel) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCityModelBuilder::FindBlocks);
+	InOutModel.Blocks.Reset();
+	TArray<FBlockLinkInfo> BlockLoops = URoadGraph::FindSurfaces(InOutModel.Graph);
+	RemoveOuterLoop(BlockLoops, [&InOutModel](int32 IntersectionID)
+	{
+		return FVector2D(InOutModel.Intersections[IntersectionID].Location);
+	});
+	//轮廓为沿环路方向的道路中心线和路口中心
+	for (FBlockLinkInfo& Loop : BlockLoops)
+	{
+		FCityModelBlock& Block = InOutModel.Blocks.AddDefaulted_GetRef();
+		Block.ID = InOutModel.Blocks.Num() - 1;
+		for (int32 j = 0; j < Loop.RoadIndexes.Num(); ++j)
+		{
+			const FCityModelRoad& Road = InOutModel.Roads[Loop.RoadIndexes[j]];
+			const int32 FromIntersectionID = j == 0 ? Loop.IntersectionIndexes.Last() : Loop.IntersectionIndexes[j - 1];
+			const TArray<FTransform>& RoadTransforms = Road.RoadInfo.ContinuousSegmentsTrans;
+			const bool bIsForwardTraverse = Road.ConnectedIntersections[0] == FromIntersectionID;
+			for (int32 k = 0; k < RoadTransforms.Num(); ++k)
+			{
+				Block.Contour.Emplace(RoadTransforms[bIsForwardTraverse ? k : RoadTransforms.Num() - 1 - k].
+					GetLocation());
+			}
+			Block.Contour.Emplace(InOutModel.Intersections[Loop.IntersectionIndexes[j]].Location);
+		}
+		Block.Loop = MoveTemp(Loop);
+	}
+	return !InOutModel.Blocks.IsEmpty();
+}
+
+void FCityModelBuilder::RemoveOuterLoop(TArray<FBlockLinkInfo>& InOutLoops,
+                                        TFunctionRef<FVector2D(int32 IntersectionID)> InIntersectionLocations)
+{
+	double MaxArea = -1.0;
+	int32 MaxAreaIndex = INDEX_NONE;
+	TArray<FVector2D> VertexLoc2D;
+	for (int32 i = 0; i < InOutLoops.Num(); ++i)
+	{
+		VertexLoc2D.Reset();
+		for (const int32 IntersectionID : InOutLoops[i].IntersectionIndexes)
+		{
+			VertexLoc2D.Emplace(InIntersectionLocations(IntersectionID));
+		}
+		const double LoopArea = URoadGeometryUtilities::GetAreaOfSortedPoints(VertexLoc2D);
+		if (LoopArea > MaxArea)
+		{
+			MaxArea = LoopArea;
+			MaxAreaIndex = i;
+		}
+	}
+	//保持其余环路的顺序，街区编号与环路枚举顺序一致
+	if (InOutLoops.IsValidIndex(MaxAreaIndex))
+	{
+		InOutLoops.RemoveAt(MaxAreaIndex);
+	}
+}
+#pragma endregion Block
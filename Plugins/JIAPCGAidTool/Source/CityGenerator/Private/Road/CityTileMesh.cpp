@@ -0,0 +1,109 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/CityTileMesh.h"
+
+#include "DynamicMeshEditor.h"
+#include "Algo/BinarySearch.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+
+int32 FCityTileMesh::AppendSource(ECityTileSourceType InSourceType, int32 InSourceIndex,
+                                  const UE::Geometry::FDynamicMesh3& InSourceMesh, const FTransform& InSourceToTile,
+                                  TConstArrayView<UMaterialInterface*> InSourceMaterials)
+{
+	using namespace UE::Geometry;
+	if (InSourceMesh.TriangleCount() == 0)
+	{
+		return 0;
+	}
+	if (!Mesh.HasAttributes())
+	{
+		Mesh.EnableAttributes();
+	}
+	if (!Mesh.Attributes()->HasMaterialID())
+	{
+		Mesh.Attributes()->EnableMaterialID();
+	}
+	//来源材质槽到瓦片材质表的映射
+	TArray<int32, TInlineAllocator<8>> MaterialRemap;
+	for (UMaterialInterface* SourceMaterial : InSourceMaterials)
+	{
+		MaterialRemap.Emplace(FindOrAddMaterial(SourceMaterial));
+	}
+	if (MaterialRemap.IsEmpty())
+	{
+		MaterialRemap.Emplace(FindOrAddMaterial(nullptr));
+	}
+	//只追加不删除时Mesh保持紧凑，新三角形ID从MaxTriangleID开始连续
+	const int32 FirstTriangle = Mesh.MaxTriangleID();
+	FDynamicMeshEditor MeshEditor(&Mesh);
+	FMeshIndexMappings IndexMappings;
+	MeshEditor.AppendMesh(&InSourceMesh, IndexMappings,
+	                      [&InSourceToTile](int32, const FVector3d& Position)
+	                      {
+		                      return FVector3d(InSourceToTile.TransformPosition(Position));
+	                      },
+	                      [&InSourceToTile](int32, const FVector3d& Normal)
+	                      {
+		                      return FVector3d(InSourceToTile.TransformVectorNoScale(Normal));
+	                      });
+	const FDynamicMeshMaterialAttribute* SourceMaterialIDs = InSourceMesh.HasAttributes()
+		                                                         ? InSourceMesh.Attributes()->GetMaterialID()
+		                                                         : nullptr;
+	FDynamicMeshMaterialAttribute* MaterialIDs = Mesh.Attributes()->GetMaterialID();
+	for (const int32 SourceTriangleID : InSourceMesh.TriangleIndicesItr())
+	{
+		const int32 SourceMaterialID = nullptr != SourceMaterialIDs ? SourceMaterialIDs->GetValue(SourceTriangleID) : 0;
+		MaterialIDs->SetValue(IndexMappings.GetNewTriangle(SourceTriangleID),
+		                      MaterialRemap.IsValidIndex(SourceMaterialID)
+			                      ? MaterialRemap[SourceMaterialID]
+			                      : MaterialRemap[0]);
+	}
+	FCityTileTriangleRange& Range = TriangleRanges.AddDefaulted_GetRef();
+	Range.SourceType = InSourceType;
+	Range.SourceIndex = InSourceIndex;
+	Range.FirstTriangle = FirstTriangle;
+	Range.TriangleNum = Mesh.MaxTriangleID() - FirstTriangle;
+	return Range.TriangleNum;
+}
+
+const FCityTileTriangleRange* FCityTileMesh::FindRangeByTriangle(int32 TriangleID) const
+{
+	return FindRangeByTriangle(TriangleRanges, TriangleID);
+}
+
+const FCityTileTriangleRange* FCityTileMesh::FindRangeByTriangle(TConstArrayView<FCityTileTriangleRange> InRanges,
+                                                                 int32 TriangleID)
+{
+	//第一个起点大于TriangleID的区间的前一个
+	const int32 UpperIndex = Algo::UpperBoundBy(InRanges, TriangleID, &FCityTileTriangleRange::FirstTriangle);
+	if (UpperIndex == 0 || !InRanges[UpperIndex - 1].Contains(TriangleID))
+	{
+		return nullptr;
+	}
+	return &InRanges[UpperIndex - 1];
+}
+
+void FCityTileMesh::Reset()
+{
+	Mesh.Clear();
+	Materials.Reset();
+	TriangleRanges.Reset();
+}
+
+FIntPoint FCityTileMesh::GetTileCoord(const FVector& InWorldLocation, double InTileSize)
+{
+	return FIntPoint(FMath::FloorToInt32(InWorldLocation.X / InTileSize),
+	                 FMath::FloorToInt32(InWorldLocation.Y / InTileSize));
+}
+
+FVector FCityTileMesh::GetTileOrigin(const FIntPoint& InTileCoord, double InTileSize)
+{
+	return FVector(InTileCoord.X * InTileSize, InTileCoord.Y * InTileSize, 0.0);
+}
+
+int32 FCityTileMesh::FindOrAddMaterial(UMaterialInterface* InMaterial)
+{
+	const int32 ExistedIndex = Materials.Find(InMaterial);
+	return ExistedIndex != INDEX_NONE ? ExistedIndex : Materials.Emplace(InMaterial);
+}
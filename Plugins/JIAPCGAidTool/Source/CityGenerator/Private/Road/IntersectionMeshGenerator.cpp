@@ -4,13 +4,16 @@
 #include "Road/IntersectionMeshGenerator.h"
 
 #include "NotifyUtilities.h"
+#include "UDynamicMesh.h"
 #include "Components/DynamicMeshComponent.h"
 #include "Road/RoadSegmentStruct.h"
 #include "Components/SplineComponent.h"
 #include "GeometryScript/MeshNormalsFunctions.h"
 #include "GeometryScript/MeshPrimitiveFunctions.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Road/RoadCrossSectionProfile.h"
 #include "Road/RoadGeometryUtilities.h"
+#include "Road/RoadSweepBuilder.h"
 #include "Subsystems/EditorAssetSubsystem.h"
 
 class FAssetToolsModule;
@@ -19,6 +22,19 @@ static TAutoConsoleVariable<bool> CVarOnlyDebugPoint(
 	TEXT("RIG.OnlyDebugPoint"), false,TEXT("Only Generate Points Ignore Meshes"), ECVF_Default);
 static TAutoConsoleVariable<bool> CVarHideGraphicDebug(
 	TEXT("RIG.HideGraphicDebug"), false,TEXT("Only Generate Points Ignore Meshes"), ECVF_Default);
+static TAutoConsoleVariable<bool> CVarNativeIntersection(
+	TEXT("CityGenerator.Road.NativeIntersection"), true,
+	TEXT("Ear Clip And Extrude Intersection Polygon Directly Into FDynamicMesh3,Set To False To Use AppendSimpleExtrudePolygon For A/B Comparison"),
+	ECVF_Default);
+
+/**
+ * 交汇路口挤出高度，与道路截面行车道边缘高度一致
+ */
+static constexpr double IntersectionExtrudeHeight = 30.0;
+/**
+ * 侧面法线平滑的开角阈值°，与FGeometryScriptSplitNormalsOptions默认值一致
+ */
+static constexpr float IntersectionSmoothAngle = 15.0f;
 
 // Sets default values for this component's properties
 UIntersectionMeshGenerator::UIntersectionMeshGenerator()
@@ -40,6 +56,14 @@ void UIntersectionMeshGenerator::SetIntersectionSegmentsData(const TArray<FInter
 	}
 }
 
+void UIntersectionMeshGenerator::ResetForRegenerate()
+{
+	IMeshGeneratorInterface::ResetForRegenerate();
+	ConnectionLocations.Reset();
+	ExtrudeShape.Reset();
+	OccupiedBox.Init();
+}
+
 TArray<FIntersectionSegment> UIntersectionMeshGenerator::GetRoadConnectionPoint(
 	const TWeakObjectPtr<USplineComponent> InOwnerSpline)
 {
@@ -51,7 +75,7 @@ TArray<FIntersectionSegment> UIntersectionMeshGenerator::GetRoadConnectionPoint(
 	return Results;
 }
 
-bool UIntersectionMeshGenerator::GenerateMesh()
+bool UIntersectionMeshGenerator::PrepareBuild()
 {
 	AActor* Owner = GetOwner();
 	ensureAlwaysMsgf(nullptr!=Owner, TEXT("Component Has No Owner"));
@@ -69,6 +93,7 @@ bool UIntersectionMeshGenerator::GenerateMesh()
 				TEXT("[ERROR]%s Create Intersection Failed,Spline Data Is Empty"), *Owner->GetActorLabel()));
 		return false;
 	}
+	//挤出截面同时更新OccupiedBox，道路切分依赖该结果，在游戏线程完成
 	ExtrudeShape = CreateExtrudeShape();
 	if (ExtrudeShape.IsEmpty())
 	{
@@ -77,27 +102,67 @@ bool UIntersectionMeshGenerator::GenerateMesh()
 				TEXT("[ERROR]%s Create Intersection Failed,Extrude Is Not Defined"), *Owner->GetActorLabel()));
 		return false;
 	}
-	if (CVarOnlyDebugPoint.GetValueOnGameThread())
+	if (nullptr == Material)
+	{
+		InitialMaterials();
+	}
+	bOnlyDebugPoint = CVarOnlyDebugPoint.GetValueOnGameThread();
+	bUseNativeExtrude = CVarNativeIntersection.GetValueOnGameThread();
+	ExtrudeTemplate = FRoadProfileTemplate();
+	if (bUseNativeExtrude && !FRoadProfileTemplate::CompileSimplePolygon(ExtrudeShape, ExtrudeTemplate,
+	                                                                     IntersectionSmoothAngle))
+	{
+		//截面自相交等耳切失败的情况回退GeometryScript，在游戏线程构建
+		UE_LOG(LogTemp, Warning,
+		       TEXT("[WARNING]Intersection %d Ear Clip Failed,Fallback To AppendSimpleExtrudePolygon"),
+		       GetGlobalIndex());
+		bUseNativeExtrude = false;
+	}
+	if (!bUseNativeExtrude && nullptr == BuildScratchMesh)
+	{
+		BuildScratchMesh = NewObject<UDynamicMesh>(this, NAME_None, RF_Transient);
+	}
+	return true;
+}
+
+bool UIntersectionMeshGenerator::BuildMesh(FMeshBuildResult& OutResult) const
+{
+	if (ExtrudeShape.IsEmpty())
+	{
+		return false;
+	}
+	if (bOnlyDebugPoint)
 	{
 		return true;
 	}
+	if (bUseNativeExtrude)
+	{
+		return FRoadSweepBuilder::AppendExtrudedPolygon(OutResult.Mesh, ExtrudeTemplate, IntersectionExtrudeHeight) > 0;
+	}
+	if (nullptr == BuildScratchMesh)
+	{
+		return false;
+	}
+	BuildScratchMesh->Reset();
 	FGeometryScriptPrimitiveOptions GeometryScriptOptions;
 	FTransform ExtrudeMeshTrans = FTransform::Identity;
 	UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendSimpleExtrudePolygon(
-		MeshComponent->GetDynamicMesh(), GeometryScriptOptions, ExtrudeMeshTrans, ExtrudeShape, 30.0f);
-	UGeometryScriptLibrary_MeshNormalsFunctions::AutoRepairNormals(MeshComponent->GetDynamicMesh());
+		BuildScratchMesh, GeometryScriptOptions, ExtrudeMeshTrans, ExtrudeShape, static_cast<float>(IntersectionExtrudeHeight));
+	UGeometryScriptLibrary_MeshNormalsFunctions::AutoRepairNormals(BuildScratchMesh);
 	FGeometryScriptSplitNormalsOptions SplitOptions;
 	FGeometryScriptCalculateNormalsOptions CalculateOptions;
-	UGeometryScriptLibrary_MeshNormalsFunctions::ComputeSplitNormals(MeshComponent->GetDynamicMesh(), SplitOptions,
+	UGeometryScriptLibrary_MeshNormalsFunctions::ComputeSplitNormals(BuildScratchMesh, SplitOptions,
 	                                                                 CalculateOptions);
-	if (nullptr == Material)
-	{
-		InitialMaterials();
-	}
-	RefreshMatsOnDynamicMeshComp();
+	MoveScratchMeshTo(BuildScratchMesh, OutResult.Mesh);
 	return true;
 }
 
+void UIntersectionMeshGenerator::CommitMesh(FMeshBuildResult&& InResult)
+{
+	IMeshGeneratorInterface::CommitMesh(MoveTemp(InResult));
+	RefreshMatsOnDynamicMeshComp();
+}
+
 void UIntersectionMeshGenerator::SetMeshComponent(class UDynamicMeshComponent* InMeshComponent)
 {
 	if (InMeshComponent != nullptr)
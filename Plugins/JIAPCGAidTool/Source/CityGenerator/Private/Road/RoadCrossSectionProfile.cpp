@@ -0,0 +1,381 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/RoadCrossSectionProfile.h"
+
+#include "Misc/ScopeLock.h"
+
+float FRoadCrossSectionProfile::GetTotalWidth() const
+{
+	float TotalWidth = 0.0f;
+	for (const FRoadProfileElement& Element : Elements)
+	{
+		TotalWidth += FMath::Max(0.0f, Element.Width);
+	}
+	return TotalWidth;
+}
+
+FRoadCrossSectionProfile FRoadCrossSectionProfile::MakePreset(ELaneType InLaneType)
+{
+	using EType = ERoadProfileElementType;
+	FRoadCrossSectionProfile Profile;
+	switch (InLaneType)
+	{
+	case ELaneType::ARTERIALROADS:
+		//10m：双向四车道，中央分隔带，两侧路缘石和人行道
+		Profile.Elements = {
+			{EType::SIDEWALK, 120.0f, 15.0f}, {EType::CURB, 20.0f, 15.0f}, {EType::LANE, 170.0f},
+			{EType::LANE, 170.0f}, {EType::MEDIAN, 40.0f, 15.0f}, {EType::LANE, 170.0f}, {EType::LANE, 170.0f},
+			{EType::CURB, 20.0f, 15.0f}, {EType::SIDEWALK, 120.0f, 15.0f}
+		};
+		break;
+	case ELaneType::EXPRESSWAYS:
+		//20m：双向八车道，宽中央分隔带，两侧只有路缘石
+		Profile.Elements = {
+			{EType::CURB, 30.0f, 20.0f}, {EType::LANE, 220.0f}, {EType::LANE, 220.0f}, {EType::LANE, 220.0f},
+			{EType::LANE, 220.0f}, {EType::MEDIAN, 180.0f, 20.0f}, {EType::LANE, 220.0f}, {EType::LANE, 220.0f},
+			{EType::LANE, 220.0f}, {EType::LANE, 220.0f}, {EType::CURB, 30.0f, 20.0f}
+		};
+		break;
+	case ELaneType::COLLECTORROADS:
+	default:
+		//5m：双向两车道，两侧路缘石和人行道
+		Profile.Elements = {
+			{EType::SIDEWALK, 80.0f, 15.0f}, {EType::CURB, 15.0f, 15.0f}, {EType::LANE, 155.0f},
+			{EType::LANE, 155.0f}, {EType::CURB, 15.0f, 15.0f}, {EType::SIDEWALK, 80.0f, 15.0f}
+		};
+		break;
+	}
+	return Profile;
+}
+
+bool FRoadProfileTemplate::ComputeEdgeData()
+{
+	const int32 PointNum = Points.Num();
+	if (PointNum < 3)
+	{
+		return false;
+	}
+	double SignedArea = 0.0;
+	EdgeU.SetNumUninitialized(PointNum + 1);
+	EdgeU[0] = 0.0;
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		const FVector2D& Current = Points[i];
+		const FVector2D& Next = Points[(i + 1) % PointNum];
+		SignedArea += Current.X * Next.Y - Next.X * Current.Y;
+		EdgeU[i + 1] = EdgeU[i] + FVector2D::Distance(Current, Next);
+	}
+	const double Perimeter = EdgeU[PointNum];
+	if (Perimeter <= UE_DOUBLE_SMALL_NUMBER || FMath::IsNearlyZero(SignedArea))
+	{
+		return false;
+	}
+	for (double& U : EdgeU)
+	{
+		U /= Perimeter;
+	}
+	EdgeNormals.SetNumUninitialized(PointNum);
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		const FVector2D EdgeDir = Points[(i + 1) % PointNum] - Points[i];
+		//逆时针截面的外法线在边方向右侧
+		EdgeNormals[i] = SignedArea > 0.0
+			                 ? FVector2D(EdgeDir.Y, -EdgeDir.X).GetSafeNormal()
+			                 : FVector2D(-EdgeDir.Y, EdgeDir.X).GetSafeNormal();
+	}
+	Bounds = FBox2D(Points.GetData(), PointNum);
+	return true;
+}
+
+FVector2D FRoadProfileTemplate::GetEdgeNormal(int32 InEdgeIndex, bool bAtEdgeEnd) const
+{
+	const int32 PointNum = Points.Num();
+	const int32 PointIndex = bAtEdgeEnd ? (InEdgeIndex + 1) % PointNum : InEdgeIndex;
+	if (!SmoothPoints.IsValidIndex(PointIndex) || !SmoothPoints[PointIndex])
+	{
+		return EdgeNormals[InEdgeIndex];
+	}
+	const int32 OtherEdgeIndex = bAtEdgeEnd ? PointIndex : (InEdgeIndex + PointNum - 1) % PointNum;
+	return (EdgeNormals[InEdgeIndex] + EdgeNormals[OtherEdgeIndex]).GetSafeNormal();
+}
+
+bool FRoadProfileTemplate::CompilePolygon(TConstArrayView<FVector2D> InPolygon, FRoadProfileTemplate& OutTemplate)
+{
+	OutTemplate = FRoadProfileTemplate();
+	OutTemplate.Points.Append(InPolygon.GetData(), InPolygon.Num());
+	if (!OutTemplate.ComputeEdgeData())
+	{
+		return false;
+	}
+	OutTemplate.CapTriangles.Reserve(3 * (InPolygon.Num() - 2));
+	for (int32 i = 1; i + 1 < InPolygon.Num(); ++i)
+	{
+		OutTemplate.CapTriangles.Append({0, i, i + 1});
+	}
+	return true;
+}
+
+bool FRoadProfileTemplate::CompileSimplePolygon(TConstArrayView<FVector2D> InPolygon,
+                                                FRoadProfileTemplate& OutTemplate, float SmoothAngle)
+{
+	OutTemplate = FRoadProfileTemplate();
+	OutTemplate.Points.Reserve(InPolygon.Num());
+	for (const FVector2D& Point : InPolygon)
+	{
+		if (OutTemplate.Points.IsEmpty() || !OutTemplate.Points.Last().Equals(Point, UE_KINDA_SMALL_NUMBER))
+		{
+			OutTemplate.Points.Emplace(Point);
+		}
+	}
+	while (OutTemplate.Points.Num() > 1 && OutTemplate.Points.Last().Equals(OutTemplate.Points[0],
+	                                                                       UE_KINDA_SMALL_NUMBER))
+	{
+		OutTemplate.Points.Pop();
+	}
+	if (!OutTemplate.ComputeEdgeData() || !EarClipPolygon(OutTemplate.Points, OutTemplate.CapTriangles))
+	{
+		return false;
+	}
+	if (SmoothAngle > 0.0f)
+	{
+		const int32 PointNum = OutTemplate.Points.Num();
+		const double SmoothCos = FMath::Cos(FMath::DegreesToRadians(SmoothAngle));
+		OutTemplate.SmoothPoints.SetNumUninitialized(PointNum);
+		for (int32 i = 0; i < PointNum; ++i)
+		{
+			const FVector2D& PrevNormal = OutTemplate.EdgeNormals[(i + PointNum - 1) % PointNum];
+			OutTemplate.SmoothPoints[i] = PrevNormal.Dot(OutTemplate.EdgeNormals[i]) > SmoothCos;
+		}
+	}
+	return true;
+}
+
+bool FRoadProfileTemplate::EarClipPolygon(TConstArrayView<FVector2D> InPolygon, TArray<int32>& OutTriangles)
+{
+	OutTriangles.Reset();
+	const int32 PointNum = InPolygon.Num();
+	if (PointNum < 3)
+	{
+		return false;
+	}
+	double SignedArea = 0.0;
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		SignedArea += FVector2D::CrossProduct(InPolygon[i], InPolygon[(i + 1) % PointNum]);
+	}
+	if (FMath::IsNearlyZero(SignedArea))
+	{
+		return false;
+	}
+	//统一按逆时针处理，剩余点环中凸点且三角形内没有其他点即为耳
+	TArray<int32, TInlineAllocator<64>> Remaining;
+	Remaining.SetNumUninitialized(PointNum);
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		Remaining[i] = SignedArea > 0.0 ? i : PointNum - 1 - i;
+	}
+	auto Cross = [&InPolygon](int32 A, int32 B, int32 P)-> double
+	{
+		return FVector2D::CrossProduct(InPolygon[B] - InPolygon[A], InPolygon[P] - InPolygon[A]);
+	};
+	OutTriangles.Reserve(3 * (PointNum - 2));
+	int32 StartIndex = 0;
+	while (Remaining.Num() > 3)
+	{
+		const int32 RemainingNum = Remaining.Num();
+		bool bFoundEar = false;
+		for (int32 Step = 0; Step < RemainingNum && !bFoundEar; ++Step)
+		{
+			const int32 EarIndex = (StartIndex + Step) % RemainingNum;
+			const int32 Prev = Remaining[(EarIndex + RemainingNum - 1) % RemainingNum];
+			const int32 Curr = Remaining[EarIndex];
+			const int32 Next = Remaining[(EarIndex + 1) % RemainingNum];
+			//共线点允许作为耳切掉，生成退化三角形保持封口与侧面共边
+			if (Cross(Prev, Curr, Next) < -UE_KINDA_SMALL_NUMBER)
+			{
+				continue;
+			}
+			bool bContainsOther = false;
+			for (int32 k = 0; k < RemainingNum && !bContainsOther; ++k)
+			{
+				const int32 Other = Remaining[k];
+				if (Other == Prev || Other == Curr || Other == Next)
+				{
+					continue;
+				}
+				//落在对角线Next-Prev上的点也算在内，避免封口出现T形顶点
+				bContainsOther = Cross(Prev, Curr, Other) > 0.0 && Cross(Curr, Next, Other) > 0.0 &&
+					Cross(Next, Prev, Other) >= 0.0;
+			}
+			if (bContainsOther)
+			{
+				continue;
+			}
+			OutTriangles.Append({Prev, Curr, Next});
+			Remaining.RemoveAt(EarIndex, 1, EAllowShrinking::No);
+			StartIndex = EarIndex % Remaining.Num();
+			bFoundEar = true;
+		}
+		if (!bFoundEar)
+		{
+			OutTriangles.Reset();
+			return false;
+		}
+	}
+	OutTriangles.Append({Remaining[0], Remaining[1], Remaining[2]});
+	return true;
+}
+
+bool FRoadProfileTemplate::CompileProfile(const FRoadCrossSectionProfile& InProfile,
+                                          FRoadProfileTemplate& OutTemplate)
+{
+	OutTemplate = FRoadProfileTemplate();
+	const double TotalWidth = InProfile.GetTotalWidth();
+	if (TotalWidth <= UE_DOUBLE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+	const double BaseThickness = FMath::Max(1.0, static_cast<double>(InProfile.BaseThickness));
+	//1.行车道横坡以距道路中心最远的行车道边缘为基准，中心最高
+	double CarriageHalfWidth = 0.0;
+	double ElementLeft = -0.5 * TotalWidth;
+	for (const FRoadProfileElement& Element : InProfile.Elements)
+	{
+		const double ElementRight = ElementLeft + FMath::Max(0.0f, Element.Width);
+		if (Element.Type == ERoadProfileElementType::LANE)
+		{
+			CarriageHalfWidth = FMath::Max3(CarriageHalfWidth, FMath::Abs(ElementLeft), FMath::Abs(ElementRight));
+		}
+		ElementLeft = ElementRight;
+	}
+	auto GetLaneTopHeight = [&](double X)-> double
+	{
+		return BaseThickness + InProfile.CrownSlope * (CarriageHalfWidth - FMath::Abs(X));
+	};
+	//2.从左到右的顶面折线，组成部分之间高度不同时同一X上有两个点形成台阶
+	TArray<FVector2D> TopPoints;
+	auto AddTopPoint = [&TopPoints](const FVector2D& InPoint)
+	{
+		if (TopPoints.IsEmpty() || !TopPoints.Last().Equals(InPoint, UE_KINDA_SMALL_NUMBER))
+		{
+			TopPoints.Emplace(InPoint);
+		}
+	};
+	ElementLeft = -0.5 * TotalWidth;
+	for (const FRoadProfileElement& Element : InProfile.Elements)
+	{
+		if (Element.Width <= UE_KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+		const double ElementRight = ElementLeft + Element.Width;
+		if (Element.Type == ERoadProfileElementType::LANE)
+		{
+			AddTopPoint(FVector2D(ElementLeft, GetLaneTopHeight(ElementLeft)));
+			//行车道跨过道路中心时在中心补点保留路拱
+			if (ElementLeft < 0.0 && ElementRight > 0.0)
+			{
+				AddTopPoint(FVector2D(0.0, GetLaneTopHeight(0.0)));
+			}
+			AddTopPoint(FVector2D(ElementRight, GetLaneTopHeight(ElementRight)));
+		}
+		else
+		{
+			const double TopHeight = BaseThickness + FMath::Max(0.0f, Element.Height);
+			AddTopPoint(FVector2D(ElementLeft, TopHeight));
+			AddTopPoint(FVector2D(ElementRight, TopHeight));
+		}
+		ElementLeft = ElementRight;
+	}
+	//3.底面在顶面每个不同的X处补点，封口按竖条带三角化
+	TArray<double> BottomXs;
+	for (const FVector2D& TopPoint : TopPoints)
+	{
+		if (BottomXs.IsEmpty() || !FMath::IsNearlyEqual(BottomXs.Last(), TopPoint.X, UE_KINDA_SMALL_NUMBER))
+		{
+			BottomXs.Emplace(TopPoint.X);
+		}
+	}
+	if (BottomXs.Num() < 2)
+	{
+		return false;
+	}
+	//轮廓逆时针：顶面从右到左，底面从左到右
+	const int32 TopNum = TopPoints.Num();
+	OutTemplate.Points.Reserve(TopNum + BottomXs.Num());
+	for (int32 i = TopNum - 1; i >= 0; --i)
+	{
+		OutTemplate.Points.Emplace(TopPoints[i]);
+	}
+	for (const double BottomX : BottomXs)
+	{
+		OutTemplate.Points.Emplace(BottomX, 0.0);
+	}
+	if (!OutTemplate.ComputeEdgeData())
+	{
+		return false;
+	}
+	int32 BottomIndex = 0;
+	for (int32 i = 0; i + 1 < TopNum; ++i)
+	{
+		if (FMath::IsNearlyEqual(TopPoints[i].X, TopPoints[i + 1].X, UE_KINDA_SMALL_NUMBER))
+		{
+			continue;
+		}
+		const int32 TopLeft = TopNum - 1 - i;
+		const int32 TopRight = TopLeft - 1;
+		const int32 BottomLeft = TopNum + BottomIndex;
+		const int32 BottomRight = BottomLeft + 1;
+		OutTemplate.CapTriangles.Append({BottomLeft, BottomRight, TopRight, BottomLeft, TopRight, TopLeft});
+		BottomIndex++;
+	}
+	return true;
+}
+
+/**
+ * 模板缓存，道路类型-模板
+ */
+static FCriticalSection GRoadProfileTemplateLock;
+static TMap<ELaneType, TSharedRef<const FRoadProfileTemplate>> GRoadProfileTemplates;
+
+/**
+ * 编译横断面，失败时退回该道路类型宽度的矩形截面
+ */
+static TSharedRef<const FRoadProfileTemplate> CompileTemplateOrFallback(ELaneType InLaneType,
+                                                                        const FRoadCrossSectionProfile& InProfile)
+{
+	TSharedRef<FRoadProfileTemplate> Template = MakeShared<FRoadProfileTemplate>();
+	if (!FRoadProfileTemplate::CompileProfile(InProfile, *Template))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[WARNING]Compile Road Profile %d Failed,Fallback To Rectangle Section"),
+		       static_cast<int32>(InLaneType));
+		const float FallbackWidth = FMath::Max(100.0f, InProfile.GetTotalWidth());
+		FRoadProfileTemplate::CompilePolygon(FLaneMeshInfo(FallbackWidth).CrossSectionCoord, *Template);
+	}
+	return Template;
+}
+
+TSharedRef<const FRoadProfileTemplate> FRoadProfileLibrary::GetTemplate(ELaneType InLaneType)
+{
+	FScopeLock Lock(&GRoadProfileTemplateLock);
+	if (const TSharedRef<const FRoadProfileTemplate>* CachedTemplate = GRoadProfileTemplates.Find(InLaneType))
+	{
+		return *CachedTemplate;
+	}
+	return GRoadProfileTemplates.Add(InLaneType, CompileTemplateOrFallback(
+		                                 InLaneType, FRoadCrossSectionProfile::MakePreset(InLaneType)));
+}
+
+void FRoadProfileLibrary::SetProfile(ELaneType InLaneType, const FRoadCrossSectionProfile& InProfile)
+{
+	TSharedRef<const FRoadProfileTemplate> Template = CompileTemplateOrFallback(InLaneType, InProfile);
+	FScopeLock Lock(&GRoadProfileTemplateLock);
+	GRoadProfileTemplates.Add(InLaneType, Template);
+}
+
+int32 FRoadProfileLibrary::GetCachedTemplateNum()
+{
+	FScopeLock Lock(&GRoadProfileTemplateLock);
+	return GRoadProfileTemplates.Num();
+}
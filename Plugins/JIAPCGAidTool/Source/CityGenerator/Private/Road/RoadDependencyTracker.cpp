@@ -0,0 +1,202 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/RoadDependencyTracker.h"
+#include "Components/SplineComponent.h"
+
+void FRoadDependencyTracker::Reset()
+{
+	IntersectionSplines.Empty();
+	IntersectionsOnSpline.Empty();
+	Roads.Empty();
+	RoadsOnSpline.Empty();
+	BlockLoops.Empty();
+}
+
+void FRoadDependencyTracker::ResetRoads()
+{
+	Roads.Empty();
+	RoadsOnSpline.Empty();
+}
+
+void FRoadDependencyTracker::ResetBlocks()
+{
+	BlockLoops.Empty();
+}
+
+void FRoadDependencyTracker::AddIntersection(int32 IntersectionIndex,
+                                             const TArray<TWeakObjectPtr<USplineComponent>>& InSplines)
+{
+	RemoveIntersection(IntersectionIndex);
+	IntersectionSplines.Emplace(IntersectionIndex, InSplines);
+	for (const TWeakObjectPtr<USplineComponent>& Spline : InSplines)
+	{
+		IntersectionsOnSpline.FindOrAdd(Spline).Emplace(IntersectionIndex);
+	}
+}
+
+void FRoadDependencyTracker::RemoveIntersection(int32 IntersectionIndex)
+{
+	TArray<TWeakObjectPtr<USplineComponent>> Splines;
+	if (!IntersectionSplines.RemoveAndCopyValue(IntersectionIndex, Splines))
+	{
+		return;
+	}
+	for (const TWeakObjectPtr<USplineComponent>& Spline : Splines)
+	{
+		if (TSet<int32>* Intersections = IntersectionsOnSpline.Find(Spline))
+		{
+			Intersections->Remove(IntersectionIndex);
+		}
+	}
+}
+
+void FRoadDependencyTracker::AddRoad(int32 RoadIndex, const TWeakObjectPtr<USplineComponent>& InSpline,
+                                     int32 FromIntersection, int32 ToIntersection)
+{
+	RemoveRoad(RoadIndex);
+	FTrackedRoad& Road = Roads.Emplace(RoadIndex);
+	Road.Spline = InSpline;
+	Road.FromIntersection = FromIntersection;
+	Road.ToIntersection = ToIntersection;
+	RoadsOnSpline.FindOrAdd(InSpline).Emplace(RoadIndex);
+}
+
+void FRoadDependencyTracker::RemoveRoad(int32 RoadIndex)
+{
+	FTrackedRoad Road;
+	if (!Roads.RemoveAndCopyValue(RoadIndex, Road))
+	{
+		return;
+	}
+	if (TSet<int32>* RoadIndexes = RoadsOnSpline.Find(Road.Spline))
+	{
+		RoadIndexes->Remove(RoadIndex);
+	}
+}
+
+bool FRoadDependencyTracker::GetRoadEnds(int32 RoadIndex, int32& OutFromIntersection, int32& OutToIntersection) const
+{
+	const FTrackedRoad* Road = Roads.Find(RoadIndex);
+	if (nullptr == Road)
+	{
+		return false;
+	}
+	OutFromIntersection = Road->FromIntersection;
+	OutToIntersection = Road->ToIntersection;
+	return true;
+}
+
+void FRoadDependencyTracker::AddBlock(int32 BlockIndex, const FBlockLinkInfo& InBlockLoop)
+{
+	BlockLoops.Emplace(BlockIndex, InBlockLoop);
+}
+
+void FRoadDependencyTracker::RemoveBlock(int32 BlockIndex)
+{
+	BlockLoops.Remove(BlockIndex);
+}
+
+int32 FRoadDependencyTracker::FindBlockByLoop(const FBlockLinkInfo& InBlockLoop) const
+{
+	//环的遍历起点取决于图中边的顺序，比较排序后的道路集合
+	TArray<int32> TargetRoads = InBlockLoop.RoadIndexes;
+	TargetRoads.Sort();
+	for (const TPair<int32, FBlockLinkInfo>& BlockLoop : BlockLoops)
+	{
+		if (BlockLoop.Value.RoadIndexes.Num() != TargetRoads.Num())
+		{
+			continue;
+		}
+		TArray<int32> ExistedRoads = BlockLoop.Value.RoadIndexes;
+		ExistedRoads.Sort();
+		if (ExistedRoads == TargetRoads)
+		{
+			return BlockLoop.Key;
+		}
+	}
+	return INDEX_NONE;
+}
+
+FRoadDirtySet FRoadDependencyTracker::CollectDirtySet(const FRoadDirtySet& InSeed, const URoadGraph* InGraph) const
+{
+	FRoadDirtySet Result = InSeed;
+	//1.样条→交汇路口
+	for (const TWeakObjectPtr<USplineComponent>& Spline : InSeed.Splines)
+	{
+		if (const TSet<int32>* Intersections = IntersectionsOnSpline.Find(Spline))
+		{
+			Result.Intersections.Append(*Intersections);
+		}
+	}
+	//2.交汇路口→样条，只传播一层，路口变化不会改变其他路口
+	for (const int32 IntersectionIndex : Result.Intersections)
+	{
+		if (const TArray<TWeakObjectPtr<USplineComponent>>* Splines = IntersectionSplines.Find(IntersectionIndex))
+		{
+			Result.Splines.Append(*Splines);
+		}
+	}
+	//3.样条、交汇路口→道路
+	for (const TWeakObjectPtr<USplineComponent>& Spline : Result.Splines)
+	{
+		if (const TSet<int32>* RoadIndexes = RoadsOnSpline.Find(Spline))
+		{
+			Result.Roads.Append(*RoadIndexes);
+		}
+	}
+	if (nullptr != InGraph)
+	{
+		for (const int32 IntersectionIndex : Result.Intersections)
+		{
+			if (!InGraph->Graph.IsValidIndex(IntersectionIndex))
+			{
+				continue;
+			}
+			for (const FRoadGraphEdge& Edge : InGraph->Graph[IntersectionIndex])
+			{
+				if (Edge.RoadIndex != INT32_ERROR)
+				{
+					Result.Roads.Emplace(Edge.RoadIndex);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (const TPair<int32, FTrackedRoad>& Road : Roads)
+		{
+			if (Result.Intersections.Contains(Road.Value.FromIntersection) ||
+				Result.Intersections.Contains(Road.Value.ToIntersection))
+			{
+				Result.Roads.Emplace(Road.Key);
+			}
+		}
+	}
+	//4.道路、交汇路口→街区
+	for (const TPair<int32, FBlockLinkInfo>& BlockLoop : BlockLoops)
+	{
+		if (Result.Blocks.Contains(BlockLoop.Key))
+		{
+			continue;
+		}
+		bool bIsDirty = false;
+		for (const int32 RoadIndex : BlockLoop.Value.RoadIndexes)
+		{
+			if (Result.Roads.Contains(RoadIndex))
+			{
+				bIsDirty = true;
+				break;
+			}
+		}
+		for (int32 i = 0; !bIsDirty && i < BlockLoop.Value.IntersectionIndexes.Num(); ++i)
+		{
+			bIsDirty = Result.Intersections.Contains(BlockLoop.Value.IntersectionIndexes[i]);
+		}
+		if (bIsDirty)
+		{
+			Result.Blocks.Emplace(BlockLoop.Key);
+		}
+	}
+	return Result;
+}
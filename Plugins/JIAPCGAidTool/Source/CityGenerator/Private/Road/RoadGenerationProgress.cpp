@@ -0,0 +1,73 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/RoadGenerationProgress.h"
+
+#define LOCTEXT_NAMESPACE "RoadGenerationProgress"
+
+FRoadGenerationProgress::FRoadGenerationProgress(float InTotalWork, const FText& InTitle, bool bShowDialog) :
+	SlowTask(InTotalWork, InTitle)
+{
+	check(IsInGameThread());
+	if (bShowDialog)
+	{
+		SlowTask.MakeDialog(true);
+	}
+}
+
+bool FRoadGenerationProgress::Wait(const UE::Tasks::FTask& InTask, float InWork, const FText& InMessage)
+{
+	check(IsInGameThread());
+	SlowTask.EnterProgressFrame(InWork, InMessage);
+	while (!InTask.Wait(FTimespan::FromMilliseconds(PollIntervalMs)))
+	{
+		SlowTask.TickProgress();
+		PollCancel();
+	}
+	PollCancel();
+	return !IsCancelled();
+}
+
+bool FRoadGenerationProgress::ForEachBatch(int32 InNum, int32 InBatchSize, float InWork, const FText& InMessage,
+                                           TFunctionRef<void(int32 BeginIndex, int32 EndIndex)> InBatchFunc)
+{
+	check(IsInGameThread());
+	const int32 BatchSize = FMath::Max(1, InBatchSize);
+	const int32 BatchNum = FMath::DivideAndRoundUp(FMath::Max(0, InNum), BatchSize);
+	if (BatchNum == 0)
+	{
+		Skip(InWork);
+		return !IsCancelled();
+	}
+	const float WorkOfBatch = InWork / BatchNum;
+	for (int32 BatchIndex = 0; BatchIndex < BatchNum; ++BatchIndex)
+	{
+		SlowTask.EnterProgressFrame(WorkOfBatch, FText::Format(
+			                            LOCTEXT("BatchProgress", "{0} ({1}/{2})"), InMessage,
+			                            FText::AsNumber(BatchIndex + 1), FText::AsNumber(BatchNum)));
+		PollCancel();
+		if (IsCancelled())
+		{
+			return false;
+		}
+		const int32 BeginIndex = BatchIndex * BatchSize;
+		InBatchFunc(BeginIndex, FMath::Min(BeginIndex + BatchSize, InNum));
+	}
+	return true;
+}
+
+void FRoadGenerationProgress::Skip(float InWork)
+{
+	SlowTask.EnterProgressFrame(InWork);
+}
+
+void FRoadGenerationProgress::PollCancel()
+{
+	if (!IsCancelled() && SlowTask.ShouldCancel())
+	{
+		bCancelled.store(true, std::memory_order_relaxed);
+		UE_LOG(LogTemp, Warning, TEXT("Road Generation Cancelled By User"));
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
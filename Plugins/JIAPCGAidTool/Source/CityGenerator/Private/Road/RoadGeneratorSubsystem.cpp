@@ -5,20 +5,37 @@
 
 #include "CityGeneratorSubSystem.h"
 #include "EditorComponentUtilities.h"
+#include "EditorSpawnBatch.h"
+#include "FileHelpers.h"
+#include "LevelEditorViewport.h"
 #include "NotifyUtilities.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
 #include "Components/DynamicMeshComponent.h"
 #include "Components/SplineComponent.h"
 #include "Components/TextRenderComponent.h"
+#include "Engine/StaticMesh.h"
+#include "DynamicMeshToMeshDescription.h"
+#include "StaticMeshAttributes.h"
 #include "GeometryScript/MeshNormalsFunctions.h"
 #include "GeometryScript/MeshPrimitiveFunctions.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetStringLibrary.h"
 #include "Road/BlockMeshGenerator.h"
+#include "Road/CityModel.h"
+#include "Road/CityModelBuilder.h"
+#include "Road/GeneratedActorPool.h"
 #include "Road/IntersectionMeshGenerator.h"
+#include "Road/RoadGenerationProgress.h"
 #include "Road/RoadGeometryUtilities.h"
 #include "Road/RoadGraphForBlock.h"
 #include "Road/RoadMeshGenerator.h"
 #include "Road/RoadSegmentStruct.h"
+#include "Road/SplineCursorEvaluator.h"
+#include "Road/SplineSnapshot.h"
+#include "Tasks/Task.h"
+
+#define LOCTEXT_NAMESPACE "RoadGeneratorSubsystem"
 
 /*static TAutoConsoleVariable<float> PolyLineSubdivisionDis(
 	TEXT("SplineToPolySampleDis"), 50.0f,TEXT("Sample Distance Convert Spline To PolyLine"), ECVF_Default);*/
@@ -27,6 +44,233 @@ static TAutoConsoleVariable<bool> AddTextRender(
 static TAutoConsoleVariable<bool> bEnableVisualDebug(
 	TEXT("bEnableVisualDebug"), false, TEXT("Enable Graphic Debugging Shape,Include Point,Box,Sphere etal"),
 	ECVF_Default);
+static TAutoConsoleVariable<bool> CVarParallelIntersection(
+	TEXT("CityGenerator.Road.ParallelIntersection"), true,
+	TEXT("Find Segment Intersections In ParallelFor,Set To False To Run Serially For A/B Comparison"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarIntersectionChunkSize(
+	TEXT("CityGenerator.Road.IntersectionChunkSize"), 128,
+	TEXT("Segment Count Of Each Chunk When Finding Intersections"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarIntersectionBackend(
+	TEXT("CityGenerator.Road.IntersectionBackend"), 0,
+	TEXT("Backend Used To Find Segment Intersections,0:BVH,1:SweepLine(Bentley-Ottmann)"), ECVF_Default);
+static TAutoConsoleVariable<bool> CVarIncrementalIntersection(
+	TEXT("CityGenerator.Road.IncrementalIntersection"), true,
+	TEXT("Only Recompute Intersections Of Moved Splines When Regenerating,Set To False To Always Rebuild All"),
+	ECVF_Default);
+static TAutoConsoleVariable<bool> CVarDirtyPropagation(
+	TEXT("CityGenerator.Road.DirtyPropagation"), true,
+	TEXT("Only Rebuild Roads And Blocks Affected By Changed Intersections,Set To False To Always Rebuild All"),
+	ECVF_Default);
+static TAutoConsoleVariable<int32> CVarResampleMode(
+	TEXT("CityGenerator.Road.ResampleMode"), 0,
+	TEXT("Spline Resample Mode,0:Fixed PolyLineSampleDistance,1:Adaptive By Curvature And Chord Error"),
+	ECVF_Default);
+static TAutoConsoleVariable<float> CVarAdaptiveChordError(
+	TEXT("CityGenerator.Road.AdaptiveChordError"), 5.0f,
+	TEXT("Max Distance(cm) Between Spline And PolyLine Chord When ResampleMode Is Adaptive"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarSpawnBatchSize(
+	TEXT("CityGenerator.Road.SpawnBatchSize"), 32,
+	TEXT("Actors Spawned Or Meshes Committed On Game Thread Between Two Progress Bar Refreshes"), ECVF_Default);
+static TAutoConsoleVariable<bool> CVarParallelMeshBuild(
+	TEXT("CityGenerator.Road.ParallelMeshBuild"), true,
+	TEXT("Run BuildMesh Of Each Commit Batch In ParallelFor,Set To False To Build Serially For A/B Comparison"),
+	ECVF_Default);
+static TAutoConsoleVariable<bool> CVarTileBatching(
+	TEXT("CityGenerator.Road.TileBatching"), false,
+	TEXT("Merge Intersection,Road And Block Meshes Into One DynamicMeshComponent Per City Tile,Set To False For A/B Comparison"),
+	ECVF_Default);
+static TAutoConsoleVariable<float> CVarTileSize(
+	TEXT("CityGenerator.Road.TileSize"), 20000.0f,
+	TEXT("Edge Length(cm) Of City Tiles When TileBatching Is Enabled"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarRoadLODDistance(
+	TEXT("CityGenerator.Road.LODDistance"), 30000.0f,
+	TEXT("View Distance(cm) Per Road LOD Level,Also Used To Estimate Screen Size Of Baked Static Mesh LODs"),
+	ECVF_Default);
+static TAutoConsoleVariable<float> CVarRoadLODUpdateInterval(
+	TEXT("CityGenerator.Road.LODUpdateInterval"), 0.5f,
+	TEXT("Seconds Between Road LOD Updates From Level Editor Viewport,0 Disables Automatic Road LOD"), ECVF_Default);
+
+/**
+ * 分批生成Generator的Mesh，每批之前刷新进度条并检查取消
+ * 每批先在游戏线程PrepareBuild，再在ParallelFor中BuildMesh，最后回到游戏线程CommitMesh替换到UDynamicMeshComponent
+ * RequiresGameThreadBuild的Generator使用GeometryScript，不放入ParallelFor，在游戏线程串行BuildMesh
+ * @return 全部提交返回true，被取消返回false
+ */
+template <typename GeneratorType>
+static bool CommitMeshesInBatches(const TArray<TWeakObjectPtr<GeneratorType>>& InGenerators,
+                                  FRoadGenerationProgress& Progress, const FText& InMessage)
+{
+	const bool bDrawVisualDebug = bEnableVisualDebug.GetValueOnGameThread();
+	const bool bParallel = CVarParallelMeshBuild.GetValueOnGameThread();
+	double BuildSeconds = 0.0;
+	const bool bFinished = Progress.ForEachBatch(
+		InGenerators.Num(), CVarSpawnBatchSize.GetValueOnGameThread(), 1.0f, InMessage,
+		[&InGenerators, bDrawVisualDebug, bParallel, &BuildSeconds](int32 BeginIndex, int32 EndIndex)
+		{
+			TArray<GeneratorType*> PreparedGenerators;
+			PreparedGenerators.Reserve(EndIndex - BeginIndex);
+			for (int32 i = BeginIndex; i < EndIndex; ++i)
+			{
+				if (!InGenerators[i].IsValid())
+				{
+					continue;
+				}
+				InGenerators[i]->SetDrawVisualDebug(bDrawVisualDebug);
+				if (InGenerators[i]->PrepareBuild())
+				{
+					PreparedGenerators.Emplace(InGenerators[i].Get());
+				}
+			}
+			//BuildMesh只读取各自的生成数据，不同Generator之间没有共享状态
+			const double BuildStartTime = FPlatformTime::Seconds();
+			TArray<FMeshBuildResult> BuiltMeshes;
+			BuiltMeshes.SetNum(PreparedGenerators.Num());
+			TArray<bool> BuildResults;
+			BuildResults.SetNumZeroed(PreparedGenerators.Num());
+			ParallelFor(PreparedGenerators.Num(), [&PreparedGenerators, &BuiltMeshes, &BuildResults](int32 Index)
+			{
+				if (!PreparedGenerators[Index]->RequiresGameThreadBuild())
+				{
+					BuildResults[Index] = PreparedGenerators[Index]->BuildMesh(BuiltMeshes[Index]);
+				}
+			}, !bParallel);
+			for (int32 i = 0; i < PreparedGenerators.Num(); ++i)
+			{
+				if (PreparedGenerators[i]->RequiresGameThreadBuild())
+				{
+					BuildResults[i] = PreparedGenerators[i]->BuildMesh(BuiltMeshes[i]);
+				}
+			}
+			BuildSeconds += FPlatformTime::Seconds() - BuildStartTime;
+			for (int32 i = 0; i < PreparedGenerators.Num(); ++i)
+			{
+				if (BuildResults[i])
+				{
+					PreparedGenerators[i]->CommitMesh(MoveTemp(BuiltMeshes[i]));
+				}
+			}
+		});
+	UE_LOG(LogTemp, Display, TEXT("%s:%d Meshes,Build Cost %f ms,Parallel %d"), *InMessage.ToString(),
+	       InGenerators.Num(), BuildSeconds * 1000.0, bParallel);
+	return bFinished;
+}
+
+/**
+ * 用户取消生成后提示，本阶段已生成的Actor由调用方销毁
+ */
+static void NotifyGenerationCancelled(const FString& StageName)
+{
+	UE_LOG(LogTemp, Warning, TEXT("%s Cancelled,Actors Spawned In This Pass Were Destroyed"), *StageName);
+	UNotifyUtilities::ShowPopupMsgAtCorner(FString::Printf(TEXT("%s Cancelled"), *StageName));
+}
+
+/**
+ * 路口拓扑键，由相交样条集合决定，与入口顺序无关
+ */
+static uint32 MakeIntersectionTopologyKey(const TArray<FIntersectionSegment>& InSegments)
+{
+	TArray<uint32, TInlineAllocator<8>> SplineHashes;
+	for (const FIntersectionSegment& Segment : InSegments)
+	{
+		SplineHashes.AddUnique(GetTypeHash(Segment.OwnerSpline));
+	}
+	SplineHashes.Sort();
+	uint32 TopologyKey = 0;
+	for (const uint32 SplineHash : SplineHashes)
+	{
+		TopologyKey = HashCombineFast(TopologyKey, SplineHash);
+	}
+	return TopologyKey;
+}
+
+/**
+ * 道路拓扑键，由所在样条和两端路口GlobalIndex决定，两端路口被复用时保持不变
+ */
+static uint32 MakeRoadTopologyKey(const TWeakObjectPtr<USplineComponent>& InSpline, int32 FromIntersection,
+                                  int32 ToIntersection)
+{
+	return HashCombineFast(GetTypeHash(InSpline),
+	                       HashCombineFast(GetTypeHash(FromIntersection), GetTypeHash(ToIntersection)));
+}
+
+/**
+ * 街区拓扑键，由环路道路集合决定，与环的起点无关
+ */
+static uint32 MakeBlockTopologyKey(const FBlockLinkInfo& InBlockLoop)
+{
+	TArray<int32, TInlineAllocator<16>> SortedRoads(InBlockLoop.RoadIndexes);
+	SortedRoads.Sort();
+	uint32 TopologyKey = 0;
+	for (const int32 RoadIndex : SortedRoads)
+	{
+		TopologyKey = HashCombineFast(TopologyKey, GetTypeHash(RoadIndex));
+	}
+	return TopologyKey;
+}
+
+/**
+ * 全量重新生成前把表中的Generator移入回收池并清空表
+ */
+template <typename GeneratorType>
+static void MoveGeneratorsToPool(TMap<int32, TWeakObjectPtr<GeneratorType>>& InOutIDToGenerator,
+                                 TGeneratedActorPool<GeneratorType>& OutPool)
+{
+	OutPool.Reset();
+	for (const auto& IDGeneratorPair : InOutIDToGenerator)
+	{
+		if (IDGeneratorPair.Value.IsValid())
+		{
+			OutPool.Add(IDGeneratorPair.Value.Get());
+		}
+	}
+	InOutIDToGenerator.Reset();
+}
+
+/**
+ * 生成结束后销毁未被复用的Actor，其拓扑已经消失
+ */
+template <typename GeneratorType>
+static void DestroyUnusedPooledActors(TGeneratedActorPool<GeneratorType>& InOutPool, const TCHAR* StageName)
+{
+	const int32 DestroyedNum = InOutPool.DestroyRemaining();
+	UE_LOG(LogTemp, Display, TEXT("Regenerate %s:%d Actors Reused,%d Destroyed"), StageName,
+	       InOutPool.GetReusedNum(), DestroyedNum);
+	InOutPool.Reset();
+}
+
+/**
+ * 取消全量重新生成时只销毁本次新建的Actor，复用的和池中剩余的Generator放回表中，不删除上次的结果
+ * @param DestroyFunc 销毁新建Generator的函数，负责从各记录表中移除
+ */
+template <typename GeneratorType, typename DestroyFuncType>
+static void RestorePooledGeneratorsOnCancel(const TArray<TWeakObjectPtr<GeneratorType>>& InNewGenerators,
+                                            TGeneratedActorPool<GeneratorType>& InOutPool,
+                                            TMap<int32, TWeakObjectPtr<GeneratorType>>& OutIDToGenerator,
+                                            DestroyFuncType&& DestroyFunc)
+{
+	for (const TWeakObjectPtr<GeneratorType>& NewGenerator : InNewGenerators)
+	{
+		if (NewGenerator.IsValid() && !InOutPool.WasReused(NewGenerator))
+		{
+			DestroyFunc(NewGenerator);
+		}
+	}
+	InOutPool.RestoreTo(OutIDToGenerator);
+}
+
+/**
+ * 复用的Actor在修改变换和重置数据前记录到当前事务中，撤销时与新建的Actor一起恢复
+ */
+static void ModifyReusedActor(UActorComponent* InGenerator)
+{
+	AActor* ReusedActor = InGenerator->GetOwner();
+	ReusedActor->Modify();
+	if (USceneComponent* RootComp = ReusedActor->GetRootComponent())
+	{
+		RootComp->Modify();
+	}
+	InGenerator->Modify();
+}
 
 
 void URoadGeneratorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
@@ -39,6 +283,9 @@ void URoadGeneratorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		this, &URoadGeneratorSubsystem::OnRoadActorRemoved);
 	RoadGraph = NewObject<URoadGraph>();
 	WorldChangeDelegate = GEditor->OnWorldDestroyed().AddUObject(this, &URoadGeneratorSubsystem::OnWorldChanged);
+	//固定频率注册，间隔在回调中按控制台变量的当前值判断，运行时修改立即生效
+	RoadLODTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &URoadGeneratorSubsystem::TickRoadLODs), 0.1f);
 }
 
 void URoadGeneratorSubsystem::OnLevelComponentMoved(USceneComponent* MovedComp, ETeleportType MoveType)
@@ -56,6 +303,7 @@ void URoadGeneratorSubsystem::OnLevelComponentMoved(USceneComponent* MovedComp,
 	if (SplineSegmentsInfo.Contains(PotentialSpline))
 	{
 		bNeedRefreshSegmentData = true;
+		DirtySplines.Emplace(PotentialSpline);
 	}
 }
 
@@ -104,449 +352,897 @@ void URoadGeneratorSubsystem::OnRoadActorRemoved(AActor* RemovedActor)
 void URoadGeneratorSubsystem::Deinitialize()
 {
 	SplineSegmentsInfo.Empty();
-	SplineQuadTree.Empty();
+	SegmentStore.Empty();
+	NextSegmentGlobalIndex = 0;
+	SegmentBVH.Empty();
+	DirtySplines.Empty();
+	CachedSegmentHits.Empty();
+	CachedIntersections.Empty();
+	CachedIntersectionGenerators.Empty();
+	DependencyTracker.Reset();
+	PendingRoadEdit.Reset();
+	PendingBlockEdit.Reset();
 	IDToRoadGenerator.Empty();
 	IDToIntersectionGenerator.Empty();
+	IntersectionActorPool.Reset();
+	RoadActorPool.Reset();
+	BlockActorPool.Reset();
+	CityTiles.Empty();
+	CityTileSources.Empty();
 	GEditor->OnComponentTransformChanged().Remove(ComponentMoveHandle);
 	GEditor->OnLevelActorDeleted().Remove(RoadActorRemovedHandle);
 	GEditor->OnWorldDestroyed().Remove(WorldChangeDelegate);
+	FTSTicker::GetCoreTicker().RemoveTicker(RoadLODTickerHandle);
 	RoadGraph = nullptr;
 	Super::Deinitialize();
 }
 
 #pragma region GenerateIntersection
+/**
+ * 按(GlobalIndexA,GlobalIndexB)排序原始交点，使不同后端、不同线程数的输出顺序一致
+ */
+static void SortSegmentHits(TArray<FSegmentPairHit>& InOutHits)
+{
+	InOutHits.Sort([](const FSegmentPairHit& A, const FSegmentPairHit& B)
+	{
+		return A.GlobalIndexA == B.GlobalIndexA ? A.GlobalIndexB < B.GlobalIndexB : A.GlobalIndexA < B.GlobalIndexA;
+	});
+}
+
+/**
+ * 交点所合并原始交点Segment对的哈希，未移动样条的Segment GlobalIndex不变，增量更新时据此匹配上次的交点
+ */
+static uint32 GetSourceHitPairsHash(const FSplineIntersection& InIntersection)
+{
+	uint32 Hash = 0;
+	for (const uint64 HitPair : InIntersection.SourceHitPairs)
+	{
+		Hash = HashCombineFast(Hash, GetTypeHash(HitPair));
+	}
+	return Hash;
+}
+
 void URoadGeneratorSubsystem::GenerateIntersections()
 {
-	//更新样条信息
-	if (bNeedRefreshSegmentData)
+	//只有部分样条移动时增量更新，失败时回退到完整流程
+	if (bIntersectionsGenerated && !DirtySplines.IsEmpty() && CVarIncrementalIntersection.GetValueOnGameThread())
 	{
-		InitialRoadSplines();
+		if (UpdateIntersectionsIncrementally())
+		{
+			UpdateCityTilesIfEnabled();
+			return;
+		}
 	}
-	if (SplineSegmentsInfo.IsEmpty())
+	FRoadGenerationProgress Progress(5.0f, LOCTEXT("GenerateIntersections", "Generating Road Intersections"));
+	//全量流程与GenerateFromCityModel相同：复制样条到CityModel，后台由FCityModelBuilder重采样、求交和拆分路口
+	FCityModel Model;
+	TArray<TWeakObjectPtr<USplineComponent>> SourceSplines;
+	if (!CaptureCityModel(Model, SourceSplines))
+	{
+		return;
+	}
+	const FCityModelBuilder Builder(MakeBuildSettings());
+	bool bHasSegments = false;
+	const UE::Tasks::FTask ResampleTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Builder, &Model, &bHasSegments]()
+	{
+		bHasSegments = Builder.ResampleSplines(Model);
+	});
+	if (!Progress.Wait(ResampleTask, 1.0f, LOCTEXT("ResampleSplines", "Resampling Road Splines")))
+	{
+		NotifyGenerationCancelled(TEXT("Generate Intersections"));
+		return;
+	}
+	if (!bHasSegments)
 	{
 		UNotifyUtilities::ShowPopupMsgAtCorner("Error:Find Null Spline");
 		return;
 	}
-	//计算样条交点
-	TArray<FSplineIntersection> IntersectionResults = FindAllIntersections();
-	if (IntersectionResults.IsEmpty())
+	const UE::Tasks::FTask FindIntersectionTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Builder, &Model]()
+	{
+		Builder.FindIntersections(Model);
+	});
+	if (!Progress.Wait(FindIntersectionTask, 2.0f, LOCTEXT("FindIntersections", "Finding Spline Intersections")))
+	{
+		NotifyGenerationCancelled(TEXT("Generate Intersections"));
+		return;
+	}
+	//模型中的Segment和原始交点写回，之后增量更新以此为基础
+	ApplyCityModelSegments(Model, SourceSplines);
+	bIntersectionsGenerated = false;
+	if (Model.Intersections.IsEmpty())
 	{
 		UNotifyUtilities::ShowPopupMsgAtCorner("Error:Find Null Intersections");
 		return;
 	}
-	IDToIntersectionGenerator.Reserve(IntersectionResults.Num());
-	IDToIntersectionGenerator.Reset();
+	//上次的路口移入回收池，相交样条相同的路口复用已有Actor
+	MoveGeneratorsToPool(IDToIntersectionGenerator, IntersectionActorPool);
+	IDToIntersectionGenerator.Reserve(Model.Intersections.Num());
 	IntersectionCompOnSpline.Reset();
+	//全部重建，道路和街区之后也需要全部重建
+	DependencyTracker.Reset();
+	PendingRoadEdit.Reset();
+	PendingBlockEdit.Reset();
+	bRoadsGenerated = false;
+	bBlocksGenerated = false;
 
-	TArray<FIntersectionSegment> IntersectionBuildData;
-	//对每一个交点生成Actor挂载
-	for (int32 i = 0; i < IntersectionResults.Num(); ++i)
-	{
-		//切割交点分段
-		if (TearIntersectionToSegments(IntersectionResults[i], IntersectionBuildData))
-		{
-			if (bEnableVisualDebug.GetValueOnGameThread())
-			{
-				for (int32 k = 0; k < IntersectionBuildData.Num(); ++k)
-				{
-					FColor DebugColor = FColor((k + 1.0) / IntersectionBuildData.Num() * 255, 0, 0);
-					DrawDebugSphere(UEditorComponentUtilities::GetEditorContext()->GetWorld(),
-					                IntersectionBuildData[k].IntersectionEndPointWS, 100.0, 8, DebugColor, true, -1, 0,
-					                10.0f);
-				}
-			}
-			//生成交点对象
-			FTransform ActorTransform = FTransform::Identity;
-			ActorTransform.SetLocation(IntersectionResults[i].WorldLocation);
-			AActor* IntersectionActor = UEditorComponentUtilities::SpawnEmptyActor(
-				FString::Printf(TEXT("RoadIntersection%d"), i), ActorTransform);
-			ensureAlwaysMsgf(IntersectionActor!=nullptr, TEXT("Error:Create Intersection Actor Failed"));
-
-			UActorComponent* MeshCompTemp = UEditorComponentUtilities::AddComponentInEditor(
-				IntersectionActor, UDynamicMeshComponent::StaticClass());
-			UDynamicMeshComponent* MeshComp = Cast<UDynamicMeshComponent>(MeshCompTemp);
-			ensureAlwaysMsgf(MeshComp!=nullptr, TEXT("Error:Create DynamicMeshComp Failed"));
-
-			UActorComponent* GeneratorCompTemp = UEditorComponentUtilities::AddComponentInEditor(
-				IntersectionActor, UIntersectionMeshGenerator::StaticClass());
-			UIntersectionMeshGenerator* GeneratorComp = Cast<UIntersectionMeshGenerator>(GeneratorCompTemp);
-			ensureAlwaysMsgf(GeneratorComp!=nullptr, TEXT("Error:Create IntersectionMeshGeneratorComp Failed"));
-			GeneratorComp->SetMeshComponent(MeshComp);
-			GeneratorComp->SetIntersectionSegmentsData(IntersectionBuildData);
-
-			if (true == AddTextRender.GetValueOnGameThread())
-			{
-				AddDebugTextRender(IntersectionActor, FColor::Turquoise,
-				                   FString::Printf(TEXT("II:%d"), GeneratorComp->GetGlobalIndex()));
-			}
-
-			IDToIntersectionGenerator.Emplace(GeneratorComp->GetGlobalIndex(), GeneratorComp);
-			for (const FIntersectionSegment& BuildData : IntersectionBuildData)
-			{
-				if (!IntersectionCompOnSpline.Contains(BuildData.OwnerSpline))
-				{
-					IntersectionCompOnSpline.Emplace(BuildData.OwnerSpline,
-					                                 TArray<TWeakObjectPtr<UIntersectionMeshGenerator>>());
-				}
-				IntersectionCompOnSpline[BuildData.OwnerSpline].Emplace(GeneratorComp);
-			}
-		}
-	}
+	TArray<int32> IntersectionGlobalIndexes;
+	bool bFinished = SpawnCityModelIntersections(Model, SourceSplines, Progress, IntersectionGlobalIndexes);
 
 	FlushPersistentDebugLines(GetWorld());
 	//调用生成
-	for (const auto& IDGeneratorPair : IDToIntersectionGenerator)
-	{
-		if (!IDGeneratorPair.Value.IsValid())
-		{
-			continue;
-		}
-		IDGeneratorPair.Value->SetDrawVisualDebug(bEnableVisualDebug.GetValueOnGameThread());
-		IDGeneratorPair.Value->GenerateMesh();
+	bFinished = bFinished && CommitMeshesInBatches(CachedIntersectionGenerators, Progress,
+	                                               LOCTEXT("CommitIntersectionMeshes", "Building Intersection Meshes"));
+	if (!bFinished)
+	{
+		RestorePooledGeneratorsOnCancel(CachedIntersectionGenerators, IntersectionActorPool, IDToIntersectionGenerator,
+		                                [this](const TWeakObjectPtr<UIntersectionMeshGenerator>& Generator)
+		                                {
+			                                DestroyIntersectionActor(Generator);
+		                                });
+		CachedIntersectionGenerators.Reset();
+		CachedIntersections.Reset();
+		DependencyTracker.Reset();
+		NotifyGenerationCancelled(TEXT("Generate Intersections"));
+		return;
 	}
+	DestroyUnusedPooledActors(IntersectionActorPool, TEXT("Intersections"));
 	bIntersectionsGenerated = true;
+	UpdateCityTilesIfEnabled();
 }
 
-void URoadGeneratorSubsystem::VisualizeSegmentByDebugline(bool bUpdateBeforeDraw, float Thickness,
-                                                          bool bFlushBeforeDraw)
+UIntersectionMeshGenerator* URoadGeneratorSubsystem::SpawnIntersectionActor(
+	const FSplineIntersection& InIntersectionInfo)
 {
-	if (bUpdateBeforeDraw)
-	{
-		InitialRoadSplines();
-	}
-	if (SplineSegmentsInfo.IsEmpty())
+	TArray<FIntersectionSegment> IntersectionBuildData;
+	//切割交点分段
+	if (!TearIntersectionToSegments(InIntersectionInfo, IntersectionBuildData))
 	{
-		return;
+		return nullptr;
 	}
-	if (bFlushBeforeDraw)
+	return SpawnIntersectionActor(InIntersectionInfo, IntersectionBuildData);
+}
+
+UIntersectionMeshGenerator* URoadGeneratorSubsystem::SpawnIntersectionActor(
+	const FSplineIntersection& InIntersectionInfo, const TArray<FIntersectionSegment>& IntersectionBuildData)
+{
+	if (IntersectionBuildData.IsEmpty())
 	{
-		FlushPersistentDebugLines(UEditorComponentUtilities::GetEditorContext());
+		return nullptr;
 	}
-	for (const auto& SegmentOfSingleSpline : SplineSegmentsInfo)
+	if (bEnableVisualDebug.GetValueOnGameThread())
 	{
-		if (!SegmentOfSingleSpline.Key.IsValid()) { continue; }
-		USplineComponent* OwnerSpline = SegmentOfSingleSpline.Key.Pin().Get();
-		TArray<FSplinePolyLineSegment> Segments = SegmentOfSingleSpline.Value;
-		for (int32 i = 0; i < Segments.Num(); ++i)
+		for (int32 k = 0; k < IntersectionBuildData.Num(); ++k)
 		{
-			FColor DebugColor = Segments.Num() != 1 ? FColor(i * 255 / (Segments.Num() - 1)) : FColor(255, 255, 1);
-			DrawDebugSphere(OwnerSpline->GetWorld(), Segments[i].StartTransform.GetLocation(), 100.0f, 8, DebugColor,
-			                true);
-			DrawDebugSphere(OwnerSpline->GetWorld(), Segments[i].EndTransform.GetLocation(), 100.0f, 8, DebugColor,
-			                true);
-			FVector CenterLocation = (Segments[i].StartTransform.GetLocation() + Segments[i].EndTransform.GetLocation())
-				/ 2.0;
-			double BoxExtendX = FVector::Dist2D(Segments[i].StartTransform.GetLocation(),
-			                                    Segments[i].EndTransform.GetLocation()) / 2.0;
-			FVector BoxExtend(BoxExtendX, 250.0, 100.0);
-			FRotator BoxRotator = UKismetMathLibrary::MakeRotFromX((
-				Segments[i].StartTransform.GetLocation() - Segments[i].EndTransform.GetLocation()).GetSafeNormal());
-			DrawDebugBox(OwnerSpline->GetWorld(), CenterLocation, BoxExtend, BoxRotator.Quaternion(), DebugColor, true);
+			FColor DebugColor = FColor((k + 1.0) / IntersectionBuildData.Num() * 255, 0, 0);
+			DrawDebugSphere(UEditorComponentUtilities::GetEditorContext()->GetWorld(),
+			                IntersectionBuildData[k].IntersectionEndPointWS, 100.0, 8, DebugColor, true, -1, 0,
+			                10.0f);
 		}
 	}
-}
-
-bool URoadGeneratorSubsystem::InitialRoadSplines()
-{
-	UCityGeneratorSubSystem* DataSubsystem = GEditor->GetEditorSubsystem<UCityGeneratorSubSystem>();
-	if (!DataSubsystem)
+	//生成交点对象，全量重新生成时优先复用相交样条相同的已有路口
+	FTransform ActorTransform = FTransform::Identity;
+	ActorTransform.SetLocation(InIntersectionInfo.WorldLocation);
+	const uint32 TopologyKey = MakeIntersectionTopologyKey(IntersectionBuildData);
+	UIntersectionMeshGenerator* GeneratorComp = IntersectionActorPool.Take(
+		TopologyKey, InIntersectionInfo.WorldLocation);
+	AActor* IntersectionActor = nullptr;
+	if (nullptr != GeneratorComp)
 	{
-		UNotifyUtilities::ShowPopupMsgAtCorner("Error::Find Null UCityGeneratorSubSystem");
-		return false;
+		ModifyReusedActor(GeneratorComp);
+		IntersectionActor = GeneratorComp->GetOwner();
+		IntersectionActor->SetActorTransform(ActorTransform);
+		GeneratorComp->ResetForRegenerate();
 	}
-	RoadSplines = DataSubsystem->GetSplines();
-	if (RoadSplines.IsEmpty())
+	else
 	{
-		UNotifyUtilities::ShowPopupMsgAtCorner("Error::Find Null Spline");
-		return false;
+		IntersectionActor = UEditorComponentUtilities::SpawnEmptyActor(TEXT("RoadIntersection"), ActorTransform);
+		ensureAlwaysMsgf(IntersectionActor!=nullptr, TEXT("Error:Create Intersection Actor Failed"));
+
+		UActorComponent* MeshCompTemp = UEditorComponentUtilities::AddComponentInEditor(
+			IntersectionActor, UDynamicMeshComponent::StaticClass());
+		UDynamicMeshComponent* MeshComp = Cast<UDynamicMeshComponent>(MeshCompTemp);
+		ensureAlwaysMsgf(MeshComp!=nullptr, TEXT("Error:Create DynamicMeshComp Failed"));
+
+		UActorComponent* GeneratorCompTemp = UEditorComponentUtilities::AddComponentInEditor(
+			IntersectionActor, UIntersectionMeshGenerator::StaticClass());
+		GeneratorComp = Cast<UIntersectionMeshGenerator>(GeneratorCompTemp);
+		ensureAlwaysMsgf(GeneratorComp!=nullptr, TEXT("Error:Create IntersectionMeshGeneratorComp Failed"));
+		GeneratorComp->SetMeshComponent(MeshComp);
+		//GlobalIndex在Generator构造时分配，按其命名避免增量更新时与保留的Actor重名
+		UEditorComponentUtilities::SetActorLabelInEditor(
+			IntersectionActor, FString::Printf(TEXT("RoadIntersection%d"), GeneratorComp->GetGlobalIndex()));
 	}
-	bIntersectionsGenerated = false;
-	FSplinePolyLineSegment::ResetGlobalIndex();
-	for (TWeakObjectPtr<USplineComponent> SplineComponent : RoadSplines)
+	GeneratorComp->SetTopologyKey(TopologyKey);
+	GeneratorComp->SetIntersectionSegmentsData(IntersectionBuildData);
+
+	if (true == AddTextRender.GetValueOnGameThread())
 	{
-		USplineComponent* PinnedSplineComp = SplineComponent.Pin().Get();
-		//CVar细分预览
-		//PolyLineSubdivisionDis.GetValueOnGameThread()
-		UpdateSplineSegments(PinnedSplineComp);
+		AddDebugTextRender(IntersectionActor, FColor::Turquoise,
+		                   FString::Printf(TEXT("II:%d"), GeneratorComp->GetGlobalIndex()));
 	}
-	//
-	SplineQuadTree.Empty();
-	return true;
-}
 
-void URoadGeneratorSubsystem::UpdateSplineSegments(USplineComponent* TargetSpline)
-{
-	if (nullptr == TargetSpline)
+	IDToIntersectionGenerator.Emplace(GeneratorComp->GetGlobalIndex(), GeneratorComp);
+	for (const FIntersectionSegment& BuildData : IntersectionBuildData)
 	{
-		return;
+		IntersectionCompOnSpline.FindOrAdd(BuildData.OwnerSpline).Emplace(GeneratorComp);
 	}
-	TArray<FTransform> ResamplePointsOnSpline;
-	const int32 OriginalSegmentCount = TargetSpline->GetNumberOfSplineSegments();
-	//const float OriginalSplineLength = TargetSpline->GetSplineLength();
-	//没构成有效样条
-	if (OriginalSegmentCount < 1)
+	DependencyTracker.AddIntersection(GeneratorComp->GetGlobalIndex(), InIntersectionInfo.IntersectedSplines);
+	return GeneratorComp;
+}
+
+void URoadGeneratorSubsystem::DestroyIntersectionActor(
+	const TWeakObjectPtr<UIntersectionMeshGenerator>& TargetGenerator)
+{
+	if (!TargetGenerator.IsValid())
 	{
 		return;
 	}
-	ResamplePointsOnSpline.Append(ResampleSpline(TargetSpline));
-
-	if (ResamplePointsOnSpline.IsEmpty())
+	UIntersectionMeshGenerator* Generator = TargetGenerator.Pin().Get();
+	IDToIntersectionGenerator.Remove(Generator->GetGlobalIndex());
+	for (auto& SplineGeneratorsPair : IntersectionCompOnSpline)
 	{
-		ensureAlwaysMsgf(!ResamplePointsOnSpline.IsEmpty(), TEXT("Get Empty PolyPointArray"));
-		return;
+		SplineGeneratorsPair.Value.Remove(TargetGenerator);
 	}
-	TArray<FSplinePolyLineSegment> Segments;
-	const int32 SegmentCount = ResamplePointsOnSpline.Num() - 1;
-	Segments.Reserve(SegmentCount);
-
-	for (int32 i = 1; i < ResamplePointsOnSpline.Num(); i++)
+	if (AActor* IntersectionActor = Generator->GetOwner())
 	{
-		Segments.Emplace(FSplinePolyLineSegment(TargetSpline, i - 1, SegmentCount - 1, ResamplePointsOnSpline[i - 1],
-		                                        ResamplePointsOnSpline[i]));
+		IntersectionActor->Destroy();
 	}
-	SplineSegmentsInfo.Emplace(TargetSpline, Segments);
 }
 
-TArray<FSplineIntersection> URoadGeneratorSubsystem::FindAllIntersections()
+bool URoadGeneratorSubsystem::UpdateIntersectionsIncrementally()
 {
-	TRACE_BOOKMARK(TEXT("Begin Find Intersections"));
-	TArray<FSplineIntersection> Results;
-	if (SplineSegmentsInfo.IsEmpty())
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::UpdateIntersectionsIncrementally);
+	const double StartTime = FPlatformTime::Seconds();
+	UCityGeneratorSubSystem* DataSubsystem = GEditor->GetEditorSubsystem<UCityGeneratorSubSystem>();
+	if (!DataSubsystem || SegmentStore.IsEmpty() || SegmentBVH.Num() != SegmentStore.Num())
 	{
-		UNotifyUtilities::ShowPopupMsgAtCorner("Find Intersection Failed, Reason:Find Null Spline");
-		return Results;
+		return false;
+	}
+	//样条增删时GlobalIndex和图结构都需要重建，只处理样条移动
+	const TSet<TWeakObjectPtr<USplineComponent>> CurrentSplines = DataSubsystem->GetSplines();
+	if (CurrentSplines.Num() != RoadSplines.Num() || !CurrentSplines.Includes(RoadSplines))
+	{
+		return false;
+	}
+	for (const TWeakObjectPtr<USplineComponent>& DirtySpline : DirtySplines)
+	{
+		if (!DirtySpline.IsValid() || !RoadSplines.Contains(DirtySpline))
+		{
+			return false;
+		}
 	}
-	//收集当前所有分段信息,额外存一份ID
-	//TArray<FSplinePolyLineSegment> 
-	TArray<FSplinePolyLineSegment> AllSegments;
-	//构建四叉树
-	//计算世界包围盒，使用ForceInit可以在后续追加包围盒时自动计算总包围盒大小
 
-	AllSegments.Reserve(SplineSegmentsInfo.Num() * 2);
-	FBox2D TotalBounds(ForceInit);
-	for (const auto& SegmentsOfSingleSpline : SplineSegmentsInfo)
+	//1.移除旧Segment，BVH与SegmentStore下标一致，同步标记
+	for (const TWeakObjectPtr<USplineComponent>& DirtySpline : DirtySplines)
 	{
-		if (!SegmentsOfSingleSpline.Key.IsValid())
+		const int32 SplineId = SegmentStore.FindSplineId(DirtySpline);
+		if (SplineId == INDEX_NONE)
 		{
 			continue;
 		}
-		TArray<FSplinePolyLineSegment> Segments = SegmentsOfSingleSpline.Value;
-		for (const FSplinePolyLineSegment& Segment : Segments)
+		const int32 FirstSegment = SegmentStore.GetSplineFirstSegment(SplineId);
+		for (int32 i = 0; i < SegmentStore.GetSplineSegmentNum(SplineId); ++i)
 		{
-			TotalBounds += FVector2D(Segment.StartTransform.GetLocation());
-			TotalBounds += FVector2D(Segment.EndTransform.GetLocation());
-			AllSegments.Emplace(Segment);
+			SegmentBVH.Remove(FirstSegment + i);
 		}
+		SegmentStore.RemoveSpline(SplineId);
 	}
-
-	SplineQuadTree = TQuadTree<FSplinePolyLineSegment>(TotalBounds, MinimumQuadSize);
-	for (const auto& SegmentWithIndex : AllSegments)
+	//2.重新采样，新Segment的GlobalIndex继续递增，追加在存储末尾
+	const int32 NumBeforeAppend = SegmentStore.Num();
+	for (const TWeakObjectPtr<USplineComponent>& DirtySpline : DirtySplines)
 	{
-		FBox2D SegmentBounds(ForceInit);
-		SegmentBounds += FVector2D(SegmentWithIndex.StartTransform.GetLocation());
-		SegmentBounds += FVector2D(SegmentWithIndex.EndTransform.GetLocation());
-		SplineQuadTree.Insert(SegmentWithIndex, SegmentBounds);
+		UpdateSplineSegments(DirtySpline.Pin().Get());
 	}
+	const int32 AppendedNum = SegmentStore.Num() - NumBeforeAppend;
+	for (int32 i = NumBeforeAppend; i < SegmentStore.Num(); ++i)
+	{
+		SegmentBVH.Append(SegmentStore.GetStart(i), SegmentStore.GetEnd(i));
+	}
+	//溢出或移除过多时查询退化为线性，压缩后重建
+	if (SegmentBVH.GetOverflowNum() + SegmentBVH.GetRemovedNum() > FMath::Max(64, SegmentStore.Num() / 4))
+	{
+		SegmentStore.Compact();
+		SegmentBVH = BuildSegmentBVH(SegmentStore);
+	}
+	//Compact保持顺序，新Segment仍位于末尾
+	const int32 QueryBeginIndex = SegmentStore.Num() - AppendedNum;
 
-	UE_LOG(LogTemp, Display, TEXT("Finish Insert To QuadTree"));
-	//用于接收四叉树查询结果
-	TArray<FSplinePolyLineSegment> OverlappedSegments;
-	//用于缓存四叉树处理过的样条分段,使用Segment的GlobalIndex
-	TSet<TPair<uint32, uint32>> ProcessedPairs;
-	for (int i = 0; i < AllSegments.Num(); ++i)
+	//3.只保留不涉及移动样条的原始交点，再补上新Segment的交点
+	TArray<FSegmentPairHit> NewHits = FindSegmentHitsByBVH(SegmentBVH, SegmentStore, QueryBeginIndex);
+	const int32 OldHitNum = CachedSegmentHits.Num();
+	CachedSegmentHits.RemoveAll([this](const FSegmentPairHit& Hit)-> bool
 	{
-		FBox2D SegmentQueryBounds;
-		SegmentQueryBounds += FVector2D(AllSegments[i].StartTransform.GetLocation());
-		SegmentQueryBounds += FVector2D(AllSegments[i].EndTransform.GetLocation());
-		//扩大范围
-		SegmentQueryBounds = SegmentQueryBounds.ExpandBy(10.0f);
-		//Reset不缩小内存
-		OverlappedSegments.Reset();
-		SplineQuadTree.GetElements(SegmentQueryBounds, OverlappedSegments);
-		for (const FSplinePolyLineSegment& OverlappedSegment : OverlappedSegments)
+		return DirtySplines.Contains(Hit.SplineA) || DirtySplines.Contains(Hit.SplineB);
+	});
+	const int32 RemovedHitNum = OldHitNum - CachedSegmentHits.Num();
+	CachedSegmentHits.Append(MoveTemp(NewHits));
+	//新Segment的GlobalIndex最大，但与旧Segment组成的交点A为旧Segment，仍需整体排序
+	SortSegmentHits(CachedSegmentHits);
+	TArray<FSplineIntersection> IntersectionResults = MergeSegmentHits(CachedSegmentHits);
+
+	//4.与上次的交点比较，未涉及移动样条且合并的原始交点Segment对完全相同的交点保留原Actor
+	//不比较质心位置，原始交点顺序变化引起的浮点误差不会导致无关路口重建
+	TMultiMap<uint32, int32> OldIntersectionIndices;
+	for (int32 i = 0; i < CachedIntersections.Num(); ++i)
+	{
+		OldIntersectionIndices.Add(GetSourceHitPairsHash(CachedIntersections[i]), i);
+	}
+	auto IsDirtyIntersection = [this](const FSplineIntersection& Intersection)-> bool
+	{
+		for (const TWeakObjectPtr<USplineComponent>& IntersectedSpline : Intersection.IntersectedSplines)
 		{
-			//排除自己
-			if (AllSegments[i].GetGlobalIndex() == OverlappedSegment.GetGlobalIndex())
-			{
-				continue;
-			}
-			//排除相连的同一样条的Segment
-			if (AllSegments[i].OwnerSpline == OverlappedSegment.OwnerSpline)
-			{
-				const uint32 IndexGap = AllSegments[i].SegmentIndex > OverlappedSegment.SegmentIndex
-					                        ? AllSegments[i].SegmentIndex - OverlappedSegment.SegmentIndex
-					                        : OverlappedSegment.SegmentIndex - AllSegments[i].SegmentIndex;
-				if (IndexGap <= 1 || IndexGap == AllSegments[i].LastSegmentIndex)
-				{
-					continue;
-				}
-			}
-			//记录已经处理过的样条
-			TPair<uint32, uint32> IndexPair;
-			if (AllSegments[i].GetGlobalIndex() < OverlappedSegment.GetGlobalIndex())
-			{
-				IndexPair.Key = AllSegments[i].GetGlobalIndex();
-				IndexPair.Value = OverlappedSegment.GetGlobalIndex();
-			}
-			else
+			if (DirtySplines.Contains(IntersectedSpline))
 			{
-				IndexPair.Key = OverlappedSegment.GetGlobalIndex();
-				IndexPair.Value = AllSegments[i].GetGlobalIndex();
+				return true;
 			}
-			//已经处理过跳过
-			if (ProcessedPairs.Contains(IndexPair))
-			{
-				continue;
-			}
-			ProcessedPairs.Emplace(IndexPair);
-			FVector2D IteratorSegmentStart = FVector2D(AllSegments[i].StartTransform.GetLocation());
-			FVector2D IteratorSegmentEnd = FVector2D(AllSegments[i].EndTransform.GetLocation());
-			FVector2D TestingSegmentStart = FVector2D(OverlappedSegment.StartTransform.GetLocation());
-			FVector2D TestingSegmentEnd = FVector2D(OverlappedSegment.EndTransform.GetLocation());
-			FVector2D IntersectionLoc2D;
-			if (!URoadGeometryUtilities::Get2DIntersection(IteratorSegmentStart, IteratorSegmentEnd,
-			                                               TestingSegmentStart, TestingSegmentEnd,
-			                                               IntersectionLoc2D))
-			{
-				continue;
-			}
-			FVector FlattedIntersectionLoc = FVector(IntersectionLoc2D, 0.0);
-			//检查相近点
-			bool bCanMerge = false;
-			for (FSplineIntersection& Result : Results)
+		}
+		return false;
+	};
+	TBitArray<> OldIntersectionKept(false, CachedIntersections.Num());
+	TArray<TWeakObjectPtr<UIntersectionMeshGenerator>> NewIntersectionGenerators;
+	NewIntersectionGenerators.SetNum(IntersectionResults.Num());
+	TArray<int32> IntersectionsToSpawn;
+	for (int32 i = 0; i < IntersectionResults.Num(); ++i)
+	{
+		bool bMatched = false;
+		if (!IsDirtyIntersection(IntersectionResults[i]))
+		{
+			TArray<int32, TInlineAllocator<2>> CandidateIndices;
+			OldIntersectionIndices.MultiFind(GetSourceHitPairsHash(IntersectionResults[i]), CandidateIndices);
+			for (const int32 OldIndex : CandidateIndices)
 			{
-				//相当于用空间关系进行交点索引
-				//@TODO:这里可能需要一个优先级算法确定以谁为终点
-				if (FVector::DistSquared2D(Result.WorldLocation, FlattedIntersectionLoc) < MergeThreshold *
-					MergeThreshold)
+				if (!OldIntersectionKept[OldIndex] &&
+					CachedIntersections[OldIndex].SourceHitPairs == IntersectionResults[i].SourceHitPairs &&
+					CachedIntersections[OldIndex].IntersectedSplines == IntersectionResults[i].IntersectedSplines)
 				{
-					//AddSplineToOldIntersectionData
-					Result.IntersectedSplines.Emplace(OverlappedSegment.OwnerSpline);
-					Result.IntersectedSegmentIndex.Emplace(OverlappedSegment.SegmentIndex);
-					bCanMerge = true;
+					OldIntersectionKept[OldIndex] = true;
+					NewIntersectionGenerators[i] = CachedIntersectionGenerators[OldIndex];
+					bMatched = true;
 					break;
 				}
 			}
-			if (!bCanMerge)
-			{
-				//首次添加需要加两个Segment信息
-				TArray<TWeakObjectPtr<USplineComponent>> IntersectedSplines{
-					AllSegments[i].OwnerSpline, OverlappedSegment.OwnerSpline
-				};
-				TArray<uint32> IntersectedSegmentIndex{AllSegments[i].SegmentIndex, OverlappedSegment.SegmentIndex};
-				FSplineIntersection
-					NewIntersection(IntersectedSplines, IntersectedSegmentIndex, FlattedIntersectionLoc);
-				//AddSplineToNewIntersectionData
-				Results.Emplace(NewIntersection);
-			}
-		}
-	}
-	return Results;
-}
-
-bool URoadGeneratorSubsystem::TearIntersectionToSegments(
-	const FSplineIntersection& InIntersectionInfo, TArray<FIntersectionSegment>& OutSegments, float UniformDistance)
-{
-	if (InIntersectionInfo.IntersectedSplines.IsEmpty())
-	{
-		return false;
-	}
-	TArray<TWeakObjectPtr<USplineComponent>> IntersectedSplines = InIntersectionInfo.IntersectedSplines;
-	OutSegments.Reserve(IntersectedSplines.Num());
-	OutSegments.Reset();
-
-	for (int i = 0; i < IntersectedSplines.Num(); ++i)
-	{
-		if (!IntersectedSplines[i].IsValid())
-		{
-			return false;
-		}
-		USplineComponent* TargetSpline = IntersectedSplines[i].Pin().Get();
-		float Distance = TargetSpline->GetDistanceAlongSplineAtLocation(InIntersectionInfo.WorldLocation,
-		                                                                ESplineCoordinateSpace::World);
-		//判断后边一段是不是在样条上
-		const float DistanceOfNextPoint = Distance + UniformDistance;
-		if (DistanceOfNextPoint < TargetSpline->GetSplineLength())
-		{
-			FVector FlowOutPointLoc = TargetSpline->GetLocationAtDistanceAlongSpline(
-				DistanceOfNextPoint, ESplineCoordinateSpace::World);
-			FRotator FlowOutPointRot = TargetSpline->GetRotationAtDistanceAlongSpline(
-				DistanceOfNextPoint, ESplineCoordinateSpace::World);
-			OutSegments.Emplace(FIntersectionSegment(IntersectedSplines[i], FlowOutPointLoc, FlowOutPointRot, false,
-			                                         500.0f));
 		}
-		//判断前边一段是不是在样条上
-		if (Distance > UniformDistance)
+		if (!bMatched)
 		{
-			FVector FlowInPointLoc = TargetSpline->GetLocationAtDistanceAlongSpline(
-				Distance - UniformDistance, ESplineCoordinateSpace::World);
-			FRotator FlowInPointRot = TargetSpline->GetRotationAtDistanceAlongSpline(
-				DistanceOfNextPoint, ESplineCoordinateSpace::World);
-			OutSegments.Emplace(FIntersectionSegment(IntersectedSplines[i], FlowInPointLoc, FlowInPointRot, true,
-			                                         500.0f));
+			IntersectionsToSpawn.Emplace(i);
 		}
 	}
-	if (OutSegments.IsEmpty())
+	int32 DestroyedNum = 0;
+	for (int32 i = 0; i < CachedIntersections.Num(); ++i)
 	{
-		return false;
+		if (!OldIntersectionKept[i])
+		{
+			//销毁的交汇路口暂时保留在DependencyTracker中，道路阶段据此找到受影响的样条
+			if (CachedIntersectionGenerators[i].IsValid())
+			{
+				PendingRoadEdit.Intersections.Emplace(CachedIntersectionGenerators[i]->GetGlobalIndex());
+			}
+			DestroyIntersectionActor(CachedIntersectionGenerators[i]);
+			DestroyedNum++;
+		}
 	}
-	//根据顺时针顺序排序，X正方向为0，Y正方向为正
-	FVector IntersectionPoint = InIntersectionInfo.WorldLocation;
-	UE_LOG(LogTemp, Display, TEXT("Begin Sort"));
-	OutSegments.Sort([&IntersectionPoint](const FIntersectionSegment& A, const FIntersectionSegment& B)
+	//新路口在同一事务中生成，Component在生成Mesh前统一注册
 	{
-		FVector ProjectedA = FVector::VectorPlaneProject((A.IntersectionEndPointWS - IntersectionPoint),
-		                                                 FVector::UnitZ());
-		FVector2D RelA(ProjectedA);
-		FVector ProjectedB = FVector::VectorPlaneProject((B.IntersectionEndPointWS - IntersectionPoint),
-		                                                 FVector::UnitZ());
-		FVector2D RelB(ProjectedB);
-
-		float AngleA = FMath::Atan2(RelA.Y, RelA.X);
-		float AngleB = FMath::Atan2(RelB.Y, RelB.X);
-
-		UE_LOG(LogTemp, Display, TEXT("AngleA: %f,AngleB: %f"), AngleA, AngleB);
-		// Atan2返回范围为[-π,π)转换为[0, 2π)范围
-		if (AngleA < 0) AngleA += 2 * PI;
-		if (AngleB < 0) AngleB += 2 * PI;
-
-		if (AngleA != AngleB)
+		FEditorSpawnBatch SpawnBatch(TEXT("Spawn Intersections"));
+		for (const int32 NewIndex : IntersectionsToSpawn)
 		{
-			float AngleAInDegree = FMath::RadiansToDegrees(AngleA);
-			float AngleBInDegree = FMath::RadiansToDegrees(AngleB);
-			UE_LOG(LogTemp, Display, TEXT("AngleA: %f FromLoc:%s,AngleB: %f FromLoc:%s"), AngleAInDegree,
-			       *A.IntersectionEndPointWS.ToString(), AngleBInDegree, *B.IntersectionEndPointWS.ToString());
-			return AngleA < AngleB; // 极角小的排在前面
+			NewIntersectionGenerators[NewIndex] = SpawnIntersectionActor(IntersectionResults[NewIndex]);
 		}
-		else
+	}
+	//与完整流程相同分批并行构建Mesh，只在状态栏显示进度
+	TArray<TWeakObjectPtr<UIntersectionMeshGenerator>> SpawnedGenerators;
+	SpawnedGenerators.Reserve(IntersectionsToSpawn.Num());
+	for (const int32 NewIndex : IntersectionsToSpawn)
+	{
+		if (NewIntersectionGenerators[NewIndex].IsValid())
 		{
-			// 角度相同，按距离排序（近的在前）
-			return RelA.SizeSquared() < RelB.SizeSquared();
+			SpawnedGenerators.Emplace(NewIntersectionGenerators[NewIndex]);
+			PendingRoadEdit.Intersections.Emplace(NewIntersectionGenerators[NewIndex]->GetGlobalIndex());
 		}
-	});
-	UE_LOG(LogTemp, Display, TEXT("End Sort"));
+	}
+	FRoadGenerationProgress Progress(1.0f, LOCTEXT("UpdateIntersections", "Updating Road Intersections"), false);
+	CommitMeshesInBatches(SpawnedGenerators, Progress,
+	                      LOCTEXT("CommitIntersectionMeshes", "Building Intersection Meshes"));
+	CachedIntersections = MoveTemp(IntersectionResults);
+	CachedIntersectionGenerators = MoveTemp(NewIntersectionGenerators);
+
+	UE_LOG(LogTemp, Display,
+	       TEXT("Incremental Intersection Update:%d Splines,%d Segments Resampled,%d Hits Replaced By %d,%d Intersections Destroyed,%d Spawned,Cost %f ms"),
+	       DirtySplines.Num(), AppendedNum, RemovedHitNum, CachedSegmentHits.Num() - (OldHitNum - RemovedHitNum),
+	       DestroyedNum, IntersectionsToSpawn.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	PendingRoadEdit.Splines.Append(DirtySplines);
+	DirtySplines.Reset();
+	bNeedRefreshSegmentData = false;
 	return true;
 }
 
-#pragma endregion GenerateIntersection
-
-#pragma region GenerateRoad
-TArray<FSplinePolyLineSegment> URoadGeneratorSubsystem::GetInteractionOccupiedSegments(
+void URoadGeneratorSubsystem::VisualizeSegmentByDebugline(bool bUpdateBeforeDraw, float Thickness,
+                                                          bool bFlushBeforeDraw)
+{
+	if (bUpdateBeforeDraw)
+	{
+		InitialRoadSplines();
+	}
+	if (SplineSegmentsInfo.IsEmpty())
+	{
+		return;
+	}
+	if (bFlushBeforeDraw)
+	{
+		FlushPersistentDebugLines(UEditorComponentUtilities::GetEditorContext());
+	}
+	for (int32 i = 0; i < SegmentStore.Num(); ++i)
+	{
+		if (!SegmentStore.GetSpline(i).IsValid()) { continue; }
+		USplineComponent* OwnerSpline = SegmentStore.GetSpline(i).Pin().Get();
+		const uint32 SegmentNum = SegmentStore.GetLastSegmentIndex(i) + 1;
+		const uint32 SegmentIndex = SegmentStore.GetSegmentIndex(i);
+		FColor DebugColor = SegmentNum != 1 ? FColor(SegmentIndex * 255 / (SegmentNum - 1)) : FColor(255, 255, 1);
+		const FVector StartLocation = SegmentStore.GetStartLocation(i);
+		const FVector EndLocation = SegmentStore.GetEndLocation(i);
+		DrawDebugSphere(OwnerSpline->GetWorld(), StartLocation, 100.0f, 8, DebugColor, true);
+		DrawDebugSphere(OwnerSpline->GetWorld(), EndLocation, 100.0f, 8, DebugColor, true);
+		FVector CenterLocation = (StartLocation + EndLocation) / 2.0;
+		double BoxExtendX = FVector::Dist2D(StartLocation, EndLocation) / 2.0;
+		FVector BoxExtend(BoxExtendX, 250.0, 100.0);
+		FRotator BoxRotator = UKismetMathLibrary::MakeRotFromX((StartLocation - EndLocation).GetSafeNormal());
+		DrawDebugBox(OwnerSpline->GetWorld(), CenterLocation, BoxExtend, BoxRotator.Quaternion(), DebugColor, true);
+	}
+}
+
+bool URoadGeneratorSubsystem::InitialRoadSplines()
+{
+	FRoadGenerationProgress Progress(1.0f, LOCTEXT("InitialRoadSplines", "Resampling Road Splines"), false);
+	return ResampleRoadSplines(Progress);
+}
+
+bool URoadGeneratorSubsystem::ResampleRoadSplines(FRoadGenerationProgress& Progress)
+{
+	//在游戏线程复制样条曲线数据，后台任务只访问CityModel
+	FCityModel Model;
+	TArray<TWeakObjectPtr<USplineComponent>> SourceSplines;
+	if (!CaptureCityModel(Model, SourceSplines))
+	{
+		return false;
+	}
+	bIntersectionsGenerated = false;
+	const FCityModelBuilder Builder(MakeBuildSettings());
+	const UE::Tasks::FTask ResampleTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Builder, &Model]()
+	{
+		Builder.ResampleSplines(Model);
+	});
+	const double StartTime = FPlatformTime::Seconds();
+	if (!Progress.Wait(ResampleTask, 1.0f, LOCTEXT("ResampleSplines", "Resampling Road Splines")))
+	{
+		//SegmentStore与当前样条不一致，下次需要重新采样
+		bNeedRefreshSegmentData = true;
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Resample %d Splines To %d Segments(%s),Cost %f ms"), SourceSplines.Num(),
+	       Model.Segments.Num(), CVarResampleMode.GetValueOnGameThread() == 1 ? TEXT("Adaptive") : TEXT("Fixed"),
+	       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	ApplyCityModelSegments(Model, SourceSplines);
+	return true;
+}
+
+FCityModelBuildSettings URoadGeneratorSubsystem::MakeBuildSettings() const
+{
+	FCityModelBuildSettings Settings;
+	Settings.SampleDistance = PolyLineSampleDistance;
+	Settings.SegmentMaxLength = GetSegmentMaxLength();
+	Settings.bAdaptiveResample = CVarResampleMode.GetValueOnAnyThread() == 1;
+	Settings.AdaptiveChordError = CVarAdaptiveChordError.GetValueOnAnyThread();
+	Settings.MergeThreshold = MergeThreshold;
+	const ERoadIntersectionBackend Backend = static_cast<ERoadIntersectionBackend>(
+		FMath::Clamp(CVarIntersectionBackend.GetValueOnAnyThread(), 0, 1));
+	Settings.bUseSweepLine = Backend == ERoadIntersectionBackend::SweepLine;
+	Settings.bParallel = CVarParallelIntersection.GetValueOnAnyThread();
+	return Settings;
+}
+
+void URoadGeneratorSubsystem::ApplyCityModelSegments(const FCityModel& InModel,
+                                                     const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines)
+{
+	check(IsInGameThread());
+	RoadSplines.Reset();
+	RoadSplines.Append(InSourceSplines);
+	SegmentStore.Empty();
+	SplineSegmentsInfo.Reset();
+	//按模型中的存储顺序写入，GlobalIndex与模型一致，BVH和原始交点可以直接沿用
+	const FSplineSegmentStore& ModelSegments = InModel.Segments;
+	for (int32 StoreSplineId = 0; StoreSplineId < ModelSegments.GetSplineNum(); ++StoreSplineId)
+	{
+		const int32 SegmentNum = ModelSegments.GetSplineSegmentNum(StoreSplineId);
+		const int32 SplineID = InModel.StoreSplineToSplineID[StoreSplineId];
+		if (SegmentNum <= 0 || !InSourceSplines.IsValidIndex(SplineID))
+		{
+			continue;
+		}
+		const uint32 FirstGlobalIndex = ModelSegments.GetGlobalIndex(
+			ModelSegments.GetSplineFirstSegment(StoreSplineId));
+		AddSplineSegments(InSourceSplines[SplineID], InModel.Splines[SplineID].ResamplePoints,
+		                  FSplinePolyLineSegment::MakeSegments(InSourceSplines[SplineID], SegmentNum,
+		                                                       FirstGlobalIndex));
+	}
+	NextSegmentGlobalIndex = SegmentStore.IsEmpty() ? 0 : SegmentStore.GetGlobalIndex(SegmentStore.Num() - 1) + 1;
+	SegmentBVH = InModel.SegmentBVH;
+	CachedSegmentHits.Reset(InModel.SegmentHits.Num());
+	for (const FSegmentPairHit& Hit : InModel.SegmentHits)
+	{
+		CachedSegmentHits.Emplace(SegmentStore, SegmentStore.IndexOfGlobalIndex(Hit.GlobalIndexA),
+		                          SegmentStore.IndexOfGlobalIndex(Hit.GlobalIndexB), Hit.Location);
+	}
+	DirtySplines.Reset();
+	bNeedRefreshSegmentData = false;
+}
+
+bool URoadGeneratorSubsystem::SpawnCityModelIntersections(const FCityModel& InModel,
+                                                          const TArray<TWeakObjectPtr<USplineComponent>>&
+                                                          InSourceSplines, FRoadGenerationProgress& Progress,
+                                                          TArray<int32>& OutIntersectionGlobalIndexes)
+{
+	CachedIntersections.Reset(InModel.Intersections.Num());
+	CachedIntersectionGenerators.Reset(InModel.Intersections.Num());
+	OutIntersectionGlobalIndexes.Init(INT32_ERROR, InModel.Intersections.Num());
+	//拆分结果即入口顺序，入口局部ID直接沿用；Component在生成Mesh前统一注册
+	FEditorSpawnBatch SpawnBatch(TEXT("Spawn Intersections"));
+	const bool bFinished = Progress.ForEachBatch(
+		InModel.Intersections.Num(), CVarSpawnBatchSize.GetValueOnGameThread(), 1.0f,
+		LOCTEXT("SpawnIntersections", "Spawning Intersection Actors"), [&](int32 BeginIndex, int32 EndIndex)
+		{
+			for (int32 i = BeginIndex; i < EndIndex; ++i)
+			{
+				const FCityModelIntersection& Intersection = InModel.Intersections[i];
+				FSplineIntersection IntersectionInfo;
+				IntersectionInfo.WorldLocation = Intersection.Location;
+				IntersectionInfo.SourceHitPairs = Intersection.SourceHitPairs;
+				for (const int32 SplineID : Intersection.SplineIDs)
+				{
+					IntersectionInfo.IntersectedSplines.Emplace(InSourceSplines[SplineID]);
+				}
+				TArray<FIntersectionSegment> IntersectionBuildData;
+				IntersectionBuildData.Reserve(Intersection.Entries.Num());
+				for (const FCityModelEntry& Entry : Intersection.Entries)
+				{
+					TWeakObjectPtr<USplineComponent> OwnerSpline = InSourceSplines[Entry.SplineID];
+					IntersectionBuildData.Emplace(OwnerSpline, Entry.EndPoint, Entry.EndRotation, Entry.bIsFlowIn,
+					                              Entry.RoadWidth);
+				}
+				UIntersectionMeshGenerator* GeneratorComp = SpawnIntersectionActor(
+					IntersectionInfo, IntersectionBuildData);
+				CachedIntersections.Emplace(MoveTemp(IntersectionInfo));
+				CachedIntersectionGenerators.Emplace(GeneratorComp);
+				if (nullptr != GeneratorComp)
+				{
+					OutIntersectionGlobalIndexes[i] = GeneratorComp->GetGlobalIndex();
+				}
+			}
+		});
+	SpawnBatch.Commit();
+	return bFinished;
+}
+
+void URoadGeneratorSubsystem::UpdateSplineSegments(USplineComponent* TargetSpline)
+{
+	if (nullptr == TargetSpline)
+	{
+		return;
+	}
+	UpdateSplineSegments(TargetSpline, ResampleSpline(FSplineSnapshot::Capture(TargetSpline)));
+}
+
+void URoadGeneratorSubsystem::UpdateSplineSegments(USplineComponent* TargetSpline,
+                                                   const TArray<FTransform>& ResamplePointsOnSpline)
+{
+	if (nullptr == TargetSpline)
+	{
+		return;
+	}
+	const int32 OriginalSegmentCount = TargetSpline->GetNumberOfSplineSegments();
+	//const float OriginalSplineLength = TargetSpline->GetSplineLength();
+	//没构成有效样条
+	if (OriginalSegmentCount < 1)
+	{
+		return;
+	}
+	if (ResamplePointsOnSpline.IsEmpty())
+	{
+		ensureAlwaysMsgf(!ResamplePointsOnSpline.IsEmpty(), TEXT("Get Empty PolyPointArray"));
+		return;
+	}
+	TArray<FSplinePolyLineSegment> Segments = FSplinePolyLineSegment::MakeSegments(
+		TargetSpline, ResamplePointsOnSpline.Num() - 1, NextSegmentGlobalIndex);
+	NextSegmentGlobalIndex += Segments.Num();
+	AddSplineSegments(TargetSpline, ResamplePointsOnSpline, MoveTemp(Segments));
+}
+
+void URoadGeneratorSubsystem::AddSplineSegments(const TWeakObjectPtr<USplineComponent>& TargetSpline,
+                                                const TArray<FTransform>& ResamplePointsOnSpline,
+                                                TArray<FSplinePolyLineSegment>&& InSegments)
+{
+	check(IsInGameThread());
+	if (InSegments.IsEmpty())
+	{
+		return;
+	}
+	//端点坐标写入SoA存储，旋转和缩放只留在侧边数组供道路Mesh使用
+	SegmentStore.AppendSpline(TargetSpline, ResamplePointsOnSpline, InSegments[0].GetGlobalIndex());
+	SplineSegmentsInfo.Emplace(TargetSpline, MoveTemp(InSegments));
+}
+
+FSegmentBVH URoadGeneratorSubsystem::BuildSegmentBVH(const FSplineSegmentStore& InStore)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::BuildSegmentBVH);
+	TArray<FVector2D> SegmentStarts;
+	TArray<FVector2D> SegmentEnds;
+	SegmentStarts.Reserve(InStore.Num());
+	SegmentEnds.Reserve(InStore.Num());
+	for (int32 i = 0; i < InStore.Num(); ++i)
+	{
+		SegmentStarts.Emplace(InStore.GetStart(i));
+		SegmentEnds.Emplace(InStore.GetEnd(i));
+	}
+	FSegmentBVH BVH;
+	BVH.Build(SegmentStarts, SegmentEnds);
+	return BVH;
+}
+
+TArray<FSegmentPairHit> URoadGeneratorSubsystem::FindSegmentHitsByBVH(
+	const FSegmentBVH& InBVH, const FSplineSegmentStore& InStore, int32 InQueryBeginIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::FindSegmentHitsByBVH);
+	//BVH此后只读，按连续区间分块求交，每块独立缓冲，合并时按块顺序拼接即与单线程遍历顺序一致
+	const int32 QueryBeginIndex = FMath::Clamp(InQueryBeginIndex, 0, InStore.Num());
+	const int32 ChunkSize = FMath::Max(1, CVarIntersectionChunkSize.GetValueOnAnyThread());
+	const int32 ChunkNum = FMath::DivideAndRoundUp(InStore.Num() - QueryBeginIndex, ChunkSize);
+	TArray<TArray<FSegmentPairHit>> ChunkHits;
+	ChunkHits.SetNum(ChunkNum);
+	const bool bUseParallel = CVarParallelIntersection.GetValueOnAnyThread();
+	ParallelFor(ChunkNum, [&](int32 ChunkIndex)
+	{
+		const int32 BeginIndex = QueryBeginIndex + ChunkIndex * ChunkSize;
+		const int32 EndIndex = FMath::Min(BeginIndex + ChunkSize, InStore.Num());
+		FindSegmentHitsInRange(InBVH, InStore, BeginIndex, EndIndex, ChunkHits[ChunkIndex], QueryBeginIndex);
+	}, bUseParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+
+	TArray<FSegmentPairHit> AllHits;
+	int32 HitNum = 0;
+	for (const TArray<FSegmentPairHit>& SingleChunkHits : ChunkHits)
+	{
+		HitNum += SingleChunkHits.Num();
+	}
+	AllHits.Reserve(HitNum);
+	for (TArray<FSegmentPairHit>& SingleChunkHits : ChunkHits)
+	{
+		AllHits.Append(MoveTemp(SingleChunkHits));
+	}
+	SortSegmentHits(AllHits);
+	return AllHits;
+}
+
+void URoadGeneratorSubsystem::FindSegmentHitsInRange(const FSegmentBVH& InBVH, const FSplineSegmentStore& InStore,
+                                                     int32 BeginIndex, int32 EndIndex,
+                                                     TArray<FSegmentPairHit>& OutHits,
+                                                     int32 InQueryBeginIndex)
+{
+	//用于接收BVH查询结果
+	TArray<uint32> OverlappedSegmentIndices;
+	//过滤后的候选Segment，以SoA形式收集后交给批量求交
+	TArray<uint32> CandidateIndices;
+	TArray<double> CandidateStartX;
+	TArray<double> CandidateStartY;
+	TArray<double> CandidateEndX;
+	TArray<double> CandidateEndY;
+	TArray<uint8> CandidateHitMask;
+	TArray<double> CandidateT;
+	TArray<double> CandidateS;
+	for (int32 i = BeginIndex; i < EndIndex; ++i)
+	{
+		if (InStore.IsRemoved(i))
+		{
+			continue;
+		}
+		const FVector2D IteratorSegmentStart = InStore.GetStart(i);
+		const FVector2D IteratorSegmentEnd = InStore.GetEnd(i);
+		FBox2D SegmentQueryBounds(ForceInit);
+		SegmentQueryBounds += IteratorSegmentStart;
+		SegmentQueryBounds += IteratorSegmentEnd;
+		//扩大范围
+		SegmentQueryBounds = SegmentQueryBounds.ExpandBy(10.0f);
+		//Reset不缩小内存
+		OverlappedSegmentIndices.Reset();
+		InBVH.Query(SegmentQueryBounds, OverlappedSegmentIndices);
+		CandidateIndices.Reset();
+		CandidateStartX.Reset();
+		CandidateStartY.Reset();
+		CandidateEndX.Reset();
+		CandidateEndY.Reset();
+		for (const uint32 OverlappedIndex : OverlappedSegmentIndices)
+		{
+			//每对Segment只由GlobalIndex较小的一方处理，同时排除了自己；存储按GlobalIndex升序，直接比较下标
+			//查询范围之前的Segment不会再遍历，与其相交的Segment对由查询范围内的一方补算
+			if (static_cast<uint32>(i) >= OverlappedIndex && OverlappedIndex >= static_cast<uint32>(InQueryBeginIndex))
+			{
+				continue;
+			}
+			//排除相连的同一样条的Segment
+			if (InStore.IsAdjacent(i, OverlappedIndex))
+			{
+				continue;
+			}
+			CandidateIndices.Emplace(OverlappedIndex);
+			CandidateStartX.Emplace(InStore.GetStartX()[OverlappedIndex]);
+			CandidateStartY.Emplace(InStore.GetStartY()[OverlappedIndex]);
+			CandidateEndX.Emplace(InStore.GetEndX()[OverlappedIndex]);
+			CandidateEndY.Emplace(InStore.GetEndY()[OverlappedIndex]);
+		}
+		if (CandidateIndices.IsEmpty())
+		{
+			continue;
+		}
+		CandidateHitMask.SetNumUninitialized(CandidateIndices.Num(), EAllowShrinking::No);
+		CandidateT.SetNumUninitialized(CandidateIndices.Num(), EAllowShrinking::No);
+		CandidateS.SetNumUninitialized(CandidateIndices.Num(), EAllowShrinking::No);
+		if (URoadGeometryUtilities::Get2DIntersectionBatch(IteratorSegmentStart, IteratorSegmentEnd,
+		                                                   CandidateStartX, CandidateStartY, CandidateEndX,
+		                                                   CandidateEndY, CandidateHitMask, CandidateT,
+		                                                   CandidateS) == 0)
+		{
+			continue;
+		}
+		//BVH查询结果无序，交点在最终合并前统一排序
+		for (int32 j = 0; j < CandidateIndices.Num(); ++j)
+		{
+			if (CandidateHitMask[j] == 0)
+			{
+				continue;
+			}
+			if (static_cast<uint32>(i) < CandidateIndices[j])
+			{
+				OutHits.Emplace(InStore, i, CandidateIndices[j],
+				                IteratorSegmentStart + (IteratorSegmentEnd - IteratorSegmentStart) * CandidateT[j]);
+			}
+			else
+			{
+				//补算的Segment对仍以下标较小的一方作为A，交点取其参数位置
+				const FVector2D CandidateStart = InStore.GetStart(CandidateIndices[j]);
+				const FVector2D CandidateEnd = InStore.GetEnd(CandidateIndices[j]);
+				OutHits.Emplace(InStore, CandidateIndices[j], i,
+				                CandidateStart + (CandidateEnd - CandidateStart) * CandidateS[j]);
+			}
+		}
+	}
+}
+
+TArray<FSegmentPairHit> URoadGeneratorSubsystem::FindSegmentHitsBySweepLine(const FSplineSegmentStore& InStore)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::FindSegmentHitsBySweepLine);
+	TArray<FVector2D> SegmentStarts;
+	TArray<FVector2D> SegmentEnds;
+	SegmentStarts.Reserve(InStore.Num());
+	SegmentEnds.Reserve(InStore.Num());
+	for (int32 i = 0; i < InStore.Num(); ++i)
+	{
+		SegmentStarts.Emplace(InStore.GetStart(i));
+		SegmentEnds.Emplace(InStore.GetEnd(i));
+	}
+	TArray<TPair<int32, int32>> IntersectedPairs;
+	URoadGeometryUtilities::FindSegmentIntersectionsBySweepLine(
+		SegmentStarts, SegmentEnds, [&InStore](int32 IndexA, int32 IndexB)-> bool
+		{
+			return InStore.IsAdjacent(IndexA, IndexB);
+		}, IntersectedPairs);
+
+	TArray<FSegmentPairHit> AllHits;
+	AllHits.Reserve(IntersectedPairs.Num());
+	for (const TPair<int32, int32>& IntersectedPair : IntersectedPairs)
+	{
+		//与BVH后端保持一致：以GlobalIndex较小的一方作为A求交，保证交点数值完全相同
+		int32 IndexA = IntersectedPair.Key;
+		int32 IndexB = IntersectedPair.Value;
+		if (IndexA > IndexB)
+		{
+			Swap(IndexA, IndexB);
+		}
+		//单条候选调用批量求交，使交点数值与BVH后端逐位一致
+		uint8 HitMask = 0;
+		double T = 0.0;
+		double S = 0.0;
+		const FVector2D StartA = InStore.GetStart(IndexA);
+		const FVector2D EndA = InStore.GetEnd(IndexA);
+		if (URoadGeometryUtilities::Get2DIntersectionBatch(StartA, EndA, MakeArrayView(&InStore.GetStartX()[IndexB], 1),
+		                                                   MakeArrayView(&InStore.GetStartY()[IndexB], 1),
+		                                                   MakeArrayView(&InStore.GetEndX()[IndexB], 1),
+		                                                   MakeArrayView(&InStore.GetEndY()[IndexB], 1),
+		                                                   MakeArrayView(&HitMask, 1), MakeArrayView(&T, 1),
+		                                                   MakeArrayView(&S, 1)) == 0)
+		{
+			continue;
+		}
+		AllHits.Emplace(InStore, IndexA, IndexB, StartA + (EndA - StartA) * T);
+	}
+	SortSegmentHits(AllHits);
+	return AllHits;
+}
+
+TArray<FSplineIntersection> URoadGeneratorSubsystem::MergeSegmentHits(const TArray<FSegmentPairHit>& InHits) const
+{
+	TArray<FCityModelIntersection> MergedIntersections = FCityModelBuilder::MergeSegmentHits(
+		SegmentStore, InHits, MergeThreshold);
+	TArray<FSplineIntersection> Results;
+	Results.Reserve(MergedIntersections.Num());
+	for (FCityModelIntersection& MergedIntersection : MergedIntersections)
+	{
+		FSplineIntersection& Result = Results.AddDefaulted_GetRef();
+		//SplineIDs为SegmentStore中的SplineId
+		for (const int32 StoreSplineId : MergedIntersection.SplineIDs)
+		{
+			Result.IntersectedSplines.Emplace(SegmentStore.GetSpline(SegmentStore.GetSplineFirstSegment(StoreSplineId)));
+		}
+		Result.WorldLocation = MergedIntersection.Location;
+		Result.SourceHitPairs = MoveTemp(MergedIntersection.SourceHitPairs);
+	}
+	return Results;
+}
+
+bool URoadGeneratorSubsystem::TearIntersectionToSegments(
+	const FSplineIntersection& InIntersectionInfo, TArray<FIntersectionSegment>& OutSegments, float UniformDistance)
+{
+	OutSegments.Reset();
+	const TArray<TWeakObjectPtr<USplineComponent>>& IntersectedSplines = InIntersectionInfo.IntersectedSplines;
+	//在游戏线程现场复制相交样条，模型中的样条ID即IntersectedSplines下标
+	TArray<FSplineSnapshot> Snapshots;
+	Snapshots.Reserve(IntersectedSplines.Num());
+	FCityModelIntersection Intersection;
+	Intersection.Location = InIntersectionInfo.WorldLocation;
+	for (int32 i = 0; i < IntersectedSplines.Num(); ++i)
+	{
+		if (!IntersectedSplines[i].IsValid())
+		{
+			return false;
+		}
+		Snapshots.Emplace(FSplineSnapshot::Capture(IntersectedSplines[i].Get()));
+		Intersection.SplineIDs.Emplace(i);
+	}
+	TArray<const FSplineSnapshot*> SnapshotPtrs;
+	SnapshotPtrs.Reserve(Snapshots.Num());
+	for (const FSplineSnapshot& Snapshot : Snapshots)
+	{
+		SnapshotPtrs.Emplace(&Snapshot);
+	}
+	FCityModelBuildSettings Settings = MakeBuildSettings();
+	Settings.EntryDistance = UniformDistance;
+	if (!FCityModelBuilder(Settings).TearIntersection(Intersection, SnapshotPtrs))
+	{
+		return false;
+	}
+	OutSegments.Reserve(Intersection.Entries.Num());
+	for (const FCityModelEntry& Entry : Intersection.Entries)
+	{
+		TWeakObjectPtr<USplineComponent> OwnerSpline = IntersectedSplines[Entry.SplineID];
+		OutSegments.Emplace(OwnerSpline, Entry.EndPoint, Entry.EndRotation, Entry.bIsFlowIn, Entry.RoadWidth);
+	}
+	return true;
+}
+
+#pragma endregion GenerateIntersection
+
+#pragma region GenerateRoad
+TArray<uint32> URoadGeneratorSubsystem::GetInteractionOccupiedSegments(
 	TWeakObjectPtr<UIntersectionMeshGenerator> TargetIntersection) const
 {
-	TArray<FSplinePolyLineSegment> OverlappedSegments;
+	TArray<uint32> OverlappedSegmentIndices;
 	if (TargetIntersection.IsValid())
 	{
 		UIntersectionMeshGenerator* IntersectionMeshGenerator = TargetIntersection.Pin().Get();
 		FBox2D BoxOfIntersection = IntersectionMeshGenerator->GetOccupiedBox();
-		SplineQuadTree.GetElements(BoxOfIntersection, OverlappedSegments);
+		SegmentBVH.Query(BoxOfIntersection, OverlappedSegmentIndices);
 	}
-	return OverlappedSegments;
+	return OverlappedSegmentIndices;
 }
 
 void URoadGeneratorSubsystem::GenerateRoads()
 {
-	uint32 RoadCounter = 0;
 	//如果Intersection已经生成则按照之前的信息
 	if (!bIntersectionsGenerated && bNeedRefreshSegmentData)
 	{
@@ -567,681 +1263,1193 @@ void URoadGeneratorSubsystem::GenerateRoads()
 		UNotifyUtilities::ShowPopupMsgAtCorner("Error:Find Null Spline");
 		return;
 	}
-	//1，需要把完整、连续的Spline提取出来，使用四叉树提取可能存在十字路口的格子
-	for (const auto& SingleSpline : RoadSplines)
+	FRoadGenerationProgress Progress(3.0f, LOCTEXT("GenerateRoads", "Generating Roads"));
+	//交汇路口增量更新过时只重建受影响的道路
+	if (bRoadsGenerated && !PendingRoadEdit.IsEmpty() && CVarDirtyPropagation.GetValueOnGameThread())
+	{
+		RegenerateDirtyRoads(Progress);
+		return;
+	}
+	uint32 RoadCounter = 0;
+	DependencyTracker.ResetRoads();
+	//上次的道路移入回收池，全部边重新加入路网图
+	MoveGeneratorsToPool(IDToRoadGenerator, RoadActorPool);
+	if (nullptr != RoadGraph)
+	{
+		RoadGraph->RemoveAllEdges();
+	}
+	TArray<TWeakObjectPtr<URoadMeshGenerator>> NewRoads;
+	bool bFinished = GenerateRoadsOnSplines(RoadSplines.Array(), Progress, RoadCounter, NewRoads);
+	if (bFinished)
+	{
+		RoadGraph->PrintConnectionToLog();
+		//4.调用生成
+		TArray<TWeakObjectPtr<URoadMeshGenerator>> AllRoads;
+		IDToRoadGenerator.GenerateValueArray(AllRoads);
+		bFinished = CommitMeshesInBatches(AllRoads, Progress, LOCTEXT("CommitRoadMeshes", "Building Road Meshes"));
+	}
+	if (!bFinished)
+	{
+		RestorePooledGeneratorsOnCancel(NewRoads, RoadActorPool, IDToRoadGenerator,
+		                                [this](const TWeakObjectPtr<URoadMeshGenerator>& NewRoad)
+		                                {
+			                                DestroyRoadActor(NewRoad->GetGlobalIndex());
+		                                });
+		bRoadsGenerated = false;
+		NotifyGenerationCancelled(TEXT("Generate Roads"));
+		return;
+	}
+	DestroyUnusedPooledActors(RoadActorPool, TEXT("Roads"));
+	PendingRoadEdit.Reset();
+	PendingBlockEdit.Reset();
+	bRoadsGenerated = true;
+	bBlocksGenerated = false;
+	UpdateCityTilesIfEnabled();
+}
+
+void URoadGeneratorSubsystem::RegenerateDirtyRoads(FRoadGenerationProgress& Progress)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::RegenerateDirtyRoads);
+	const double StartTime = FPlatformTime::Seconds();
+	const FRoadDirtySet DirtySet = DependencyTracker.CollectDirtySet(PendingRoadEdit, RoadGraph);
+	const int32 RoadNumBefore = DependencyTracker.GetRoadNum();
+	//1.移除脏道路在图中的边和Actor，边置为无效值，未受影响道路的EntryIndex保持不变
+	int32 RemovedRoadNum = 0;
+	for (const int32 RoadIndex : DirtySet.Roads)
+	{
+		if (DestroyRoadActor(RoadIndex))
+		{
+			RemovedRoadNum++;
+		}
+	}
+	//已销毁的交汇路口此后不再参与传播
+	for (const int32 IntersectionIndex : DirtySet.Intersections)
 	{
-		if (!SingleSpline.IsValid())
+		if (!IDToIntersectionGenerator.Contains(IntersectionIndex))
 		{
-			continue;
+			DependencyTracker.RemoveIntersection(IntersectionIndex);
+		}
+	}
+	//移除的道路和变化的交汇路口交给街区阶段，重建被取消时也不会丢失
+	PendingBlockEdit.Roads.Append(DirtySet.Roads);
+	PendingBlockEdit.Intersections.Append(DirtySet.Intersections);
+	//2.道路按样条整体切分，只处理受影响的样条
+	uint32 RoadCounter = IDToRoadGenerator.Num();
+	TArray<TWeakObjectPtr<USplineComponent>> DirtySplinesToSplit;
+	for (const TWeakObjectPtr<USplineComponent>& DirtySpline : DirtySet.Splines)
+	{
+		if (DirtySpline.IsValid() && RoadSplines.Contains(DirtySpline))
+		{
+			DirtySplinesToSplit.Emplace(DirtySpline);
+		}
+	}
+	TArray<TWeakObjectPtr<URoadMeshGenerator>> NewRoads;
+	bool bFinished = GenerateRoadsOnSplines(DirtySplinesToSplit, Progress, RoadCounter, NewRoads);
+	//3.只为新道路生成Mesh
+	bFinished = bFinished && CommitMeshesInBatches(NewRoads, Progress,
+	                                               LOCTEXT("CommitDirtyRoadMeshes", "Building Road Meshes"));
+	if (!bFinished)
+	{
+		//PendingRoadEdit保留，下次调用时脏样条上的道路重新生成
+		for (const TWeakObjectPtr<URoadMeshGenerator>& NewRoad : NewRoads)
+		{
+			if (NewRoad.IsValid())
+			{
+				DestroyRoadActor(NewRoad->GetGlobalIndex());
+			}
+		}
+		NotifyGenerationCancelled(TEXT("Generate Roads"));
+		return;
+	}
+	for (const TWeakObjectPtr<URoadMeshGenerator>& NewRoad : NewRoads)
+	{
+		if (NewRoad.IsValid())
+		{
+			PendingBlockEdit.Roads.Emplace(NewRoad->GetGlobalIndex());
+		}
+	}
+	PendingRoadEdit.Reset();
+	UpdateCityTilesIfEnabled();
+	UE_LOG(LogTemp, Display,
+	       TEXT("Dirty Road Update:%d Splines,%d Intersections,%d Roads Removed,%d Rebuilt,%d Skipped,Cost %f ms"),
+	       DirtySet.Splines.Num(), DirtySet.Intersections.Num(), RemovedRoadNum, NewRoads.Num(),
+	       RoadNumBefore - RemovedRoadNum, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool URoadGeneratorSubsystem::DestroyRoadActor(int32 RoadIndex)
+{
+	int32 FromIntersection = INT32_ERROR;
+	int32 ToIntersection = INT32_ERROR;
+	if (!DependencyTracker.GetRoadEnds(RoadIndex, FromIntersection, ToIntersection))
+	{
+		return false;
+	}
+	if (nullptr != RoadGraph)
+	{
+		RoadGraph->RemoveEdge(FromIntersection, ToIntersection, RoadIndex);
+		RoadGraph->RemoveEdge(ToIntersection, FromIntersection, RoadIndex);
+	}
+	DependencyTracker.RemoveRoad(RoadIndex);
+	TWeakObjectPtr<URoadMeshGenerator> RoadGenerator;
+	if (IDToRoadGenerator.RemoveAndCopyValue(RoadIndex, RoadGenerator) && RoadGenerator.IsValid())
+	{
+		if (AActor* RoadActor = RoadGenerator->GetOwner())
+		{
+			RoadActor->Destroy();
 		}
-		//找到所有Segment，然后从其中移除被交叉路口占用的
+	}
+	return true;
+}
 
-		//Spline上的全部Segments
-		TArray<FSplinePolyLineSegment> AllSegmentOnSpline;
-		TMap<uint32, FSplinePolyLineSegment> IndexToAllSegments;
-		//在这里获得的值是有序的
-		TArray<uint32> AllSegmentsIndex;
-		//IndexToAllSegments.Reserve(AllSegmentOnSpline.Num());
-		if (SplineSegmentsInfo.Contains(SingleSpline))
+/**
+ * 由已生成的交汇路口Generator构建CityModel中的路口，只在游戏线程调用
+ * @param InIntersectionGenerators 经过目标样条的交汇路口
+ * @param InSourceSplines 与模型样条一一对应的源样条
+ * @param InSplineIDs 源样条到模型样条ID，不在其中的样条入口为INDEX_NONE
+ * @param OutModel 追加路口，ID为追加顺序
+ * @param OutIntersectionGlobalIndexes 模型路口ID到Generator GlobalIndex
+ */
+static void AddCityModelIntersections(const TArray<TWeakObjectPtr<UIntersectionMeshGenerator>>& InIntersectionGenerators,
+                                      const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines,
+                                      const TMap<TWeakObjectPtr<USplineComponent>, int32>& InSplineIDs,
+                                      FCityModel& OutModel, TArray<int32>& OutIntersectionGlobalIndexes)
+{
+	for (const TWeakObjectPtr<UIntersectionMeshGenerator>& IntersectionGenerator : InIntersectionGenerators)
+	{
+		if (!IntersectionGenerator.IsValid() || nullptr == IntersectionGenerator->GetOwner())
+		{
+			continue;
+		}
+		UIntersectionMeshGenerator* Generator = IntersectionGenerator.Get();
+		FCityModelIntersection& Intersection = OutModel.Intersections.AddDefaulted_GetRef();
+		Intersection.ID = OutModel.Intersections.Num() - 1;
+		Intersection.Location = Generator->GetOwner()->GetActorLocation();
+		Intersection.OccupiedBox = Generator->GetOccupiedBox();
+		OutIntersectionGlobalIndexes.Emplace(Generator->GetGlobalIndex());
+		//入口顺序即EntryLocalIndex，衔接点由Generator生成Mesh时计算
+		const TArray<FIntersectionSegment> SegmentsData = Generator->GetIntersectionSegmentsData();
+		Intersection.Entries.SetNum(SegmentsData.Num());
+		for (int32 i = 0; i < SegmentsData.Num(); ++i)
 		{
-			AllSegmentOnSpline = SplineSegmentsInfo[SingleSpline];
-			IndexToAllSegments.Reserve(AllSegmentOnSpline.Num());
-			AllSegmentsIndex.Reserve(AllSegmentOnSpline.Num());
-			for (const auto& Segment : AllSegmentOnSpline)
+			FCityModelEntry& Entry = Intersection.Entries[i];
+			const int32* SplineID = InSplineIDs.Find(SegmentsData[i].OwnerSpline);
+			Entry.SplineID = nullptr != SplineID ? *SplineID : INDEX_NONE;
+			Entry.EndPoint = SegmentsData[i].IntersectionEndPointWS;
+			Entry.EndRotation = SegmentsData[i].IntersectionEndRotWS;
+			Entry.bIsFlowIn = SegmentsData[i].bIsFlowIn;
+			Entry.RoadWidth = SegmentsData[i].RoadWidth;
+			if (INDEX_NONE != Entry.SplineID)
 			{
-				IndexToAllSegments.Emplace(Segment.GetGlobalIndex(), Segment);
-				AllSegmentsIndex.Emplace(Segment.GetGlobalIndex());
+				Intersection.SplineIDs.AddUnique(Entry.SplineID);
 			}
 		}
-		//取交汇路口占用的，同时把交接路口取出来
-		//记录交汇路口占据的Segment编号
-		TArray<uint32> OccupiedSegmentsIndex;
-		//记录交汇路口和道路的连接点信息
-		TArray<FIntersectionSegment> RoadIntersectionConnectionInfo;
-		if (IntersectionCompOnSpline.Contains(SingleSpline))
+		for (const int32 SplineID : Intersection.SplineIDs)
 		{
-			TSet<TWeakObjectPtr<UIntersectionMeshGenerator>> IntersectionGensOnSpline =
-				IntersectionCompOnSpline[SingleSpline];
-			for (const TWeakObjectPtr<UIntersectionMeshGenerator>& MeshGenerator : IntersectionGensOnSpline)
+			for (const FIntersectionSegment& Connection : Generator->GetRoadConnectionPoint(InSourceSplines[SplineID]))
 			{
-				if (!MeshGenerator.IsValid()) { continue; }
-				UIntersectionMeshGenerator* MeshGeneratorPtr = MeshGenerator.Pin().Get();
-				TArray<FSplinePolyLineSegment> PotentialIntersections;
-				SplineQuadTree.GetElements(MeshGeneratorPtr->GetOccupiedBox(), PotentialIntersections);
-				for (const FSplinePolyLineSegment& PolyLineSegment : PotentialIntersections)
+				if (Intersection.Entries.IsValidIndex(Connection.EntryLocalIndex))
 				{
-					if (SingleSpline == PolyLineSegment.OwnerSpline)
-					{
-						OccupiedSegmentsIndex.Emplace(PolyLineSegment.GetGlobalIndex());
-					}
+					Intersection.Entries[Connection.EntryLocalIndex].ConnectionPoint = Connection.IntersectionEndPointWS;
 				}
-				//所在样条上**所有**的交叉坐标
-				RoadIntersectionConnectionInfo.Append(MeshGeneratorPtr->GetRoadConnectionPoint(SingleSpline));
 			}
 		}
-		//切分出的连续分段Segment组
-		TArray<TArray<uint32>> ContinuousSegmentsGroups;
-		//去除被占用的，获取连续的Segments数据,均使用GlobalID作为区分
-		if (!OccupiedSegmentsIndex.IsEmpty())
+	}
+}
+
+/**
+ * 将CityModel中的道路转换为FRoadSpawnPlan，路口ID换回Generator GlobalIndex，未生成的路口视为无衔接
+ * @param InRoad 模型中的道路
+ * @param InSourceSplines 与模型样条一一对应的源样条
+ * @param InIntersectionGlobalIndexes 模型路口ID到Generator GlobalIndex
+ * @return 道路生成计划
+ */
+static FRoadSpawnPlan MakeRoadSpawnPlan(const FCityModelRoad& InRoad,
+                                        const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines,
+                                        const TArray<int32>& InIntersectionGlobalIndexes)
+{
+	auto ToGlobalIndex = [&InIntersectionGlobalIndexes](int32 IntersectionID)-> int32
+	{
+		return InIntersectionGlobalIndexes.IsValidIndex(IntersectionID)
+			       ? InIntersectionGlobalIndexes[IntersectionID]
+			       : INT32_ERROR;
+	};
+	FRoadSpawnPlan Plan;
+	Plan.Spline = InSourceSplines[InRoad.SplineID];
+	Plan.RoadInfo = InRoad.RoadInfo;
+	Plan.RoadInfo.FromIntersectionIndex = ToGlobalIndex(InRoad.RoadInfo.FromIntersectionIndex);
+	Plan.RoadInfo.ToIntersectionIndex = ToGlobalIndex(InRoad.RoadInfo.ToIntersectionIndex);
+	Plan.StartTransform = InRoad.RoadInfo.ContinuousSegmentsTrans[0];
+	for (int32 k = 0; k < 2; ++k)
+	{
+		Plan.ConnectedIntersections[k] = ToGlobalIndex(InRoad.ConnectedIntersections[k]);
+		Plan.EntryIndexOfIntersections[k] = Plan.ConnectedIntersections[k] != INT32_ERROR
+			                                    ? InRoad.EntryIndexOfIntersections[k]
+			                                    : INT32_ERROR;
+	}
+	return Plan;
+}
+
+bool URoadGeneratorSubsystem::GenerateRoadsOnSplines(const TArray<TWeakObjectPtr<USplineComponent>>& InSplines,
+                                                     FRoadGenerationProgress& Progress, uint32& RoadCounter,
+                                                     TArray<TWeakObjectPtr<URoadMeshGenerator>>& OutNewRoads)
+{
+	//1.游戏线程复制样条、SegmentStore和经过这些样条的交汇路口，构建CityModel
+	FCityModel Model;
+	TArray<TWeakObjectPtr<USplineComponent>> SourceSplines;
+	TMap<TWeakObjectPtr<USplineComponent>, int32> SplineIDs;
+	for (const TWeakObjectPtr<USplineComponent>& SingleSpline : InSplines)
+	{
+		if (SingleSpline.IsValid() && !SplineIDs.Contains(SingleSpline))
 		{
-			ContinuousSegmentsGroups = GetContinuousIndexSeries(AllSegmentsIndex, OccupiedSegmentsIndex);
+			const int32 SplineID = Model.AddSpline(FCityModelSpline(FSplineSnapshot::Capture(SingleSpline.Get())));
+			SplineIDs.Emplace(SingleSpline, SplineID);
+			SourceSplines.Emplace(SingleSpline);
 		}
+	}
+	Model.Segments = SegmentStore;
+	Model.SegmentBVH = SegmentBVH;
+	Model.StoreSplineToSplineID.Init(INDEX_NONE, SegmentStore.GetSplineNum());
+	TSet<TWeakObjectPtr<UIntersectionMeshGenerator>> IntersectionGenerators;
+	for (FCityModelSpline& Spline : Model.Splines)
+	{
+		Spline.SegmentSplineId = SegmentStore.FindSplineId(SourceSplines[Spline.ID]);
+		if (INDEX_NONE != Spline.SegmentSplineId)
+		{
+			Model.StoreSplineToSplineID[Spline.SegmentSplineId] = Spline.ID;
+		}
+		if (const TSet<TWeakObjectPtr<UIntersectionMeshGenerator>>* IntersectionGensOnSpline =
+			IntersectionCompOnSpline.Find(SourceSplines[Spline.ID]))
+		{
+			IntersectionGenerators.Append(*IntersectionGensOnSpline);
+		}
+	}
+	TArray<int32> IntersectionGlobalIndexes;
+	AddCityModelIntersections(IntersectionGenerators.Array(), SourceSplines, SplineIDs, Model,
+	                          IntersectionGlobalIndexes);
+	//2.后台按样条并行切分，只访问CityModel
+	const FCityModelBuilder Builder(MakeBuildSettings());
+	const UE::Tasks::FTask SplitTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Builder, &Model]()
+	{
+		Builder.SplitRoads(Model);
+	});
+	if (!Progress.Wait(SplitTask, 1.0f, LOCTEXT("SplitRoads", "Splitting Roads By Intersections")))
+	{
+		return false;
+	}
+	//部分路口外部无衔接道路
+	if (bEnableVisualDebug.GetValueOnGameThread())
+	{
+		for (const FVector& UnconnectedPoint : Model.UnconnectedPoints)
+		{
+			DrawDebugBox(UEditorComponentUtilities::GetEditorContext()->GetWorld(), UnconnectedPoint,
+			             FVector(10.0f), FColor::Red, true, -1, 0, 5.0f);
+		}
+	}
+	//3.按道路ID（即样条顺序）分批生成道路Actor，图中边的加入顺序与串行一致，返回时统一注册Component
+	FEditorSpawnBatch SpawnBatch(TEXT("Spawn Roads"));
+	return Progress.ForEachBatch(
+		Model.Roads.Num(), CVarSpawnBatchSize.GetValueOnGameThread(), 1.0f,
+		LOCTEXT("SpawnRoads", "Spawning Road Actors"), [&](int32 BeginIndex, int32 EndIndex)
+		{
+			for (int32 i = BeginIndex; i < EndIndex; ++i)
+			{
+				OutNewRoads.Emplace(SpawnRoadActor(
+					MakeRoadSpawnPlan(Model.Roads[i], SourceSplines, IntersectionGlobalIndexes), RoadCounter));
+				RoadCounter++;
+			}
+		});
+}
+
+URoadMeshGenerator* URoadGeneratorSubsystem::SpawnRoadActor(const FRoadSpawnPlan& InPlan, uint32 RoadCounter)
+{
+	const TWeakObjectPtr<USplineComponent>& SingleSpline = InPlan.Spline;
+	const FTransform& StartTransform = InPlan.StartTransform;
+	const int32* ConnectedIntersections = InPlan.ConnectedIntersections;
+	const int32* EntryIndexOfIntersections = InPlan.EntryIndexOfIntersections;
+	//两端路口复用后GlobalIndex不变，样条和两端相同的道路复用已有Actor
+	const uint32 TopologyKey = MakeRoadTopologyKey(SingleSpline, ConnectedIntersections[0],
+	                                               ConnectedIntersections[1]);
+	URoadMeshGenerator* GeneratorComp = RoadActorPool.Take(TopologyKey, StartTransform.GetLocation());
+	AActor* RoadActor = nullptr;
+	if (nullptr != GeneratorComp)
+	{
+		ModifyReusedActor(GeneratorComp);
+		RoadActor = GeneratorComp->GetOwner();
+		RoadActor->SetActorTransform(StartTransform);
+		GeneratorComp->ResetForRegenerate();
+	}
+	else
+	{
+		FString ActorLabel = FString::Printf(TEXT("RoadActor%d"), RoadCounter);
+		RoadActor = UEditorComponentUtilities::SpawnEmptyActor(ActorLabel, StartTransform);
+		ensureAlways(nullptr!=RoadActor);
+
+		UActorComponent* MeshCompTemp = UEditorComponentUtilities::AddComponentInEditor(
+			RoadActor, UDynamicMeshComponent::StaticClass());
+		UDynamicMeshComponent* MeshComp = Cast<UDynamicMeshComponent>(MeshCompTemp);
+		UActorComponent* GeneratorCompTemp = UEditorComponentUtilities::AddComponentInEditor(
+			RoadActor, URoadMeshGenerator::StaticClass());
+		GeneratorComp = Cast<URoadMeshGenerator>(GeneratorCompTemp);
+		GeneratorComp->SetMeshComponent(MeshComp);
+	}
+	GeneratorComp->SetTopologyKey(TopologyKey);
+	GeneratorComp->SetReferenceSpline(SingleSpline);
+	GeneratorComp->SetRoadInfo(InPlan.RoadInfo);
+	IDToRoadGenerator.Emplace(GeneratorComp->GetGlobalIndex(), GeneratorComp);
+	DependencyTracker.AddRoad(GeneratorComp->GetGlobalIndex(), SingleSpline, ConnectedIntersections[0],
+	                          ConnectedIntersections[1]);
+
+	if (true == AddTextRender.GetValueOnGameThread())
+	{
+		AddDebugTextRender(RoadActor, FColor::Yellow,
+		                   FString::Printf(TEXT("RI:%d"), GeneratorComp->GetGlobalIndex()));
+	}
+	//把对道路和附属节点加入图
+	if (nullptr != RoadGraph)
+	{
+		/*RoadGraph->AddUndirectedEdge(ConnectedIntersections[0], ConnectedIntersections[1],
+		                             GeneratorComp->GetGlobalIndex());*/
+		RoadGraph->AddEdgeInGivenSlot(ConnectedIntersections[0], ConnectedIntersections[1],
+		                              GeneratorComp->GetGlobalIndex(), EntryIndexOfIntersections[0]);
+		RoadGraph->AddEdgeInGivenSlot(ConnectedIntersections[1], ConnectedIntersections[0],
+		                              GeneratorComp->GetGlobalIndex(), EntryIndexOfIntersections[1]);
+	}
+	return GeneratorComp;
+}
+
+TArray<TArray<uint32>> URoadGeneratorSubsystem::GetContinuousIndexSeries(const TArray<uint32>& AllSegmentIndex,
+                                                                         TArray<uint32>& BreakPoints)
+{
+	TArray<TArray<uint32>> Results;
+	if (BreakPoints.IsEmpty())
+	{
+		Results.Emplace(AllSegmentIndex);
+		return Results;
+	}
+	//连续数组问题使用滑动窗口处理，但因为不需要长度数据，可以直接用单指针模拟窗口
+	TArray<uint32> IndexSeries;
+	//int32 LeftIndex = 0;
+	int32 RightIndex = 0;
+	BreakPoints.Sort();
+	int32 BreakpointIndex = 0;
+	int32 ValidBreakPoints = BreakPoints.Num();
+	//对齐数据
+	while (ValidBreakPoints > 0 && BreakPoints[BreakpointIndex] < AllSegmentIndex[0])
+	{
+		BreakpointIndex++;
+		ValidBreakPoints--;
+	}
+	int32 BreakpointIndexLast = BreakPoints.Num() - 1;
+	while (ValidBreakPoints > 0 && BreakPoints[BreakpointIndexLast] > AllSegmentIndex.Last(0))
+	{
+		BreakpointIndexLast--;
+		ValidBreakPoints--;
+	}
+	if (ValidBreakPoints <= 0)
+	{
+		Results.Emplace(AllSegmentIndex);
+		return Results;
+	}
+	while (RightIndex < AllSegmentIndex.Num())
+	{
+		//没遇到BreakPionts中的值是扩张
+		if (AllSegmentIndex[RightIndex] != BreakPoints[BreakpointIndex])
+		{
+			IndexSeries.Emplace(AllSegmentIndex[RightIndex]);
+			RightIndex++;
+		}
+		//遇到BreakPoints时更新结果并收缩
 		else
 		{
-			ContinuousSegmentsGroups.Emplace(AllSegmentsIndex);
+			if (IndexSeries.Num() > 0)
+			{
+				Results.Emplace(IndexSeries);
+			}
+			IndexSeries.Reset();
+			//这里使用两个数组单调且元素不重复特性
+			while (RightIndex < AllSegmentIndex.Num() &&
+				BreakpointIndex < BreakPoints.Num() && AllSegmentIndex[RightIndex] == BreakPoints[BreakpointIndex])
+			{
+				BreakpointIndex++;
+				RightIndex++;
+			}
+			//两个都走到头了
+			if (BreakpointIndex == BreakPoints.Num() && RightIndex == AllSegmentIndex.Num())
+			{
+				break;
+			}
+			// BreakPoint是Allsegment子集，不存在BreakpointIndex没到头但是RightIndex到头的情况
+			if (BreakpointIndex == BreakPoints.Num() && RightIndex < AllSegmentIndex.Num())
+			{
+				//RightIndex++;
+				//没有发现截取子数组的函数，使用FMemory::Memcpy()
+				IndexSeries.SetNum(AllSegmentIndex.Num() - RightIndex);
+				FMemory::Memcpy(IndexSeries.GetData(),
+				                AllSegmentIndex.GetData() + RightIndex,
+				                (AllSegmentIndex.Num() - RightIndex) * sizeof(uint32));
+				break;
+			}
+			//此时回归正常情况两者指向数字不同，收缩窗口
+			//Left=Right
+		}
+	}
+	//把最后一组数字放进去
+	if (!IndexSeries.IsEmpty())
+	{
+		Results.Emplace(IndexSeries);
+	}
+	return Results;
+}
+
+TArray<FTransform> URoadGeneratorSubsystem::ResampleSpline(const FSplineSnapshot& TargetSpline)
+{
+	const ERoadResampleMode Mode = CVarResampleMode.GetValueOnAnyThread() == 1
+		                               ? ERoadResampleMode::Adaptive
+		                               : ERoadResampleMode::Fixed;
+	return ResampleSpline(TargetSpline, Mode);
+}
+
+TArray<FTransform> URoadGeneratorSubsystem::ResampleSpline(const USplineComponent* TargetSpline,
+                                                           ERoadResampleMode InMode)
+{
+	return ResampleSpline(FSplineSnapshot::Capture(TargetSpline), InMode);
+}
+
+TArray<FTransform> URoadGeneratorSubsystem::ResampleSpline(const FSplineSnapshot& TargetSpline,
+                                                           ERoadResampleMode InMode)
+{
+	TArray<FTransform> Results;
+	FCityModelBuildSettings Settings = MakeBuildSettings();
+	Settings.bAdaptiveResample = InMode == ERoadResampleMode::Adaptive;
+	FCityModelBuilder(Settings).ResampleSpline(TargetSpline, Results);
+	return Results;
+}
+
+#pragma endregion GenerateRoad
+
+void URoadGeneratorSubsystem::AddDebugTextRender(AActor* TargetActor, const FColor& TextColor, const FString& Text)
+{
+	//复用的Actor上已有TextRender
+	UTextRenderComponent* IndexTexRender = TargetActor->FindComponentByClass<UTextRenderComponent>();
+	if (nullptr == IndexTexRender)
+	{
+		UActorComponent* IndexTexRenderTemp = UEditorComponentUtilities::AddComponentInEditor(
+			TargetActor, UTextRenderComponent::StaticClass());
+		IndexTexRender = Cast<UTextRenderComponent>(IndexTexRenderTemp);
+	}
+	IndexTexRender->SetRelativeRotation(FRotator(90.0, 0.0, 0.0));
+	IndexTexRender->SetRelativeLocation(FVector(0.0, 0.0, 50.0));
+	IndexTexRender->SetText(FText::FromString(Text));
+	IndexTexRender->SetTextRenderColor(TextColor);
+	IndexTexRender->SetWorldSize(800.0);
+	IndexTexRender->SetHorizontalAlignment(EHorizTextAligment::EHTA_Center);
+	IndexTexRender->SetVerticalAlignment(EVerticalTextAligment::EVRTA_TextCenter);
+}
+
+
+void URoadGeneratorSubsystem::PrintGraphConnection()
+{
+	if (nullptr != RoadGraph)
+	{
+		RoadGraph->PrintConnectionToLog();
+	}
+}
+
+TArray<TWeakObjectPtr<UIntersectionMeshGenerator>> URoadGeneratorSubsystem::GetIntersectionGenerators() const
+{
+	TArray<TWeakObjectPtr<UIntersectionMeshGenerator>> Results;
+	IDToIntersectionGenerator.GenerateValueArray(Results);
+	return Results;
+}
+
+TArray<TWeakObjectPtr<URoadMeshGenerator>> URoadGeneratorSubsystem::GetRoadGenerators() const
+{
+	TArray<TWeakObjectPtr<URoadMeshGenerator>> Results;
+	IDToRoadGenerator.GenerateValueArray(Results);
+	return Results;
+}
+
+TArray<TWeakObjectPtr<UBlockMeshGenerator>> URoadGeneratorSubsystem::GetBlockGenerators() const
+{
+	TArray<TWeakObjectPtr<UBlockMeshGenerator>> Results;
+	IDToBlockGenerator.GenerateValueArray(Results);
+	return Results;
+}
+
+#pragma region GenerateFromCityModel
+void URoadGeneratorSubsystem::GenerateFromCityModel()
+{
+	FCityModel Model;
+	TArray<TWeakObjectPtr<USplineComponent>> SourceSplines;
+	if (!CaptureCityModel(Model, SourceSplines))
+	{
+		return;
+	}
+	FRoadGenerationProgress Progress(5.0f, LOCTEXT("GenerateFromCityModel", "Generating City From City Model"));
+	const FCityModelBuilder Builder(MakeBuildSettings());
+	//后台只访问CityModel，街区由GenerateCityBlock从生成后的Mesh边线提取，这里不调用FindBlocks
+	bool bHasIntersections = false;
+	const UE::Tasks::FTask BuildTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&]()
+	{
+		bHasIntersections = Builder.ResampleSplines(Model) && Builder.FindIntersections(Model);
+		if (bHasIntersections)
+		{
+			Builder.SplitRoads(Model);
+			Builder.BuildGraph(Model);
+		}
+	});
+	if (!Progress.Wait(BuildTask, 1.0f, LOCTEXT("BuildCityModel", "Building City Model")))
+	{
+		NotifyGenerationCancelled(TEXT("Generate From City Model"));
+		return;
+	}
+	if (!bHasIntersections)
+	{
+		UNotifyUtilities::ShowPopupMsgAtCorner("Error:Find Null Intersections");
+		return;
+	}
+	if (!MaterializeCityModel(Model, SourceSplines, Progress))
+	{
+		NotifyGenerationCancelled(TEXT("Generate From City Model"));
+		return;
+	}
+	GenerateCityBlock();
+	//街区阶段失败时道路和路口仍需要合并到瓦片，成功时这里没有脏瓦片
+	UpdateCityTilesIfEnabled();
+}
+
+bool URoadGeneratorSubsystem::CaptureCityModel(FCityModel& OutModel,
+                                               TArray<TWeakObjectPtr<USplineComponent>>& OutSourceSplines)
+{
+	OutModel.Reset();
+	OutSourceSplines.Reset();
+	UCityGeneratorSubSystem* DataSubsystem = GEditor->GetEditorSubsystem<UCityGeneratorSubSystem>();
+	if (!DataSubsystem)
+	{
+		UNotifyUtilities::ShowPopupMsgAtCorner("Error::Find Null UCityGeneratorSubSystem");
+		return false;
+	}
+	for (const TWeakObjectPtr<USplineComponent>& SourceSpline : DataSubsystem->GetSplines())
+	{
+		if (!SourceSpline.IsValid())
+		{
+			continue;
 		}
+		OutModel.AddSpline(FCityModelSpline(FSplineSnapshot::Capture(SourceSpline.Get())));
+		OutSourceSplines.Emplace(SourceSpline);
+	}
+	if (OutSourceSplines.IsEmpty())
+	{
+		UNotifyUtilities::ShowPopupMsgAtCorner("Error::Find Null Spline");
+		return false;
+	}
+	return true;
+}
 
-		//2.判断十字路口端点位于哪个Segment、将其作为附加信息与连续Segments封装到FConnectionInsertInfo结构体
-		//对应ContinuousSegmentsGroup的二维序号和是否为前缀
-		TMultiMap<int32, FConnectionInsertInfo> SegmentGroupToConnectionToHead;
-		USplineComponent* TargetSplinePtr = SingleSpline.Pin().Get();
-		for (const FIntersectionSegment& IntersectionSegment : RoadIntersectionConnectionInfo)
+bool URoadGeneratorSubsystem::MaterializeCityModel(const FCityModel& InModel,
+                                                   const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines,
+                                                   FRoadGenerationProgress& Progress)
+{
+	//全部重建，与GenerateIntersections相同只重置记录，SegmentStore和原始交点与模型一致，之后可以增量更新
+	ApplyCityModelSegments(InModel, InSourceSplines);
+	MoveGeneratorsToPool(IDToIntersectionGenerator, IntersectionActorPool);
+	MoveGeneratorsToPool(IDToRoadGenerator, RoadActorPool);
+	IntersectionCompOnSpline.Reset();
+	DependencyTracker.Reset();
+	PendingRoadEdit.Reset();
+	PendingBlockEdit.Reset();
+	if (nullptr != RoadGraph)
+	{
+		RoadGraph->RemoveAllEdges();
+	}
+	bIntersectionsGenerated = false;
+	bRoadsGenerated = false;
+	bBlocksGenerated = false;
+
+	//模型中的路口ID到Generator GlobalIndex
+	TArray<int32> IntersectionGlobalIndexes;
+	bool bFinished = SpawnCityModelIntersections(InModel, InSourceSplines, Progress, IntersectionGlobalIndexes);
+	bFinished = bFinished && CommitMeshesInBatches(CachedIntersectionGenerators, Progress,
+	                                               LOCTEXT("CommitIntersectionMeshes", "Building Intersection Meshes"));
+
+	TArray<TWeakObjectPtr<URoadMeshGenerator>> NewRoads;
+	NewRoads.Reserve(InModel.Roads.Num());
+	TOptional<FEditorSpawnBatch> SpawnBatch(InPlace, TEXT("Spawn Roads"));
+	bFinished = bFinished && Progress.ForEachBatch(
+		InModel.Roads.Num(), CVarSpawnBatchSize.GetValueOnGameThread(), 1.0f,
+		LOCTEXT("SpawnRoads", "Spawning Road Actors"), [&](int32 BeginIndex, int32 EndIndex)
 		{
-			FBox2D BoxOfConnection(ForceInit);
-			BoxOfConnection += FVector2D(IntersectionSegment.IntersectionEndPointWS);
-			//这个值比较重要，太小可能搜不到相邻节点，太大要筛选的量过多
-			BoxOfConnection = BoxOfConnection.ExpandBy(50.0f);
-			TArray<FSplinePolyLineSegment> PotentialConnection;
-			SplineQuadTree.GetElements(BoxOfConnection, PotentialConnection);
-			//部分路口外部无衔接道路
-			if (PotentialConnection.IsEmpty())
+			for (int32 i = BeginIndex; i < EndIndex; ++i)
+			{
+				const FCityModelRoad& Road = InModel.Roads[i];
+				NewRoads.Emplace(SpawnRoadActor(MakeRoadSpawnPlan(Road, InSourceSplines, IntersectionGlobalIndexes),
+				                                Road.ID));
+			}
+		});
+	SpawnBatch.Reset();
+	bFinished = bFinished && CommitMeshesInBatches(NewRoads, Progress,
+	                                               LOCTEXT("CommitRoadMeshes", "Building Road Meshes"));
+	if (!bFinished)
+	{
+		RestorePooledGeneratorsOnCancel(NewRoads, RoadActorPool, IDToRoadGenerator,
+		                                [this](const TWeakObjectPtr<URoadMeshGenerator>& NewRoad)
+		                                {
+			                                DestroyRoadActor(NewRoad->GetGlobalIndex());
+		                                });
+		RestorePooledGeneratorsOnCancel(CachedIntersectionGenerators, IntersectionActorPool,
+		                                IDToIntersectionGenerator,
+		                                [this](const TWeakObjectPtr<UIntersectionMeshGenerator>& NewIntersection)
+		                                {
+			                                DestroyIntersectionActor(NewIntersection);
+		                                });
+		CachedIntersectionGenerators.Reset();
+		CachedIntersections.Reset();
+		DependencyTracker.Reset();
+		return false;
+	}
+	DestroyUnusedPooledActors(IntersectionActorPool, TEXT("Intersections"));
+	DestroyUnusedPooledActors(RoadActorPool, TEXT("Roads"));
+	bIntersectionsGenerated = true;
+	bRoadsGenerated = true;
+	return true;
+}
+#pragma endregion GenerateFromCityModel
+
+#pragma region CityTile
+/**
+ * 瓦片来源键，高32位为来源类型，低32位为GlobalIndex
+ */
+static uint64 MakeCityTileSourceKey(ECityTileSourceType InSourceType, int32 InGlobalIndex)
+{
+	return (static_cast<uint64>(InSourceType) << 32) | static_cast<uint32>(InGlobalIndex);
+}
+
+void URoadGeneratorSubsystem::BuildCityTiles()
+{
+	UpdateCityTiles(true);
+}
+
+void URoadGeneratorSubsystem::ClearCityTiles()
+{
+	for (const TPair<FIntPoint, FCityTile>& TilePair : CityTiles)
+	{
+		if (TilePair.Value.Component.IsValid() && nullptr != TilePair.Value.Component->GetOwner())
+		{
+			TilePair.Value.Component->GetOwner()->Destroy();
+		}
+	}
+	CityTiles.Empty();
+	CityTileSources.Empty();
+	auto ShowSourceMeshes = [](const auto& IDToGenerator)
+	{
+		for (const auto& GeneratorPair : IDToGenerator)
+		{
+			if (GeneratorPair.Value.IsValid() && nullptr != GeneratorPair.Value->GetMeshComponent())
+			{
+				GeneratorPair.Value->GetMeshComponent()->SetVisibility(true);
+			}
+		}
+	};
+	ShowSourceMeshes(IDToIntersectionGenerator);
+	ShowSourceMeshes(IDToRoadGenerator);
+	ShowSourceMeshes(IDToBlockGenerator);
+}
+
+const FCityTileTriangleRange* URoadGeneratorSubsystem::FindCityTileSource(
+	const UDynamicMeshComponent* InTileComponent, int32 TriangleID) const
+{
+	if (nullptr == InTileComponent)
+	{
+		return nullptr;
+	}
+	for (const TPair<FIntPoint, FCityTile>& TilePair : CityTiles)
+	{
+		if (TilePair.Value.Component.Get() == InTileComponent)
+		{
+			return FCityTileMesh::FindRangeByTriangle(TilePair.Value.TriangleRanges, TriangleID);
+		}
+	}
+	return nullptr;
+}
+
+void URoadGeneratorSubsystem::UpdateCityTilesIfEnabled()
+{
+	if (CVarTileBatching.GetValueOnGameThread())
+	{
+		UpdateCityTiles(false);
+	}
+	//关闭合批后销毁已有瓦片并恢复源Mesh显示
+	else if (!CityTiles.IsEmpty())
+	{
+		ClearCityTiles();
+	}
+}
+
+void URoadGeneratorSubsystem::UpdateCityTiles(bool bForceRebuildAll)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::UpdateCityTiles);
+	const double StartTime = FPlatformTime::Seconds();
+	const double TileSize = FMath::Max(100.0, static_cast<double>(CVarTileSize.GetValueOnGameThread()));
+	if (!FMath::IsNearlyEqual(TileSize, CityTileSize))
+	{
+		bForceRebuildAll = true;
+		CityTileSize = TileSize;
+	}
+	struct FTileSource
+	{
+		ECityTileSourceType SourceType;
+		int32 SourceIndex;
+		UDynamicMeshComponent* MeshComponent;
+	};
+	//1.按Owner位置把来源分到瓦片，和上次记录比较得到脏瓦片
+	TMap<FIntPoint, TArray<FTileSource>> SourcesOnTile;
+	TMap<uint64, FCityTileSourceRecord> NewSourceRecords;
+	TSet<FIntPoint> DirtyTiles;
+	auto CollectSources = [&](ECityTileSourceType InSourceType, const auto& IDToGenerator)
+	{
+		for (const auto& GeneratorPair : IDToGenerator)
+		{
+			const auto* Generator = GeneratorPair.Value.Get();
+			if (nullptr == Generator || nullptr == Generator->GetOwner() || nullptr == Generator->GetMeshComponent())
 			{
-				if (bEnableVisualDebug.GetValueOnGameThread())
-				{
-					DrawDebugBox(UEditorComponentUtilities::GetEditorContext()->GetWorld(),
-					             IntersectionSegment.IntersectionEndPointWS, FVector(10.0f), FColor::Red, true, -1, 0,
-					             5.0f);
-				}
 				continue;
 			}
-			//有多个可能性，根据距离判定究竟属于哪个Segment，放到PotentialConnection[0]
-			if (PotentialConnection.Num() != 1)
+			const FIntPoint TileCoord = FCityTileMesh::GetTileCoord(Generator->GetOwner()->GetActorLocation(),
+			                                                        TileSize);
+			const uint64 SourceKey = MakeCityTileSourceKey(InSourceType, Generator->GetGlobalIndex());
+			const FCityTileSourceRecord* OldRecord = CityTileSources.Find(SourceKey);
+			if (bForceRebuildAll || nullptr == OldRecord || OldRecord->TileCoord != TileCoord ||
+				OldRecord->MeshRevision != Generator->GetMeshRevision())
 			{
-				uint32 OwnerSegmentIndex = 0;
-				float MinDistance = FLT_MAX;
-				for (int i = 0; i < PotentialConnection.Num(); ++i)
+				DirtyTiles.Add(TileCoord);
+				if (nullptr != OldRecord)
 				{
-					FVector SegmentCenter = PotentialConnection[i].StartTransform.GetLocation() + PotentialConnection[i]
-						.EndTransform.GetLocation();
-					float DisCenterToConnection = FVector::DistSquared2D(
-						SegmentCenter, IntersectionSegment.IntersectionEndPointWS);
-					if (DisCenterToConnection < MinDistance)
-					{
-						OwnerSegmentIndex = i;
-					}
-				}
-				if (OwnerSegmentIndex != 0)
-				{
-					PotentialConnection.Swap(0, OwnerSegmentIndex);
+					DirtyTiles.Add(OldRecord->TileCoord);
 				}
 			}
-			//所属Segment保存在0位置
-			FConnectionInsertInfo InsertInfo = FindInsertIndexInExistedContinuousSegments(
-				ContinuousSegmentsGroups, AllSegmentOnSpline,
-				PotentialConnection[0].GetGlobalIndex(), IntersectionSegment.IntersectionEndPointWS);
-			InsertInfo.IntersectionGlobalIndex = IntersectionSegment.OwnerGlobalIndex;
-			//传递顺时针排序给建图用
-			InsertInfo.EntryLocalIndex = IntersectionSegment.EntryLocalIndex;
-			float DisOfConnectionOnSpline = TargetSplinePtr->GetDistanceAlongSplineAtLocation(
-				IntersectionSegment.IntersectionEndPointWS, ESplineCoordinateSpace::World);
-			FTransform ConnectionTransform = TargetSplinePtr->GetTransformAtDistanceAlongSpline(
-				DisOfConnectionOnSpline, ESplineCoordinateSpace::World);
-
-			ConnectionTransform.SetRotation(IntersectionSegment.IntersectionEndRotWS.Quaternion());
-
-			InsertInfo.ConnectionTrans = ConnectionTransform;
-			SegmentGroupToConnectionToHead.Emplace(
-				InsertInfo.GroupIndex, InsertInfo);
-			//不要直接在这里插入（相当于一边遍历一边修改），会破坏上面的算法
-		}
-
-		//如果是闭合曲线把Segments合并
-		if (SingleSpline->IsClosedLoop())
-		{
-			if (ContinuousSegmentsGroups.Num() > 1)
+			NewSourceRecords.Add(SourceKey, {TileCoord, Generator->GetMeshRevision()});
+			SourcesOnTile.FindOrAdd(TileCoord).Add(
+				{InSourceType, Generator->GetGlobalIndex(), Generator->GetMeshComponent()});
+		}
+	};
+	CollectSources(ECityTileSourceType::Intersection, IDToIntersectionGenerator);
+	CollectSources(ECityTileSourceType::Road, IDToRoadGenerator);
+	CollectSources(ECityTileSourceType::Block, IDToBlockGenerator);
+	//已销毁的来源所在瓦片也需要重建
+	for (const TPair<uint64, FCityTileSourceRecord>& OldRecordPair : CityTileSources)
+	{
+		if (!NewSourceRecords.Contains(OldRecordPair.Key))
+		{
+			DirtyTiles.Add(OldRecordPair.Value.TileCoord);
+		}
+	}
+	if (bForceRebuildAll)
+	{
+		for (const TPair<FIntPoint, FCityTile>& TilePair : CityTiles)
+		{
+			DirtyTiles.Add(TilePair.Key);
+		}
+	}
+	CityTileSources = MoveTemp(NewSourceRecords);
+	//2.重新合并脏瓦片，空瓦片销毁，新瓦片Actor在同一事务中生成
+	int32 TriangleNum = 0;
+	FEditorSpawnBatch SpawnBatch(TEXT("Spawn City Tiles"));
+	for (const FIntPoint& TileCoord : DirtyTiles)
+	{
+		const TArray<FTileSource>* TileSources = SourcesOnTile.Find(TileCoord);
+		if (nullptr == TileSources)
+		{
+			FCityTile RemovedTile;
+			if (CityTiles.RemoveAndCopyValue(TileCoord, RemovedTile) && RemovedTile.Component.IsValid() &&
+				nullptr != RemovedTile.Component->GetOwner())
 			{
-				bool bCanMerge = (AllSegmentOnSpline[0].GetGlobalIndex() == ContinuousSegmentsGroups[0][0]);
-				bCanMerge &= (AllSegmentOnSpline.Last(0).GetGlobalIndex() == ContinuousSegmentsGroups.Last(0).Last(0));
-
-				if (bCanMerge)
-				{
-					//合并到第一组，可以避免后续组的去除
-					TArray<uint32> NewFirstGroup;
-					int32 LastGroupLength = ContinuousSegmentsGroups.Last(0).Num();
-					NewFirstGroup.SetNum(ContinuousSegmentsGroups[0].Num() + ContinuousSegmentsGroups.Last(0).Num());
-					FMemory::Memcpy(NewFirstGroup.GetData(), ContinuousSegmentsGroups.Last(0).GetData(),
-					                LastGroupLength * sizeof(uint32));
-					FMemory::Memcpy(NewFirstGroup.GetData() + LastGroupLength,
-					                ContinuousSegmentsGroups[0].GetData(),
-					                ContinuousSegmentsGroups[0].Num() * sizeof(uint32));
-					ContinuousSegmentsGroups[0] = NewFirstGroup;
-					//调整衔接内容,能衔接的情况必然是第一组元素去除尾部或最后一组元素去除头部；因为是把最后一组元素合并到头部，所以只需要移动一组
-					if (SegmentGroupToConnectionToHead.Contains(ContinuousSegmentsGroups.Num() - 1))
-					{
-						TArray<FConnectionInsertInfo> HeadInsertsOfLastGroup;
-						SegmentGroupToConnectionToHead.MultiFind(ContinuousSegmentsGroups.Num() - 1,
-						                                         HeadInsertsOfLastGroup);
-						//插入元素必然在头部，理论上应该只有一个元素
-						for (auto& Insert : HeadInsertsOfLastGroup)
-						{
-							Insert.GroupIndex = 0;
-							SegmentGroupToConnectionToHead.Emplace(0, Insert);
-							ensureAlwaysMsgf(Insert.bConnectToGroupHead==true, TEXT("Error Insert Place,Please Check"));
-						}
-						SegmentGroupToConnectionToHead.Remove(ContinuousSegmentsGroups.Num() - 1);
-					}
-					//移除最后一组
-					ContinuousSegmentsGroups.RemoveAt(ContinuousSegmentsGroups.Num() - 1);
-				}
+				RemovedTile.Component->GetOwner()->Destroy();
 			}
+			continue;
 		}
-
-		//3.创建Actor负载信息
-		for (int32 i = 0; i < ContinuousSegmentsGroups.Num(); ++i)
+		const FTransform TileTransform(FCityTileMesh::GetTileOrigin(TileCoord, TileSize));
+		FCityTile& Tile = CityTiles.FindOrAdd(TileCoord);
+		if (!Tile.Component.IsValid())
 		{
-			TArray<uint32>& ContinuousSegments = ContinuousSegmentsGroups[i];
-			//把所有Segments创建路径
-			TArray<FTransform> RoadSegmentTransforms;
-			FTransform StartTransform = IndexToAllSegments[ContinuousSegments[0]].StartTransform;
-			RoadSegmentTransforms.Emplace(StartTransform);
-			for (int32 j = 0; j < ContinuousSegments.Num(); ++j)
+			AActor* TileActor = UEditorComponentUtilities::SpawnEmptyActor(
+				FString::Printf(TEXT("CityTile_%d_%d"), TileCoord.X, TileCoord.Y), TileTransform);
+			if (nullptr != TileActor)
 			{
-				RoadSegmentTransforms.Emplace(IndexToAllSegments[ContinuousSegments[j]].EndTransform);
+				Tile.Component = Cast<UDynamicMeshComponent>(UEditorComponentUtilities::AddComponentInEditor(
+					TileActor, UDynamicMeshComponent::StaticClass()));
 			}
-			//生成衔接位置信息,用Transform初始化结构体
-			FRoadSegmentsGroup RoadWithConnectInfo(RoadSegmentTransforms);
-			TArray<int32> ConnectedIntersections;
-			ConnectedIntersections.Init(INT32_ERROR, 2);
-			//连接到Intersection的路口序号，用于图邻接表构建
-			TArray<int32> EntryIndexOfIntersections;
-			EntryIndexOfIntersections.Init(INT32_ERROR, 2);
-			if (SegmentGroupToConnectionToHead.Contains(i))
+			if (!Tile.Component.IsValid())
 			{
-				TArray<FConnectionInsertInfo> Connections;
-				SegmentGroupToConnectionToHead.MultiFind(i, Connections);
-				if (!Connections.IsEmpty())
+				//源Mesh保持显示，移除来源记录，下次更新时重试
+				UE_LOG(LogTemp, Error, TEXT("[CityTile]Create City Tile %d_%d Failed"), TileCoord.X, TileCoord.Y);
+				if (nullptr != TileActor)
+				{
+					TileActor->Destroy();
+				}
+				CityTiles.Remove(TileCoord);
+				for (const FTileSource& Source : *TileSources)
 				{
-					for (const auto& Connection : Connections)
-					{
-						if (Connection.bConnectToGroupHead == true)
-						{
-							RoadWithConnectInfo.bHasHeadConnection = true;
-							RoadWithConnectInfo.HeadConnectionTrans = Connection.ConnectionTrans;
-							ConnectedIntersections[0] = Connection.IntersectionGlobalIndex;
-							//给连接信息加负载，用于判断走向
-							RoadWithConnectInfo.FromIntersectionIndex = Connection.IntersectionGlobalIndex;
-							EntryIndexOfIntersections[0] = Connection.EntryLocalIndex;
-						}
-						else
-						{
-							RoadWithConnectInfo.bHasTailConnection = true;
-							RoadWithConnectInfo.TailConnectionTrans = Connection.ConnectionTrans;
-							ConnectedIntersections[1] = Connection.IntersectionGlobalIndex;
-							//给连接信息加负载，用于判断走向
-							RoadWithConnectInfo.ToIntersectionIndex = Connection.IntersectionGlobalIndex;
-							EntryIndexOfIntersections[1] = Connection.EntryLocalIndex;
-						}
-					}
+					CityTileSources.Remove(MakeCityTileSourceKey(Source.SourceType, Source.SourceIndex));
 				}
+				continue;
 			}
-
-			FString ActorLabel = FString::Printf(TEXT("RoadActor%d"), RoadCounter);
-			AActor* RoadActor = UEditorComponentUtilities::SpawnEmptyActor(ActorLabel, StartTransform);
-			ensureAlways(nullptr!=RoadActor);
-
-			UActorComponent* MeshCompTemp = UEditorComponentUtilities::AddComponentInEditor(
-				RoadActor, UDynamicMeshComponent::StaticClass());
-			UDynamicMeshComponent* MeshComp = Cast<UDynamicMeshComponent>(MeshCompTemp);
-			UActorComponent* GeneratorCompTemp = UEditorComponentUtilities::AddComponentInEditor(
-				RoadActor, URoadMeshGenerator::StaticClass());
-			URoadMeshGenerator* GeneratorComp = Cast<URoadMeshGenerator>(GeneratorCompTemp);
-
-			GeneratorComp->SetMeshComponent(MeshComp);
-			GeneratorComp->SetReferenceSpline(SingleSpline);
-			GeneratorComp->SetRoadInfo(RoadWithConnectInfo);
-			IDToRoadGenerator.Emplace(GeneratorComp->GetGlobalIndex(), GeneratorComp);
-			RoadCounter++;
-
-			if (true == AddTextRender.GetValueOnGameThread())
+		}
+		FCityTileMesh TileMesh;
+		for (const FTileSource& Source : *TileSources)
+		{
+			TArray<UMaterialInterface*> SourceMaterials;
+			for (int32 i = 0; i < Source.MeshComponent->GetNumMaterials(); ++i)
 			{
-				AddDebugTextRender(RoadActor, FColor::Yellow,
-				                   FString::Printf(TEXT("RI:%d"), GeneratorComp->GetGlobalIndex()));
+				SourceMaterials.Emplace(Source.MeshComponent->GetMaterial(i));
 			}
-			//把对道路和附属节点加入图
-			if (nullptr != RoadGraph)
+			const FTransform SourceToTile = Source.MeshComponent->GetComponentTransform().
+			                                       GetRelativeTransform(TileTransform);
+			Source.MeshComponent->ProcessMesh([&](const UE::Geometry::FDynamicMesh3& SourceMesh)
 			{
-				/*RoadGraph->AddUndirectedEdge(ConnectedIntersections[0], ConnectedIntersections[1],
-				                             GeneratorComp->GetGlobalIndex());*/
-				RoadGraph->AddEdgeInGivenSlot(ConnectedIntersections[0], ConnectedIntersections[1],
-				                              GeneratorComp->GetGlobalIndex(), EntryIndexOfIntersections[0]);
-				RoadGraph->AddEdgeInGivenSlot(ConnectedIntersections[1], ConnectedIntersections[0],
-				                              GeneratorComp->GetGlobalIndex(), EntryIndexOfIntersections[1]);
-			}
+				TileMesh.AppendSource(Source.SourceType, Source.SourceIndex, SourceMesh, SourceToTile,
+				                      SourceMaterials);
+			});
+			Source.MeshComponent->SetVisibility(false);
 		}
-	}
-	RoadGraph->PrintConnectionToLog();
-	//4.调用生成
-	for (const auto& IDGeneratorPair : IDToRoadGenerator)
+		TriangleNum += TileMesh.Mesh.TriangleCount();
+		Tile.Component->SetMesh(MoveTemp(TileMesh.Mesh));
+		Tile.Component->ConfigureMaterialSet(TileMesh.Materials);
+		Tile.TriangleRanges = MoveTemp(TileMesh.TriangleRanges);
+	}
+	SpawnBatch.Commit();
+	UE_LOG(LogTemp, Display, TEXT("[CityTile]Rebuild %d Of %d Tiles,%d Triangles,Cost %f ms"), DirtyTiles.Num(),
+	       CityTiles.Num(), TriangleNum, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+#pragma endregion CityTile
+
+#pragma region RoadLOD
+void URoadGeneratorSubsystem::UpdateRoadLODs(const FVector& ViewLocation)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::UpdateRoadLODs);
+	const double LODDistance = FMath::Max(100.0, static_cast<double>(CVarRoadLODDistance.GetValueOnGameThread()));
+	for (const TPair<int32, TWeakObjectPtr<URoadMeshGenerator>>& RoadPair : IDToRoadGenerator)
 	{
-		if (!IDGeneratorPair.Value.IsValid())
+		URoadMeshGenerator* Road = RoadPair.Value.Get();
+		if (nullptr == Road || Road->GetLODNum() <= 1 || nullptr == Road->GetMeshComponent())
 		{
 			continue;
 		}
-		IDGeneratorPair.Value->SetDrawVisualDebug(bEnableVisualDebug.GetValueOnGameThread());
-		IDGeneratorPair.Value->GenerateMesh();
+		const UDynamicMeshComponent* RoadMeshComp = Road->GetMeshComponent();
+		int32 TargetLOD = 0;
+		if (RoadMeshComp->IsVisible())
+		{
+			const double Distance = FMath::Sqrt(RoadMeshComp->Bounds.GetBox().ComputeSquaredDistanceToPoint(ViewLocation));
+			TargetLOD = FMath::Min(Road->GetLODNum() - 1, FMath::FloorToInt32(Distance / LODDistance));
+		}
+		Road->SetDisplayedLOD(TargetLOD);
 	}
 }
 
-TArray<TArray<uint32>> URoadGeneratorSubsystem::GetContinuousIndexSeries(const TArray<uint32>& AllSegmentIndex,
-                                                                         TArray<uint32>& BreakPoints)
+bool URoadGeneratorSubsystem::TickRoadLODs(float DeltaTime)
 {
-	TArray<TArray<uint32>> Results;
-	if (BreakPoints.IsEmpty())
-	{
-		Results.Emplace(AllSegmentIndex);
-		return Results;
-	}
-	//连续数组问题使用滑动窗口处理，但因为不需要长度数据，可以直接用单指针模拟窗口
-	TArray<uint32> IndexSeries;
-	//int32 LeftIndex = 0;
-	int32 RightIndex = 0;
-	BreakPoints.Sort();
-	int32 BreakpointIndex = 0;
-	int32 ValidBreakPoints = BreakPoints.Num();
-	//对齐数据
-	while (ValidBreakPoints > 0 && BreakPoints[BreakpointIndex] < AllSegmentIndex[0])
-	{
-		BreakpointIndex++;
-		ValidBreakPoints--;
-	}
-	int32 BreakpointIndexLast = BreakPoints.Num() - 1;
-	while (ValidBreakPoints > 0 && BreakPoints[BreakpointIndexLast] > AllSegmentIndex.Last(0))
+	const float UpdateInterval = CVarRoadLODUpdateInterval.GetValueOnGameThread();
+	if (UpdateInterval <= 0.0f || nullptr == GCurrentLevelEditingViewportClient || IDToRoadGenerator.IsEmpty())
 	{
-		BreakpointIndexLast--;
-		ValidBreakPoints--;
+		return true;
 	}
-	if (ValidBreakPoints <= 0)
+	const double CurrentTime = FPlatformTime::Seconds();
+	if (CurrentTime - LastRoadLODUpdateTime < UpdateInterval)
 	{
-		Results.Emplace(AllSegmentIndex);
-		return Results;
+		return true;
 	}
-	while (RightIndex < AllSegmentIndex.Num())
-	{
-		//没遇到BreakPionts中的值是扩张
-		if (AllSegmentIndex[RightIndex] != BreakPoints[BreakpointIndex])
+	LastRoadLODUpdateTime = CurrentTime;
+	UpdateRoadLODs(GCurrentLevelEditingViewportClient->GetViewLocation());
+	return true;
+}
+
+void URoadGeneratorSubsystem::BakeRoadLODsToStaticMeshes(const FString& InPackageFolder)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URoadGeneratorSubsystem::BakeRoadLODsToStaticMeshes);
+	const double LODDistance = FMath::Max(100.0, static_cast<double>(CVarRoadLODDistance.GetValueOnGameThread()));
+	int32 BakedNum = 0;
+	TArray<UPackage*> BakedPackages;
+	for (const TPair<int32, TWeakObjectPtr<URoadMeshGenerator>>& RoadPair : IDToRoadGenerator)
+	{
+		const URoadMeshGenerator* Road = RoadPair.Value.Get();
+		if (nullptr == Road || nullptr == Road->GetMeshComponent())
 		{
-			IndexSeries.Emplace(AllSegmentIndex[RightIndex]);
-			RightIndex++;
+			continue;
 		}
-		//遇到BreakPoints时更新结果并收缩
-		else
+		//先取出有效的LOD，SourceModel数量与之一致，避免取出失败时留下空的SourceModel
+		TArray<UE::Geometry::FDynamicMesh3> LODMeshes;
+		TArray<int32> LODLevels;
+		for (int32 LODIndex = 0; LODIndex < Road->GetLODNum(); ++LODIndex)
 		{
-			if (IndexSeries.Num() > 0)
-			{
-				Results.Emplace(IndexSeries);
-			}
-			IndexSeries.Reset();
-			//这里使用两个数组单调且元素不重复特性
-			while (RightIndex < AllSegmentIndex.Num() &&
-				BreakpointIndex < BreakPoints.Num() && AllSegmentIndex[RightIndex] == BreakPoints[BreakpointIndex])
-			{
-				BreakpointIndex++;
-				RightIndex++;
-			}
-			//两个都走到头了
-			if (BreakpointIndex == BreakPoints.Num() && RightIndex == AllSegmentIndex.Num())
-			{
-				break;
-			}
-			// BreakPoint是Allsegment子集，不存在BreakpointIndex没到头但是RightIndex到头的情况
-			if (BreakpointIndex == BreakPoints.Num() && RightIndex < AllSegmentIndex.Num())
+			UE::Geometry::FDynamicMesh3 LODMesh;
+			if (Road->CopyLODMesh(LODIndex, LODMesh) && LODMesh.TriangleCount() > 0)
 			{
-				//RightIndex++;
-				//没有发现截取子数组的函数，使用FMemory::Memcpy()
-				IndexSeries.SetNum(AllSegmentIndex.Num() - RightIndex);
-				FMemory::Memcpy(IndexSeries.GetData(),
-				                AllSegmentIndex.GetData() + RightIndex,
-				                (AllSegmentIndex.Num() - RightIndex) * sizeof(uint32));
-				break;
+				LODMeshes.Emplace(MoveTemp(LODMesh));
+				LODLevels.Emplace(LODIndex);
 			}
-			//此时回归正常情况两者指向数字不同，收缩窗口
-			//Left=Right
 		}
+		if (LODMeshes.IsEmpty())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[WARNING]Road %d Has No Valid LOD Mesh,Skip Baking"),
+			       Road->GetGlobalIndex());
+			continue;
+		}
+		const FString AssetName = FString::Printf(TEXT("SM_Road_%d"), Road->GetGlobalIndex());
+		UPackage* Package = CreatePackage(*FPaths::Combine(InPackageFolder, AssetName));
+		if (nullptr == Package)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[ERROR]Create Package For %s Failed"), *AssetName);
+			continue;
+		}
+		UStaticMesh* StaticMesh = FindObject<UStaticMesh>(Package, *AssetName);
+		const bool bIsNewAsset = nullptr == StaticMesh;
+		if (bIsNewAsset)
+		{
+			StaticMesh = NewObject<UStaticMesh>(Package, *AssetName, RF_Public | RF_Standalone);
+		}
+		const int32 LODNum = LODMeshes.Num();
+		StaticMesh->SetNumSourceModels(LODNum);
+		StaticMesh->bAutoComputeLODScreenSize = false;
+		const double BoundsRadius = Road->GetMeshComponent()->Bounds.SphereRadius;
+		FDynamicMeshToMeshDescription Converter;
+		for (int32 LODIndex = 0; LODIndex < LODNum; ++LODIndex)
+		{
+			FStaticMeshSourceModel& SourceModel = StaticMesh->GetSourceModel(LODIndex);
+			SourceModel.BuildSettings.bRecomputeNormals = false;
+			SourceModel.BuildSettings.bRecomputeTangents = true;
+			//屏幕尺寸近似为包围球直径与切换距离之比，按原LOD级别计算，与UpdateRoadLODs的切换距离大致对应
+			SourceModel.ScreenSize = 0 == LODIndex
+				                         ? 1.0f
+				                         : FMath::Clamp(
+					                         static_cast<float>(2.0 * BoundsRadius / (LODLevels[LODIndex] *
+						                         LODDistance)), 0.001f, 1.0f);
+			FMeshDescription* MeshDescription = StaticMesh->CreateMeshDescription(LODIndex);
+			FStaticMeshAttributes(*MeshDescription).Register();
+			Converter.Convert(&LODMeshes[LODIndex], *MeshDescription);
+			StaticMesh->CommitMeshDescription(LODIndex);
+		}
+		//与UpdateCityTiles相同复制全部材质槽，MaterialID即槽位下标
+		const UDynamicMeshComponent* RoadMeshComp = Road->GetMeshComponent();
+		StaticMesh->GetStaticMaterials().Reset();
+		for (int32 i = 0; i < RoadMeshComp->GetNumMaterials(); ++i)
+		{
+			StaticMesh->GetStaticMaterials().Emplace(RoadMeshComp->GetMaterial(i));
+		}
+		StaticMesh->Build();
+		StaticMesh->PostEditChange();
+		StaticMesh->MarkPackageDirty();
+		if (bIsNewAsset)
+		{
+			FAssetRegistryModule::AssetCreated(StaticMesh);
+		}
+		BakedPackages.Emplace(Package);
+		BakedNum++;
 	}
-	//把最后一组数字放进去
-	if (!IndexSeries.IsEmpty())
+	if (!BakedPackages.IsEmpty() && !UEditorLoadingAndSavingUtils::SavePackages(BakedPackages, true))
 	{
-		Results.Emplace(IndexSeries);
+		UE_LOG(LogTemp, Error, TEXT("[RoadLOD]Save Baked Road Static Meshes Failed,Please Save Them Manually"));
 	}
-	return Results;
+	UE_LOG(LogTemp, Display, TEXT("[RoadLOD]Baked %d Road Static Meshes To %s"), BakedNum, *InPackageFolder);
+	UNotifyUtilities::ShowPopupMsgAtCorner(FString::Printf(TEXT("Baked %d Road Static Meshes"), BakedNum));
 }
+#pragma endregion RoadLOD
 
-FConnectionInsertInfo URoadGeneratorSubsystem::FindInsertIndexInExistedContinuousSegments(
-	const TArray<TArray<uint32>>& InContinuousSegmentsGroups,
-	const TArray<FSplinePolyLineSegment>& InAllSegmentOnSpline,
-	const uint32 OwnerSegmentID, const FVector& PointTransWS)
+void URoadGeneratorSubsystem::GenerateCityBlock()
 {
-	FConnectionInsertInfo Result;
-	//利用连续特性,寻找是不是在端点
-	if (OwnerSegmentID < InContinuousSegmentsGroups[0][0])
-	{
-		Result.GroupIndex = 0;
-		Result.bConnectToGroupHead = true;
-	}
-	else if (OwnerSegmentID > InContinuousSegmentsGroups.Last(0).Last(0))
+	if (nullptr == RoadGraph)
 	{
-		Result.GroupIndex = InContinuousSegmentsGroups.Num() - 1;
-		Result.bConnectToGroupHead = false;
+		return;
 	}
-	else
-	{
-		int32 IndexDistance = INT_MAX;
-		uint32 NeighborSegmentIndex = UINT_MAX;
-		bool bChoiceHead = true;
-		for (int32 i = 1; i < InContinuousSegmentsGroups.Num(); ++i)
+	const double StartTime = FPlatformTime::Seconds();
+	FRoadGenerationProgress Progress(3.0f, LOCTEXT("GenerateCityBlock", "Generating City Blocks"));
+	//1.游戏线程由路网图和交汇路口位置构建CityModel，路口和道路ID为模型内的连续序号
+	FCityModel Model;
+	TMap<int32, int32> IntersectionIDs;
+	TArray<int32> IntersectionGlobalIndexes;
+	TArray<int32> SortedIntersectionIndexes;
+	IDToIntersectionGenerator.GenerateKeyArray(SortedIntersectionIndexes);
+	SortedIntersectionIndexes.Sort();
+	for (const int32 IntersectionIndex : SortedIntersectionIndexes)
+	{
+		const TWeakObjectPtr<UIntersectionMeshGenerator>& Generator = IDToIntersectionGenerator[IntersectionIndex];
+		if (!Generator.IsValid() || nullptr == Generator->GetOwner())
 		{
-			//@TODO：可以使用二分查找优化
-			//遍历寻找中间位置
-			if (InContinuousSegmentsGroups[i - 1].Last() < OwnerSegmentID && OwnerSegmentID <=
-				InContinuousSegmentsGroups[i][0])
+			continue;
+		}
+		FCityModelIntersection& Intersection = Model.Intersections.AddDefaulted_GetRef();
+		Intersection.ID = Model.Intersections.Num() - 1;
+		Intersection.Location = Generator->GetOwner()->GetActorLocation();
+		Intersection.Entries.SetNum(RoadGraph->Graph.IsValidIndex(IntersectionIndex)
+			                            ? RoadGraph->Graph[IntersectionIndex].Num()
+			                            : 0);
+		IntersectionIDs.Emplace(IntersectionIndex, Intersection.ID);
+		IntersectionGlobalIndexes.Emplace(IntersectionIndex);
+	}
+	//路网图中每条道路有两条反向边，槽位即两端的入口局部ID
+	TMap<int32, TArray<TPair<int32, int32>, TInlineAllocator<2>>> RoadEnds;
+	for (int32 NodeIndex = 0; NodeIndex < RoadGraph->Graph.Num(); ++NodeIndex)
+	{
+		const int32* IntersectionID = IntersectionIDs.Find(NodeIndex);
+		if (nullptr == IntersectionID)
+		{
+			continue;
+		}
+		const TArray<FRoadGraphEdge>& Edges = RoadGraph->Graph[NodeIndex];
+		for (int32 Slot = 0; Slot < Edges.Num(); ++Slot)
+		{
+			if (Edges[Slot].RoadIndex != INT32_ERROR && Edges[Slot].ToNodeIndex != INT32_ERROR)
 			{
-				uint32 IndexGapToLastEnd = OwnerSegmentID - InContinuousSegmentsGroups[i - 1].Last();
-				uint32 IndexGapToNextStart = InContinuousSegmentsGroups[i][0] - OwnerSegmentID;
-				//距离两端序号距离一样
-				if (IndexGapToLastEnd == IndexGapToNextStart)
-				{
-					//@TODO:这里触发偶发断言内层返回的序号不在InAllSegmentOnSpline数组中，可能是由于重复生成，待后续排查
-					FVector LocOfLastEnd = InAllSegmentOnSpline[InContinuousSegmentsGroups[i - 1].Last()].EndTransform.
-						GetLocation();
-					float DisToLastEnd = FVector::DistSquared2D(LocOfLastEnd, PointTransWS);
-					FVector LocOfNextStart = InAllSegmentOnSpline[InContinuousSegmentsGroups[i][0]].EndTransform.
-						GetLocation();
-					float DisToNestStart = FVector::DistSquared2D(LocOfNextStart, PointTransWS);
-					//理论上不存在等于
-					if (DisToLastEnd <= DisToNestStart)
-					{
-						Result.GroupIndex = i - 1;
-						Result.bConnectToGroupHead = false;
-						break;
-					}
-					else
-					{
-						Result.GroupIndex = i;
-						Result.bConnectToGroupHead = true;
-						break;
-					}
-				}
-				//距离上一段终点更近
-				else if (IndexGapToLastEnd < IndexGapToNextStart)
-				{
-					Result.GroupIndex = i - 1;
-					Result.bConnectToGroupHead = false;
-					break;
-				}
-				//距离当前段起点更近
-				else
-				{
-					Result.GroupIndex = i;
-					Result.bConnectToGroupHead = true;
-					break;
-				}
+				RoadEnds.FindOrAdd(Edges[Slot].RoadIndex).Emplace(*IntersectionID, Slot);
 			}
 		}
 	}
-	return Result;
-}
-
-
-TArray<FTransform> URoadGeneratorSubsystem::ResampleSpline(const USplineComponent* TargetSpline)
-{
-	TArray<FTransform> Results;
-	if (nullptr == TargetSpline || TargetSpline->GetNumberOfSplinePoints() <= 1)
+	RoadEnds.KeySort(TLess<int32>());
+	TArray<int32> RoadGlobalIndexes;
+	for (const auto& RoadEndsPair : RoadEnds)
 	{
-		return Results;
-	}
-	const float SegmentMaxDisThreshold = 10 * PolyLineSampleDistance;
-	TArray<FVector> PolyLineEndPointLoc;
-	TArray<double> PolyLineLengths;
-	//曲线，该函数返回闭合样条返回段,Distance数组是到每一个端点处的长度（类似前缀和）,ControlPoint位置一定会有一个采样点
-	TargetSpline->ConvertSplineToPolyLineWithDistances(ESplineCoordinateSpace::World, PolyLineSampleDistance,
-	                                                   PolyLineEndPointLoc, PolyLineLengths);
-	//先处理Linear
-	TArray<int32> LinearControlPointIndexes;
-	for (int32 i = 0; i < PolyLineLengths.Num(); ++i)
-	{
-		float InputKey = TargetSpline->GetInputKeyValueAtDistanceAlongSpline(PolyLineLengths[i]);
-		if (IsIntegerInFloatFormat(InputKey))
-		{
-			int32 ControlPointIndex = static_cast<int32>(InputKey);
-			if (TargetSpline->GetSplinePointType(ControlPointIndex) == ESplinePointType::Linear && i > 0 &&
-				i < PolyLineLengths.Num() - 1)
-			{
-				LinearControlPointIndexes.Add(i);
-			}
+		if (RoadEndsPair.Value.Num() != 2)
+		{
+			continue;
+		}
+		FCityModelRoad& Road = Model.Roads.AddDefaulted_GetRef();
+		Road.ID = Model.Roads.Num() - 1;
+		for (int32 k = 0; k < 2; ++k)
+		{
+			Road.ConnectedIntersections[k] = RoadEndsPair.Value[k].Key;
+			Road.EntryIndexOfIntersections[k] = RoadEndsPair.Value[k].Value;
 		}
+		RoadGlobalIndexes.Emplace(RoadEndsPair.Key);
 	}
-
-	//所有细分点的初始内容
-	Results.Reserve(PolyLineEndPointLoc.Num());
-	for (int i = 0; i < PolyLineLengths.Num(); ++i)
+	//2.后台建图、枚举环路并剔除外轮廓
+	const FCityModelBuilder Builder(MakeBuildSettings());
+	const UE::Tasks::FTask FindLoopTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Builder, &Model]()
 	{
-		Results.Emplace(
-			TargetSpline->GetTransformAtDistanceAlongSpline(PolyLineLengths[i], ESplineCoordinateSpace::World,
-			                                                true));
+		Builder.BuildGraph(Model);
+		Builder.FindBlocks(Model);
+	});
+	if (!Progress.Wait(FindLoopTask, 1.0f, LOCTEXT("FindBlockLoops", "Finding Block Loops In Road Graph")))
+	{
+		NotifyGenerationCancelled(TEXT("Generate City Block"));
+		return;
 	}
-
-	TMap<int32, TArray<FTransform>> InterplatePointsOnControlPoints;
-	TMap<int32, TArray<double>> InterplateLengthOnSpline;
-	if (!LinearControlPointIndexes.IsEmpty())
+	if (Model.Blocks.Num() <= 0)
 	{
-		for (int32& ControlPointIndex : LinearControlPointIndexes)
+		UNotifyUtilities::ShowPopupMsgAtCorner("Find Null Valid Loop");
+		return;
+	}
+	//3.环路中的ID换回GlobalIndex
+	TArray<FBlockLinkInfo> BlockLoops;
+	BlockLoops.Reserve(Model.Blocks.Num());
+	for (FCityModelBlock& Block : Model.Blocks)
+	{
+		for (int32& RoadIndex : Block.Loop.RoadIndexes)
 		{
-			//值过小会因为被四叉树判定为相交，生成交汇路口时报错
-			const float AdditionalSampleDistance = 4 * PolyLineSampleDistance;
-			//判断和前边点的距离
-			float FrontNeighbourDis = PolyLineLengths[ControlPointIndex] - PolyLineLengths[ControlPointIndex - 1];
-			FTransform LastTransform = TargetSpline->GetTransformAtDistanceAlongSpline(
-				PolyLineLengths[ControlPointIndex - 1], ESplineCoordinateSpace::World,
-				true);
-
-			if (FrontNeighbourDis > AdditionalSampleDistance)
-			{
-				LastTransform = TargetSpline->GetTransformAtDistanceAlongSpline(
-					PolyLineLengths[ControlPointIndex] - AdditionalSampleDistance,
-					ESplineCoordinateSpace::World,
-					true);
-				InterplatePointsOnControlPoints.Emplace(ControlPointIndex - 1).Add(LastTransform);
-				InterplateLengthOnSpline.Emplace(ControlPointIndex - 1).Emplace(
-					PolyLineLengths[ControlPointIndex] - AdditionalSampleDistance);
-			}
-
-			float NextNeighbourDis = PolyLineLengths[ControlPointIndex + 1] - PolyLineLengths[ControlPointIndex];
-			FTransform NextTransform = TargetSpline->GetTransformAtDistanceAlongSpline(
-				PolyLineLengths[ControlPointIndex + 1], ESplineCoordinateSpace::World,
-				true);
-			if (NextNeighbourDis > AdditionalSampleDistance)
-			{
-				NextTransform = TargetSpline->GetTransformAtDistanceAlongSpline(
-					PolyLineLengths[ControlPointIndex] + AdditionalSampleDistance,
-					ESplineCoordinateSpace::World,
-					true);
-				InterplatePointsOnControlPoints.Add(ControlPointIndex).Add(NextTransform);
-				InterplateLengthOnSpline.Add(ControlPointIndex).Emplace(
-					PolyLineLengths[ControlPointIndex] + AdditionalSampleDistance);
-			}
-			//FQuat不要使用(A+B)/2计算值不对
-			FQuat AverageRotator = FQuat::Slerp(LastTransform.GetRotation(), NextTransform.GetRotation(), 0.5);
-			Results[ControlPointIndex].SetRotation(AverageRotator);
-			FVector RotDir = AverageRotator.Rotator().Vector();
+			RoadIndex = RoadGlobalIndexes[RoadIndex];
+		}
+		for (int32& IntersectionIndex : Block.Loop.IntersectionIndexes)
+		{
+			IntersectionIndex = IntersectionGlobalIndexes[IntersectionIndex];
 		}
-		InsertElementsAtIndex(Results, InterplatePointsOnControlPoints);
-		InsertElementsAtIndex(PolyLineLengths, InterplateLengthOnSpline);
+		BlockLoops.Emplace(MoveTemp(Block.Loop));
 	}
-
-	TMap<int32, TArray<FTransform>> SegmentsToSubdivide;
-	//检测上面函数返回的分段长度是否符合设定要求，如果不符合则记录位置进一步处理
-	for (int i = 1; i < Results.Num(); ++i)
+	//街区已生成过时只重建环路包含脏道路或脏交汇路口的街区，其余环路与已有街区一致，直接跳过
+	const bool bRebuildDirtyOnly = bBlocksGenerated && CVarDirtyPropagation.GetValueOnGameThread();
+	int32 RemovedBlockNum = 0;
+	if (bRebuildDirtyOnly)
 	{
-		if (PolyLineLengths[i] - PolyLineLengths[i - 1] > SegmentMaxDisThreshold)
+		const FRoadDirtySet DirtySet = DependencyTracker.CollectDirtySet(PendingBlockEdit, RoadGraph);
+		for (const int32 BlockIndex : DirtySet.Blocks)
 		{
-			//以该点为起点的位置需要插入元素
-			SegmentsToSubdivide.Emplace(i - 1);
+			DestroyBlockActor(BlockIndex);
+			RemovedBlockNum++;
 		}
 	}
-	if (SegmentsToSubdivide.IsEmpty())
+	else
 	{
-		return Results;
+		DependencyTracker.ResetBlocks();
+		MoveGeneratorsToPool(IDToBlockGenerator, BlockActorPool);
 	}
-	//如果需要处理，在记录的位置增加细分
-	for (TPair<int32, TArray<FTransform>>& TargetSegment : SegmentsToSubdivide)
-	{
-		const int32 SegmentIndex = TargetSegment.Key;
-		const float OriginalSegmentLength = PolyLineLengths[SegmentIndex + 1] - PolyLineLengths[SegmentIndex];
-		int32 TargetSubdivisionNum = FMath::CeilToInt32(OriginalSegmentLength / SegmentMaxDisThreshold);
-		double TargetSubdivisionLength = OriginalSegmentLength / TargetSubdivisionNum;
-		TArray<FTransform> SubdivisionPoints;
-		for (int32 j = 1; j < TargetSubdivisionNum; j++)
+	int32 SkippedBlockNum = 0;
+	TArray<TWeakObjectPtr<UBlockMeshGenerator>> NewBlocks;
+	//轮廓提取需要读取道路和路口Generator，与生成Actor一起在游戏线程分批执行
+	FEditorSpawnBatch SpawnBatch(TEXT("Spawn Blocks"));
+	bool bFinished = Progress.ForEachBatch(
+		BlockLoops.Num(), CVarSpawnBatchSize.GetValueOnGameThread(), 1.0f,
+		LOCTEXT("SpawnBlocks", "Spawning Block Actors"), [&](int32 BeginIndex, int32 EndIndex)
 		{
-			float DisToSubdivisionPoint = static_cast<float>(j * TargetSubdivisionLength + PolyLineLengths[
-				SegmentIndex]);
-			TargetSegment.Value.Add(
-				TargetSpline->GetTransformAtDistanceAlongSpline(DisToSubdivisionPoint, ESplineCoordinateSpace::World));
-		}
+			for (int32 i = BeginIndex; i < EndIndex; ++i)
+			{
+				if (bRebuildDirtyOnly && DependencyTracker.FindBlockByLoop(BlockLoops[i]) != INDEX_NONE)
+				{
+					SkippedBlockNum++;
+					continue;
+				}
+				if (UBlockMeshGenerator* NewBlock = SpawnBlockActor(BlockLoops[i], i))
+				{
+					NewBlocks.Emplace(NewBlock);
+				}
+			}
+		});
+	SpawnBatch.Commit();
+	//生成Mesh，增量时只生成新街区
+	if (bFinished && bRebuildDirtyOnly)
+	{
+		bFinished = CommitMeshesInBatches(NewBlocks, Progress,
+		                                  LOCTEXT("CommitDirtyBlockMeshes", "Building Block Meshes"));
+		UE_LOG(LogTemp, Display, TEXT("Dirty Block Update:%d Blocks Removed,%d Rebuilt,%d Skipped,Cost %f ms"),
+		       RemovedBlockNum, NewBlocks.Num(), SkippedBlockNum, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+	else if (bFinished)
+	{
+		TArray<TWeakObjectPtr<UBlockMeshGenerator>> AllBlocks;
+		IDToBlockGenerator.GenerateValueArray(AllBlocks);
+		bFinished = CommitMeshesInBatches(AllBlocks, Progress, LOCTEXT("CommitBlockMeshes", "Building Block Meshes"));
+	}
+	if (!bFinished)
+	{
+		//PendingBlockEdit保留，下次调用时重新生成被取消的街区，增量更新时回收池为空，新街区全部销毁
+		RestorePooledGeneratorsOnCancel(NewBlocks, BlockActorPool, IDToBlockGenerator,
+		                                [this](const TWeakObjectPtr<UBlockMeshGenerator>& NewBlock)
+		                                {
+			                                DestroyBlockActor(NewBlock->GetGlobalIndex());
+		                                });
+		bBlocksGenerated = bBlocksGenerated && bRebuildDirtyOnly;
+		NotifyGenerationCancelled(TEXT("Generate City Block"));
+		return;
 	}
-	//FTransform为非POD对象，不能直接内存拷贝
-	InsertElementsAtIndex(Results, SegmentsToSubdivide);
-	return Results;
-}
-
-#pragma endregion GenerateRoad
-
-void URoadGeneratorSubsystem::AddDebugTextRender(AActor* TargetActor, const FColor& TextColor, const FString& Text)
-{
-	UActorComponent* IndexTexRenderTemp = UEditorComponentUtilities::AddComponentInEditor(
-		TargetActor, UTextRenderComponent::StaticClass());
-	UTextRenderComponent* IndexTexRender = Cast<UTextRenderComponent>(IndexTexRenderTemp);
-	IndexTexRender->SetRelativeRotation(FRotator(90.0, 0.0, 0.0));
-	IndexTexRender->SetRelativeLocation(FVector(0.0, 0.0, 50.0));
-	IndexTexRender->SetText(FText::FromString(Text));
-	IndexTexRender->SetTextRenderColor(TextColor);
-	IndexTexRender->SetWorldSize(800.0);
-	IndexTexRender->SetHorizontalAlignment(EHorizTextAligment::EHTA_Center);
-	IndexTexRender->SetVerticalAlignment(EVerticalTextAligment::EVRTA_TextCenter);
-}
-
-
-void URoadGeneratorSubsystem::PrintGraphConnection()
-{
-	if (nullptr != RoadGraph)
+	if (!bRebuildDirtyOnly)
 	{
-		RoadGraph->PrintConnectionToLog();
+		DestroyUnusedPooledActors(BlockActorPool, TEXT("Blocks"));
 	}
+	PendingBlockEdit.Reset();
+	bBlocksGenerated = true;
+	UpdateCityTilesIfEnabled();
 }
 
-bool URoadGeneratorSubsystem::IsIntegerInFloatFormat(float InFloatValue)
-{
-	return FMath::IsNearlyEqual(InFloatValue, FMath::RoundToFloat(InFloatValue));
-}
-
-void URoadGeneratorSubsystem::GenerateCityBlock()
+UBlockMeshGenerator* URoadGeneratorSubsystem::SpawnBlockActor(const FBlockLinkInfo& InBlockLoop, int32 ActorIndex)
 {
-	if (nullptr == RoadGraph)
+	//获取生成轮廓信息
+	TArray<FVector> LoopPath;
+	TArray<FInterpCurveVector> RefsSplineGroup;
+	const FString PrintStr = GetBlockLoopPath(InBlockLoop, LoopPath, RefsSplineGroup);
+	UE_LOG(LogTemp, Display, TEXT("Block Loop:%d {%s}"), ActorIndex, *PrintStr);
+	if (LoopPath.IsEmpty())
 	{
-		return;
+		return nullptr;
 	}
-	TArray<FBlockLinkInfo> BlockLoops = RoadGraph->GetSurfaceInGraph();
-	//移除外轮廓
-	RemoveInvalidLoopInline(BlockLoops);
-	if (BlockLoops.Num() <= 0)
+	//生成Actor并挂载，环路道路集合相同的街区复用已有Actor，SetSweepPath依赖Actor变换需要先更新位置
+	FTransform ActorTransform = FTransform::Identity;
+	ActorTransform.SetLocation(LoopPath[0]);
+	const uint32 TopologyKey = MakeBlockTopologyKey(InBlockLoop);
+	UBlockMeshGenerator* GeneratorComp = BlockActorPool.Take(TopologyKey, LoopPath[0]);
+	if (nullptr != GeneratorComp)
 	{
-		UNotifyUtilities::ShowPopupMsgAtCorner("Find Null Valid Loop");
-		return;
-	}
-	TArray<TArray<FVector>> AllLoopPath;
-	TArray<TArray<FInterpCurveVector>> AllRefsSplineGroup;
-	//获取生成轮廓信息
-	for (int32 i = 0; i < BlockLoops.Num(); ++i)
-	{
-		const TArray<int32>& RoadIndexes = BlockLoops[i].RoadIndexes;
-		const TArray<int32>& IntersectionIndexes = BlockLoops[i].IntersectionIndexes;
-		FColor DebugColor = FColor::MakeRandomColor();
-		FString PrintStr = "";
-		PrintStr += FString::Printf(TEXT("[%d]"), IntersectionIndexes.Last());
-		//单个循环边组
-		TArray<FVector> SingleLoopPath;
-		TArray<FInterpCurveVector> SingleRoadRefGroup;
-		for (int j = 0; j < RoadIndexes.Num(); ++j)
-		{
-			PrintStr += FString::Printf(TEXT("-(%d)-"), RoadIndexes[j]);
-			TWeakObjectPtr<URoadMeshGenerator> RoadGeneratorWeak = IDToRoadGenerator[RoadIndexes[j]];
-			if (!RoadGeneratorWeak.IsValid())
-			{
-				continue;
-			}
-			URoadMeshGenerator* RoadGenerator = RoadGeneratorWeak.Pin().Get();
-			//道路的起点终点
-			int32 RoadPathFromConnection = INT32_ERROR;
-			int32 RoadPathToConnection = INT32_ERROR;
-			RoadGenerator->GetConnectionOrderOfIntersection(RoadPathFromConnection, RoadPathToConnection);
-			//图顺序是当前边和它的终点
-			int32 GraphStartEdge = IntersectionIndexes.Last();
-			if (j != 0)
-			{
-				GraphStartEdge = IntersectionIndexes[j - 1];
-			}
-			int32 GraphEndEdge = IntersectionIndexes[j];
-			ensureAlways(
-				(RoadPathFromConnection==GraphStartEdge||RoadPathFromConnection==GraphEndEdge)&&(RoadPathToConnection==
-					GraphStartEdge||RoadPathToConnection==GraphEndEdge));
-			bool bIsForwardTraverse = RoadPathFromConnection == GraphStartEdge;
-			//根据道路朝向提取Location
-			TArray<FVector> RoadEdgeLocArray = RoadGenerator->GetRoadEdgePoints(bIsForwardTraverse);
-			SingleLoopPath.Append(RoadEdgeLocArray);
-			//根据道路走向提取参考Spline
-			SingleRoadRefGroup.Emplace(
-				RoadGenerator->GetSplineControlPointsInRoadRange(bIsForwardTraverse, ECoordOffsetType::LEFTEDGE));
-			//十字路口的衔接点
-			PrintStr += FString::Printf(TEXT("[%d]"), IntersectionIndexes[j]);
-			TWeakObjectPtr<UIntersectionMeshGenerator> IntersectionGeneratorWeak = IDToIntersectionGenerator[
-				IntersectionIndexes[j]];
-			if (!IntersectionGeneratorWeak.IsValid())
-			{
-				UE_LOG(LogTemp, Error, TEXT("Intersection Indexes %d Was Invalid"), IntersectionIndexes[j])
-				continue;
-			}
-			UIntersectionMeshGenerator* IntersectionGenerator = IntersectionGeneratorWeak.Pin().Get();
-			//注意顺序
-			int32 FromIntersection = j == 0 ? IntersectionIndexes.Last() : IntersectionIndexes[j - 1];
-			int32 EntryIndex = RoadGraph->
-				FindEdgeEntryIndex(IntersectionIndexes[j], FromIntersection, RoadIndexes[j]);
-			if (EntryIndex == INT32_ERROR)
-			{
-				UE_LOG(LogTemp, Error, TEXT("Find Null Edge In Graph"))
-				continue;
-			}
-			UE_LOG(LogTemp, Display, TEXT("Road Index %d, Intersection %d,At EntryIndex %d"), RoadIndexes[j],
-			       IntersectionIndexes[j], EntryIndex);
-			TArray<FVector> TransitionalPoints = IntersectionGenerator->GetTransitionalPoints(EntryIndex);
-			SingleLoopPath.Append(TransitionalPoints);
-			if (bEnableVisualDebug.GetValueOnGameThread())
-			{
-				for (const FVector& PathPoint : SingleLoopPath)
-				{
-					DrawDebugSphere(RoadGenerator->GetWorld(), PathPoint, 100.0f, 8, DebugColor,
-					                true);
-				}
-			}
-		}
-		AllLoopPath.Emplace(SingleLoopPath);
-		AllRefsSplineGroup.Emplace(SingleRoadRefGroup);
-		UE_LOG(LogTemp, Display, TEXT("Block Loop:%d {%s}"), i, *PrintStr);
+		ModifyReusedActor(GeneratorComp);
+		GeneratorComp->GetOwner()->SetActorTransform(ActorTransform);
+		GeneratorComp->ResetForRegenerate();
 	}
-	//生成Actor并挂载
-	for (int32 i = 0; i < AllLoopPath.Num(); i++)
+	else
 	{
-		FString ActorLabel = FString::Printf(TEXT("BlockActor%d"), i);
-		FTransform ActorTransform = FTransform::Identity;
-		ActorTransform.SetLocation(AllLoopPath[i][0]);
+		FString ActorLabel = FString::Printf(TEXT("BlockActor%d"), ActorIndex);
 		AActor* BlockActor = UEditorComponentUtilities::SpawnEmptyActor(ActorLabel, ActorTransform);
 		ensureAlways(nullptr!=BlockActor);
 
@@ -1250,57 +2458,102 @@ void URoadGeneratorSubsystem::GenerateCityBlock()
 		UDynamicMeshComponent* MeshComp = Cast<UDynamicMeshComponent>(MeshCompTemp);
 		UActorComponent* GeneratorCompTemp = UEditorComponentUtilities::AddComponentInEditor(
 			BlockActor, UBlockMeshGenerator::StaticClass());
-		UBlockMeshGenerator* GeneratorComp = Cast<UBlockMeshGenerator>(GeneratorCompTemp);
+		GeneratorComp = Cast<UBlockMeshGenerator>(GeneratorCompTemp);
 		GeneratorComp->SetMeshComponent(MeshComp);
-		GeneratorComp->SetSweepPath(AllLoopPath[i]);
-		GeneratorComp->SetInnerSplinePoints(AllRefsSplineGroup[i]);
-		IDToBlockGenerator.Emplace(GeneratorComp->GetGlobalIndex(), TWeakObjectPtr<UBlockMeshGenerator>(GeneratorComp));
 	}
-	//生成Mesh
-	for (const auto& IDGeneratorPair : IDToBlockGenerator)
+	GeneratorComp->SetTopologyKey(TopologyKey);
+	GeneratorComp->SetSweepPath(LoopPath);
+	GeneratorComp->SetInnerSplinePoints(RefsSplineGroup);
+	IDToBlockGenerator.Emplace(GeneratorComp->GetGlobalIndex(), TWeakObjectPtr<UBlockMeshGenerator>(GeneratorComp));
+	DependencyTracker.AddBlock(GeneratorComp->GetGlobalIndex(), InBlockLoop);
+	return GeneratorComp;
+}
+
+void URoadGeneratorSubsystem::DestroyBlockActor(int32 BlockIndex)
+{
+	DependencyTracker.RemoveBlock(BlockIndex);
+	TWeakObjectPtr<UBlockMeshGenerator> BlockGenerator;
+	if (IDToBlockGenerator.RemoveAndCopyValue(BlockIndex, BlockGenerator) && BlockGenerator.IsValid())
 	{
-		if (!IDGeneratorPair.Value.IsValid())
+		if (AActor* BlockActor = BlockGenerator->GetOwner())
 		{
-			continue;
+			BlockActor->Destroy();
 		}
-		IDGeneratorPair.Value->SetDrawVisualDebug(bEnableVisualDebug.GetValueOnGameThread());
-		IDGeneratorPair.Value->GenerateMesh();
 	}
 }
 
-void URoadGeneratorSubsystem::RemoveInvalidLoopInline(TArray<FBlockLinkInfo>& OutBlockLoops)
+FString URoadGeneratorSubsystem::GetBlockLoopPath(const FBlockLinkInfo& InBlockLoop, TArray<FVector>& OutLoopPath,
+                                                  TArray<FInterpCurveVector>& OutRefsSplineGroup)
 {
-	double MaxArea = -1.0;
-	int32 MaxAreaIndex = -1;
-	for (int32 i = 0; i < OutBlockLoops.Num(); ++i)
-	{
-		const TArray<int32>& VertexIndex = OutBlockLoops[i].IntersectionIndexes;
-		TArray<FVector2D> VertexLoc2D;
-		VertexLoc2D.Reserve(VertexIndex.Num());
-		for (const auto& Index : VertexIndex)
+	const TArray<int32>& RoadIndexes = InBlockLoop.RoadIndexes;
+	const TArray<int32>& IntersectionIndexes = InBlockLoop.IntersectionIndexes;
+	FColor DebugColor = FColor::MakeRandomColor();
+	FString PrintStr = "";
+	PrintStr += FString::Printf(TEXT("[%d]"), IntersectionIndexes.Last());
+	//单个循环边组
+	for (int j = 0; j < RoadIndexes.Num(); ++j)
+	{
+		PrintStr += FString::Printf(TEXT("-(%d)-"), RoadIndexes[j]);
+		TWeakObjectPtr<URoadMeshGenerator> RoadGeneratorWeak = IDToRoadGenerator[RoadIndexes[j]];
+		if (!RoadGeneratorWeak.IsValid())
 		{
-			ensureAlways(IDToIntersectionGenerator.Contains(Index));
-			TWeakObjectPtr<UIntersectionMeshGenerator> MeshGenerator = IDToIntersectionGenerator[Index];
-			if (!MeshGenerator.IsValid())
-			{
-				UE_LOG(LogTemp, Error, TEXT("Intersection Index:%d Is Not Valid"), Index);
-				continue;
-			}
-			UIntersectionMeshGenerator* IntersectionComp = MeshGenerator.Pin().Get();
-			VertexLoc2D.Emplace(FVector2D(IntersectionComp->GetOwner()->GetActorLocation()));
+			continue;
 		}
-		double LoopArea = URoadGeometryUtilities::GetAreaOfSortedPoints(VertexLoc2D);
-		if (LoopArea > MaxArea)
+		URoadMeshGenerator* RoadGenerator = RoadGeneratorWeak.Pin().Get();
+		//道路的起点终点
+		int32 RoadPathFromConnection = INT32_ERROR;
+		int32 RoadPathToConnection = INT32_ERROR;
+		RoadGenerator->GetConnectionOrderOfIntersection(RoadPathFromConnection, RoadPathToConnection);
+		//图顺序是当前边和它的终点
+		int32 GraphStartEdge = IntersectionIndexes.Last();
+		if (j != 0)
 		{
-			MaxArea = LoopArea;
-			MaxAreaIndex = i;
+			GraphStartEdge = IntersectionIndexes[j - 1];
+		}
+		int32 GraphEndEdge = IntersectionIndexes[j];
+		ensureAlways(
+			(RoadPathFromConnection==GraphStartEdge||RoadPathFromConnection==GraphEndEdge)&&(RoadPathToConnection==
+				GraphStartEdge||RoadPathToConnection==GraphEndEdge));
+		bool bIsForwardTraverse = RoadPathFromConnection == GraphStartEdge;
+		//根据道路朝向提取Location
+		TArray<FVector> RoadEdgeLocArray = RoadGenerator->GetRoadEdgePoints(bIsForwardTraverse);
+		OutLoopPath.Append(RoadEdgeLocArray);
+		//根据道路走向提取参考Spline
+		OutRefsSplineGroup.Emplace(
+			RoadGenerator->GetSplineControlPointsInRoadRange(bIsForwardTraverse, ECoordOffsetType::LEFTEDGE));
+		//十字路口的衔接点
+		PrintStr += FString::Printf(TEXT("[%d]"), IntersectionIndexes[j]);
+		TWeakObjectPtr<UIntersectionMeshGenerator> IntersectionGeneratorWeak = IDToIntersectionGenerator[
+			IntersectionIndexes[j]];
+		if (!IntersectionGeneratorWeak.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Intersection Indexes %d Was Invalid"), IntersectionIndexes[j])
+			continue;
+		}
+		UIntersectionMeshGenerator* IntersectionGenerator = IntersectionGeneratorWeak.Pin().Get();
+		//注意顺序
+		int32 FromIntersection = j == 0 ? IntersectionIndexes.Last() : IntersectionIndexes[j - 1];
+		int32 EntryIndex = RoadGraph->
+			FindEdgeEntryIndex(IntersectionIndexes[j], FromIntersection, RoadIndexes[j]);
+		if (EntryIndex == INT32_ERROR)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Find Null Edge In Graph"))
+			continue;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Road Index %d, Intersection %d,At EntryIndex %d"), RoadIndexes[j],
+		       IntersectionIndexes[j], EntryIndex);
+		TArray<FVector> TransitionalPoints = IntersectionGenerator->GetTransitionalPoints(EntryIndex);
+		OutLoopPath.Append(TransitionalPoints);
+		if (bEnableVisualDebug.GetValueOnGameThread())
+		{
+			for (const FVector& PathPoint : OutLoopPath)
+			{
+				DrawDebugSphere(RoadGenerator->GetWorld(), PathPoint, 100.0f, 8, DebugColor,
+				                true);
+			}
 		}
 	}
-	if (OutBlockLoops.IsValidIndex(MaxAreaIndex))
-	{
-		OutBlockLoops.RemoveAtSwap(MaxAreaIndex);
-	}
-	return;
+	return PrintStr;
 }
 
 # pragma region DOF
@@ -1677,3 +2930,5 @@ float URoadGeneratorSubsystem::GetSplineSegmentLength(const USplineComponent* Ta
 }
 */
 # pragma endregion DOF
+
+#undef LOCTEXT_NAMESPACE
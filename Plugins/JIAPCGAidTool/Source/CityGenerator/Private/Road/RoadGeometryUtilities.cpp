@@ -3,6 +3,7 @@
 
 #include "Road/RoadGeometryUtilities.h"
 #include "Components/SplineComponent.h"
+#include "Algo/BinarySearch.h"
 
 bool URoadGeometryUtilities::Get2DIntersection(const FVector2D& InSegmentAStart, const FVector2D& InSegmentAEnd,
                                                const FVector2D& InSegmentBStart, const FVector2D& InSegmentBEnd,
@@ -43,111 +44,347 @@ bool URoadGeometryUtilities::Get2DIntersection(const FVector2D& InSegmentAStart,
 	return false;
 }
 
-bool URoadGeometryUtilities::Get2DIntersection(USplineComponent* TargetSplineA, USplineComponent* TargetSplineB,
-                                               TArray<FVector2D>& IntersectionsIn2DSpace)
+int32 URoadGeometryUtilities::Get2DIntersectionBatch(const FVector2D& InSegmentAStart, const FVector2D& InSegmentAEnd,
+                                                     TConstArrayView<double> InStartX, TConstArrayView<double> InStartY,
+                                                     TConstArrayView<double> InEndX, TConstArrayView<double> InEndY,
+                                                     TArrayView<uint8> OutHitMask, TArrayView<double> OutT,
+                                                     TArrayView<double> OutS)
 {
-	TArray<FVector2D> Results;
-
-	struct FSplineBezierSegment
+	const int32 CandidateNum = InStartX.Num();
+	if (!ensureAlwaysMsgf(InStartY.Num() == CandidateNum && InEndX.Num() == CandidateNum &&
+	                      InEndY.Num() == CandidateNum && OutHitMask.Num() >= CandidateNum &&
+	                      OutT.Num() >= CandidateNum && OutS.Num() >= CandidateNum,
+	                      TEXT("Batch Intersection Array Size Mismatch")))
 	{
-	public:
-		FVector P0, P1, P2, P3;
+		return 0;
+	}
+	constexpr int32 LaneNum = 4;
+	//查询线段A的数据对所有候选相同，广播到4路
+	const VectorRegister4Double AStartX = VectorSetFloat1(InSegmentAStart.X);
+	const VectorRegister4Double AStartY = VectorSetFloat1(InSegmentAStart.Y);
+	const VectorRegister4Double VectorAX = VectorSetFloat1(InSegmentAEnd.X - InSegmentAStart.X);
+	const VectorRegister4Double VectorAY = VectorSetFloat1(InSegmentAEnd.Y - InSegmentAStart.Y);
+	const VectorRegister4Double AMinX = VectorSetFloat1(FMath::Min(InSegmentAStart.X, InSegmentAEnd.X));
+	const VectorRegister4Double AMaxX = VectorSetFloat1(FMath::Max(InSegmentAStart.X, InSegmentAEnd.X));
+	const VectorRegister4Double AMinY = VectorSetFloat1(FMath::Min(InSegmentAStart.Y, InSegmentAEnd.Y));
+	const VectorRegister4Double AMaxY = VectorSetFloat1(FMath::Max(InSegmentAStart.Y, InSegmentAEnd.Y));
+	const VectorRegister4Double ParallelThreshold = VectorSetFloat1(static_cast<double>(UE_SMALL_NUMBER));
+	const VectorRegister4Double Zero = VectorZeroDouble();
+	const VectorRegister4Double One = VectorSetFloat1(1.0);
 
-		FVector GetLocation(float InputKeyFromPreControlPoint) const
+	int32 HitNum = 0;
+	//尾部不足4条时拷贝到补零的临时缓冲，补齐的结果不写回
+	alignas(32) double TailBuffer[4][LaneNum];
+	alignas(32) double TBuffer[LaneNum];
+	alignas(32) double SBuffer[LaneNum];
+	for (int32 BaseIndex = 0; BaseIndex < CandidateNum; BaseIndex += LaneNum)
+	{
+		const int32 ValidLaneNum = FMath::Min(LaneNum, CandidateNum - BaseIndex);
+		VectorRegister4Double BStartX, BStartY, BEndX, BEndY;
+		if (ValidLaneNum == LaneNum)
+		{
+			BStartX = VectorLoad(InStartX.GetData() + BaseIndex);
+			BStartY = VectorLoad(InStartY.GetData() + BaseIndex);
+			BEndX = VectorLoad(InEndX.GetData() + BaseIndex);
+			BEndY = VectorLoad(InEndY.GetData() + BaseIndex);
+		}
+		else
 		{
-			return FMath::CubicInterp(P0, (P1 - P0) * 3.0f, P3, (P3 - P2) * 3.0f, InputKeyFromPreControlPoint);
+			FMemory::Memzero(TailBuffer);
+			for (int32 Lane = 0; Lane < ValidLaneNum; ++Lane)
+			{
+				TailBuffer[0][Lane] = InStartX[BaseIndex + Lane];
+				TailBuffer[1][Lane] = InStartY[BaseIndex + Lane];
+				TailBuffer[2][Lane] = InEndX[BaseIndex + Lane];
+				TailBuffer[3][Lane] = InEndY[BaseIndex + Lane];
+			}
+			BStartX = VectorLoadAligned(TailBuffer[0]);
+			BStartY = VectorLoadAligned(TailBuffer[1]);
+			BEndX = VectorLoadAligned(TailBuffer[2]);
+			BEndY = VectorLoadAligned(TailBuffer[3]);
 		}
+		//快速排斥测试，与标量版本的四个"<"条件取反
+		VectorRegister4Double Mask = VectorCompareGE(AMaxX, VectorMin(BStartX, BEndX));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareGE(VectorMax(BStartX, BEndX), AMinX));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareGE(AMaxY, VectorMin(BStartY, BEndY)));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareGE(VectorMax(BStartY, BEndY), AMinY));
+		//整组都被排斥时跳过求解
+		if (VectorMaskBits(Mask) == 0)
+		{
+			for (int32 Lane = 0; Lane < ValidLaneNum; ++Lane)
+			{
+				OutHitMask[BaseIndex + Lane] = 0;
+			}
+			continue;
+		}
+		const VectorRegister4Double VectorBX = VectorSubtract(BEndX, BStartX);
+		const VectorRegister4Double VectorBY = VectorSubtract(BEndY, BStartY);
+		const VectorRegister4Double VectorABStartX = VectorSubtract(BStartX, AStartX);
+		const VectorRegister4Double VectorABStartY = VectorSubtract(BStartY, AStartY);
+		//叉积，不使用VectorMultiplyAdd，避免FMA导致与标量结果不同
+		const VectorRegister4Double Denominator = VectorSubtract(VectorMultiply(VectorAX, VectorBY),
+		                                                         VectorMultiply(VectorAY, VectorBX));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareGT(VectorAbs(Denominator), ParallelThreshold));
+		const VectorRegister4Double T = VectorDivide(
+			VectorSubtract(VectorMultiply(VectorABStartX, VectorBY), VectorMultiply(VectorABStartY, VectorBX)),
+			Denominator);
+		const VectorRegister4Double S = VectorDivide(
+			VectorSubtract(VectorMultiply(VectorABStartX, VectorAY), VectorMultiply(VectorABStartY, VectorAX)),
+			Denominator);
+		//平行时除零产生的Inf/NaN比较结果为false，不会被判定为相交
+		Mask = VectorBitwiseAnd(Mask, VectorCompareGE(T, Zero));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareLE(T, One));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareGE(S, Zero));
+		Mask = VectorBitwiseAnd(Mask, VectorCompareLE(S, One));
+		const int32 MaskBits = VectorMaskBits(Mask);
+		VectorStoreAligned(T, TBuffer);
+		VectorStoreAligned(S, SBuffer);
+		for (int32 Lane = 0; Lane < ValidLaneNum; ++Lane)
+		{
+			const bool bHit = ((MaskBits >> Lane) & 1) != 0;
+			OutHitMask[BaseIndex + Lane] = bHit ? 1 : 0;
+			OutT[BaseIndex + Lane] = TBuffer[Lane];
+			OutS[BaseIndex + Lane] = SBuffer[Lane];
+			HitNum += bHit ? 1 : 0;
+		}
+	}
+	return HitNum;
+}
 
-		FVector GetDerivative(float InputKeyFromPreControlPoint) const
+bool URoadGeometryUtilities::Get2DIntersection(USplineComponent* TargetSplineA, USplineComponent* TargetSplineB,
+                                               TArray<FVector2D>& IntersectionsIn2DSpace)
+{
+	if (nullptr == TargetSplineA || nullptr == TargetSplineB)
+	{
+		return false;
+	}
+	//与旧版Newton求解器保持一致的精度和去重距离
+	constexpr double Tolerance = 0.01;
+	constexpr double DuplicateDistance = 5.0;
+	auto GetAllSegments = [](const USplineComponent* TargetSpline, TArray<FCubicBezier2D>& OutCurves,
+	                         TArray<FBox2D>& OutBounds)
+	{
+		const int32 SegmentNum = TargetSpline->GetNumberOfSplineSegments();
+		OutCurves.Reserve(SegmentNum);
+		OutBounds.Reserve(SegmentNum);
+		for (int32 i = 0; i < SegmentNum; ++i)
 		{
-			float InputKeyFromNextControlPoint = 1.0f - InputKeyFromPreControlPoint;
-			return 3.0f * InputKeyFromNextControlPoint * InputKeyFromNextControlPoint * (P1 - P0) +
-				6.0f * InputKeyFromNextControlPoint * InputKeyFromPreControlPoint * (P2 - P1) +
-				3.0f * InputKeyFromPreControlPoint * InputKeyFromPreControlPoint * (P3 - P2);
+			OutCurves.Emplace(GetSplineSegmentBezier2D(TargetSpline, i));
+			OutBounds.Emplace(OutCurves.Last().GetControlBounds().ExpandBy(Tolerance));
 		}
 	};
+	TArray<FCubicBezier2D> CurvesA, CurvesB;
+	TArray<FBox2D> BoundsA, BoundsB;
+	GetAllSegments(TargetSplineA, CurvesA, BoundsA);
+	GetAllSegments(TargetSplineB, CurvesB, BoundsB);
+	const bool bIsSameSpline = TargetSplineA == TargetSplineB;
+	//自交时相邻分段在共享端点处必然相交，按参数判定后丢弃：A的终点接B的起点，或A的起点接B的终点
+	constexpr double SharedParameterTolerance = 1e-3;
+	const int32 SegmentNum = CurvesA.Num();
+	const bool bIsClosedLoop = bIsSameSpline && TargetSplineA->IsClosedLoop();
+	auto IsSharedEndpointHit = [&](int32 SegIndexA, int32 SegIndexB, const FVector2D& Parameter)-> bool
+	{
+		const bool bBFollowsA = SegIndexB == SegIndexA + 1 || (bIsClosedLoop && SegIndexA == SegmentNum - 1 &&
+			SegIndexB == 0);
+		const bool bAFollowsB = SegIndexA == SegIndexB + 1 || (bIsClosedLoop && SegIndexB == SegmentNum - 1 &&
+			SegIndexA == 0);
+		return (bBFollowsA && Parameter.X > 1.0 - SharedParameterTolerance && Parameter.Y < SharedParameterTolerance)
+			|| (bAFollowsB && Parameter.X < SharedParameterTolerance && Parameter.Y > 1.0 - SharedParameterTolerance);
+	};
+
+	TArray<FVector2D> CandidateLocations;
+	TArray<FVector2D> Parameters;
+	for (int32 SegIndexA = 0; SegIndexA < CurvesA.Num(); ++SegIndexA)
+	{
+		for (int32 SegIndexB = 0; SegIndexB < CurvesB.Num(); ++SegIndexB)
+		{
+			//同一分段与自身处处重合
+			if (bIsSameSpline && SegIndexA == SegIndexB)
+			{
+				continue;
+			}
+			if (!BoundsA[SegIndexA].Intersect(BoundsB[SegIndexB]))
+			{
+				continue;
+			}
+			Parameters.Reset();
+			FindBezierIntersections(CurvesA[SegIndexA], CurvesB[SegIndexB], Tolerance, Parameters);
+			for (const FVector2D& Parameter : Parameters)
+			{
+				if (bIsSameSpline && IsSharedEndpointHit(SegIndexA, SegIndexB, Parameter))
+				{
+					continue;
+				}
+				CandidateLocations.Emplace(CurvesA[SegIndexA].GetLocation(Parameter.X));
+			}
+		}
+	}
+	if (CandidateLocations.IsEmpty())
+	{
+		return !IntersectionsIn2DSpace.IsEmpty();
+	}
+	//相邻分段共享端点处的交点会被重复求得，把已有结果放在前面一起聚类，每类只保留首个点
+	const int32 ExistedNum = IntersectionsIn2DSpace.Num();
+	TArray<FVector2D> AllLocations = IntersectionsIn2DSpace;
+	AllLocations.Append(CandidateLocations);
+	TArray<int32> ClusterIndices;
+	const int32 ClusterNum = ClusterPoints2D(AllLocations, DuplicateDistance, ClusterIndices);
+	TBitArray<> ClusterVisited(false, ClusterNum);
+	for (int32 i = 0; i < AllLocations.Num(); ++i)
+	{
+		if (ClusterVisited[ClusterIndices[i]])
+		{
+			continue;
+		}
+		ClusterVisited[ClusterIndices[i]] = true;
+		if (i >= ExistedNum)
+		{
+			IntersectionsIn2DSpace.Emplace(AllLocations[i]);
+		}
+	}
+	return !IntersectionsIn2DSpace.IsEmpty();
+}
+
+int32 URoadGeometryUtilities::FindBezierIntersections(const FCubicBezier2D& InCurveA, const FCubicBezier2D& InCurveB,
+                                                      double InTolerance, TArray<FVector2D>& OutParameters)
+{
+	//平直度阈值取容差的十分之一，使弦线交点足够接近真实交点，Newton只需少量迭代
+	const double FlatnessThreshold = InTolerance * 0.1;
+	//容许弦线交点略微越出端点，曲线与弦线的偏差可能使端点附近的交点落在弦线外
+	constexpr double ChordParameterMargin = 0.01;
+	//防止重合曲线等退化情况无限细分
+	constexpr int32 MaxDepth = 48;
 
-	auto Newton2DSolver = [](const FSplineBezierSegment& A, const FSplineBezierSegment& B, FVector2D Seed,
-	                         FVector2D& Intersection, float Tolerance, int32 MaxIteration)-> bool
+	auto RefineByNewton = [&InCurveA, &InCurveB, InTolerance](FVector2D& InOutParameter)-> bool
 	{
-		FVector2D ApproximateResult = Seed;
-		for (int32 i = 0; i < MaxIteration; ++i)
+		const double ToleranceSquared = InTolerance * InTolerance;
+		for (int32 i = 0; i < 16; ++i)
 		{
-			FVector LocationInA = A.GetLocation(ApproximateResult.X);
-			FVector LocationInB = B.GetLocation(ApproximateResult.Y);
-			FVector2D VectorAToB{(LocationInA - LocationInB).X, (LocationInA - LocationInB).Y};
-			if (VectorAToB.SizeSquared() < Tolerance * Tolerance)
+			const FVector2D VectorBToA = InCurveA.GetLocation(InOutParameter.X) - InCurveB.GetLocation(
+				InOutParameter.Y);
+			if (VectorBToA.SizeSquared() < ToleranceSquared)
 			{
-				Intersection = ApproximateResult;
 				return true;
 			}
-			FVector DerivativeInA = A.GetDerivative(ApproximateResult.X);
-			FVector DerivativeInB = B.GetDerivative(ApproximateResult.Y);
-			//UE不支持直接逆矩阵与向量相乘，所以构造一个矩阵意义不大
-			FMatrix2x2d Jacobian{DerivativeInA.X, -DerivativeInB.X, DerivativeInA.Y, -DerivativeInB.Y};
-			float Determinant = Jacobian.Determinant();
-			//雅可比矩阵行列式绝对值表示两条曲线速度向量形成的平行四变相面颊越大越好，值小会造成牛顿步爆炸；或者理解成矩阵可逆
-			if (FMath::Abs(Determinant) < 1e-6f)
+			const FVector2D DerivativeInA = InCurveA.GetDerivative(InOutParameter.X);
+			const FVector2D DerivativeInB = InCurveB.GetDerivative(InOutParameter.Y);
+			//雅可比矩阵为[DerivativeInA,-DerivativeInB]
+			const double Determinant = FVector2D::CrossProduct(DerivativeInB, DerivativeInA);
+			if (FMath::Abs(Determinant) < UE_DOUBLE_SMALL_NUMBER)
 			{
 				return false;
 			}
-			float InvDet = 1.0f / Determinant;
-			FVector2D Delta{
-				(-DerivativeInB.Y * VectorAToB.X - (-DerivativeInB.X) * VectorAToB.Y) * InvDet,
-				(-DerivativeInA.Y * VectorAToB.X + DerivativeInA.X * VectorAToB.Y) * InvDet
-			};
-			ApproximateResult -= Delta;
-			//Clamp在[0,1]
-			ApproximateResult.X = FMath::Clamp(ApproximateResult.X, 0.0f, 1.0f);
-			ApproximateResult.Y = FMath::Clamp(ApproximateResult.Y, 0.0f, 1.0f);
+			InOutParameter.X = FMath::Clamp(
+				InOutParameter.X - FVector2D::CrossProduct(DerivativeInB, VectorBToA) / Determinant, 0.0, 1.0);
+			InOutParameter.Y = FMath::Clamp(
+				InOutParameter.Y - FVector2D::CrossProduct(DerivativeInA, VectorBToA) / Determinant, 0.0, 1.0);
 		}
-		return false;
+		return (InCurveA.GetLocation(InOutParameter.X) - InCurveB.GetLocation(InOutParameter.Y)).SizeSquared() <
+			ToleranceSquared;
 	};
 
-	auto GetSegment = [](const USplineComponent* S, int32 Index)-> FSplineBezierSegment
-	{
-		FSplineBezierSegment Sg;
-		Sg.P0 = S->GetLocationAtSplineInputKey(Index, ESplineCoordinateSpace::World);
-		Sg.P3 = S->GetLocationAtSplineInputKey(Index + 1, ESplineCoordinateSpace::World);
-		// 切线控制点
-		Sg.P1 = Sg.P0 + S->GetTangentAtSplineInputKey(Index, ESplineCoordinateSpace::World) / 3.f;
-		Sg.P2 = Sg.P3 - S->GetTangentAtSplineInputKey(Index + 1, ESplineCoordinateSpace::World) / 3.f;
-		return Sg;
+	struct FCurvePairTask
+	{
+		FCubicBezier2D CurveA;
+		FCubicBezier2D CurveB;
+		//子曲线在原曲线上的参数区间
+		FVector2D RangeA;
+		FVector2D RangeB;
+		int32 Depth;
 	};
-
-	//Newton-Raphson求三次贝塞尔线段交点
-	const int32 NumOfSegmentA = TargetSplineA->GetNumberOfSplineSegments();
-	const int32 NumOfSegmentB = TargetSplineB->GetNumberOfSplineSegments();
-	for (int32 SegIndexA = 0; SegIndexA < NumOfSegmentA; ++SegIndexA)
+	const int32 FirstResultIndex = OutParameters.Num();
+	TArray<FCurvePairTask, TInlineAllocator<64>> TaskStack;
+	TaskStack.Add({InCurveA, InCurveB, FVector2D(0.0, 1.0), FVector2D(0.0, 1.0), 0});
+	while (!TaskStack.IsEmpty())
 	{
-		FSplineBezierSegment CurrentSegmentA = GetSegment(TargetSplineA, SegIndexA);
-		for (int32 SegIndexB = 0; SegIndexB < NumOfSegmentB; ++SegIndexB)
+		const FCurvePairTask Task = TaskStack.Pop(EAllowShrinking::No);
+		const FBox2D BoundsA = Task.CurveA.GetControlBounds();
+		const FBox2D BoundsB = Task.CurveB.GetControlBounds();
+		if (!BoundsA.ExpandBy(InTolerance).Intersect(BoundsB))
+		{
+			continue;
+		}
+		const bool bIsFlatA = Task.CurveA.GetFlatness() <= FlatnessThreshold;
+		const bool bIsFlatB = Task.CurveB.GetFlatness() <= FlatnessThreshold;
+		if ((bIsFlatA && bIsFlatB) || Task.Depth >= MaxDepth)
 		{
-			FSplineBezierSegment CurrentSegmentB = GetSegment(TargetSplineB, SegIndexB);
-			for (float SeedT = 0.05f; SeedT < 1.f; SeedT += 0.013f)
+			//弦线求交得到初值
+			const FVector2D ChordA = Task.CurveA.P3 - Task.CurveA.P0;
+			const FVector2D ChordB = Task.CurveB.P3 - Task.CurveB.P0;
+			const FVector2D ChordStartAToB = Task.CurveB.P0 - Task.CurveA.P0;
+			const double Denominator = FVector2D::CrossProduct(ChordA, ChordB);
+			if (FMath::Abs(Denominator) < UE_DOUBLE_SMALL_NUMBER)
 			{
-				for (float SeedS = 0.05f; SeedS < 1.f; SeedS += 0.017f)
+				continue;
+			}
+			const double LocalT = FVector2D::CrossProduct(ChordStartAToB, ChordB) / Denominator;
+			const double LocalS = FVector2D::CrossProduct(ChordStartAToB, ChordA) / Denominator;
+			if (LocalT < -ChordParameterMargin || LocalT > 1.0 + ChordParameterMargin ||
+				LocalS < -ChordParameterMargin || LocalS > 1.0 + ChordParameterMargin)
+			{
+				continue;
+			}
+			FVector2D Parameter(FMath::Lerp(Task.RangeA.X, Task.RangeA.Y, FMath::Clamp(LocalT, 0.0, 1.0)),
+			                    FMath::Lerp(Task.RangeB.X, Task.RangeB.Y, FMath::Clamp(LocalS, 0.0, 1.0)));
+			if (!RefineByNewton(Parameter))
+			{
+				continue;
+			}
+			//交点位于子曲线分界处时会被相邻的子曲线对重复求得
+			const FVector2D Location = InCurveA.GetLocation(Parameter.X);
+			bool bIsDuplicated = false;
+			for (int32 i = FirstResultIndex; i < OutParameters.Num(); ++i)
+			{
+				if (FVector2D::DistSquared(InCurveA.GetLocation(OutParameters[i].X), Location) <
+					4.0 * InTolerance * InTolerance)
 				{
-					FVector2D TS;
-					if (Newton2DSolver(CurrentSegmentA, CurrentSegmentB, FVector2D(SeedT, SeedS), TS, 0.01f, 100))
-					{
-						FVector2D P{CurrentSegmentA.GetLocation(TS.X).X, CurrentSegmentA.GetLocation(TS.X).Y};
-						// 去重
-						bool bNew = true;
-						for (const auto& Ex : IntersectionsIn2DSpace)
-							if (FVector2D::DistSquared(Ex, P) < 25.f)
-							{
-								bNew = false;
-								break;
-							}
-						if (bNew)
-							IntersectionsIn2DSpace.Emplace(P);
-					}
+					bIsDuplicated = true;
+					break;
 				}
 			}
+			if (!bIsDuplicated)
+			{
+				OutParameters.Emplace(Parameter);
+			}
+			continue;
+		}
+		//优先细分不平直且包围盒更大的一方
+		const bool bSplitA = bIsFlatB || (!bIsFlatA && BoundsA.GetSize().X + BoundsA.GetSize().Y >=
+			BoundsB.GetSize().X + BoundsB.GetSize().Y);
+		FCubicBezier2D Left, Right;
+		if (bSplitA)
+		{
+			Task.CurveA.SubdivideAtHalf(Left, Right);
+			const double Middle = (Task.RangeA.X + Task.RangeA.Y) * 0.5;
+			TaskStack.Add({Left, Task.CurveB, FVector2D(Task.RangeA.X, Middle), Task.RangeB, Task.Depth + 1});
+			TaskStack.Add({Right, Task.CurveB, FVector2D(Middle, Task.RangeA.Y), Task.RangeB, Task.Depth + 1});
+		}
+		else
+		{
+			Task.CurveB.SubdivideAtHalf(Left, Right);
+			const double Middle = (Task.RangeB.X + Task.RangeB.Y) * 0.5;
+			TaskStack.Add({Task.CurveA, Left, Task.RangeA, FVector2D(Task.RangeB.X, Middle), Task.Depth + 1});
+			TaskStack.Add({Task.CurveA, Right, Task.RangeA, FVector2D(Middle, Task.RangeB.Y), Task.Depth + 1});
 		}
 	}
-	return !IntersectionsIn2DSpace.IsEmpty();
+	return OutParameters.Num() - FirstResultIndex;
+}
+
+FCubicBezier2D URoadGeometryUtilities::GetSplineSegmentBezier2D(const USplineComponent* TargetSpline,
+                                                                int32 SegmentIndex)
+{
+	const FVector2D Start(TargetSpline->GetLocationAtSplinePoint(SegmentIndex, ESplineCoordinateSpace::World));
+	const FVector2D End(TargetSpline->GetLocationAtSplinePoint(SegmentIndex + 1, ESplineCoordinateSpace::World));
+	if (TargetSpline->GetSplinePointType(SegmentIndex) == ESplinePointType::Linear)
+	{
+		return FCubicBezier2D(Start, FMath::Lerp(Start, End, 1.0 / 3.0), FMath::Lerp(Start, End, 2.0 / 3.0), End);
+	}
+	//Hermite切线换算为贝塞尔控制点
+	const FVector2D LeaveTangent(
+		TargetSpline->GetLeaveTangentAtSplinePoint(SegmentIndex, ESplineCoordinateSpace::World));
+	const FVector2D ArriveTangent(
+		TargetSpline->GetArriveTangentAtSplinePoint(SegmentIndex + 1, ESplineCoordinateSpace::World));
+	return FCubicBezier2D(Start, Start + LeaveTangent / 3.0, End - ArriveTangent / 3.0, End);
 }
 
 void URoadGeometryUtilities::SortPointClockwise(const FVector2D& Center, TArray<FVector2D>& ArrayToSort)
@@ -269,6 +506,52 @@ void URoadGeometryUtilities::SimplifySplinePointsInline(TArray<FVector>& SplineP
 	SplinePoints = MoveTemp(PointsAfterAngleSimplification);
 }
 
+void URoadGeometryUtilities::SimplifySweepPathIndices(TConstArrayView<FTransform> InPath, double ChordError,
+                                                      float AngleThreshold, TArray<int32>& OutKeptIndices)
+{
+	OutKeptIndices.Reset();
+	const int32 PathNum = InPath.Num();
+	if (PathNum < 3)
+	{
+		for (int32 i = 0; i < PathNum; ++i)
+		{
+			OutKeptIndices.Emplace(i);
+		}
+		return;
+	}
+	//与SimplifySplinePointsInline相同，传入角度的Sin值作为IsParallel阈值
+	const double ParallelThreshold = FMath::Sin(FMath::DegreesToRadians(AngleThreshold));
+	const double ChordErrorSquared = ChordError * ChordError;
+	//从锚点向后贪心延伸弦，弦无法再延伸时保留上一个终点作为新锚点
+	OutKeptIndices.Emplace(0);
+	int32 AnchorIndex = 0;
+	int32 EndIndex = 1;
+	while (EndIndex < PathNum - 1)
+	{
+		const int32 NextIndex = EndIndex + 1;
+		const FVector AnchorLocation = InPath[AnchorIndex].GetLocation();
+		const FVector NextLocation = InPath[NextIndex].GetLocation();
+		bool bCanExtend =
+			IsParallel(AnchorLocation, NextLocation, AnchorLocation,
+			           AnchorLocation + InPath[AnchorIndex].GetRotation().GetForwardVector(), false,
+			           ParallelThreshold) &&
+			IsParallel(AnchorLocation, NextLocation, NextLocation,
+			           NextLocation + InPath[NextIndex].GetRotation().GetForwardVector(), false, ParallelThreshold);
+		for (int32 i = AnchorIndex + 1; bCanExtend && i < NextIndex; ++i)
+		{
+			bCanExtend = FMath::PointDistToSegmentSquared(InPath[i].GetLocation(), AnchorLocation, NextLocation) <=
+				ChordErrorSquared;
+		}
+		if (!bCanExtend)
+		{
+			OutKeptIndices.Emplace(EndIndex);
+			AnchorIndex = EndIndex;
+		}
+		EndIndex = NextIndex;
+	}
+	OutKeptIndices.Emplace(PathNum - 1);
+}
+
 void URoadGeometryUtilities::ShrinkLoopSpline(const USplineComponent* TargetSpline, float ShrinkValue)
 {
 	//主要问题在于如何定义收缩
@@ -415,4 +698,306 @@ void URoadGeometryUtilities::ResolveTwistySplineSegments(USplineComponent* Targe
 		}
 	}
 	TargetSpline->UpdateSpline();
-}
\ No newline at end of file
+}
+
+int32 URoadGeometryUtilities::ClusterPoints2D(const TArray<FVector2D>& InPoints, double InMergeDistance,
+                                              TArray<int32>& OutClusterIndices)
+{
+	const int32 PointNum = InPoints.Num();
+	OutClusterIndices.Reset();
+	OutClusterIndices.SetNumUninitialized(PointNum);
+	if (PointNum == 0)
+	{
+		return 0;
+	}
+	const double CellSize = FMath::Max(InMergeDistance, UE_DOUBLE_KINDA_SMALL_NUMBER);
+	const double MergeDistanceSquared = InMergeDistance * InMergeDistance;
+	//并查集，始终以较小下标作为根，使根即为该类最小下标
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(PointNum);
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		Parents[i] = i;
+	}
+	auto FindRoot = [&Parents](int32 Index)-> int32
+	{
+		while (Parents[Index] != Index)
+		{
+			//路径减半
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	};
+	auto GetCellCoord = [CellSize](const FVector2D& Point)-> FIntPoint
+	{
+		return FIntPoint(FMath::FloorToInt32(Point.X / CellSize), FMath::FloorToInt32(Point.Y / CellSize));
+	};
+	//网格->落在该网格内的点下标
+	TMap<FIntPoint, TArray<int32>> Cells;
+	Cells.Reserve(PointNum);
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		const FIntPoint CellCoord = GetCellCoord(InPoints[i]);
+		//只需要与已经入格的点比较，每对点只检查一次
+		for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+		{
+			for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+			{
+				const TArray<int32>* NeighbourPoints = Cells.Find(CellCoord + FIntPoint(OffsetX, OffsetY));
+				if (nullptr == NeighbourPoints)
+				{
+					continue;
+				}
+				for (const int32 NeighbourIndex : *NeighbourPoints)
+				{
+					if (FVector2D::DistSquared(InPoints[i], InPoints[NeighbourIndex]) >= MergeDistanceSquared)
+					{
+						continue;
+					}
+					const int32 RootA = FindRoot(i);
+					const int32 RootB = FindRoot(NeighbourIndex);
+					if (RootA != RootB)
+					{
+						Parents[FMath::Max(RootA, RootB)] = FMath::Min(RootA, RootB);
+					}
+				}
+			}
+		}
+		Cells.FindOrAdd(CellCoord).Emplace(i);
+	}
+	//根按下标升序首次出现，据此分配连续编号
+	TArray<int32> RootToCluster;
+	RootToCluster.Init(INDEX_NONE, PointNum);
+	int32 ClusterNum = 0;
+	for (int32 i = 0; i < PointNum; ++i)
+	{
+		const int32 Root = FindRoot(i);
+		if (RootToCluster[Root] == INDEX_NONE)
+		{
+			RootToCluster[Root] = ClusterNum++;
+		}
+		OutClusterIndices[i] = RootToCluster[Root];
+	}
+	return ClusterNum;
+}
+
+void URoadGeometryUtilities::FindSegmentIntersectionsBySweepLine(const TArray<FVector2D>& InSegmentStarts,
+                                                                 const TArray<FVector2D>& InSegmentEnds,
+                                                                 TFunctionRef<bool(int32, int32)> InShouldSkipPair,
+                                                                 TArray<TPair<int32, int32>>& OutIntersectedPairs)
+{
+	OutIntersectedPairs.Reset();
+	if (!ensureAlwaysMsgf(InSegmentStarts.Num() == InSegmentEnds.Num(), TEXT("Segment Start/End Count Mismatch")))
+	{
+		return;
+	}
+	//坐标单位为cm，位置重合、位于线段上均使用该容差判断
+	constexpr double SweepTolerance = 1e-3;
+	const int32 SegmentNum = InSegmentStarts.Num();
+	//统一线段方向，Left为扫描先到达的端点（X较小，X相同时Y较小）
+	TArray<FVector2D> LeftPoints;
+	TArray<FVector2D> RightPoints;
+	LeftPoints.SetNumUninitialized(SegmentNum);
+	RightPoints.SetNumUninitialized(SegmentNum);
+	auto IsPointBefore = [](const FVector2D& A, const FVector2D& B)-> bool
+	{
+		return A.X < B.X || (A.X == B.X && A.Y < B.Y);
+	};
+	//事件，StartSegment有效时为线段左端点事件，否则为右端点或交点事件，所需线段由状态结构中查找
+	struct FSweepEvent
+	{
+		FVector2D Point = FVector2D::ZeroVector;
+		int32 StartSegment = INDEX_NONE;
+	};
+	auto EventPredicate = [&IsPointBefore](const FSweepEvent& A, const FSweepEvent& B)-> bool
+	{
+		return IsPointBefore(A.Point, B.Point);
+	};
+	TArray<FSweepEvent> EventHeap;
+	EventHeap.Reserve(SegmentNum * 2);
+	for (int32 i = 0; i < SegmentNum; ++i)
+	{
+		const bool bStartFirst = IsPointBefore(InSegmentStarts[i], InSegmentEnds[i]);
+		LeftPoints[i] = bStartFirst ? InSegmentStarts[i] : InSegmentEnds[i];
+		RightPoints[i] = bStartFirst ? InSegmentEnds[i] : InSegmentStarts[i];
+		if (LeftPoints[i].Equals(RightPoints[i], SweepTolerance))
+		{
+			continue;
+		}
+		EventHeap.Add(FSweepEvent{LeftPoints[i], i});
+		EventHeap.Add(FSweepEvent{RightPoints[i], INDEX_NONE});
+	}
+	EventHeap.Heapify(EventPredicate);
+
+	//当前扫描点，状态结构中线段的排序键为线段在SweepPoint.X处的Y值
+	FVector2D SweepPoint = FVector2D::ZeroVector;
+	auto GetSweepKey = [&](int32 SegmentIndex)-> double
+	{
+		const FVector2D& Left = LeftPoints[SegmentIndex];
+		const FVector2D& Right = RightPoints[SegmentIndex];
+		const double DeltaX = Right.X - Left.X;
+		//竖直线段覆盖一段Y区间，取扫描点Y在区间内的投影
+		if (DeltaX <= SweepTolerance)
+		{
+			return FMath::Clamp(SweepPoint.Y, Left.Y, Right.Y);
+		}
+		const double Alpha = FMath::Clamp((SweepPoint.X - Left.X) / DeltaX, 0.0, 1.0);
+		return Left.Y + (Right.Y - Left.Y) * Alpha;
+	};
+	//经过同一点的线段在该点右侧的上下顺序由方向角决定，竖直线段位于最上方
+	auto GetDirectionAngle = [&](int32 SegmentIndex)-> double
+	{
+		const FVector2D Direction = RightPoints[SegmentIndex] - LeftPoints[SegmentIndex];
+		return FMath::Atan2(Direction.Y, FMath::Max(Direction.X, 0.0));
+	};
+	//扫描线状态，自下而上排列
+	TArray<int32> SweepStatus;
+	//已输出线段对，同一对可能在多个事件点被发现（共线重叠、重复交点事件）
+	TSet<uint64> ReportedPairs;
+	//已加入交点事件的线段对
+	TSet<uint64> ScheduledPairs;
+	auto ReportPair = [&](int32 IndexA, int32 IndexB)
+	{
+		if (IndexA > IndexB)
+		{
+			Swap(IndexA, IndexB);
+		}
+		const uint64 PairKey = (static_cast<uint64>(IndexA) << 32) | static_cast<uint64>(IndexB);
+		if (ReportedPairs.Contains(PairKey) || InShouldSkipPair(IndexA, IndexB))
+		{
+			return;
+		}
+		ReportedPairs.Emplace(PairKey);
+		FVector2D Intersection;
+		if (Get2DIntersection(InSegmentStarts[IndexA], InSegmentEnds[IndexA], InSegmentStarts[IndexB],
+		                      InSegmentEnds[IndexB], Intersection))
+		{
+			OutIntersectedPairs.Emplace(IndexA, IndexB);
+		}
+	};
+	//相邻线段若在当前事件点之后相交，加入交点事件
+	//Get2DIntersection内部参数为float精度，大坐标下交点误差可能超过容差导致事件点找不到对应线段，这里使用双精度单独求解
+	auto CheckNewEvent = [&](int32 IndexBelow, int32 IndexAbove)
+	{
+		const FVector2D VectorA = RightPoints[IndexBelow] - LeftPoints[IndexBelow];
+		const FVector2D VectorB = RightPoints[IndexAbove] - LeftPoints[IndexAbove];
+		const double Denominator = FVector2D::CrossProduct(VectorA, VectorB);
+		if (FMath::IsNearlyZero(Denominator, UE_DOUBLE_SMALL_NUMBER))
+		{
+			return;
+		}
+		const FVector2D VectorABStart = LeftPoints[IndexAbove] - LeftPoints[IndexBelow];
+		const double T = FVector2D::CrossProduct(VectorABStart, VectorB) / Denominator;
+		const double S = FVector2D::CrossProduct(VectorABStart, VectorA) / Denominator;
+		if (T < 0.0 || T > 1.0 || S < 0.0 || S > 1.0)
+		{
+			return;
+		}
+		FVector2D Intersection = LeftPoints[IndexBelow] + T * VectorA;
+		//交点位于端点时吸附到端点，使其与端点事件严格相等，避免被X相同的其他事件隔开导致同一位置的事件分两次处理
+		for (const FVector2D& EndPoint : {
+			     LeftPoints[IndexBelow], RightPoints[IndexBelow], LeftPoints[IndexAbove], RightPoints[IndexAbove]
+		     })
+		{
+			if (Intersection.Equals(EndPoint, SweepTolerance))
+			{
+				Intersection = EndPoint;
+				break;
+			}
+		}
+		//陡峭线段在容差范围内的Y差值可能很大，不能以容差判断是否已处理，只要严格位于扫描点之后就加入事件
+		//同一线段对只加入一次事件，保证浮点误差下不会反复交换
+		if (!IsPointBefore(SweepPoint, Intersection))
+		{
+			return;
+		}
+		const uint64 PairKey = IndexBelow < IndexAbove
+			                       ? (static_cast<uint64>(IndexBelow) << 32) | static_cast<uint64>(IndexAbove)
+			                       : (static_cast<uint64>(IndexAbove) << 32) | static_cast<uint64>(IndexBelow);
+		if (!ScheduledPairs.Contains(PairKey))
+		{
+			ScheduledPairs.Emplace(PairKey);
+			EventHeap.HeapPush(FSweepEvent{Intersection, INDEX_NONE}, EventPredicate);
+		}
+	};
+
+	TArray<int32> UpperSegments;
+	TArray<int32> ThroughSegments;
+	while (!EventHeap.IsEmpty())
+	{
+		FSweepEvent Event;
+		EventHeap.HeapPop(Event, EventPredicate, EAllowShrinking::No);
+		SweepPoint = Event.Point;
+		//收集同一位置的全部事件，U(p):以该点为左端点的线段
+		UpperSegments.Reset();
+		if (Event.StartSegment != INDEX_NONE)
+		{
+			UpperSegments.Emplace(Event.StartSegment);
+		}
+		while (!EventHeap.IsEmpty() && EventHeap.HeapTop().Point.Equals(SweepPoint, SweepTolerance))
+		{
+			EventHeap.HeapPop(Event, EventPredicate, EAllowShrinking::No);
+			if (Event.StartSegment != INDEX_NONE)
+			{
+				UpperSegments.Emplace(Event.StartSegment);
+			}
+		}
+		//状态结构中经过该点的线段在数组中连续，L(p)∪C(p)
+		int32 RangeBegin = Algo::LowerBoundBy(SweepStatus, SweepPoint.Y - SweepTolerance, GetSweepKey);
+		int32 RangeEnd = RangeBegin;
+		while (RangeEnd < SweepStatus.Num() && GetSweepKey(SweepStatus[RangeEnd]) <= SweepPoint.Y + SweepTolerance)
+		{
+			++RangeEnd;
+		}
+		ThroughSegments.Reset();
+		ThroughSegments.Append(UpperSegments);
+		for (int32 i = RangeBegin; i < RangeEnd; ++i)
+		{
+			ThroughSegments.Emplace(SweepStatus[i]);
+		}
+		//经过同一点的线段两两相交
+		for (int32 i = 0; i < ThroughSegments.Num(); ++i)
+		{
+			for (int32 j = i + 1; j < ThroughSegments.Num(); ++j)
+			{
+				ReportPair(ThroughSegments[i], ThroughSegments[j]);
+			}
+		}
+		//删除L(p)∪C(p)，重新按方向角插入U(p)∪C(p)，相当于交换经过该点的线段次序
+		ThroughSegments.Reset();
+		ThroughSegments.Append(UpperSegments);
+		for (int32 i = RangeBegin; i < RangeEnd; ++i)
+		{
+			if (!RightPoints[SweepStatus[i]].Equals(SweepPoint, SweepTolerance))
+			{
+				ThroughSegments.Emplace(SweepStatus[i]);
+			}
+		}
+		SweepStatus.RemoveAt(RangeBegin, RangeEnd - RangeBegin, EAllowShrinking::No);
+		ThroughSegments.Sort([&GetDirectionAngle](int32 A, int32 B)
+		{
+			const double AngleA = GetDirectionAngle(A);
+			const double AngleB = GetDirectionAngle(B);
+			return AngleA == AngleB ? A < B : AngleA < AngleB;
+		});
+		SweepStatus.Insert(ThroughSegments, RangeBegin);
+		if (ThroughSegments.IsEmpty())
+		{
+			if (RangeBegin > 0 && RangeBegin < SweepStatus.Num())
+			{
+				CheckNewEvent(SweepStatus[RangeBegin - 1], SweepStatus[RangeBegin]);
+			}
+			continue;
+		}
+		if (RangeBegin > 0)
+		{
+			CheckNewEvent(SweepStatus[RangeBegin - 1], SweepStatus[RangeBegin]);
+		}
+		const int32 HighestIndex = RangeBegin + ThroughSegments.Num() - 1;
+		if (HighestIndex + 1 < SweepStatus.Num())
+		{
+			CheckNewEvent(SweepStatus[HighestIndex], SweepStatus[HighestIndex + 1]);
+		}
+	}
+}
@@ -23,35 +23,49 @@ void URoadGraph::AddEdge(int32 FromNodeIndex, int32 ToNodeIndex, int32 EdgeIndex
 			Graph.SetNum(FromNodeIndex + 1);
 		}
 	}
-	Graph[FromNodeIndex].Emplace(FRoadEdge(ToNodeIndex, EdgeIndex));
+	Graph[FromNodeIndex].Emplace(FRoadGraphEdge(ToNodeIndex, EdgeIndex));
 	EdgeCount++;
 }
 
 void URoadGraph::AddEdgeInGivenSlot(int32 FromNodeIndex, int32 ToNodeIndex, int32 EdgeIndex, int32 SlotIndexOfFromNode)
 {
-	if (FromNodeIndex == INT32_ERROR || ToNodeIndex == INT32_ERROR || SlotIndexOfFromNode < 0)
+	if (AddEdgeInGivenSlot(Graph, FromNodeIndex, ToNodeIndex, EdgeIndex, SlotIndexOfFromNode))
 	{
-		return;
+		EdgeCount++;
 	}
+}
 
-	if (!Graph.IsValidIndex(FromNodeIndex))
+bool URoadGraph::AddEdgeInGivenSlot(TArray<TArray<FRoadGraphEdge>>& InOutGraph, int32 FromNodeIndex,
+                                    int32 ToNodeIndex, int32 EdgeIndex, int32 SlotIndexOfFromNode)
+{
+	if (FromNodeIndex == INT32_ERROR || ToNodeIndex == INT32_ERROR || SlotIndexOfFromNode < 0 ||
+		SlotIndexOfFromNode == INT32_ERROR)
 	{
-		if (FromNodeIndex > Graph.Num() - 1)
+		return false;
+	}
+
+	if (!InOutGraph.IsValidIndex(FromNodeIndex))
+	{
+		if (FromNodeIndex > InOutGraph.Num() - 1)
 		{
-			Graph.SetNum(FromNodeIndex + 1);
+			InOutGraph.SetNum(FromNodeIndex + 1);
 		}
 	}
-	if (!Graph[FromNodeIndex].IsValidIndex(SlotIndexOfFromNode))
+	if (!InOutGraph[FromNodeIndex].IsValidIndex(SlotIndexOfFromNode))
 	{
-		Graph[FromNodeIndex].SetNum(SlotIndexOfFromNode + 1);
+		InOutGraph[FromNodeIndex].SetNum(SlotIndexOfFromNode + 1);
 	}
-	Graph[FromNodeIndex][SlotIndexOfFromNode] = FRoadEdge(ToNodeIndex, EdgeIndex);
-	EdgeCount++;
+	InOutGraph[FromNodeIndex][SlotIndexOfFromNode] = FRoadGraphEdge(ToNodeIndex, EdgeIndex);
+	return true;
 }
 
 void URoadGraph::RemoveEdge(int32 FromNodeIndex, int32 ToNodeIndex, int32 RoadIndex)
 {
-	TArray<FRoadEdge>& AllConnectedNodes = Graph[FromNodeIndex];
+	if (!Graph.IsValidIndex(FromNodeIndex))
+	{
+		return;
+	}
+	TArray<FRoadGraphEdge>& AllConnectedNodes = Graph[FromNodeIndex];
 	for (int32 i = 0; i < AllConnectedNodes.Num(); ++i)
 	{
 		if (AllConnectedNodes[i].ToNodeIndex == ToNodeIndex)
@@ -84,7 +98,7 @@ void URoadGraph::RemoveEdge(int32 FromNodeIndex, int32 ToNodeIndex, int32 RoadIn
 
 void URoadGraph::RemoveAllEdges()
 {
-	for (TArray<FRoadEdge>& NeighborOfNode : Graph)
+	for (TArray<FRoadGraphEdge>& NeighborOfNode : Graph)
 	{
 		NeighborOfNode.Empty();
 	}
@@ -92,7 +106,7 @@ void URoadGraph::RemoveAllEdges()
 
 bool URoadGraph::HasEdge(int32 FromNodeIndex, int32 ToNodeIndex) const
 {
-	const TArray<FRoadEdge>& AllConnectedNodes = Graph[FromNodeIndex];
+	const TArray<FRoadGraphEdge>& AllConnectedNodes = Graph[FromNodeIndex];
 	for (int32 i = 0; i < AllConnectedNodes.Num(); ++i)
 	{
 		if (AllConnectedNodes[i].ToNodeIndex == ToNodeIndex && AllConnectedNodes[i].RoadIndex != INT32_ERROR)
@@ -134,84 +148,77 @@ void URoadGraph::PrintConnectionToLog()
 	UE_LOG(LogTemp, Display, TEXT("Print Graph Connections Finished"));
 }
 
-TArray<FBlockLinkInfo> URoadGraph::GetSurfaceInGraph()
+TArray<FBlockLinkInfo> URoadGraph::GetSurfaceInGraph() const
+{
+	return FindSurfaces(Graph);
+}
+
+TArray<FBlockLinkInfo> URoadGraph::FindSurfaces(const TArray<TArray<FRoadGraphEdge>>& InGraph)
 {
 	TArray<FBlockLinkInfo> Results;
-	if (Graph.IsEmpty())
+	//半边以(节点,槽位)表示，RoadIndex可能不连续，不能直接用作备忘录下标
+	TArray<TBitArray<>> bVisited;
+	bVisited.SetNum(InGraph.Num());
+	for (int32 i = 0; i < InGraph.Num(); ++i)
 	{
-		return Results;
+		bVisited[i].Init(false, InGraph[i].Num());
 	}
-
-	//二维表转一维表用于和bVisited形成对应；但因为RoadIndex可以删除数组可能不连贯
-	//不能直接使用RoadIndex作为数组ID，可能开头不为0、可能不连贯、双向无法区分
-	//设计一个编码算法节点A->B，当A<B时返回2I；当A>B时返回2I+1，为了能拿到节点需要从节点开始遍历
-	TArray<FRoadEdge*> AllEdges;
-	TMap<int32, bool> bVisited;
-	bVisited.Reserve(EdgeCount);
-	//因为边数据中没有保存FromVertex，利用数组有序特性先记录这个值
-	int32 FromVertex = INT32_ERROR;
-	for (int32 i = 0; i < Graph.Num(); ++i)
+	for (int32 StartNode = 0; StartNode < InGraph.Num(); ++StartNode)
 	{
-		for (auto& Edge : Graph[i])
+		for (int32 StartSlot = 0; StartSlot < InGraph[StartNode].Num(); ++StartSlot)
 		{
-			if (FromVertex == INT32_ERROR)
+			//RemoveEdge留下的空位，保留是为了不改变其他边的EntryIndex
+			if (InGraph[StartNode][StartSlot].RoadIndex == INT32_ERROR || bVisited[StartNode][StartSlot])
 			{
-				FromVertex = i;
+				continue;
 			}
-			bVisited.Emplace(GetDirectionalEdgeIndex(i, Edge.ToNodeIndex, Edge.RoadIndex), false);
-			AllEdges.Emplace(&Edge);
-		}
-	}
-	//DFS搜索，备忘录剪枝
-	for (int i = 0; i < AllEdges.Num(); ++i)
-	{
-		int32 TargetEdgeIndex = GetDirectionalEdgeIndex(FromVertex, AllEdges[i]->ToNodeIndex, AllEdges[i]->RoadIndex);
-		if (bVisited[TargetEdgeIndex])
-		{
-			continue;
-		}
-		bVisited[TargetEdgeIndex] = true;
-		FBlockLinkInfo Surface;
-		Surface.RoadIndexes.Emplace(AllEdges[i]->RoadIndex);
-		const FRoadEdge* CurrentRoad = AllEdges[i];
-		const FRoadEdge* NextRoad = nullptr;
-		while (NextRoad != AllEdges[i])
-		{
-			if (nullptr != NextRoad)
+			FBlockLinkInfo Surface;
+			int32 CurrentNode = StartNode;
+			int32 CurrentSlot = StartSlot;
+			bool bClosed = false;
+			while (!bVisited[CurrentNode][CurrentSlot])
 			{
-				Surface.RoadIndexes.Emplace(NextRoad->RoadIndex);
-				TargetEdgeIndex = GetDirectionalEdgeIndex(FromVertex, NextRoad->ToNodeIndex, NextRoad->RoadIndex);
-				bVisited[TargetEdgeIndex] = true;
+				bVisited[CurrentNode][CurrentSlot] = true;
+				const FRoadGraphEdge& Edge = InGraph[CurrentNode][CurrentSlot];
+				Surface.RoadIndexes.Emplace(Edge.RoadIndex);
+				Surface.IntersectionIndexes.Emplace(Edge.ToNodeIndex);
+				if (!InGraph.IsValidIndex(Edge.ToNodeIndex))
+				{
+					break;
+				}
+				//沿道路进入下一节点时所在的槽位，与FindEdgeEntryIndex相同
+				const TArray<FRoadGraphEdge>& NextEdges = InGraph[Edge.ToNodeIndex];
+				const int32 EntrySlot = NextEdges.IndexOfByPredicate([&Edge, CurrentNode](const FRoadGraphEdge& NextEdge)
+				{
+					return NextEdge.RoadIndex == Edge.RoadIndex && NextEdge.ToNodeIndex == CurrentNode;
+				});
+				if (EntrySlot == INDEX_NONE)
+				{
+					break;
+				}
+				//跳过无效边，入口槽位本身有效，最多绕一圈
+				int32 NextSlot = (EntrySlot + 1) % NextEdges.Num();
+				while (NextEdges[NextSlot].RoadIndex == INT32_ERROR)
+				{
+					NextSlot = (NextSlot + 1) % NextEdges.Num();
+				}
+				CurrentNode = Edge.ToNodeIndex;
+				CurrentSlot = NextSlot;
+				if (CurrentNode == StartNode && CurrentSlot == StartSlot)
+				{
+					bClosed = true;
+					break;
+				}
+			}
+			if (bClosed && Surface.RoadIndexes.Num() >= 2)
+			{
+				Results.Emplace(MoveTemp(Surface));
 			}
-			int32 NextVertex = CurrentRoad->ToNodeIndex;
-			Surface.IntersectionIndexes.Emplace(NextVertex);
-			NextRoad = FindNextEdge(NextVertex, *CurrentRoad);
-			CurrentRoad = NextRoad;
-			FromVertex = NextVertex;
-		}
-		if (Surface.RoadIndexes.Num() >= 2)
-		{
-			Results.Emplace(Surface);
 		}
 	}
 	return Results;
 }
 
-
-URoadGraph::FRoadEdge* URoadGraph::FindNextEdge(int32 NodeIndex, const FRoadEdge& CurrentEdgeIndex)
-{
-	const int32 NeighboursCount = Graph[NodeIndex].Num();
-	int32 i = 0;
-	for (; i < NeighboursCount; ++i)
-	{
-		if (Graph[NodeIndex][i].RoadIndex == CurrentEdgeIndex.RoadIndex)
-		{
-			break;
-		}
-	}
-	return &Graph[NodeIndex][(i + 1) % NeighboursCount];
-}
-
 int32 URoadGraph::FindEdgeEntryIndex(int32 CurrentNodeIndex, int32 FromNodeIndex, int32 EdgeIndex) const
 {
 	if (!Graph.IsValidIndex(CurrentNodeIndex))
@@ -232,12 +239,3 @@ int32 URoadGraph::FindEdgeEntryIndex(int32 CurrentNodeIndex, int32 FromNodeIndex
 	}
 	return INT32_ERROR;
 }
-
-int32 URoadGraph::GetDirectionalEdgeIndex(int32 FromNodeIndex, int32 ToNodeIndex, int32 RoadIndex)
-{
-	if (FromNodeIndex < ToNodeIndex)
-	{
-		return 2 * RoadIndex;
-	}
-	return 2 * RoadIndex + 1;
-}
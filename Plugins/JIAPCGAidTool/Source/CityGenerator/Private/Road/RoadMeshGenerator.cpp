@@ -4,14 +4,34 @@
 #include "Road/RoadMeshGenerator.h"
 
 #include "NotifyUtilities.h"
+#include "UDynamicMesh.h"
 #include "Components/DynamicMeshComponent.h"
 #include "Components/SplineComponent.h"
 #include "GeometryScript/MeshMaterialFunctions.h"
 #include "GeometryScript/MeshNormalsFunctions.h"
 #include "GeometryScript/MeshPrimitiveFunctions.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Road/RoadGeometryUtilities.h"
+#include "Road/RoadSweepBuilder.h"
+#include "Road/SplineCursorEvaluator.h"
 #include "Subsystems/EditorAssetSubsystem.h"
 
+static TAutoConsoleVariable<bool> CVarNativeSweep(
+	TEXT("CityGenerator.Road.NativeSweep"), true,
+	TEXT("Build Road Sweep Directly Into FDynamicMesh3 With Analytic Normals,Set To False To Use AppendSweepPolygon For A/B Comparison"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarLaneProfile(
+	TEXT("CityGenerator.Road.LaneProfile"), true,
+	TEXT("Sweep Roads With Cached Lane/Curb/Sidewalk Profile Of Road Type,Set To False To Sweep Plain Rectangle For A/B Comparison"),
+	ECVF_Default);
+static TAutoConsoleVariable<int32> CVarRoadLODNum(
+	TEXT("CityGenerator.Road.LODNum"), 3,
+	TEXT("LOD Count Of Road Meshes Including LOD0,1 Disables Road LOD"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarRoadLODChordError(
+	TEXT("CityGenerator.Road.LODChordError"), 25.0f,
+	TEXT("Max Chord Error(cm) Of LOD1 Sweep Path,Each Coarser LOD Multiplies It By 4"), ECVF_Default);
+
 int32 URoadMeshGenerator::RoadGlobalIndex = -1;
 // Sets default values for this component's properties
 URoadMeshGenerator::URoadMeshGenerator()
@@ -67,6 +87,7 @@ void URoadMeshGenerator::SetRoadType(ELaneType InRoadType)
 		RoadInfo = FLaneMeshInfo(500.0f);
 		break;
 	}
+	RoadInfo.LaneType = InRoadType;
 }
 
 void URoadMeshGenerator::SetRoadInfo(const FRoadSegmentsGroup& InRoadWithConnect)
@@ -89,7 +110,18 @@ void URoadMeshGenerator::SetRoadInfo(const FRoadSegmentsGroup& InRoadWithConnect
 	EndToIntersectionIndex = InRoadWithConnect.ToIntersectionIndex;
 }
 
-bool URoadMeshGenerator::GenerateMesh()
+void URoadMeshGenerator::ResetForRegenerate()
+{
+	IMeshGeneratorInterface::ResetForRegenerate();
+	SweepPointsTrans.Reset();
+	LODMeshes.Reset();
+	DisplayedLOD = 0;
+	bIsLocalSpace = false;
+	StartToIntersectionIndex = INT32_ERROR;
+	EndToIntersectionIndex = INT32_ERROR;
+}
+
+bool URoadMeshGenerator::PrepareBuild()
 {
 	AActor* Owner = GetOwner();
 	ensureAlwaysMsgf(nullptr!=Owner, TEXT("Component Has No Owner"));
@@ -107,10 +139,7 @@ bool URoadMeshGenerator::GenerateMesh()
 				TEXT("[ERROR]%s Create Intersection Failed,Null MeshComp Found!"), *Owner->GetActorLabel()));
 		return false;
 	}
-	UDynamicMeshComponent* MeshComponentPtr = MeshComponent.Pin().Get();
-
-	TArray<FVector2D> SweepShape = RoadInfo.CrossSectionCoord;
-	if (SweepShape.IsEmpty())
+	if (RoadInfo.CrossSectionCoord.IsEmpty())
 	{
 		UNotifyUtilities::ShowPopupMsgAtCorner(
 			FString::Printf(
@@ -122,20 +151,143 @@ bool URoadMeshGenerator::GenerateMesh()
 	{
 		ConvertPointToLocalSpace(Owner->GetTransform());
 	}
+	if (nullptr == Material)
+	{
+		InitialMaterials();
+	}
+	bUseNativeSweep = CVarNativeSweep.GetValueOnGameThread();
+	ProfileTemplate.Reset();
+	if (bUseNativeSweep && CVarLaneProfile.GetValueOnGameThread())
+	{
+		ProfileTemplate = FRoadProfileLibrary::GetTemplate(RoadInfo.LaneType);
+	}
+	RequestedLODNum = FMath::Clamp(CVarRoadLODNum.GetValueOnGameThread(), 1, 8);
+	LODChordError = FMath::Max(1.0f, CVarRoadLODChordError.GetValueOnGameThread());
+	if (!bUseNativeSweep && nullptr == BuildScratchMesh)
+	{
+		BuildScratchMesh = NewObject<UDynamicMesh>(this, NAME_None, RF_Transient);
+	}
+	return true;
+}
+
+bool URoadMeshGenerator::BuildMesh(FMeshBuildResult& OutResult) const
+{
+	if (!bIsLocalSpace || SweepPointsTrans.IsEmpty() || RoadInfo.CrossSectionCoord.IsEmpty())
+	{
+		return false;
+	}
+	const double BuildStartTime = FPlatformTime::Seconds();
+	if (!SweepAlongPath(SweepPointsTrans, OutResult.Mesh))
+	{
+		return false;
+	}
+	//LOD逐级放大弦高误差抽稀扫掠路径，抽稀不再减少点数时停止，各级与LOD0使用相同的扫掠方式
+	int32 LastPathNum = SweepPointsTrans.Num();
+	TArray<int32> KeptIndices;
+	TArray<FTransform> LODPath;
+	for (int32 LODIndex = 1; LODIndex < RequestedLODNum; ++LODIndex)
+	{
+		const double ChordError = LODChordError * FMath::Pow(4.0, LODIndex - 1);
+		URoadGeometryUtilities::SimplifySweepPathIndices(SweepPointsTrans, ChordError, 5.0f * LODIndex,
+		                                                 KeptIndices);
+		if (KeptIndices.Num() >= LastPathNum)
+		{
+			break;
+		}
+		LastPathNum = KeptIndices.Num();
+		LODPath.Reset(KeptIndices.Num());
+		for (const int32 KeptIndex : KeptIndices)
+		{
+			LODPath.Emplace(SweepPointsTrans[KeptIndex]);
+		}
+		if (!SweepAlongPath(LODPath, OutResult.LODMeshes.AddDefaulted_GetRef()))
+		{
+			OutResult.LODMeshes.Pop();
+			break;
+		}
+	}
+	OutResult.BuildSeconds = FPlatformTime::Seconds() - BuildStartTime;
+	return true;
+}
+
+bool URoadMeshGenerator::SweepAlongPath(const TArray<FTransform>& InPath, UE::Geometry::FDynamicMesh3& OutMesh) const
+{
+	if (bUseNativeSweep)
+	{
+		if (ProfileTemplate.IsValid())
+		{
+			FRoadSweepBuilder::AppendSweep(OutMesh, *ProfileTemplate, InPath);
+		}
+		else
+		{
+			FRoadSweepBuilder::AppendSweep(OutMesh, RoadInfo.CrossSectionCoord, InPath);
+		}
+		return true;
+	}
+	if (nullptr == BuildScratchMesh)
+	{
+		return false;
+	}
+	BuildScratchMesh->Reset();
 	FGeometryScriptPrimitiveOptions GeometryScriptOptions;
 	FTransform SweepMeshTrans = FTransform::Identity;
-	UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendSweepPolygon(MeshComponentPtr->GetDynamicMesh(),
-	                                                                  GeometryScriptOptions, SweepMeshTrans, SweepShape,
-	                                                                  SweepPointsTrans);
+	UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendSweepPolygon(BuildScratchMesh, GeometryScriptOptions,
+	                                                                  SweepMeshTrans, RoadInfo.CrossSectionCoord,
+	                                                                  InPath);
 	FGeometryScriptSplitNormalsOptions SplitOptions;
 	FGeometryScriptCalculateNormalsOptions CalculateOptions;
-	UGeometryScriptLibrary_MeshNormalsFunctions::ComputeSplitNormals(MeshComponent->GetDynamicMesh(), SplitOptions,
+	UGeometryScriptLibrary_MeshNormalsFunctions::ComputeSplitNormals(BuildScratchMesh, SplitOptions,
 	                                                                 CalculateOptions);
-	if (nullptr == Material)
+	MoveScratchMeshTo(BuildScratchMesh, OutMesh);
+	return true;
+}
+
+void URoadMeshGenerator::CommitMesh(FMeshBuildResult&& InResult)
+{
+	LastMeshBuildSeconds = InResult.BuildSeconds;
+	LODMeshes.Reset(InResult.LODMeshes.Num() + 1);
+	LODMeshes.AddDefaulted();
+	LODMeshes.Append(MoveTemp(InResult.LODMeshes));
+	IMeshGeneratorInterface::CommitMesh(MoveTemp(InResult));
+	DisplayedLOD = 0;
+	RefreshMatsOnDynamicMeshComp();
+}
+
+void URoadMeshGenerator::SetDisplayedLOD(int32 InLODIndex)
+{
+	if (InLODIndex == DisplayedLOD || !LODMeshes.IsValidIndex(InLODIndex) || !LODMeshes.IsValidIndex(DisplayedLOD) ||
+		!MeshComponent.IsValid())
 	{
-		InitialMaterials();
+		return;
 	}
-	RefreshMatsOnDynamicMeshComp();
+	//显示的Mesh放回缓存槽，再取出目标LOD，槽位保持一一对应
+	MeshComponent->GetDynamicMesh()->EditMesh([this, InLODIndex](UE::Geometry::FDynamicMesh3& EditMesh)
+	{
+		Swap(EditMesh, LODMeshes[DisplayedLOD]);
+		Swap(EditMesh, LODMeshes[InLODIndex]);
+	});
+	DisplayedLOD = InLODIndex;
+}
+
+bool URoadMeshGenerator::CopyLODMesh(int32 InLODIndex, UE::Geometry::FDynamicMesh3& OutMesh) const
+{
+	if (InLODIndex != DisplayedLOD)
+	{
+		if (!LODMeshes.IsValidIndex(InLODIndex))
+		{
+			return false;
+		}
+		OutMesh = LODMeshes[InLODIndex];
+		return true;
+	}
+	if (!MeshComponent.IsValid())
+	{
+		return false;
+	}
+	MeshComponent->ProcessMesh([&OutMesh](const UE::Geometry::FDynamicMesh3& DisplayedMesh)
+	{
+		OutMesh = DisplayedMesh;
+	});
 	return true;
 }
 
@@ -183,15 +335,18 @@ FInterpCurveVector URoadMeshGenerator::GetSplineControlPointsInRoadRange(bool bF
 	AActor* OwnerActor = GetOwner();
 	if (OwnerActor == nullptr) { return Result; }
 	const float DirectionScalar = bForwardOrderDir ? -1.0f : 1.0f;
+	//起点、终点和Loop补点共用一个求值器，InputKey和右向量一次求出
+	FSplineCursorEvaluator Evaluator(OwnerSpline);
 
 	FVector RoadStartLocation = SweepPointsTrans[0].GetLocation();
 	RoadStartLocation = UKismetMathLibrary::TransformLocation(OwnerActor->GetTransform(), RoadStartLocation);
 	//下面这个函数有问题，输入数字大的时候使用Local可能会输出(0,0,0)
 	float StartAsDist = OwnerSpline->GetDistanceAlongSplineAtLocation(RoadStartLocation, ESplineCoordinateSpace::World);
-	float StartAsInputKey = OwnerSpline->GetInputKeyValueAtDistanceAlongSpline(StartAsDist);
+	const FSplineCursorEvaluator::FSample StartSample = Evaluator.Evaluate(StartAsDist);
+	float StartAsInputKey = StartSample.InputKey;
 	//处理偏移问题
-	GetWSPointFromRoadCenterWithOffset(RoadStartLocation, StartAsDist, OwnerSpline, bForwardOrderDir,
-	                                   OffsetType, CustomOffsetOnLeft);
+	GetWSPointFromRoadCenterWithOffset(RoadStartLocation, StartSample.Transform.GetRotation().GetRightVector(),
+	                                   bForwardOrderDir, OffsetType, CustomOffsetOnLeft);
 	FInterpCurvePoint<FVector> StartPoint(bForwardOrderDir ? 0.0f : 1.0f, RoadStartLocation, FVector::ZeroVector,
 	                                      FVector::ZeroVector, CIM_Constant);
 
@@ -199,10 +354,11 @@ FInterpCurveVector URoadMeshGenerator::GetSplineControlPointsInRoadRange(bool bF
 	RoadEndLocation = UKismetMathLibrary::TransformLocation(OwnerActor->GetTransform(), RoadEndLocation);
 	//下面这个函数有问题，输入数字大的时候使用Local可能会输出(0,0,0)
 	float EndAsDist = OwnerSpline->GetDistanceAlongSplineAtLocation(RoadEndLocation, ESplineCoordinateSpace::World);
-	float EndAsInputKey = OwnerSpline->GetInputKeyValueAtDistanceAlongSpline(EndAsDist);
+	const FSplineCursorEvaluator::FSample EndSample = Evaluator.Evaluate(EndAsDist);
+	float EndAsInputKey = EndSample.InputKey;
 	//处理偏移
-	GetWSPointFromRoadCenterWithOffset(RoadEndLocation, EndAsDist, OwnerSpline, bForwardOrderDir,
-	                                   OffsetType, CustomOffsetOnLeft);
+	GetWSPointFromRoadCenterWithOffset(RoadEndLocation, EndSample.Transform.GetRotation().GetRightVector(),
+	                                   bForwardOrderDir, OffsetType, CustomOffsetOnLeft);
 	FInterpCurvePoint<FVector> EndPoint(bForwardOrderDir ? 1.0f : 0.0f, RoadEndLocation, FVector::ZeroVector,
 	                                    FVector::ZeroVector,
 	                                    CIM_Constant);
@@ -266,15 +422,14 @@ FInterpCurveVector URoadMeshGenerator::GetSplineControlPointsInRoadRange(bool bF
 				//对最后一个点到第一个点在后边插入一个点，避免CloseLoop时强制设置Tangent使得Spline走形
 				float AppendPointDis = OwnerSpline->GetSplineLength() - (OwnerSpline->GetSplineLength() - OwnerSpline->
 					GetDistanceAlongSplineAtSplinePoint(OwnerSpline->GetNumberOfSplinePoints() - 1)) * 0.5f;
-				FVector AppendPointLocWS = OwnerSpline->GetLocationAtDistanceAlongSpline(
-					AppendPointDis, ESplineCoordinateSpace::World);
+				const FSplineCursorEvaluator::FSample AppendSample = Evaluator.Evaluate(AppendPointDis);
+				FVector AppendPointLocWS = AppendSample.Transform.GetLocation();
 				DrawDebugSphere(GetWorld(), AppendPointLocWS, 100.0f, 10, FColor::Red, true, -1, 0, 5.0f);
 				UE_LOG(LogTemp, Display, TEXT("Add Location At %s Distance %f"), *AppendPointLocWS.ToString(),
 				       AppendPointDis);
-				GetWSPointFromRoadCenterWithOffset(AppendPointLocWS, AppendPointDis, OwnerSpline, bForwardOrderDir,
-				                                   OffsetType, CustomOffsetOnLeft);
-				FVector AppendPointTangentWS = (bForwardOrderDir ? 1.0 : -1.0) * OwnerSpline->
-					GetTangentAtDistanceAlongSpline(AppendPointDis, ESplineCoordinateSpace::World);
+				GetWSPointFromRoadCenterWithOffset(AppendPointLocWS, AppendSample.Transform.GetRotation().GetRightVector(),
+				                                   bForwardOrderDir, OffsetType, CustomOffsetOnLeft);
+				FVector AppendPointTangentWS = (bForwardOrderDir ? 1.0 : -1.0) * AppendSample.TangentWS;
 				TempTime += 0.5f / (1.0f + ControlPointNumInRange);
 				FInterpCurvePoint<FVector> AppendPoint(TempTime, AppendPointLocWS, AppendPointTangentWS,
 				                                       AppendPointTangentWS, CIM_CurveAuto);
@@ -373,15 +528,14 @@ void URoadMeshGenerator::InitialMaterials()
 	}
 }
 
-void URoadMeshGenerator::GetWSPointFromRoadCenterWithOffset(FVector& PointOnRoadCenter, float DistanceFromStart,
-                                                            const USplineComponent* OwnerSpline, bool bForwardOrderDir,
-                                                            ECoordOffsetType OffsetType, float CustomOffsetOnLeft)
+void URoadMeshGenerator::GetWSPointFromRoadCenterWithOffset(FVector& PointOnRoadCenter, const FVector& RightVectorWS,
+                                                            bool bForwardOrderDir, ECoordOffsetType OffsetType,
+                                                            float CustomOffsetOnLeft)
 {
 	if (OffsetType == ECoordOffsetType::LEFTEDGE || OffsetType == ECoordOffsetType::CUSTOM)
 	{
 		const float DirectionScalar = bForwardOrderDir ? -1.0 : 1.0;
-		FVector EndRightVector = OwnerSpline->GetRightVectorAtDistanceAlongSpline(
-			DistanceFromStart, ESplineCoordinateSpace::World);
+		const FVector& EndRightVector = RightVectorWS;
 		float OffsetValue = CustomOffsetOnLeft;
 		if (OffsetType == ECoordOffsetType::LEFTEDGE)
 		{
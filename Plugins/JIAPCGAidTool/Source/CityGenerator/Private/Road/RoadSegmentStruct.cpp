@@ -4,4 +4,18 @@
 #include "Road/RoadSegmentStruct.h"
 
 
-uint32 FSplinePolyLineSegment::SegmentGlobalIndex = 0;
+TArray<FSplinePolyLineSegment> FSplinePolyLineSegment::MakeSegments(
+	const TWeakObjectPtr<USplineComponent>& InSplineRef, int32 InSegmentNum, uint32 InFirstGlobalIndex)
+{
+	TArray<FSplinePolyLineSegment> Segments;
+	if (InSegmentNum <= 0)
+	{
+		return Segments;
+	}
+	Segments.Reserve(InSegmentNum);
+	for (int32 i = 0; i < InSegmentNum; ++i)
+	{
+		Segments.Emplace(InSplineRef, i, InSegmentNum - 1, InFirstGlobalIndex + i);
+	}
+	return Segments;
+}
@@ -0,0 +1,203 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/RoadSweepBuilder.h"
+
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "Road/RoadCrossSectionProfile.h"
+#include "VectorUtil.h"
+
+void FRoadSweepBuilder::GetSweepElementNum(int32 InSectionNum, int32 InPathNum, bool bCapped, int32& OutVertexNum,
+                                           int32& OutTriangleNum)
+{
+	OutVertexNum = InSectionNum * InPathNum;
+	OutTriangleNum = 2 * InSectionNum * (InPathNum - 1) + (bCapped ? 2 * (InSectionNum - 2) : 0);
+}
+
+void FRoadSweepBuilder::GetSweepElementNum(const FRoadProfileTemplate& InTemplate, int32 InPathNum, bool bCapped,
+                                           int32& OutVertexNum, int32& OutTriangleNum)
+{
+	const int32 SectionNum = InTemplate.Points.Num();
+	OutVertexNum = SectionNum * InPathNum;
+	OutTriangleNum = 2 * SectionNum * (InPathNum - 1) + (bCapped ? 2 * (InTemplate.CapTriangles.Num() / 3) : 0);
+}
+
+/**
+ * 追加三角形并设置法线、UV元素，几何法线与期望法线相反时翻转绕序
+ */
+static int32 AppendOrientedTriangle(UE::Geometry::FDynamicMesh3& OutMesh, const UE::Geometry::FIndex3i& InVertices,
+                                    const UE::Geometry::FIndex3i& InNormals, const UE::Geometry::FIndex3i& InUVs,
+                                    const FVector3d& InExpectedNormal, int32 InGroupID)
+{
+	using namespace UE::Geometry;
+	const FVector3d TriangleNormal = VectorUtil::Normal(OutMesh.GetVertex(InVertices.A),
+	                                                    OutMesh.GetVertex(InVertices.B),
+	                                                    OutMesh.GetVertex(InVertices.C));
+	const bool bFlip = TriangleNormal.Dot(InExpectedNormal) < 0.0;
+	const FIndex3i Vertices = bFlip ? FIndex3i(InVertices.A, InVertices.C, InVertices.B) : InVertices;
+	const FIndex3i Normals = bFlip ? FIndex3i(InNormals.A, InNormals.C, InNormals.B) : InNormals;
+	const FIndex3i UVs = bFlip ? FIndex3i(InUVs.A, InUVs.C, InUVs.B) : InUVs;
+	const int32 TriangleID = OutMesh.AppendTriangle(Vertices, InGroupID);
+	if (TriangleID < 0)
+	{
+		return TriangleID;
+	}
+	OutMesh.Attributes()->PrimaryNormals()->SetTriangle(TriangleID, Normals);
+	OutMesh.Attributes()->PrimaryUV()->SetTriangle(TriangleID, UVs);
+	return TriangleID;
+}
+
+int32 FRoadSweepBuilder::AppendSweep(UE::Geometry::FDynamicMesh3& OutMesh, TConstArrayView<FVector2D> InCrossSection,
+                                     TConstArrayView<FTransform> InSweepPath, bool bCapped)
+{
+	FRoadProfileTemplate Template;
+	if (!FRoadProfileTemplate::CompilePolygon(InCrossSection, Template))
+	{
+		return 0;
+	}
+	return AppendSweep(OutMesh, Template, InSweepPath, bCapped);
+}
+
+int32 FRoadSweepBuilder::AppendSweep(UE::Geometry::FDynamicMesh3& OutMesh, const FRoadProfileTemplate& InTemplate,
+                                     TConstArrayView<FTransform> InSweepPath, bool bCapped)
+{
+	using namespace UE::Geometry;
+	const int32 SectionNum = InTemplate.Points.Num();
+	const int32 PathNum = InSweepPath.Num();
+	if (!InTemplate.IsValid() || PathNum < 2)
+	{
+		return 0;
+	}
+	if (!OutMesh.HasAttributes())
+	{
+		OutMesh.EnableAttributes();
+	}
+	if (!OutMesh.HasTriangleGroups())
+	{
+		OutMesh.EnableTriangleGroups();
+	}
+	FDynamicMeshNormalOverlay* NormalOverlay = OutMesh.Attributes()->PrimaryNormals();
+	FDynamicMeshUVOverlay* UVOverlay = OutMesh.Attributes()->PrimaryUV();
+	const int32 TriangleNumBefore = OutMesh.TriangleCount();
+	const TArray<FVector2D>& CrossSection = InTemplate.Points;
+	const TArray<double>& SectionU = InTemplate.EdgeU;
+
+	//1.路径累计长度
+	TArray<double> PathV;
+	PathV.SetNumUninitialized(PathNum);
+	PathV[0] = 0.0;
+	for (int32 i = 1; i < PathNum; ++i)
+	{
+		PathV[i] = PathV[i - 1] + FVector::Distance(InSweepPath[i - 1].GetLocation(), InSweepPath[i].GetLocation());
+	}
+	const double PathLength = FMath::Max(PathV.Last(), UE_DOUBLE_SMALL_NUMBER);
+
+	//2.每个路径点一圈顶点，截面边的两个端点各一个法线和UV元素（Overlay元素只能属于一个顶点）
+	const int32 FirstVertex = OutMesh.MaxVertexID();
+	TArray<int32> RingNormals;
+	RingNormals.SetNumUninitialized(PathNum * SectionNum * 2);
+	TArray<int32> RingUVs;
+	RingUVs.SetNumUninitialized(PathNum * SectionNum * 2);
+	for (int32 PathIndex = 0; PathIndex < PathNum; ++PathIndex)
+	{
+		const FTransform& PathTrans = InSweepPath[PathIndex];
+		const FQuat PathRotation = PathTrans.GetRotation();
+		const FVector PathScale = PathTrans.GetScale3D();
+		const float V = static_cast<float>(PathV[PathIndex] / PathLength);
+		for (int32 i = 0; i < SectionNum; ++i)
+		{
+			const FVector2D& SectionPoint = CrossSection[i];
+			OutMesh.AppendVertex(PathTrans.GetLocation() + PathRotation.RotateVector(
+				FVector(0.0, SectionPoint.X * PathScale.Y, SectionPoint.Y * PathScale.Z)));
+			//非均匀缩放时法线按缩放的倒数变换
+			for (int32 EndIndex = 0; EndIndex < 2; ++EndIndex)
+			{
+				const FVector2D EdgeNormal = InTemplate.GetEdgeNormal(i, EndIndex == 1);
+				const FVector SectionNormal = PathRotation.RotateVector(FVector(
+					0.0, EdgeNormal.X / FMath::Max(PathScale.Y, UE_DOUBLE_SMALL_NUMBER),
+					EdgeNormal.Y / FMath::Max(PathScale.Z, UE_DOUBLE_SMALL_NUMBER))).GetSafeNormal();
+				RingNormals[(PathIndex * SectionNum + i) * 2 + EndIndex] = NormalOverlay->AppendElement(
+					FVector3f(SectionNormal));
+			}
+			RingUVs[(PathIndex * SectionNum + i) * 2] = UVOverlay->AppendElement(
+				FVector2f(static_cast<float>(SectionU[i]), V));
+			RingUVs[(PathIndex * SectionNum + i) * 2 + 1] = UVOverlay->AppendElement(
+				FVector2f(static_cast<float>(SectionU[i + 1]), V));
+		}
+	}
+	//3.侧面，每条截面边一个PolyGroup
+	const int32 FirstGroup = OutMesh.MaxGroupID();
+	for (int32 PathIndex = 0; PathIndex + 1 < PathNum; ++PathIndex)
+	{
+		for (int32 i = 0; i < SectionNum; ++i)
+		{
+			const int32 Next = (i + 1) % SectionNum;
+			const int32 A = FirstVertex + PathIndex * SectionNum + i;
+			const int32 B = FirstVertex + PathIndex * SectionNum + Next;
+			const int32 C = A + SectionNum;
+			const int32 D = B + SectionNum;
+			const int32 NormalA = RingNormals[(PathIndex * SectionNum + i) * 2];
+			const int32 NormalB = RingNormals[(PathIndex * SectionNum + i) * 2 + 1];
+			const int32 NormalC = RingNormals[((PathIndex + 1) * SectionNum + i) * 2];
+			const int32 NormalD = RingNormals[((PathIndex + 1) * SectionNum + i) * 2 + 1];
+			const int32 UVA = RingUVs[(PathIndex * SectionNum + i) * 2];
+			const int32 UVB = RingUVs[(PathIndex * SectionNum + i) * 2 + 1];
+			const int32 UVC = RingUVs[((PathIndex + 1) * SectionNum + i) * 2];
+			const int32 UVD = RingUVs[((PathIndex + 1) * SectionNum + i) * 2 + 1];
+			const FVector3d ExpectedNormal = FVector3d(NormalOverlay->GetElement(NormalA) +
+				NormalOverlay->GetElement(NormalC));
+			AppendOrientedTriangle(OutMesh, FIndex3i(A, B, C), FIndex3i(NormalA, NormalB, NormalC),
+			                       FIndex3i(UVA, UVB, UVC), ExpectedNormal, FirstGroup + i);
+			AppendOrientedTriangle(OutMesh, FIndex3i(B, D, C), FIndex3i(NormalB, NormalD, NormalC),
+			                       FIndex3i(UVB, UVD, UVC), ExpectedNormal, FirstGroup + i);
+		}
+	}
+	//4.两端封口，按模板的封口三角形，UV取截面包围盒内的平面坐标
+	if (bCapped)
+	{
+		const FBox2D& SectionBounds = InTemplate.Bounds;
+		const FVector2D BoundsSize = SectionBounds.GetSize().ComponentMax(FVector2D(UE_DOUBLE_SMALL_NUMBER));
+		for (const int32 CapPathIndex : {0, PathNum - 1})
+		{
+			const bool bIsStart = CapPathIndex == 0;
+			const FVector CapDirection = InSweepPath[CapPathIndex].GetRotation().GetForwardVector() * (bIsStart
+				? -1.0
+				: 1.0);
+			TArray<int32, TInlineAllocator<8>> CapNormals;
+			TArray<int32, TInlineAllocator<8>> CapUVs;
+			for (const FVector2D& SectionPoint : CrossSection)
+			{
+				CapNormals.Emplace(NormalOverlay->AppendElement(FVector3f(CapDirection)));
+				CapUVs.Emplace(UVOverlay->AppendElement(FVector2f((SectionPoint - SectionBounds.Min) / BoundsSize)));
+			}
+			const int32 CapFirstVertex = FirstVertex + CapPathIndex * SectionNum;
+			for (int32 i = 0; i + 2 < InTemplate.CapTriangles.Num(); i += 3)
+			{
+				const int32 A = InTemplate.CapTriangles[i];
+				const int32 B = InTemplate.CapTriangles[i + 1];
+				const int32 C = InTemplate.CapTriangles[i + 2];
+				AppendOrientedTriangle(OutMesh, FIndex3i(CapFirstVertex + A, CapFirstVertex + B, CapFirstVertex + C),
+				                       FIndex3i(CapNormals[A], CapNormals[B], CapNormals[C]),
+				                       FIndex3i(CapUVs[A], CapUVs[B], CapUVs[C]), FVector3d(CapDirection),
+				                       FirstGroup + SectionNum + (bIsStart ? 0 : 1));
+			}
+		}
+	}
+	return OutMesh.TriangleCount() - TriangleNumBefore;
+}
+
+int32 FRoadSweepBuilder::AppendExtrudedPolygon(UE::Geometry::FDynamicMesh3& OutMesh,
+                                               const FRoadProfileTemplate& InTemplate, double InHeight)
+{
+	if (InHeight <= UE_DOUBLE_SMALL_NUMBER)
+	{
+		return 0;
+	}
+	//路径朝向+Z，截面X对应世界X，截面Y对应世界Y
+	const FQuat ExtrudeRotation(FRotationMatrix::MakeFromXY(FVector::UpVector, FVector::ForwardVector));
+	const FTransform ExtrudePath[] = {
+		FTransform(ExtrudeRotation, FVector::ZeroVector), FTransform(ExtrudeRotation, FVector(0.0, 0.0, InHeight))
+	};
+	return AppendSweep(OutMesh, InTemplate, ExtrudePath, true);
+}
@@ -0,0 +1,173 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/SegmentBVH.h"
+#include "Algo/Sort.h"
+
+void FSegmentBVH::Build(const TArray<FVector2D>& InSegmentStarts, const TArray<FVector2D>& InSegmentEnds)
+{
+	Empty();
+	if (!ensureAlwaysMsgf(InSegmentStarts.Num() == InSegmentEnds.Num(), TEXT("Segment Start/End Count Mismatch")))
+	{
+		return;
+	}
+	const int32 SegmentNum = InSegmentStarts.Num();
+	if (SegmentNum == 0)
+	{
+		return;
+	}
+	StartX.SetNumUninitialized(SegmentNum);
+	StartY.SetNumUninitialized(SegmentNum);
+	EndX.SetNumUninitialized(SegmentNum);
+	EndY.SetNumUninitialized(SegmentNum);
+	RemovedFlags.Init(false, SegmentNum);
+	LeafSegmentIndices.SetNumUninitialized(SegmentNum);
+	//质心只在构建时使用
+	TArray<FVector2D> Centroids;
+	Centroids.SetNumUninitialized(SegmentNum);
+	for (int32 i = 0; i < SegmentNum; ++i)
+	{
+		StartX[i] = InSegmentStarts[i].X;
+		StartY[i] = InSegmentStarts[i].Y;
+		EndX[i] = InSegmentEnds[i].X;
+		EndY[i] = InSegmentEnds[i].Y;
+		Centroids[i] = (InSegmentStarts[i] + InSegmentEnds[i]) * 0.5;
+		LeafSegmentIndices[i] = static_cast<uint32>(i);
+	}
+	//中位数切分下叶节点至少包含MaxLeafSize/2条线段，节点总数不超过线段数
+	Nodes.Reserve(SegmentNum);
+	Nodes.AddDefaulted();
+	Nodes[0].FirstIndex = 0;
+	Nodes[0].Count = SegmentNum;
+	//待处理节点，构建前FirstIndex/Count暂存该节点覆盖的LeafSegmentIndices范围
+	TArray<int32, TInlineAllocator<64>> BuildStack;
+	BuildStack.Emplace(0);
+	while (!BuildStack.IsEmpty())
+	{
+		const int32 NodeIndex = BuildStack.Pop(EAllowShrinking::No);
+		const int32 First = Nodes[NodeIndex].FirstIndex;
+		const int32 Count = Nodes[NodeIndex].Count;
+		FNode& Node = Nodes[NodeIndex];
+		Node.MinX = Node.MinY = TNumericLimits<double>::Max();
+		Node.MaxX = Node.MaxY = TNumericLimits<double>::Lowest();
+		FBox2D CentroidBounds(ForceInit);
+		for (int32 i = First; i < First + Count; ++i)
+		{
+			const uint32 SegmentIndex = LeafSegmentIndices[i];
+			Node.MinX = FMath::Min3(Node.MinX, StartX[SegmentIndex], EndX[SegmentIndex]);
+			Node.MinY = FMath::Min3(Node.MinY, StartY[SegmentIndex], EndY[SegmentIndex]);
+			Node.MaxX = FMath::Max3(Node.MaxX, StartX[SegmentIndex], EndX[SegmentIndex]);
+			Node.MaxY = FMath::Max3(Node.MaxY, StartY[SegmentIndex], EndY[SegmentIndex]);
+			CentroidBounds += Centroids[SegmentIndex];
+		}
+		if (Count <= MaxLeafSize)
+		{
+			continue;
+		}
+		//按质心在最长轴上排序取中位数，保证两侧数量平衡，重合质心也能切分
+		const FVector2D CentroidExtent = CentroidBounds.GetSize();
+		const bool bSplitX = CentroidExtent.X >= CentroidExtent.Y;
+		Algo::Sort(MakeArrayView(LeafSegmentIndices.GetData() + First, Count),
+		           [&Centroids, bSplitX](uint32 A, uint32 B)
+		           {
+			           return bSplitX ? Centroids[A].X < Centroids[B].X : Centroids[A].Y < Centroids[B].Y;
+		           });
+		const int32 LeftCount = Count / 2;
+		const int32 LeftChild = Nodes.Num();
+		//AddDefaulted可能重新分配内存，此后不能再使用Node引用
+		Nodes.AddDefaulted(2);
+		Nodes[LeftChild].FirstIndex = First;
+		Nodes[LeftChild].Count = LeftCount;
+		Nodes[LeftChild + 1].FirstIndex = First + LeftCount;
+		Nodes[LeftChild + 1].Count = Count - LeftCount;
+		Nodes[NodeIndex].FirstIndex = LeftChild;
+		Nodes[NodeIndex].Count = 0;
+		BuildStack.Emplace(LeftChild);
+		BuildStack.Emplace(LeftChild + 1);
+	}
+}
+
+void FSegmentBVH::Empty()
+{
+	Nodes.Empty();
+	LeafSegmentIndices.Empty();
+	OverflowSegmentIndices.Empty();
+	RemovedFlags.Empty();
+	RemovedNum = 0;
+	StartX.Empty();
+	StartY.Empty();
+	EndX.Empty();
+	EndY.Empty();
+}
+
+uint32 FSegmentBVH::Append(const FVector2D& InSegmentStart, const FVector2D& InSegmentEnd)
+{
+	const uint32 SegmentIndex = StartX.Num();
+	StartX.Emplace(InSegmentStart.X);
+	StartY.Emplace(InSegmentStart.Y);
+	EndX.Emplace(InSegmentEnd.X);
+	EndY.Emplace(InSegmentEnd.Y);
+	RemovedFlags.Add(false);
+	OverflowSegmentIndices.Emplace(SegmentIndex);
+	return SegmentIndex;
+}
+
+void FSegmentBVH::Remove(uint32 SegmentIndex)
+{
+	if (!RemovedFlags[SegmentIndex])
+	{
+		RemovedFlags[SegmentIndex] = true;
+		RemovedNum++;
+	}
+}
+
+void FSegmentBVH::Query(const FBox2D& InQueryBox, TArray<uint32>& OutSegmentIndices) const
+{
+	const double QueryMinX = InQueryBox.Min.X;
+	const double QueryMinY = InQueryBox.Min.Y;
+	const double QueryMaxX = InQueryBox.Max.X;
+	const double QueryMaxY = InQueryBox.Max.Y;
+	auto IsOverlapped = [this, QueryMinX, QueryMinY, QueryMaxX, QueryMaxY](uint32 SegmentIndex)-> bool
+	{
+		return !(FMath::Min(StartX[SegmentIndex], EndX[SegmentIndex]) > QueryMaxX ||
+			FMath::Max(StartX[SegmentIndex], EndX[SegmentIndex]) < QueryMinX ||
+			FMath::Min(StartY[SegmentIndex], EndY[SegmentIndex]) > QueryMaxY ||
+			FMath::Max(StartY[SegmentIndex], EndY[SegmentIndex]) < QueryMinY);
+	};
+	for (const uint32 SegmentIndex : OverflowSegmentIndices)
+	{
+		if (!RemovedFlags[SegmentIndex] && IsOverlapped(SegmentIndex))
+		{
+			OutSegmentIndices.Emplace(SegmentIndex);
+		}
+	}
+	if (Nodes.IsEmpty())
+	{
+		return;
+	}
+	TArray<int32, TInlineAllocator<64>> QueryStack;
+	QueryStack.Emplace(0);
+	while (!QueryStack.IsEmpty())
+	{
+		const FNode& Node = Nodes[QueryStack.Pop(EAllowShrinking::No)];
+		if (Node.MinX > QueryMaxX || Node.MaxX < QueryMinX || Node.MinY > QueryMaxY || Node.MaxY < QueryMinY)
+		{
+			continue;
+		}
+		if (Node.Count == 0)
+		{
+			QueryStack.Emplace(Node.FirstIndex);
+			QueryStack.Emplace(Node.FirstIndex + 1);
+			continue;
+		}
+		for (int32 i = Node.FirstIndex; i < Node.FirstIndex + Node.Count; ++i)
+		{
+			const uint32 SegmentIndex = LeafSegmentIndices[i];
+			if (RemovedFlags[SegmentIndex] || !IsOverlapped(SegmentIndex))
+			{
+				continue;
+			}
+			OutSegmentIndices.Emplace(SegmentIndex);
+		}
+	}
+}
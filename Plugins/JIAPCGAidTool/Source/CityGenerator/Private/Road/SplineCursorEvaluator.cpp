@@ -0,0 +1,212 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/SplineCursorEvaluator.h"
+#include "Components/SplineComponent.h"
+
+/**
+ * 与FInterpCurve::GetPointIndexForInputValue结果相同，命中游标所在区间或其后一个区间时不做二分
+ * @return -1表示在第一个点之前
+ */
+template <typename T>
+static int32 SeekPointIndex(const FInterpCurve<T>& Curve, float InVal, int32& InOutCursor)
+{
+	const TArray<FInterpCurvePoint<T>>& Points = Curve.Points;
+	const int32 LastIndex = Points.Num() - 1;
+	if (InVal < Points[0].InVal)
+	{
+		InOutCursor = 0;
+		return -1;
+	}
+	if (InVal >= Points[LastIndex].InVal)
+	{
+		InOutCursor = LastIndex;
+		return LastIndex;
+	}
+	int32 Cursor = FMath::Clamp(InOutCursor, 0, LastIndex - 1);
+	if (Points[Cursor].InVal <= InVal)
+	{
+		//单调递增时通常落在当前区间或下一个区间
+		for (int32 Step = 0; Step < 2 && Cursor < LastIndex; ++Step, ++Cursor)
+		{
+			if (InVal < Points[Cursor + 1].InVal)
+			{
+				InOutCursor = Cursor;
+				return Cursor;
+			}
+		}
+	}
+	int32 MinIndex = 0;
+	int32 MaxIndex = LastIndex;
+	while (MaxIndex - MinIndex > 1)
+	{
+		const int32 MidIndex = (MinIndex + MaxIndex) / 2;
+		if (Points[MidIndex].InVal <= InVal)
+		{
+			MinIndex = MidIndex;
+		}
+		else
+		{
+			MaxIndex = MidIndex;
+		}
+	}
+	InOutCursor = MinIndex;
+	return MinIndex;
+}
+
+/**
+ * 与FInterpCurve::Eval一致，FQuat通过FMath::Lerp/CubicInterp的特化走Slerp/Squad
+ */
+template <typename T>
+static T EvalWithCursor(const FInterpCurve<T>& Curve, float InVal, const T& Default, int32& InOutCursor)
+{
+	const int32 NumPoints = Curve.Points.Num();
+	if (NumPoints == 0)
+	{
+		return Default;
+	}
+	const int32 Index = SeekPointIndex(Curve, InVal, InOutCursor);
+	if (Index == -1)
+	{
+		return Curve.Points[0].OutVal;
+	}
+	if (Index == NumPoints - 1)
+	{
+		if (!Curve.bIsLooped)
+		{
+			return Curve.Points[NumPoints - 1].OutVal;
+		}
+		if (InVal >= Curve.Points[NumPoints - 1].InVal + Curve.LoopKeyOffset)
+		{
+			return Curve.Points[0].OutVal;
+		}
+	}
+	const bool bLoopSegment = Curve.bIsLooped && Index == NumPoints - 1;
+	const FInterpCurvePoint<T>& PrevPoint = Curve.Points[Index];
+	const FInterpCurvePoint<T>& NextPoint = Curve.Points[bLoopSegment ? 0 : Index + 1];
+	const float Diff = bLoopSegment ? Curve.LoopKeyOffset : NextPoint.InVal - PrevPoint.InVal;
+	if (Diff <= 0.0f || PrevPoint.InterpMode == CIM_Constant)
+	{
+		return PrevPoint.OutVal;
+	}
+	const float Alpha = (InVal - PrevPoint.InVal) / Diff;
+	if (PrevPoint.InterpMode == CIM_Linear)
+	{
+		return FMath::Lerp(PrevPoint.OutVal, NextPoint.OutVal, Alpha);
+	}
+	return FMath::CubicInterp(PrevPoint.OutVal, PrevPoint.LeaveTangent * Diff, NextPoint.OutVal,
+	                          NextPoint.ArriveTangent * Diff, Alpha);
+}
+
+/**
+ * 与FInterpCurve::EvalDerivative一致
+ */
+static FVector EvalDerivativeWithCursor(const FInterpCurveVector& Curve, float InVal, int32& InOutCursor)
+{
+	const int32 NumPoints = Curve.Points.Num();
+	if (NumPoints == 0)
+	{
+		return FVector::ZeroVector;
+	}
+	const int32 Index = SeekPointIndex(Curve, InVal, InOutCursor);
+	if (Index == -1)
+	{
+		return Curve.Points[0].LeaveTangent;
+	}
+	if (Index == NumPoints - 1)
+	{
+		if (!Curve.bIsLooped)
+		{
+			return Curve.Points[NumPoints - 1].ArriveTangent;
+		}
+		if (InVal >= Curve.Points[NumPoints - 1].InVal + Curve.LoopKeyOffset)
+		{
+			return Curve.Points[0].ArriveTangent;
+		}
+	}
+	const bool bLoopSegment = Curve.bIsLooped && Index == NumPoints - 1;
+	const FInterpCurvePoint<FVector>& PrevPoint = Curve.Points[Index];
+	const FInterpCurvePoint<FVector>& NextPoint = Curve.Points[bLoopSegment ? 0 : Index + 1];
+	const float Diff = bLoopSegment ? Curve.LoopKeyOffset : NextPoint.InVal - PrevPoint.InVal;
+	if (Diff <= 0.0f || PrevPoint.InterpMode == CIM_Constant)
+	{
+		return FVector::ZeroVector;
+	}
+	if (PrevPoint.InterpMode == CIM_Linear)
+	{
+		return (NextPoint.OutVal - PrevPoint.OutVal) / Diff;
+	}
+	const float Alpha = (InVal - PrevPoint.InVal) / Diff;
+	return FMath::CubicInterpDerivative(PrevPoint.OutVal, PrevPoint.LeaveTangent * Diff, NextPoint.OutVal,
+	                                    NextPoint.ArriveTangent * Diff, Alpha) / Diff;
+}
+
+FSplineCursorEvaluator::FSplineCursorEvaluator(const USplineComponent* InSpline)
+{
+	if (nullptr == InSpline || InSpline->SplineCurves.Position.Points.IsEmpty() ||
+		InSpline->SplineCurves.ReparamTable.Points.IsEmpty())
+	{
+		return;
+	}
+	Curves = &InSpline->SplineCurves;
+	ComponentTransform = InSpline->GetComponentTransform();
+	DefaultUpVectorLS = InSpline->GetDefaultUpVector(ESplineCoordinateSpace::Local);
+}
+
+FSplineCursorEvaluator::FSplineCursorEvaluator(const FSplineCurves& InCurves, const FTransform& InComponentTransform,
+                                               const FVector& InDefaultUpVectorLS)
+{
+	if (InCurves.Position.Points.IsEmpty() || InCurves.ReparamTable.Points.IsEmpty())
+	{
+		return;
+	}
+	Curves = &InCurves;
+	ComponentTransform = InComponentTransform;
+	DefaultUpVectorLS = InDefaultUpVectorLS;
+}
+
+float FSplineCursorEvaluator::GetSplineLength() const
+{
+	return nullptr != Curves ? Curves->GetSplineLength() : 0.0f;
+}
+
+float FSplineCursorEvaluator::GetInputKeyAtDistance(float Distance)
+{
+	if (nullptr == Curves)
+	{
+		return 0.0f;
+	}
+	return EvalWithCursor(Curves->ReparamTable, Distance, 0.0f, ReparamCursor);
+}
+
+FSplineCursorEvaluator::FSample FSplineCursorEvaluator::Evaluate(float Distance, bool bUseScale)
+{
+	FSample Sample;
+	if (nullptr == Curves)
+	{
+		return Sample;
+	}
+	Sample.InputKey = GetInputKeyAtDistance(Distance);
+	const FVector LocationLS = EvalWithCursor(Curves->Position, Sample.InputKey, FVector::ZeroVector,
+	                                          PositionCursor);
+	const FVector TangentLS = EvalDerivativeWithCursor(Curves->Position, Sample.InputKey, PositionCursor);
+	//以下与USplineComponent::GetQuaternionAtSplineInputKey相同
+	FQuat Quat = EvalWithCursor(Curves->Rotation, Sample.InputKey, FQuat::Identity, RotationCursor);
+	Quat.Normalize();
+	const FVector UpVector = Quat.RotateVector(DefaultUpVectorLS);
+	const FQuat RotationLS = FRotationMatrix::MakeFromXZ(TangentLS.GetSafeNormal(), UpVector).ToQuat();
+	const FVector ScaleLS = bUseScale
+		                        ? EvalWithCursor(Curves->Scale, Sample.InputKey, FVector(1.0f), ScaleCursor)
+		                        : FVector(1.0f);
+	Sample.Transform = FTransform(RotationLS, LocationLS, ScaleLS) * ComponentTransform;
+	Sample.TangentWS = ComponentTransform.TransformVector(TangentLS);
+	return Sample;
+}
+
+void FSplineCursorEvaluator::Reset()
+{
+	ReparamCursor = 0;
+	PositionCursor = 0;
+	RotationCursor = 0;
+	ScaleCursor = 0;
+}
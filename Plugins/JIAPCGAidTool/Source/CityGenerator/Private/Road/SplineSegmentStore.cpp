@@ -0,0 +1,204 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/SplineSegmentStore.h"
+#include "Algo/BinarySearch.h"
+#include "Components/SplineComponent.h"
+
+int32 FSplineSegmentStore::AppendSpline(const TWeakObjectPtr<USplineComponent>& InSpline,
+                                        const TArray<FTransform>& InPolyLinePoints, uint32 InFirstGlobalIndex)
+{
+	if (InPolyLinePoints.Num() < 2)
+	{
+		return INDEX_NONE;
+	}
+	if (!ensureAlwaysMsgf(GlobalIndices.IsEmpty() || InFirstGlobalIndex > GlobalIndices.Last(),
+	                      TEXT("GlobalIndex Must Be Ascending In Segment Store")))
+	{
+		return INDEX_NONE;
+	}
+	const int32 SplineId = Splines.Emplace(InSpline);
+	const int32 FirstPointIndex = PointZ.Num();
+	const int32 SegmentNum = InPolyLinePoints.Num() - 1;
+	SplineFirstSegments.Emplace(Num());
+	SplineSegmentNums.Emplace(SegmentNum);
+	RemovedFlags.Add(false, SegmentNum);
+	const int32 NewNum = Num() + SegmentNum;
+	StartX.Reserve(NewNum);
+	StartY.Reserve(NewNum);
+	EndX.Reserve(NewNum);
+	EndY.Reserve(NewNum);
+	SplineIds.Reserve(NewNum);
+	SegmentIndices.Reserve(NewNum);
+	LastSegmentIndices.Reserve(NewNum);
+	GlobalIndices.Reserve(NewNum);
+	StartPointIndices.Reserve(NewNum);
+	for (int32 i = 0; i < SegmentNum; ++i)
+	{
+		const FVector StartLocation = InPolyLinePoints[i].GetLocation();
+		const FVector EndLocation = InPolyLinePoints[i + 1].GetLocation();
+		StartX.Emplace(StartLocation.X);
+		StartY.Emplace(StartLocation.Y);
+		EndX.Emplace(EndLocation.X);
+		EndY.Emplace(EndLocation.Y);
+		SplineIds.Emplace(SplineId);
+		SegmentIndices.Emplace(i);
+		LastSegmentIndices.Emplace(SegmentNum - 1);
+		GlobalIndices.Emplace(InFirstGlobalIndex + i);
+		StartPointIndices.Emplace(FirstPointIndex + i);
+	}
+	PointZ.Reserve(FirstPointIndex + InPolyLinePoints.Num());
+	PointRotations.Reserve(FirstPointIndex + InPolyLinePoints.Num());
+	PointScales.Reserve(FirstPointIndex + InPolyLinePoints.Num());
+	for (const FTransform& PointTransform : InPolyLinePoints)
+	{
+		PointZ.Emplace(PointTransform.GetLocation().Z);
+		PointRotations.Emplace(PointTransform.GetRotation());
+		PointScales.Emplace(PointTransform.GetScale3D());
+	}
+	return SplineId;
+}
+
+void FSplineSegmentStore::RemoveSpline(int32 SplineId)
+{
+	if (!Splines.IsValidIndex(SplineId) || SplineSegmentNums[SplineId] == 0)
+	{
+		return;
+	}
+	const int32 FirstSegment = SplineFirstSegments[SplineId];
+	RemovedFlags.SetRange(FirstSegment, SplineSegmentNums[SplineId], true);
+	RemovedNum += SplineSegmentNums[SplineId];
+	SplineSegmentNums[SplineId] = 0;
+	Splines[SplineId] = nullptr;
+}
+
+void FSplineSegmentStore::Compact()
+{
+	if (RemovedNum == 0)
+	{
+		return;
+	}
+	//样条与折线点按原顺序保留，Segment同一样条连续存放，可以按样条整体搬移
+	int32 NewSplineNum = 0;
+	int32 NewSegmentNum = 0;
+	int32 NewPointNum = 0;
+	for (int32 SplineId = 0; SplineId < Splines.Num(); ++SplineId)
+	{
+		const int32 SegmentNum = SplineSegmentNums[SplineId];
+		if (SegmentNum == 0)
+		{
+			continue;
+		}
+		const int32 OldFirstSegment = SplineFirstSegments[SplineId];
+		const int32 OldFirstPoint = StartPointIndices[OldFirstSegment];
+		Splines[NewSplineNum] = Splines[SplineId];
+		SplineFirstSegments[NewSplineNum] = NewSegmentNum;
+		SplineSegmentNums[NewSplineNum] = SegmentNum;
+		for (int32 i = 0; i < SegmentNum; ++i)
+		{
+			const int32 From = OldFirstSegment + i;
+			const int32 To = NewSegmentNum + i;
+			StartX[To] = StartX[From];
+			StartY[To] = StartY[From];
+			EndX[To] = EndX[From];
+			EndY[To] = EndY[From];
+			SplineIds[To] = NewSplineNum;
+			SegmentIndices[To] = SegmentIndices[From];
+			LastSegmentIndices[To] = LastSegmentIndices[From];
+			GlobalIndices[To] = GlobalIndices[From];
+			StartPointIndices[To] = NewPointNum + i;
+		}
+		//每条样条有SegmentNum+1个折线点
+		for (int32 i = 0; i <= SegmentNum; ++i)
+		{
+			PointZ[NewPointNum + i] = PointZ[OldFirstPoint + i];
+			PointRotations[NewPointNum + i] = PointRotations[OldFirstPoint + i];
+			PointScales[NewPointNum + i] = PointScales[OldFirstPoint + i];
+		}
+		NewSplineNum++;
+		NewSegmentNum += SegmentNum;
+		NewPointNum += SegmentNum + 1;
+	}
+	Splines.SetNum(NewSplineNum);
+	SplineFirstSegments.SetNum(NewSplineNum);
+	SplineSegmentNums.SetNum(NewSplineNum);
+	StartX.SetNum(NewSegmentNum);
+	StartY.SetNum(NewSegmentNum);
+	EndX.SetNum(NewSegmentNum);
+	EndY.SetNum(NewSegmentNum);
+	SplineIds.SetNum(NewSegmentNum);
+	SegmentIndices.SetNum(NewSegmentNum);
+	LastSegmentIndices.SetNum(NewSegmentNum);
+	GlobalIndices.SetNum(NewSegmentNum);
+	StartPointIndices.SetNum(NewSegmentNum);
+	PointZ.SetNum(NewPointNum);
+	PointRotations.SetNum(NewPointNum);
+	PointScales.SetNum(NewPointNum);
+	RemovedFlags.Init(false, NewSegmentNum);
+	RemovedNum = 0;
+}
+
+void FSplineSegmentStore::Empty()
+{
+	StartX.Empty();
+	StartY.Empty();
+	EndX.Empty();
+	EndY.Empty();
+	SplineIds.Empty();
+	SegmentIndices.Empty();
+	LastSegmentIndices.Empty();
+	GlobalIndices.Empty();
+	Splines.Empty();
+	SplineFirstSegments.Empty();
+	SplineSegmentNums.Empty();
+	RemovedFlags.Empty();
+	RemovedNum = 0;
+	StartPointIndices.Empty();
+	PointZ.Empty();
+	PointRotations.Empty();
+	PointScales.Empty();
+}
+
+int32 FSplineSegmentStore::FindSplineId(const TWeakObjectPtr<USplineComponent>& InSpline) const
+{
+	return Splines.FindLast(InSpline);
+}
+
+int32 FSplineSegmentStore::IndexOfGlobalIndex(uint32 InGlobalIndex) const
+{
+	return Algo::BinarySearch(GlobalIndices, InGlobalIndex);
+}
+
+bool FSplineSegmentStore::IsAdjacent(int32 IndexA, int32 IndexB) const
+{
+	if (SplineIds[IndexA] != SplineIds[IndexB])
+	{
+		return false;
+	}
+	const uint32 SegmentIndexA = SegmentIndices[IndexA];
+	const uint32 SegmentIndexB = SegmentIndices[IndexB];
+	const uint32 IndexGap = SegmentIndexA > SegmentIndexB ? SegmentIndexA - SegmentIndexB : SegmentIndexB - SegmentIndexA;
+	return IndexGap <= 1 || IndexGap == LastSegmentIndices[IndexA];
+}
+
+FTransform FSplineSegmentStore::GetStartTransform(int32 Index) const
+{
+	const int32 PointIndex = StartPointIndices[Index];
+	return FTransform(PointRotations[PointIndex], GetStartLocation(Index), PointScales[PointIndex]);
+}
+
+FTransform FSplineSegmentStore::GetEndTransform(int32 Index) const
+{
+	const int32 PointIndex = StartPointIndices[Index] + 1;
+	return FTransform(PointRotations[PointIndex], GetEndLocation(Index), PointScales[PointIndex]);
+}
+
+FVector FSplineSegmentStore::GetStartLocation(int32 Index) const
+{
+	return FVector(StartX[Index], StartY[Index], PointZ[StartPointIndices[Index]]);
+}
+
+FVector FSplineSegmentStore::GetEndLocation(int32 Index) const
+{
+	return FVector(EndX[Index], EndY[Index], PointZ[StartPointIndices[Index] + 1]);
+}
@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Road/SplineSnapshot.h"
+
+FSplineSnapshot FSplineSnapshot::Capture(const USplineComponent* InSpline)
+{
+	check(IsInGameThread());
+	FSplineSnapshot Snapshot;
+	if (nullptr == InSpline)
+	{
+		return Snapshot;
+	}
+	Snapshot.Curves = InSpline->SplineCurves;
+	Snapshot.Transform = InSpline->GetComponentTransform();
+	Snapshot.DefaultUpVector = InSpline->GetDefaultUpVector(ESplineCoordinateSpace::Local);
+	Snapshot.bClosedLoop = InSpline->IsClosedLoop();
+	return Snapshot;
+}
+
+int32 FSplineSnapshot::GetNumberOfSplineSegments() const
+{
+	const int32 PointNum = GetNumberOfSplinePoints();
+	return bClosedLoop ? PointNum : FMath::Max(0, PointNum - 1);
+}
+
+float FSplineSnapshot::GetDistanceAlongSplineAtSplinePoint(int32 PointIndex) const
+{
+	const int32 SegmentNum = GetNumberOfSplineSegments();
+	const int32 ReparamPointNum = Curves.ReparamTable.Points.Num();
+	if (SegmentNum <= 0 || ReparamPointNum == 0)
+	{
+		return 0.0f;
+	}
+	if (PointIndex >= SegmentNum)
+	{
+		return GetSplineLength();
+	}
+	const int32 ReparamStepsPerSegment = (ReparamPointNum - 1) / SegmentNum;
+	return Curves.ReparamTable.Points[FMath::Max(0, PointIndex) * ReparamStepsPerSegment].InVal;
+}
+
+float FSplineSnapshot::GetDistanceAlongSplineAtSplineInputKey(float InKey) const
+{
+	const int32 SegmentNum = GetNumberOfSplineSegments();
+	if (InKey <= 0.0f || SegmentNum <= 0)
+	{
+		return 0.0f;
+	}
+	if (InKey >= SegmentNum)
+	{
+		return GetSplineLength();
+	}
+	//重参数表按带缩放的长度构建，段内长度同样使用世界缩放
+	const int32 PointIndex = FMath::FloorToInt32(InKey);
+	return GetDistanceAlongSplineAtSplinePoint(PointIndex) +
+		Curves.GetSegmentLength(PointIndex, InKey - PointIndex, bClosedLoop, Transform.GetScale3D());
+}
+
+float FSplineSnapshot::GetDistanceAlongSplineAtLocation(const FVector& InLocationWS) const
+{
+	if (!IsValid())
+	{
+		return 0.0f;
+	}
+	float DistanceSquared = 0.0f;
+	const float InputKey = Curves.Position.FindNearest(Transform.InverseTransformPosition(InLocationWS),
+	                                                   DistanceSquared);
+	return GetDistanceAlongSplineAtSplineInputKey(InputKey);
+}
+
+bool FSplineSnapshot::IsLinearPoint(int32 PointIndex) const
+{
+	return Curves.Position.Points.IsValidIndex(PointIndex) &&
+		Curves.Position.Points[PointIndex].InterpMode == CIM_Linear;
+}
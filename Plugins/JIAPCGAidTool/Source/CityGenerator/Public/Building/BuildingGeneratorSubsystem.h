@@ -30,6 +30,14 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void PlaceBuildingAlongSpline(USplineComponent* TargetSpline);
 
+	/**
+	 * 同PlaceBuildingAlongSpline，返回放置结果，供命令行批量生成统计和导出使用
+	 * @param TargetSpline 目标样条线，建议使用Linear
+	 * @param OutPlacedBuildings 追加本次放置的建筑，CityGenerator.Building.FillAllEdge=false时不放置
+	 */
+	void PlaceBuildingAlongSplineWithResult(USplineComponent* TargetSpline,
+	                                        TArray<FPlacedBuilding>& OutPlacedBuildings);
+
 	/**
 	 * 配置随机生成建筑配置
 	 * @param InTargetConfig 
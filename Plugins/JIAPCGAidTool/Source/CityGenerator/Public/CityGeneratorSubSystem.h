@@ -9,6 +9,7 @@
 
 class URoadGeneratorSubsystem;
 class USplineComponent;
+struct FCityLayout;
 /**
  * 
  */
@@ -41,19 +42,21 @@ public:
 	void CollectAllSplines(const FName OptionalActorTag = "", const FName OptionalCompTag = "");
 
 	/**
-	 * 序列化Spline信息，用于备份
-	 * @param FileName 保存文件名称，不需要后缀，以.json格式保存；有重名文件时有对话框提示
+	 * 序列化Spline信息，用于备份，读写见FCityLayoutSerializer
+	 * @param FileName 保存文件名称，不需要后缀，以.json或.citylayout格式保存；有重名文件时有对话框提示
 	 * @param FilePath 保存文件路径，为空时保存在项目Saved下
 	 * @param bSaveActorTag 是否保存ActorTag
 	 * @param bSaveCompTag 是否保存SplineCompTag
+	 * @param bBinaryFormat 是否保存为二进制格式(.citylayout)，大规模路网读取更快
 	 */
 	UFUNCTION(BlueprintCallable)
 	void SerializeSplines(const FString& FileName, const FString& FilePath = "", bool bSaveActorTag = false,
-	                      bool bSaveCompTag = false);
+	                      bool bSaveCompTag = false, bool bBinaryFormat = false);
 
 	/**
 	 * 反序列化SPline信息，用于还原。还原结果为Actor带有SceneComponent（Root）和SplineComponent
-	 * @param FileFullPath 读取文件名称，需要为序列化产生的.json文件；
+	 * Json文件流式读取，每解析完一条样条立即生成，不在内存中保留整个文件
+	 * @param FileFullPath 读取文件名称，需要为序列化产生的.json或.citylayout文件；
 	 * @param bTryParseActorTag 是否尝试解析序列化数据中的ActorTag并添加到新生成的Actor
 	 * @param bTryParseCompTag 是否尝试解析序列化数据中的ComponentTag并添加到新生成的Actor
 	 * @param bAutoCollectAfterSpawn 是否在全部生成完毕时刷新当前Spline信息，即最后运行UCityGeneratorSubSystem::CollectAllSplines
@@ -62,6 +65,28 @@ public:
 	void DeserializeSplines(const FString& FileFullPath, bool bTryParseActorTag = false, bool bTryParseCompTag = false,
 	                        bool bAutoCollectAfterSpawn = false);
 
+	/**
+	 * Json和二进制样条文件互相转换，格式由后缀决定，目标文件已存在时覆盖
+	 * @param SourceFullPath 源文件，.json或.citylayout
+	 * @param TargetFullPath 目标文件，.json或.citylayout
+	 */
+	UFUNCTION(BlueprintCallable)
+	void ConvertSplineFile(const FString& SourceFullPath, const FString& TargetFullPath);
+
+	/**
+	 * 将CityGeneratorSplineSet中的样条复制为布局数据
+	 * @param OutLayout 被重置并写入
+	 * @param bSaveActorTag 是否保存ActorTag
+	 * @param bSaveCompTag 是否保存SplineCompTag
+	 * @return 写入的样条数量
+	 */
+	int32 CaptureCityLayout(FCityLayout& OutLayout, bool bSaveActorTag = false, bool bSaveCompTag = false);
+
+	/**
+	 * 按布局数据生成样条Actor，同一OwnerActorID的样条挂在同一个Actor上
+	 */
+	void SpawnCityLayout(const FCityLayout& InLayout, bool bTryParseActorTag = false, bool bTryParseCompTag = false);
+
 	/**
 	 * 向已经存在的Actor添加SplineComponent并设置其参数
 	 * @param TargetActor 目标Actor
@@ -88,6 +113,14 @@ public:
 protected:
 	TObjectPtr<UWorld> GetEditorContext() const;
 
+	/**
+	 * 按布局数据生成样条Actor，SpawnedActors在多次调用间共享，用于流式读取时把后续样条挂到已生成的Actor上
+	 * @param SpawnedActors OwnerActorID到已生成Actor的映射
+	 * @return 生成的样条数量
+	 */
+	int32 SpawnCityLayout(const FCityLayout& InLayout, TMap<FGuid, TObjectPtr<AActor>>& SpawnedActors,
+	                      bool bTryParseActorTag, bool bTryParseCompTag);
+
 
 #pragma endregion UserSplineManage
 	
@@ -0,0 +1,172 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 单条样条的布局信息，控制点数据保存在FCityLayout的连续数组中，以FirstPoint和PointNum索引
+ */
+struct FCityLayoutSpline
+{
+	FCityLayoutSpline()
+	{
+	};
+
+	FString OwnerName;
+
+	/**
+	 * 用于判定是不是同一个Actor身上的多个SplineComp
+	 */
+	FGuid OwnerActorID;
+
+	int32 Index = 0;
+
+	FTransform OwnerTransform = FTransform::Identity;
+
+	bool bClosedLoop = false;
+
+	TArray<FName> ActorTags;
+
+	TArray<FName> CompTags;
+
+	/**
+	 * 第一个控制点在FCityLayout点数组中的下标
+	 */
+	int32 FirstPoint = 0;
+
+	int32 PointNum = 0;
+};
+
+/**
+ * 场景样条布局，与Json、二进制两种文件格式对应的内存数据，控制点以SoA连续存储，坐标为样条局部空间
+ */
+struct CITYGENERATOR_API FCityLayout
+{
+	FCityLayout()
+	{
+	};
+
+	TArray<FCityLayoutSpline> Splines;
+
+	/**
+	 * ESplinePointType::Type
+	 */
+	TArray<uint8> PointTypes;
+
+	TArray<FVector> PointLocations;
+
+	TArray<FVector> PointTangents;
+
+	TArray<FRotator> PointRotations;
+
+	/**
+	 * 追加一条样条，控制点数组长度需一致
+	 * @return 样条在Splines中的下标
+	 */
+	int32 AddSpline(FCityLayoutSpline&& InSpline, TConstArrayView<uint8> InTypes, TConstArrayView<FVector> InLocations,
+	                TConstArrayView<FVector> InTangents, TConstArrayView<FRotator> InRotations);
+
+	int32 GetPointNum() const { return PointLocations.Num(); }
+
+	bool IsEmpty() const { return Splines.IsEmpty(); }
+
+	void Reset();
+
+	/**
+	 * 控制点数组长度一致且每条样条的点范围有效
+	 */
+	bool IsValid() const;
+};
+
+/**
+ * 城市样条布局的读写，支持UCityGeneratorSubSystem原有的Json格式和紧凑二进制格式(.citylayout)，按文件后缀选择
+ * 二进制格式为小端序，结构为：文件头、字符串表、样条表、标签下标表、控制点类型/位置/切线/旋转四个连续数组
+ * 各段起始位置记录在文件头中并按16字节对齐，控制点数组可以直接内存映射，读取时每个数组只做一次Memcpy
+ */
+class CITYGENERATOR_API FCityLayoutSerializer
+{
+public:
+	/**
+	 * 二进制文件魔数"CTLY"
+	 */
+	static constexpr uint32 BinaryMagic = 0x594C5443;
+
+	/**
+	 * 二进制格式版本，文件头或段布局变化时递增，读取时拒绝更高版本
+	 */
+	static constexpr uint32 BinaryVersion = 1;
+
+	static const TCHAR* BinaryExtension;
+
+	static const TCHAR* JsonExtension;
+
+	/**
+	 * 写入二进制格式
+	 * @param InLayout 布局数据
+	 * @param OutBytes 原位覆盖的文件内容
+	 * @return 布局数据有效返回true
+	 */
+	static bool WriteBinary(const FCityLayout& InLayout, TArray<uint8>& OutBytes);
+
+	/**
+	 * 读取二进制格式，校验魔数、版本和各段范围
+	 * @param InBytes 文件内容
+	 * @param OutLayout 被重置并写入
+	 * @return 成功返回true
+	 */
+	static bool ReadBinary(TConstArrayView<uint8> InBytes, FCityLayout& OutLayout);
+
+	/**
+	 * 写入与UCityGeneratorSubSystem::SerializeSplines相同结构的Json
+	 */
+	static bool WriteJson(const FCityLayout& InLayout, FString& OutJsonStr);
+
+	/**
+	 * 读取UCityGeneratorSubSystem::SerializeSplines生成的Json，缺失的字段保持默认值
+	 */
+	static bool ReadJson(const FString& InJsonStr, FCityLayout& OutLayout);
+
+	/**
+	 * 每读完一条样条调用一次，传入只含该样条的布局（FirstPoint为0），返回false时停止读取
+	 * 布局在两次调用之间复用，需要保留的数据应在回调中复制
+	 */
+	using FOnSplineRead = TFunctionRef<bool(const FCityLayout& InSplineLayout)>;
+
+	/**
+	 * 流式读取Json，基于TJsonReader的记号事件逐条解码样条，不构建DOM，峰值内存只与最大的单条样条有关
+	 * 字段含义与ReadJson一致，未知字段跳过
+	 * @param InArchive UTF-8编码的Json（可带BOM）
+	 * @param OnSplineRead 每条样条的回调
+	 * @return 读取到文件末尾或被回调停止返回true，Json格式错误返回false，出错前已回调的样条不回滚
+	 */
+	static bool ReadJsonStreaming(FArchive& InArchive, FOnSplineRead OnSplineRead);
+
+	/**
+	 * 流式读取Json文件，UTF-16编码的旧文件回退到ReadJson后逐条回调
+	 * @param FileFullPath .json文件
+	 * @param OnSplineRead 每条样条的回调
+	 * @return 成功返回true
+	 */
+	static bool ReadJsonFileStreaming(const FString& FileFullPath, FOnSplineRead OnSplineRead);
+
+	/**
+	 * 按后缀保存，.citylayout为二进制，其余为UTF-8编码的Json
+	 */
+	static bool SaveToFile(const FCityLayout& InLayout, const FString& FileFullPath);
+
+	/**
+	 * 按后缀读取，.citylayout为二进制，.json为Json（流式读取）
+	 */
+	static bool LoadFromFile(const FString& FileFullPath, FCityLayout& OutLayout);
+
+	/**
+	 * 格式转换，源文件和目标文件格式都由后缀决定
+	 * @param SourceFullPath 源文件
+	 * @param TargetFullPath 目标文件，已存在时覆盖
+	 * @return 成功返回true
+	 */
+	static bool ConvertFile(const FString& SourceFullPath, const FString& TargetFullPath);
+
+	static bool IsBinaryPath(const FString& FileFullPath);
+};
@@ -0,0 +1,87 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CityGeneratorCommandlet.generated.h"
+
+class UDynamicMeshComponent;
+struct FPlacedBuilding;
+
+/**
+ * 无界面批量生成城市，用于构建机/CI按区块重新生成
+ * 读取DeserializeSplines格式的样条文件（.json或.citylayout），在新建的空白地图中依次生成交汇路口→道路→街区→建筑，
+ * 将各类Mesh导出为OBJ并写出各阶段耗时报告（Report.json）
+ * 任一阶段没有产出对象或保存地图失败时在报告中记录失败原因并返回非0
+ * 用法：UnrealEditor-Cmd <Project> -run=CityGenerator -Splines=<Json路径> [-Output=<目录>] [-SaveMap=<包路径>]
+ *       [-NoBuildings] -nullrhi -unattended
+ * 相对路径以项目目录为基准，Output默认为Saved/CityGenerator/<Json文件名>
+ */
+UCLASS()
+class CITYGENERATOR_API UCityGeneratorCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCityGeneratorCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	/**
+	 * 单个生成阶段的统计
+	 */
+	struct FStageReport
+	{
+		FString Name;
+		double Seconds = 0.0;
+		/**
+		 * 该阶段产出的对象数量（样条、路口、道路、街区或建筑）
+		 */
+		int32 Count = 0;
+		/**
+		 * 阶段内各对象Mesh构建耗时之和，目前只统计道路扫掠，用于对比CityGenerator.Road.NativeSweep开关
+		 */
+		double MeshBuildSeconds = 0.0;
+		/**
+		 * 失败原因，为空表示该阶段成功
+		 */
+		FString Error;
+	};
+
+	/**
+	 * 将Generator所在Actor的DynamicMesh以世界坐标追加到OBJ文本
+	 * @param MeshComponent 目标Mesh组件
+	 * @param ObjectName OBJ中的对象名
+	 * @param OutObjText OBJ文本
+	 * @param InOutVertexOffset 已写入的顶点数，OBJ顶点编号全文件连续
+	 * @return 写入的三角形数
+	 */
+	static int32 AppendDynamicMeshToObj(const UDynamicMeshComponent* MeshComponent, const FString& ObjectName,
+	                                    FString& OutObjText, int32& InOutVertexOffset);
+
+	/**
+	 * 将建筑包围盒以长方体追加到OBJ文本，与FPlacedBuilding::DrawDebugShape一致以Location为中心
+	 * @param InBuildings 放置结果
+	 * @param OutObjText OBJ文本
+	 * @param InOutVertexOffset 已写入的顶点数
+	 */
+	static void AppendBuildingsToObj(const TArray<FPlacedBuilding>& InBuildings, FString& OutObjText,
+	                                 int32& InOutVertexOffset);
+
+	/**
+	 * 导出一类Generator的Mesh
+	 * @return 写入的三角形数
+	 */
+	template <typename GeneratorType>
+	static int32 ExportGeneratorsToObj(const TArray<TWeakObjectPtr<GeneratorType>>& InGenerators,
+	                                   const FString& FilePath);
+
+	/**
+	 * 写出各阶段统计，有阶段失败时Succeeded为false
+	 * @return 写入成功返回true
+	 */
+	static bool WriteReport(const FString& FilePath, const FString& InSplineFile, const TArray<FStageReport>& InStages,
+	                        const TMap<FString, int32>& InTriangleCounts);
+};
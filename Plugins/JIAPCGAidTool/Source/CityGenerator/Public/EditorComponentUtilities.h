@@ -23,8 +23,16 @@ public:
  */
 	[[nodiscard]] static TObjectPtr<AActor> SpawnEmptyActor(const FString& ActorName, const FTransform& ActorTrans);
 
+	/**
+ * 辅助函数，设置ActorLabel，Actor在当前FEditorSpawnBatch中生成时推迟到批处理提交
+ * @param TargetActor 目标Actor
+ * @param ActorName ActorLable
+ */
+	static void SetActorLabelInEditor(AActor* TargetActor, const FString& ActorName);
+
 	/**
  * 辅助函数，在编辑器中为Actor添加指定类型的Component
+ * FEditorSpawnBatch生效时只创建和挂接，注册推迟到批处理提交
  * @param TargetActor 目标Actor
  * @param TargetComponentClass 需要添加的Component类型 
  * @return 返回ActorComponent，根据需要Cast
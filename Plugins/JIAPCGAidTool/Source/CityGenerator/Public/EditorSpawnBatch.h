@@ -0,0 +1,92 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FScopedTransaction;
+
+/**
+ * 编辑器中批量生成Actor的作用域，生效期间UEditorComponentUtilities::SpawnEmptyActor和AddComponentInEditor进入批处理：
+ * 1.整批只开启一个编辑器事务，本批生成的Actor不再逐次Modify，撤销时整批删除
+ * 2.Component只创建和挂接，注册和ActorLabel设置推迟到Commit，按Actor一次性注册
+ * 作用域只能在游戏线程使用，嵌套时内层并入外层，由最外层提交
+ * Commit前新建的Component尚未注册，调用方不能在批内生成Mesh或依赖渲染状态
+ */
+class CITYGENERATOR_API FEditorSpawnBatch
+{
+public:
+	/**
+	 * @param InBatchName 事务名和耗时日志中的名称
+	 */
+	explicit FEditorSpawnBatch(const FString& InBatchName);
+
+	~FEditorSpawnBatch();
+
+	FEditorSpawnBatch(const FEditorSpawnBatch&) = delete;
+
+	FEditorSpawnBatch& operator=(const FEditorSpawnBatch&) = delete;
+
+	/**
+	 * 注册本批所有Component并设置ActorLabel，结束事务并输出耗时，析构时未提交会自动提交
+	 */
+	void Commit();
+
+	/**
+	 * @return 当前生效的批处理，没有或CityGenerator.Editor.BatchedSpawn关闭时返回nullptr
+	 */
+	static FEditorSpawnBatch* GetActive();
+
+	/**
+	 * 记录本批生成的Actor，Label在Commit时设置
+	 */
+	void AddSpawnedActor(AActor* InActor, const FString& InActorLabel);
+
+	/**
+	 * 修改本批生成的Actor在Commit时设置的Label
+	 * @return Actor不在本批中返回false
+	 */
+	bool SetSpawnedActorLabel(const AActor* InActor, const FString& InActorLabel);
+
+	/**
+	 * 记录待注册的Component
+	 */
+	void AddPendingComponent(UActorComponent* InComponent);
+
+	/**
+	 * @return Actor是否在本批中生成，是则添加Component前不需要Modify
+	 */
+	bool IsSpawnedInBatch(const AActor* InActor) const;
+
+protected:
+	FString BatchName;
+
+	/**
+	 * 本批生成的Actor和对应Label
+	 */
+	TArray<TPair<TWeakObjectPtr<AActor>, FString>> SpawnedActors;
+
+	TSet<const AActor*> SpawnedActorSet;
+
+	/**
+	 * 需要注册Component的Actor，按首次加入顺序
+	 */
+	TArray<TWeakObjectPtr<AActor>> PendingActors;
+
+	TSet<const AActor*> PendingActorSet;
+
+	int32 PendingComponentNum = 0;
+
+	TUniquePtr<FScopedTransaction> Transaction;
+
+	double StartTime = 0.0;
+
+	/**
+	 * 是否为最外层且批处理开启，否则本作用域不做任何事
+	 */
+	bool bIsOwner = false;
+
+	bool bCommitted = false;
+
+	static FEditorSpawnBatch* ActiveBatch;
+};
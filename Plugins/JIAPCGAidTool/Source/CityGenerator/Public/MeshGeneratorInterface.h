@@ -4,8 +4,32 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Interface.h"
+#include "DynamicMesh/DynamicMesh3.h"
 #include "MeshGeneratorInterface.generated.h"
 
+class UDynamicMesh;
+
+/**
+ * BuildMesh的结果，BuildMesh可能在工作线程执行，需要交给游戏线程的内容都写在这里，由CommitMesh取走
+ */
+struct FMeshBuildResult
+{
+	/**
+	 * 显示的Mesh，局部空间
+	 */
+	UE::Geometry::FDynamicMesh3 Mesh;
+
+	/**
+	 * LOD1及以后的Mesh，不支持LOD的Generator为空
+	 */
+	TArray<UE::Geometry::FDynamicMesh3> LODMeshes;
+
+	/**
+	 * BuildMesh的耗时
+	 */
+	double BuildSeconds = 0.0;
+};
+
 // This class does not need to be modified.
 UINTERFACE()
 class UMeshGeneratorInterface : public UInterface
@@ -23,16 +47,77 @@ class CITYGENERATOR_API IMeshGeneratorInterface
 public:
 	virtual void SetMeshComponent(class UDynamicMeshComponent* InMeshComponent) =0;
 
-	virtual bool GenerateMesh() =0;
+	/**
+	 * 在游戏线程依次调用PrepareBuild、BuildMesh、CommitMesh生成单个对象的Mesh
+	 * 批量生成时由调用方拆开三个阶段，BuildMesh放到ParallelFor中执行
+	 * @return 生成成功返回true
+	 */
+	virtual bool GenerateMesh();
+
+	/**
+	 * 构建前的准备，只在游戏线程调用：检查数据、读取Owner变换、加载材质、创建临时UDynamicMesh，失败时提示
+	 * @return 可以构建返回true
+	 */
+	virtual bool PrepareBuild() =0;
+
+	/**
+	 * 只读取类内保存的生成数据构建Mesh，不访问Component、Owner和World，不修改自身，不同对象可以并行
+	 * RequiresGameThreadBuild返回true时只能在游戏线程调用，否则可在任意线程调用
+	 * @param OutResult 写入的Mesh和附带结果
+	 * @return 构建成功返回true
+	 */
+	virtual bool BuildMesh(FMeshBuildResult& OutResult) const =0;
+
+	/**
+	 * 只在游戏线程调用，把BuildMesh结果中的Mesh替换到UDynamicMeshComponent并递增Mesh版本号
+	 * 子类重写时需要调用父类实现，并在此保存结果中的其余内容
+	 * @param InResult BuildMesh的结果
+	 */
+	virtual void CommitMesh(FMeshBuildResult&& InResult);
+
+	/**
+	 * BuildMesh需要在临时UDynamicMesh上调用GeometryScript函数时返回true，批量生成时不放入ParallelFor，在游戏线程串行构建
+	 * 结果取决于PrepareBuild读取的控制台变量，在PrepareBuild之后调用
+	 */
+	virtual bool RequiresGameThreadBuild() const { return false; }
 
 	int32 GetGlobalIndex() const { return GlobalIndex; };
 
 	void SetDrawVisualDebug(bool bDrawDebug) { bDrawVisualDebug = bDrawDebug; };
 
+	/**
+	 * 复用已有Actor重新生成前调用，清空UDynamicMesh和上次写入的生成数据，Component和GlobalIndex保持不变
+	 * 子类重写时需要调用父类实现
+	 */
+	virtual void ResetForRegenerate();
+
+	/**
+	 * 生成时所对应的拓扑键，重新生成时据此在TGeneratedActorPool中匹配可复用的Actor
+	 */
+	uint32 GetTopologyKey() const { return TopologyKey; }
+
+	void SetTopologyKey(uint32 InTopologyKey) { TopologyKey = InTopologyKey; }
+
+	/**
+	 * Mesh内容版本号，每次CommitMesh或ResetForRegenerate后递增，城市瓦片据此判断是否需要重新合并
+	 */
+	uint32 GetMeshRevision() const { return MeshRevision; }
+
+	UDynamicMeshComponent* GetMeshComponent() const { return MeshComponent.Get(); }
+
 protected:
+	/**
+	 * BuildMesh中调用GeometryScript函数后，把临时UDynamicMesh的内容移出到结果Mesh，只在游戏线程调用
+	 */
+	static void MoveScratchMeshTo(UDynamicMesh* InScratchMesh, UE::Geometry::FDynamicMesh3& OutMesh);
+
 	TWeakObjectPtr<UDynamicMeshComponent> MeshComponent;
 
 	int32 GlobalIndex = 0;
 
+	uint32 TopologyKey = 0;
+
+	uint32 MeshRevision = 0;
+
 	bool bDrawVisualDebug = false;
 };
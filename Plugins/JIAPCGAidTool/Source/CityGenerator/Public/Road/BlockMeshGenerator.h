@@ -27,7 +27,30 @@ public:
 
 	virtual void SetMeshComponent(class UDynamicMeshComponent* InMeshComponent) override;
 
-	virtual bool GenerateMesh() override;
+	/**
+	 * IMeshGeneratorInterface接口，检查挤出轮廓并加载材质
+	 */
+	virtual bool PrepareBuild() override;
+
+	/**
+	 * IMeshGeneratorInterface接口，在临时UDynamicMesh上三角化、挤出、内缩并设置材质ID，只在游戏线程调用
+	 */
+	virtual bool BuildMesh(FMeshBuildResult& OutResult) const override;
+
+	/**
+	 * IMeshGeneratorInterface接口，BuildMesh全部使用GeometryScript，始终在游戏线程构建
+	 */
+	virtual bool RequiresGameThreadBuild() const override { return true; }
+
+	/**
+	 * IMeshGeneratorInterface接口，额外刷新材质
+	 */
+	virtual void CommitMesh(FMeshBuildResult&& InResult) override;
+
+	/**
+	 * IMeshGeneratorInterface接口，额外清空轮廓和道路控制点，RefSpline保留并在下次生成时复用
+	 */
+	virtual void ResetForRegenerate() override;
 
 	void SetInnerSplinePoints(const TArray<FInterpCurveVector>& InOrderedControlPoints);
 	
@@ -42,13 +65,18 @@ public:
 	UFUNCTION(BlueprintCallable)
 	TArray<FVector2D> GetExtrudePath() const { return ExtrudePath; };
 
+	/**
+	 * 由GenerateInnerRefSpline或ExtractLinearContourOfInnerArea生成的街区内轮廓样条，未生成时为空
+	 */
+	USplineComponent* GetRefSpline() const { return RefSpline; }
+
 protected:
 	/**
 	 * Block生成挤出截面
 	 */
 	TArray<FVector2D> ExtrudePath;
 
-	void GenerateBorderEdgeArray(const TArray<FVector2D>& InBorderPoints, TArray<FIntPoint>& OutBorderEdgeArray);
+	static void GenerateBorderEdgeArray(const TArray<FVector2D>& InBorderPoints, TArray<FIntPoint>& OutBorderEdgeArray);
 
 	/**
 	 * BlockComp全局ID
@@ -64,6 +92,12 @@ protected:
 
 	void InitialMaterials();
 
+	/**
+	 * BuildMesh中调用GeometryScript函数使用的临时Mesh，在PrepareBuild中创建，每个对象独占
+	 */
+	UPROPERTY(Transient)
+	TObjectPtr<UDynamicMesh> BuildScratchMesh = nullptr;
+
 	const TArray<FString> MaterialsPath{
 		"/Game/Road/Material/MI/MI_FreewayConcrete_PropsWS02", "/Game/Road/Material/MI/MI_Sidewalk_Plaza_E_WS"
 	};
@@ -0,0 +1,261 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SplineComponent.h"
+#include "Road/RoadGraphForBlock.h"
+#include "Road/RoadSegmentStruct.h"
+#include "Road/SegmentBVH.h"
+#include "Road/SplineSegmentStore.h"
+#include "Road/SplineSnapshot.h"
+
+/**
+ * CityModel中的样条，即带ID和重采样结果的样条快照，曲线数据与USplineComponent::SplineCurves相同
+ */
+struct CITYGENERATOR_API FCityModelSpline : public FSplineSnapshot
+{
+	FCityModelSpline()
+	{
+	};
+
+	explicit FCityModelSpline(FSplineSnapshot&& InSnapshot) : FSplineSnapshot(MoveTemp(InSnapshot))
+	{
+	};
+
+	/**
+	 * 样条ID，即在FCityModel::Splines中的下标
+	 */
+	int32 ID = INDEX_NONE;
+
+	/**
+	 * 重采样点，世界空间，由FCityModelBuilder::ResampleSplines填充
+	 */
+	TArray<FTransform> ResamplePoints;
+
+	/**
+	 * 各重采样点到样条起点的距离，与ResamplePoints一一对应
+	 */
+	TArray<double> ResampleDistances;
+
+	/**
+	 * 在FCityModel::Segments中的SplineId，重采样点不足两个时为INDEX_NONE
+	 */
+	int32 SegmentSplineId = INDEX_NONE;
+
+	/**
+	 * 由世界空间控制点构建样条，切线自动计算，用于测试和不经过USplineComponent的批量输入
+	 * @param InPointsWS 世界空间控制点
+	 * @param bInClosedLoop 是否闭合
+	 * @param bInLinear 控制点是否为Linear类型，否则为CurveAuto
+	 * @return 构建完成的样条，ID需由FCityModel::AddSpline分配
+	 */
+	static FCityModelSpline MakeFromPoints(const TArray<FVector>& InPointsWS, bool bInClosedLoop = false,
+	                                       bool bInLinear = false);
+
+	/**
+	 * 由序列化布局中的一条样条构建，点类型和切线按文件还原，旋转曲线取默认值（生成流程只使用位置曲线）
+	 * 用于流式读取Json时直接填充CityModel，不经过USplineComponent
+	 * @param InLayout 布局数据
+	 * @param SplineIndex 样条在InLayout.Splines中的下标
+	 * @return 构建完成的样条，ID需由FCityModel::AddSpline分配
+	 */
+	static FCityModelSpline MakeFromLayout(const struct FCityLayout& InLayout, int32 SplineIndex);
+};
+
+/**
+ * 交汇路口的一个入口，对应FIntersectionSegment，以样条ID代替样条引用
+ */
+struct FCityModelEntry
+{
+	FCityModelEntry()
+	{
+	};
+
+	int32 SplineID = INDEX_NONE;
+	/**
+	 * 沿样条方向的端点，交点为另一端点
+	 */
+	FVector EndPoint = FVector::ZeroVector;
+
+	FRotator EndRotation = FRotator::ZeroRotator;
+	/**
+	 * 驶入端位于交点之前（距离较小），驶出端位于交点之后
+	 */
+	bool bIsFlowIn = true;
+
+	float RoadWidth = 0.0f;
+	/**
+	 * 与道路衔接的位置，由端点向交点中心内缩，与UIntersectionMeshGenerator对外汇报的衔接点一致
+	 */
+	FVector ConnectionPoint = FVector::ZeroVector;
+};
+
+/**
+ * 交汇路口，对应FSplineIntersection与拆分后的FIntersectionSegment数组
+ */
+struct FCityModelIntersection
+{
+	FCityModelIntersection()
+	{
+	};
+
+	/**
+	 * 路口ID，即在FCityModel::Intersections中的下标
+	 */
+	int32 ID = INDEX_NONE;
+
+	FVector Location = FVector::ZeroVector;
+
+	/**
+	 * 经过该路口的样条ID，同一样条只记录一次，按原始交点中首次出现的顺序
+	 */
+	TArray<int32> SplineIDs;
+
+	/**
+	 * 合并到该路口的原始交点，每个元素为(GlobalIndexA<<32|GlobalIndexB)，升序，与FSplineIntersection::SourceHitPairs相同
+	 */
+	TArray<uint64> SourceHitPairs;
+
+	/**
+	 * 以交点为中心按极角排序的入口，下标即EntryLocalIndex
+	 */
+	TArray<FCityModelEntry> Entries;
+
+	/**
+	 * 路口占用的二维范围，用于切分道路
+	 */
+	FBox2D OccupiedBox = FBox2D(ForceInit);
+};
+
+/**
+ * 道路，对应FRoadSpawnPlan，以样条ID代替样条引用，起止交汇路口使用CityModel中的路口ID
+ */
+struct FCityModelRoad
+{
+	FCityModelRoad()
+	{
+	};
+
+	/**
+	 * 道路ID，即在FCityModel::Roads中的下标
+	 */
+	int32 ID = INDEX_NONE;
+
+	int32 SplineID = INDEX_NONE;
+
+	/**
+	 * 连续分段和衔接信息，From/ToIntersectionIndex为路口ID
+	 */
+	FRoadSegmentsGroup RoadInfo;
+
+	/**
+	 * 道路起止交汇路口ID，无衔接为INT32_ERROR
+	 */
+	int32 ConnectedIntersections[2] = {INT32_ERROR, INT32_ERROR};
+
+	/**
+	 * 道路连接到起止交汇路口的入口局部ID
+	 */
+	int32 EntryIndexOfIntersections[2] = {INT32_ERROR, INT32_ERROR};
+};
+
+/**
+ * 街区，对应图中的一个最小环
+ */
+struct FCityModelBlock
+{
+	FCityModelBlock()
+	{
+	};
+
+	int32 ID = INDEX_NONE;
+
+	/**
+	 * 环路，RoadIndexes为道路ID，IntersectionIndexes为路口ID，首个路口位于IntersectionIndexes.Last(0)
+	 */
+	FBlockLinkInfo Loop;
+
+	/**
+	 * 沿环路方向的道路中心线和路口中心，世界空间
+	 */
+	TArray<FVector> Contour;
+};
+
+/**
+ * 城市生成的纯数据模型，不持有任何UObject，各对象之间以整数ID互相引用，可以在任意线程构建、在测试中直接断言
+ * 由FCityModelBuilder逐阶段填充：样条→Segment→交汇路口→道路→路网图→街区
+ * 编辑器中URoadGeneratorSubsystem的各阶段先由场景样条或已生成的Actor构建CityModel，运行FCityModelBuilder的对应阶段后再写回
+ */
+struct CITYGENERATOR_API FCityModel
+{
+	FCityModel()
+	{
+	};
+
+	/**
+	 * 添加样条并分配ID
+	 * @param InSpline 样条数据
+	 * @return 样条ID
+	 */
+	int32 AddSpline(FCityModelSpline&& InSpline);
+
+	/**
+	 * 清空除样条曲线以外的所有生成结果
+	 */
+	void ResetGeneratedData();
+
+	/**
+	 * 清空所有数据
+	 */
+	void Reset();
+
+	/**
+	 * 返回Segment所属样条ID
+	 * @param SegmentIndex Segments中的存储下标
+	 * @return 样条ID
+	 */
+	int32 GetSplineIDOfSegment(int32 SegmentIndex) const
+	{
+		return StoreSplineToSplineID[Segments.GetSplineId(SegmentIndex)];
+	}
+
+	TArray<FCityModelSpline> Splines;
+
+	/**
+	 * 所有样条的Segment，通过GetSplineIDOfSegment查找样条ID
+	 * 由FCityModelBuilder::ResampleSplines填充时样条引用为空；道路切分前由编辑器现有数据复制时保留样条引用
+	 */
+	FSplineSegmentStore Segments;
+
+	/**
+	 * 以Segments下标构建的BVH
+	 */
+	FSegmentBVH SegmentBVH;
+
+	/**
+	 * Segments中的SplineId到样条ID，不在Splines中的样条为INDEX_NONE
+	 */
+	TArray<int32> StoreSplineToSplineID;
+
+	/**
+	 * 按(GlobalIndexA,GlobalIndexB)排序的全部原始交点，由FCityModelBuilder::FindIntersections填充
+	 */
+	TArray<FSegmentPairHit> SegmentHits;
+
+	TArray<FCityModelIntersection> Intersections;
+
+	TArray<FCityModelRoad> Roads;
+
+	/**
+	 * 切分道路时外部没有衔接道路的路口衔接点，用于Debug绘制
+	 */
+	TArray<FVector> UnconnectedPoints;
+
+	/**
+	 * 以路口ID为下标的邻接表，第二维下标为入口局部ID，未连接道路的入口为无效边，ToNodeIndex为路口ID，RoadIndex为道路ID
+	 */
+	TArray<TArray<FRoadGraphEdge>> Graph;
+
+	TArray<FCityModelBlock> Blocks;
+};
@@ -0,0 +1,232 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FSplineSegmentStore;
+struct FBlockLinkInfo;
+struct FCityModel;
+struct FCityModelIntersection;
+struct FCityModelRoad;
+struct FCityModelSpline;
+struct FSegmentPairHit;
+struct FSplineSnapshot;
+
+/**
+ * 交点插入到连续分段的信息
+ */
+struct FConnectionInsertInfo
+{
+	FConnectionInsertInfo()
+	{
+	};
+	/**
+	 * 插入到二维数组ContinuousSegmentsGroups中一维的哪一个元素，即作为哪个连续SegmentsGroup的头或尾
+	 */
+	int32 GroupIndex = -1;
+	/**
+	 * 插入到连续SegmentsGroup的头部（true）或尾部（false），同时决定了插入位置，头部一定在原有元素之前，尾部一定在原有元素之后
+	 */
+	bool bConnectToGroupHead = true;
+	/**
+	* 连接点Transform
+	*/
+	FTransform ConnectionTrans;
+
+	/**
+	 * 连接的交汇路口ID
+	 */
+	int32 IntersectionGlobalIndex = INT32_ERROR;
+
+	/**
+	 * 连接的交汇路口的具体入口局部ID
+	 */
+	int32 EntryLocalIndex = INT32_ERROR;
+};
+
+/**
+ * FCityModelBuilder的参数，默认值与URoadGeneratorSubsystem一致，编辑器中由URoadGeneratorSubsystem::MakeBuildSettings生成
+ */
+struct FCityModelBuildSettings
+{
+	FCityModelBuildSettings()
+	{
+	};
+
+	/**
+	 * 定距采样时中点到弦的距离平方容差，Linear控制点两侧补点的间距为其4倍，对应URoadGeneratorSubsystem::PolyLineSampleDistance
+	 */
+	float SampleDistance = 200.0f;
+
+	/**
+	 * 长段细分阈值，超过该长度的Segment会被继续细分，也是自适应采样的最大步长
+	 */
+	float SegmentMaxLength = 2000.0f;
+
+	/**
+	 * 按弦高误差自适应采样，否则定距采样，对应CityGenerator.Road.ResampleMode
+	 */
+	bool bAdaptiveResample = false;
+
+	/**
+	 * 自适应采样的弦高误差容差，对应CityGenerator.Road.AdaptiveChordError
+	 */
+	float AdaptiveChordError = 5.0f;
+
+	/**
+	 * 交点合并阈值，对应URoadGeneratorSubsystem::MergeThreshold
+	 */
+	float MergeThreshold = 200.0f;
+
+	/**
+	 * 路口入口到交点的沿样条距离
+	 */
+	float EntryDistance = 1000.0f;
+
+	float RoadWidth = 500.0f;
+
+	/**
+	 * 衔接点由入口端点向路口中心内缩的距离，与UIntersectionMeshGenerator一致
+	 */
+	float ConnectionInset = 20.0f;
+
+	/**
+	 * 切分道路时查找衔接点所在Segment的范围，太小可能搜不到相邻节点，太大要筛选的量过多
+	 */
+	float ConnectionSearchRadius = 50.0f;
+
+	/**
+	 * 使用扫描线求交，否则使用BVH
+	 */
+	bool bUseSweepLine = false;
+
+	/**
+	 * 各样条、各路口之间并行处理
+	 */
+	bool bParallel = true;
+};
+
+/**
+ * 在FCityModel上运行的生成流程，不访问UObject，可在后台线程或测试中调用
+ * 各阶段需按顺序调用，每个阶段会清空其后阶段的结果
+ * URoadGeneratorSubsystem的各阶段同样先构建FCityModel再调用这里的函数，编辑器流程和批量流程只有这一套实现
+ */
+class CITYGENERATOR_API FCityModelBuilder
+{
+public:
+	explicit FCityModelBuilder(const FCityModelBuildSettings& InSettings = FCityModelBuildSettings());
+
+	/**
+	 * 依次执行全部阶段
+	 * @param InOutModel 已添加样条的CityModel
+	 * @return 找到至少一个交汇路口返回true，没有形成街区不视为失败
+	 */
+	bool Build(FCityModel& InOutModel) const;
+
+	/**
+	 * 1.重采样所有样条，写入Segments并构建SegmentBVH，GlobalIndex为Segment数量前缀和
+	 * @return 至少有一条有效样条返回true
+	 */
+	bool ResampleSplines(FCityModel& InOutModel) const;
+
+	/**
+	 * 2.求交、聚类合并为交汇路口，并拆分出按极角排序的入口，拆分失败的交点被丢弃，路口ID保持连续
+	 * 原始交点保留在SegmentHits中
+	 * @return 找到至少一个交汇路口返回true
+	 */
+	bool FindIntersections(FCityModel& InOutModel) const;
+
+	/**
+	 * 3.去除路口占用的Segment切分道路，并将道路首尾衔接到路口入口，道路ID按样条顺序分配
+	 * 只需要Splines、Segments、SegmentBVH、StoreSplineToSplineID和Intersections（ID、SplineIDs、Entries、OccupiedBox）
+	 * @return 切分出至少一条道路返回true
+	 */
+	bool SplitRoads(FCityModel& InOutModel) const;
+
+	/**
+	 * 4.以入口局部ID为槽位构建邻接表，只有两端都衔接路口的道路加入图
+	 * 只需要Intersections（ID、Entries）和Roads（ID、ConnectedIntersections、EntryIndexOfIntersections）
+	 */
+	void BuildGraph(FCityModel& InOutModel) const;
+
+	/**
+	 * 5.沿半边枚举最小环，去除面积最大的外轮廓，得到街区
+	 * 只需要Intersections（Location）、Roads和Graph
+	 * @return 找到至少一个街区返回true
+	 */
+	bool FindBlocks(FCityModel& InOutModel) const;
+
+	/**
+	 * 单条样条重采样，定距模式对每对相邻控制点先二等分再递归二分，直到中点到弦的距离平方不超过SampleDistance，
+	 * 自适应模式按弦高误差步进；之后在Linear控制点两侧补点并取两侧旋转的平均值，最后细分超过SegmentMaxLength的长段
+	 * 控制点处一定有采样点，只访问快照，可在后台线程调用
+	 * @param InSpline 目标样条快照
+	 * @param OutPoints 重采样点，世界空间
+	 * @param OutDistances 各重采样点到样条起点的距离，可为空
+	 */
+	void ResampleSpline(const FSplineSnapshot& InSpline, TArray<FTransform>& OutPoints,
+	                    TArray<double>* OutDistances = nullptr) const;
+
+	/**
+	 * 同上，原位写入ResamplePoints和ResampleDistances
+	 */
+	void ResampleSpline(FCityModelSpline& InOutSpline) const;
+
+	/**
+	 * 为交汇路口拆分入口、计算衔接点和占用范围，只访问快照，可在后台线程调用
+	 * @param InOutIntersection 需要已填写Location和SplineIDs，写入Entries和OccupiedBox，Entries的SplineID取自SplineIDs
+	 * @param InSplines 与SplineIDs一一对应的样条快照
+	 * @return 至少拆分出一个入口返回true
+	 */
+	bool TearIntersection(FCityModelIntersection& InOutIntersection,
+	                      const TArray<const FSplineSnapshot*>& InSplines) const;
+
+	/**
+	 * 单根样条的道路切分，只读访问InModel，可在多线程中调用
+	 * @param InModel CityModel
+	 * @param SplineID 目标样条
+	 * @param InIntersectionIDs 经过该样条的路口
+	 * @param OutRoads 原位追加的道路，ID由调用方分配
+	 * @param OutUnconnectedPoints 原位追加外部没有衔接道路的路口衔接点
+	 */
+	void SplitRoadsOnSpline(const FCityModel& InModel, int32 SplineID, const TArray<int32>& InIntersectionIDs,
+	                        TArray<FCityModelRoad>& OutRoads, TArray<FVector>& OutUnconnectedPoints) const;
+
+	/**
+	 * 将原始交点聚类合并为交汇路口，距离小于InMergeThreshold的交点传递合并（网格哈希+并查集）
+	 * 位置取聚类质心，同一样条在一个路口只记录一次，同时记录合并的原始交点Segment对
+	 * @param InStore 原始交点所在的存储，GlobalIndex需要都在其中
+	 * @param InHits 原始交点，仅影响输出的排列顺序
+	 * @param InMergeThreshold 合并阈值
+	 * @return 合并后的路口，SplineIDs为InStore中的SplineId，由调用方转换，只填写Location、SplineIDs和SourceHitPairs
+	 */
+	[[nodiscard]] static TArray<FCityModelIntersection> MergeSegmentHits(const FSplineSegmentStore& InStore,
+	                                                                    const TArray<FSegmentPairHit>& InHits,
+	                                                                    float InMergeThreshold);
+
+	/**
+	 * 以环路顶点坐标计算面积，去除面积最大的环（外轮廓）
+	 * @param InOutLoops FindSurfaces的结果
+	 * @param InIntersectionLocations 环路中路口ID到位置
+	 */
+	static void RemoveOuterLoop(TArray<FBlockLinkInfo>& InOutLoops,
+	                            TFunctionRef<FVector2D(int32 IntersectionID)> InIntersectionLocations);
+
+	const FCityModelBuildSettings& GetSettings() const { return Settings; }
+
+protected:
+	/**
+	 * 在定距采样的基础上按连续性查找衔接点所属的连续分段组
+	 * @param InStore 分段所在的存储
+	 * @param InContinuousSegmentsGroups 连续分段组，元素为GlobalIndex
+	 * @param OwnerSegmentID 衔接点所在Segment的GlobalIndex
+	 * @param PointTransWS 衔接点
+	 * @return 所属组和头尾
+	 */
+	static FConnectionInsertInfo FindInsertIndexInExistedContinuousSegments(
+		const FSplineSegmentStore& InStore, const TArray<TArray<uint32>>& InContinuousSegmentsGroups,
+		uint32 OwnerSegmentID, const FVector& PointTransWS);
+
+	FCityModelBuildSettings Settings;
+};
@@ -0,0 +1,103 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+class UMaterialInterface;
+
+/**
+ * 瓦片中三角形的来源类型
+ */
+enum class ECityTileSourceType : uint8
+{
+	Intersection,
+	Road,
+	Block
+};
+
+/**
+ * 瓦片Mesh中一段连续三角形和其来源对象，用于拾取和增量更新时定位
+ */
+struct FCityTileTriangleRange
+{
+	ECityTileSourceType SourceType = ECityTileSourceType::Road;
+
+	/**
+	 * 来源Generator的GlobalIndex
+	 */
+	int32 SourceIndex = INDEX_NONE;
+
+	int32 FirstTriangle = 0;
+
+	int32 TriangleNum = 0;
+
+	bool Contains(int32 TriangleID) const
+	{
+		return TriangleID >= FirstTriangle && TriangleID < FirstTriangle + TriangleNum;
+	}
+};
+
+/**
+ * 一个空间瓦片的合并Mesh，道路、交汇路口和街区的Mesh变换到瓦片局部空间后依次追加
+ * 只追加不删除，三角形ID连续，每个来源占据一段连续区间；材质按指针去重后重映射MaterialID
+ * 不依赖UObject，可在任意线程构建
+ */
+struct CITYGENERATOR_API FCityTileMesh
+{
+	/**
+	 * 合并后的Mesh，瓦片局部空间，启用MaterialID属性
+	 */
+	UE::Geometry::FDynamicMesh3 Mesh;
+
+	/**
+	 * 合并后的材质表，下标即Mesh中的MaterialID
+	 */
+	TArray<UMaterialInterface*> Materials;
+
+	/**
+	 * 按追加顺序排列的三角形区间
+	 */
+	TArray<FCityTileTriangleRange> TriangleRanges;
+
+	/**
+	 * 追加一个来源的Mesh
+	 * @param InSourceType 来源类型
+	 * @param InSourceIndex 来源GlobalIndex
+	 * @param InSourceMesh 来源Mesh，没有MaterialID属性时视为全部为0
+	 * @param InSourceToTile 来源局部空间到瓦片局部空间的变换
+	 * @param InSourceMaterials 来源组件的材质表，为空时使用一个空材质槽
+	 * @return 追加的三角形数量
+	 */
+	int32 AppendSource(ECityTileSourceType InSourceType, int32 InSourceIndex,
+	                   const UE::Geometry::FDynamicMesh3& InSourceMesh, const FTransform& InSourceToTile,
+	                   TConstArrayView<UMaterialInterface*> InSourceMaterials);
+
+	/**
+	 * 二分查找三角形所属的区间
+	 * @return 找到返回区间，否则nullptr
+	 */
+	const FCityTileTriangleRange* FindRangeByTriangle(int32 TriangleID) const;
+
+	void Reset();
+
+	/**
+	 * 世界坐标所在的瓦片，按XY向下取整
+	 */
+	static FIntPoint GetTileCoord(const FVector& InWorldLocation, double InTileSize);
+
+	/**
+	 * 瓦片原点（最小角）的世界坐标
+	 */
+	static FVector GetTileOrigin(const FIntPoint& InTileCoord, double InTileSize);
+
+	/**
+	 * 在已排序的区间中二分查找三角形，供只保存区间表的调用方使用
+	 */
+	static const FCityTileTriangleRange* FindRangeByTriangle(TConstArrayView<FCityTileTriangleRange> InRanges,
+	                                                         int32 TriangleID);
+
+protected:
+	int32 FindOrAddMaterial(UMaterialInterface* InMaterial);
+};
@@ -0,0 +1,126 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+/**
+ * 全量重新生成时回收上次生成的Generator，按拓扑键分桶，同一桶内按Owner位置取最近的一个复用
+ * 复用时Actor、UDynamicMeshComponent和GlobalIndex保持不变，只重置Mesh数据，大纲视图和外部引用不受影响
+ * 生成结束后仍留在池中的Generator对应的拓扑已经消失，由DestroyRemaining销毁其Actor
+ * 生成被取消时由RestoreTo把剩余Generator放回表中，复用过的Generator可由WasReused区分
+ * @tparam GeneratorType 实现IMeshGeneratorInterface的Generator类型
+ */
+template <typename GeneratorType>
+class TGeneratedActorPool
+{
+public:
+	/**
+	 * 回收Generator，键取自IMeshGeneratorInterface::GetTopologyKey
+	 */
+	void Add(GeneratorType* InGenerator)
+	{
+		if (nullptr != InGenerator && nullptr != InGenerator->GetOwner())
+		{
+			Entries.Add(InGenerator->GetTopologyKey(), InGenerator);
+		}
+	}
+
+	/**
+	 * 取出拓扑键相同且Owner距离给定位置最近的Generator
+	 * @param InTopologyKey 新对象的拓扑键
+	 * @param InLocation 新对象的Actor位置，用于区分同一拓扑键下的多个对象
+	 * @return 可复用的Generator，没有返回nullptr
+	 */
+	GeneratorType* Take(uint32 InTopologyKey, const FVector& InLocation)
+	{
+		TArray<TWeakObjectPtr<GeneratorType>, TInlineAllocator<4>> Candidates;
+		Entries.MultiFind(InTopologyKey, Candidates);
+		GeneratorType* BestGenerator = nullptr;
+		double BestDistSquared = TNumericLimits<double>::Max();
+		for (const TWeakObjectPtr<GeneratorType>& Candidate : Candidates)
+		{
+			if (!Candidate.IsValid() || nullptr == Candidate->GetOwner())
+			{
+				continue;
+			}
+			const double DistSquared = FVector::DistSquared(Candidate->GetOwner()->GetActorLocation(), InLocation);
+			if (DistSquared < BestDistSquared)
+			{
+				BestDistSquared = DistSquared;
+				BestGenerator = Candidate.Get();
+			}
+		}
+		if (nullptr != BestGenerator)
+		{
+			Entries.RemoveSingle(InTopologyKey, BestGenerator);
+			ReusedGenerators.Add(BestGenerator);
+		}
+		return BestGenerator;
+	}
+
+	/**
+	 * 销毁池中剩余Generator的Actor并清空
+	 * @return 销毁的Actor数量
+	 */
+	int32 DestroyRemaining()
+	{
+		int32 DestroyedNum = 0;
+		for (const TPair<uint32, TWeakObjectPtr<GeneratorType>>& Entry : Entries)
+		{
+			if (Entry.Value.IsValid() && nullptr != Entry.Value->GetOwner())
+			{
+				Entry.Value->GetOwner()->Destroy();
+				DestroyedNum++;
+			}
+		}
+		Entries.Reset();
+		return DestroyedNum;
+	}
+
+	/**
+	 * 把池中剩余的Generator按GlobalIndex放回表中并清空，不销毁Actor
+	 * @param OutIDToGenerator 取消生成时需要恢复的GlobalIndex到Generator表
+	 */
+	void RestoreTo(TMap<int32, TWeakObjectPtr<GeneratorType>>& OutIDToGenerator)
+	{
+		for (const TPair<uint32, TWeakObjectPtr<GeneratorType>>& Entry : Entries)
+		{
+			if (Entry.Value.IsValid() && nullptr != Entry.Value->GetOwner())
+			{
+				OutIDToGenerator.Emplace(Entry.Value->GetGlobalIndex(), Entry.Value);
+			}
+		}
+		Reset();
+	}
+
+	/**
+	 * @return 上次Reset之后是否由Take取出过该Generator
+	 */
+	bool WasReused(const TWeakObjectPtr<GeneratorType>& InGenerator) const
+	{
+		return ReusedGenerators.Contains(InGenerator);
+	}
+
+	/**
+	 * @return 上次Reset之后复用的数量
+	 */
+	int32 GetReusedNum() const { return ReusedGenerators.Num(); }
+
+	bool IsEmpty() const { return Entries.IsEmpty(); }
+
+	/**
+	 * 清空记录，不销毁Actor
+	 */
+	void Reset()
+	{
+		Entries.Reset();
+		ReusedGenerators.Reset();
+	}
+
+protected:
+	TMultiMap<uint32, TWeakObjectPtr<GeneratorType>> Entries;
+
+	TSet<TWeakObjectPtr<GeneratorType>> ReusedGenerators;
+};
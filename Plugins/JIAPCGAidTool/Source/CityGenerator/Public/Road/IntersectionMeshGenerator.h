@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "MeshGeneratorInterface.h"
 #include "Road/RoadSegmentStruct.h"
+#include "Road/RoadCrossSectionProfile.h"
 #include "Components/ActorComponent.h"
 #include "IntersectionMeshGenerator.generated.h"
 
@@ -38,16 +39,36 @@ public:
 	TArray<FIntersectionSegment> GetRoadConnectionPoint(const TWeakObjectPtr<USplineComponent> InOwnerSpline);
 
 	/**
-	 * IMeshGeneratorInterface接口，根据类内的IntersectionsData数据调用同一Owner下挂载的UDynamicMeshComponent创建路口Mesh
-	 * @return 返回创建Mesh是否成功 
+	 * IMeshGeneratorInterface接口，检查IntersectionsData，计算挤出截面和OccupiedBox，耳切挤出截面并加载材质
+	 * @return 返回能否创建Mesh
 	 */
-	virtual bool GenerateMesh() override;
+	virtual bool PrepareBuild() override;
+
+	/**
+	 * IMeshGeneratorInterface接口，按挤出截面挤出路口并计算法线，原生挤出时可在任意线程调用
+	 */
+	virtual bool BuildMesh(FMeshBuildResult& OutResult) const override;
+
+	/**
+	 * IMeshGeneratorInterface接口，原生挤出关闭或耳切失败回退GeometryScript时在游戏线程构建
+	 */
+	virtual bool RequiresGameThreadBuild() const override { return !bUseNativeExtrude; }
+
+	/**
+	 * IMeshGeneratorInterface接口，额外刷新材质
+	 */
+	virtual void CommitMesh(FMeshBuildResult&& InResult) override;
 	/**
 	 * IMeshGeneratorInterface接口，设置Owner的UDynamicMeshComponent，变量声明在接口中
 	 * @param InMeshComponent 传入Owner的UDynamicMeshComponent
 	 */
 	virtual void SetMeshComponent(class UDynamicMeshComponent* InMeshComponent) override;
 
+	/**
+	 * IMeshGeneratorInterface接口，额外清空衔接点，交点数据由SetIntersectionSegmentsData覆盖
+	 */
+	virtual void ResetForRegenerate() override;
+
 	//这个函数有问题，看后续还要不要维护
 	//int32 GetOverlapSegmentOnGivenSpline(TWeakObjectPtr<USplineComponent> TargetSpline);
 
@@ -123,6 +144,27 @@ protected:
 
 	void InitialMaterials();
 
+	/**
+	 * BuildMesh中调用GeometryScript函数使用的临时Mesh，在PrepareBuild中创建，每个对象独占
+	 * 原生挤出开启时只在耳切失败回退GeometryScript时使用
+	 */
+	UPROPERTY(Transient)
+	TObjectPtr<UDynamicMesh> BuildScratchMesh = nullptr;
+
+	/**
+	 * PrepareBuild时读取的CityGenerator.Road.NativeIntersection，耳切失败时置为false，BuildMesh不在工作线程读取控制台变量
+	 */
+	bool bUseNativeExtrude = true;
+
+	/**
+	 * PrepareBuild时读取的RIG.OnlyDebugPoint
+	 */
+	bool bOnlyDebugPoint = false;
+
+	/**
+	 * PrepareBuild时由挤出截面耳切得到的模板，原生挤出时使用
+	 */
+	FRoadProfileTemplate ExtrudeTemplate;
 
 	const FString MaterialPath{"/Game/Road/Material/MI/M_Asphalt_Master_Inst_Intersection"};
 
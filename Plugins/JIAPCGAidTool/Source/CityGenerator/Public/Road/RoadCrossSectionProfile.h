@@ -0,0 +1,189 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Road/RoadSegmentStruct.h"
+#include "RoadCrossSectionProfile.generated.h"
+
+//道路横断面组成部分
+UENUM(BlueprintType)
+enum class ERoadProfileElementType : uint8
+{
+	//行车道，顶面按横坡从道路中心向两侧降低
+	LANE,
+	//中央分隔带
+	MEDIAN,
+	//路缘石
+	CURB,
+	//人行道
+	SIDEWALK
+};
+
+/**
+ * 横断面中的一段，从左到右依次排列
+ */
+USTRUCT(BlueprintType)
+struct FRoadProfileElement
+{
+	GENERATED_BODY()
+
+public:
+	FRoadProfileElement()
+	{
+	}
+
+	FRoadProfileElement(ERoadProfileElementType InType, float InWidth, float InHeight = 0.0f) : Type(InType),
+		Width(InWidth), Height(InHeight)
+	{
+	}
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	ERoadProfileElementType Type = ERoadProfileElementType::LANE;
+
+	/**
+	 * 横向宽度cm
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float Width = 350.0f;
+
+	/**
+	 * 顶面高出行车道边缘的高度cm，行车道忽略该值
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float Height = 0.0f;
+};
+
+/**
+ * 参数化道路横断面，描述行车道、路缘石、人行道、中央分隔带和行车道横坡
+ * 截面坐标与FLaneMeshInfo::CrossSectionCoord一致：X为道路横向，以道路中心为0；Y为高度，底面为0
+ */
+USTRUCT(BlueprintType)
+struct CITYGENERATOR_API FRoadCrossSectionProfile
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * 从左到右的横断面组成
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TArray<FRoadProfileElement> Elements;
+
+	/**
+	 * 行车道横坡（高差/水平距离），道路中心最高
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float CrownSlope = 0.015f;
+
+	/**
+	 * 行车道边缘顶面到底面的厚度cm
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float BaseThickness = 30.0f;
+
+	float GetTotalWidth() const;
+
+	/**
+	 * 各道路类型的默认横断面，总宽度与URoadMeshGenerator::SetRoadType中的道路宽度一致
+	 */
+	static FRoadCrossSectionProfile MakePreset(ELaneType InLaneType);
+};
+
+/**
+ * 编译后的截面模板，保存扫掠时与路径无关的全部数据：轮廓点、每条边的外法线、周长方向UV和封口三角形
+ * 同一道路类型的所有道路共享一份模板，扫掠时只沿路径实例化，不再重新计算截面布局
+ */
+struct CITYGENERATOR_API FRoadProfileTemplate
+{
+	/**
+	 * 闭合轮廓，逆时针
+	 */
+	TArray<FVector2D> Points;
+
+	/**
+	 * 第i条边（Points[i]到Points[i+1]）的单位外法线
+	 */
+	TArray<FVector2D> EdgeNormals;
+
+	/**
+	 * 轮廓点的周长参数，归一化到[0,1]，Num比Points多一个，最后一个为1
+	 */
+	TArray<double> EdgeU;
+
+	/**
+	 * 封口三角形，每三个为一组轮廓点下标
+	 */
+	TArray<int32> CapTriangles;
+
+	/**
+	 * 轮廓点处两侧边法线是否平滑过渡，为空时全部为硬边
+	 */
+	TArray<bool> SmoothPoints;
+
+	FBox2D Bounds = FBox2D(ForceInit);
+
+	bool IsValid() const { return Points.Num() >= 3 && CapTriangles.Num() >= 3; }
+
+	/**
+	 * 第i条边在起点或终点处的侧面法线，端点平滑时取相邻两边法线的平均
+	 */
+	FVector2D GetEdgeNormal(int32 InEdgeIndex, bool bAtEdgeEnd) const;
+
+	/**
+	 * 由凸多边形编译模板，封口按扇形三角化，用于FLaneMeshInfo::CrossSectionCoord等简单截面
+	 * @return 点数不足或面积为0返回false
+	 */
+	static bool CompilePolygon(TConstArrayView<FVector2D> InPolygon, FRoadProfileTemplate& OutTemplate);
+
+	/**
+	 * 由任意简单多边形编译模板，封口按耳切法三角化，用于交汇路口等星形非凸多边形
+	 * @param InPolygon 简单多边形，顺逆时针均可，相邻重复点会被合并
+	 * @param SmoothAngle 相邻边夹角小于该值°时侧面法线平滑，与ComputeSplitNormals的开角阈值含义一致
+	 * @return 多边形退化或耳切失败（自相交）返回false
+	 */
+	static bool CompileSimplePolygon(TConstArrayView<FVector2D> InPolygon, FRoadProfileTemplate& OutTemplate,
+	                                 float SmoothAngle = 0.0f);
+
+	/**
+	 * 耳切法三角化简单多边形，n个点输出n-2个三角形，绕序与输入无关，统一为逆时针
+	 * @param InPolygon 简单多边形，不含相邻重复点
+	 * @param OutTriangles 三角形，每三个为一组InPolygon下标
+	 * @return 点数不足、面积为0或找不到耳（自相交）返回false
+	 */
+	static bool EarClipPolygon(TConstArrayView<FVector2D> InPolygon, TArray<int32>& OutTriangles);
+
+	/**
+	 * 由横断面编译模板，底面在每个顶面点正下方补点，封口按竖条带三角化，支持路缘石等台阶形非凸截面
+	 * @return 没有宽度大于0的组成部分返回false
+	 */
+	static bool CompileProfile(const FRoadCrossSectionProfile& InProfile, FRoadProfileTemplate& OutTemplate);
+
+protected:
+	/**
+	 * 由Points计算EdgeNormals、EdgeU和Bounds
+	 */
+	bool ComputeEdgeData();
+};
+
+/**
+ * 按道路类型缓存编译后的截面模板，首次访问时编译，之后所有道路共享同一份模板，内存只随道路类型数量增长
+ * 线程安全，建议在游戏线程取出模板后传给工作线程
+ */
+struct CITYGENERATOR_API FRoadProfileLibrary
+{
+	/**
+	 * @return 该道路类型的模板，编译失败时退回FLaneMeshInfo的矩形截面
+	 */
+	static TSharedRef<const FRoadProfileTemplate> GetTemplate(ELaneType InLaneType);
+
+	/**
+	 * 替换道路类型的横断面并重新编译模板，已持有旧模板的道路在下次PrepareBuild时生效
+	 */
+	static void SetProfile(ELaneType InLaneType, const FRoadCrossSectionProfile& InProfile);
+
+	/**
+	 * @return 已编译的模板数量
+	 */
+	static int32 GetCachedTemplateNum();
+};
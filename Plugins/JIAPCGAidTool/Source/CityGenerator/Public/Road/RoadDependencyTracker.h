@@ -0,0 +1,156 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Road/RoadGraphForBlock.h"
+
+class USplineComponent;
+
+/**
+ * 一次编辑影响到的对象集合，也用作CollectDirtySet的种子
+ * 交汇路口、道路、街区均使用各自Generator的全局ID
+ */
+struct FRoadDirtySet
+{
+	TSet<TWeakObjectPtr<USplineComponent>> Splines;
+	TSet<int32> Intersections;
+	TSet<int32> Roads;
+	TSet<int32> Blocks;
+
+	bool IsEmpty() const
+	{
+		return Splines.IsEmpty() && Intersections.IsEmpty() && Roads.IsEmpty() && Blocks.IsEmpty();
+	}
+
+	void Append(const FRoadDirtySet& Other)
+	{
+		Splines.Append(Other.Splines);
+		Intersections.Append(Other.Intersections);
+		Roads.Append(Other.Roads);
+		Blocks.Append(Other.Blocks);
+	}
+
+	void Reset()
+	{
+		Splines.Reset();
+		Intersections.Reset();
+		Roads.Reset();
+		Blocks.Reset();
+	}
+};
+
+/**
+ * 记录样条→交汇路口→道路→街区的依赖关系，用于编辑后只重建受影响的Generator
+ * 样条与交汇路口的关系和IntersectionCompOnSpline一致，交汇路口与道路的关系读取URoadGraph的边，道路与街区的关系来自FBlockLinkInfo
+ * 道路按样条整体切分，因此道路的重建粒度为样条：样条本身移动或其上的交汇路口变化时，该样条上的所有道路都需要重建
+ */
+class CITYGENERATOR_API FRoadDependencyTracker
+{
+public:
+	/**
+	 * 清空所有依赖关系
+	 */
+	void Reset();
+
+	/**
+	 * 只清空道路记录，道路全部重建时使用
+	 */
+	void ResetRoads();
+
+	/**
+	 * 只清空街区记录，街区全部重建时使用
+	 */
+	void ResetBlocks();
+
+	/**
+	 * 记录交汇路口及其相交的样条，重复添加会覆盖
+	 * @param IntersectionIndex 交汇路口全局ID
+	 * @param InSplines 交汇于此的样条
+	 */
+	void AddIntersection(int32 IntersectionIndex, const TArray<TWeakObjectPtr<USplineComponent>>& InSplines);
+
+	void RemoveIntersection(int32 IntersectionIndex);
+
+	/**
+	 * 记录道路所在样条和两端的交汇路口，两端与加入URoadGraph的边一致，无连接时为INT32_ERROR
+	 * @param RoadIndex 道路全局ID
+	 * @param InSpline 道路参考样条
+	 * @param FromIntersection 道路构建起点的交汇路口
+	 * @param ToIntersection 道路构建终点的交汇路口
+	 */
+	void AddRoad(int32 RoadIndex, const TWeakObjectPtr<USplineComponent>& InSpline, int32 FromIntersection,
+	             int32 ToIntersection);
+
+	void RemoveRoad(int32 RoadIndex);
+
+	/**
+	 * 获取道路两端的交汇路口，用于从URoadGraph中移除对应的边
+	 * @return 道路未记录时返回false
+	 */
+	bool GetRoadEnds(int32 RoadIndex, int32& OutFromIntersection, int32& OutToIntersection) const;
+
+	/**
+	 * 记录街区及其环路信息
+	 * @param BlockIndex 街区全局ID
+	 * @param InBlockLoop 生成街区使用的环
+	 */
+	void AddBlock(int32 BlockIndex, const FBlockLinkInfo& InBlockLoop);
+
+	void RemoveBlock(int32 BlockIndex);
+
+	/**
+	 * 查找环路完全相同（道路集合相同）的已记录街区，环的起点可以不同
+	 * @param InBlockLoop 待查找的环
+	 * @return 街区全局ID，未找到返回INDEX_NONE
+	 */
+	int32 FindBlockByLoop(const FBlockLinkInfo& InBlockLoop) const;
+
+	/**
+	 * 由种子传播出最小的脏集合：
+	 * 1. 种子样条上的交汇路口变脏
+	 * 2. 脏交汇路口相交的样条变脏（其上道路的切分会改变）
+	 * 3. 脏样条上的道路、以及在InGraph中与脏交汇路口相连的道路变脏
+	 * 4. 环路中包含脏道路或脏交汇路口的街区变脏
+	 * @param InSeed 编辑直接影响的对象
+	 * @param InGraph 路网图，为空时只使用AddRoad记录的两端
+	 * @return 传播后的脏集合，包含种子
+	 */
+	[[nodiscard]] FRoadDirtySet CollectDirtySet(const FRoadDirtySet& InSeed, const URoadGraph* InGraph) const;
+
+	int32 GetIntersectionNum() const { return IntersectionSplines.Num(); }
+
+	int32 GetRoadNum() const { return Roads.Num(); }
+
+	int32 GetBlockNum() const { return BlockLoops.Num(); }
+
+protected:
+	struct FTrackedRoad
+	{
+		TWeakObjectPtr<USplineComponent> Spline;
+		int32 FromIntersection = INT32_ERROR;
+		int32 ToIntersection = INT32_ERROR;
+	};
+
+	/**
+	 * 交汇路口全局ID-相交样条表
+	 */
+	TMap<int32, TArray<TWeakObjectPtr<USplineComponent>>> IntersectionSplines;
+
+	/**
+	 * 样条-其上交汇路口全局ID表，IntersectionSplines的反向索引
+	 */
+	TMap<TWeakObjectPtr<USplineComponent>, TSet<int32>> IntersectionsOnSpline;
+
+	TMap<int32, FTrackedRoad> Roads;
+
+	/**
+	 * 样条-其上道路全局ID表
+	 */
+	TMap<TWeakObjectPtr<USplineComponent>, TSet<int32>> RoadsOnSpline;
+
+	/**
+	 * 街区全局ID-环路表
+	 */
+	TMap<int32, FBlockLinkInfo> BlockLoops;
+};
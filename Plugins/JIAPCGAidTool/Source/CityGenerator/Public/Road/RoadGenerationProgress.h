@@ -0,0 +1,72 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+/**
+ * 道路生成流程的进度条和取消状态，包装FScopedSlowTask
+ * 后台任务通过IsCancelled轮询取消；游戏线程在Wait中等待后台任务，在ForEachBatch中分批生成Actor、提交Mesh，两者都会刷新进度条并响应取消按钮
+ */
+class CITYGENERATOR_API FRoadGenerationProgress
+{
+public:
+	/**
+	 * @param InTotalWork 进度条总工作量，Wait、ForEachBatch和Skip传入的工作量之和应当与之一致
+	 * @param InTitle 进度条标题
+	 * @param bShowDialog 是否弹出带取消按钮的进度条窗口，为false时只在编辑器状态栏显示
+	 */
+	FRoadGenerationProgress(float InTotalWork, const FText& InTitle, bool bShowDialog = true);
+
+	/**
+	 * 在游戏线程等待后台任务完成，期间刷新进度条并检查取消按钮
+	 * 取消只设置标记，仍会等待任务自行退出，任务捕获的局部数据在返回前不会被释放
+	 * @param InTask 后台任务
+	 * @param InWork 该阶段的工作量
+	 * @param InMessage 该阶段的描述
+	 * @return 任务完成且未被取消返回true
+	 */
+	bool Wait(const UE::Tasks::FTask& InTask, float InWork, const FText& InMessage);
+
+	/**
+	 * 在游戏线程将[0,InNum)按InBatchSize分批执行，每批之前刷新进度条并检查取消按钮
+	 * @param InNum 元素总数
+	 * @param InBatchSize 每批元素数
+	 * @param InWork 该阶段的工作量，平均分配到每批
+	 * @param InMessage 该阶段的描述
+	 * @param InBatchFunc 处理[BeginIndex,EndIndex)的函数
+	 * @return 全部批次执行完成返回true，中途被取消返回false
+	 */
+	bool ForEachBatch(int32 InNum, int32 InBatchSize, float InWork, const FText& InMessage,
+	                  TFunctionRef<void(int32 BeginIndex, int32 EndIndex)> InBatchFunc);
+
+	/**
+	 * 跳过不需要执行的阶段，保持进度条比例正确
+	 * @param InWork 该阶段的工作量
+	 */
+	void Skip(float InWork);
+
+	/**
+	 * 可在任意线程调用，后台任务在处理每个元素前检查
+	 * @return 用户是否点击了取消
+	 */
+	bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+protected:
+	/**
+	 * 只能在游戏线程调用，读取进度条窗口的取消按钮状态
+	 */
+	void PollCancel();
+
+	FScopedSlowTask SlowTask;
+
+	std::atomic<bool> bCancelled{false};
+
+	/**
+	 * Wait中每次等待的时长，决定进度条刷新和取消响应的频率
+	 */
+	static constexpr double PollIntervalMs = 30.0;
+};
@@ -4,53 +4,82 @@
 
 #include "CoreMinimal.h"
 #include "EditorSubsystem.h"
-#include "GenericQuadTree.h"
+#include "Containers/Ticker.h"
 #include "RoadGraphForBlock.h"
+#include "Road/CityTileMesh.h"
+#include "Road/GeneratedActorPool.h"
+#include "Road/RoadDependencyTracker.h"
 #include "Road/RoadSegmentStruct.h"
+#include "Road/SegmentBVH.h"
+#include "Road/SplineSegmentStore.h"
+#include "Road/SplineSnapshot.h"
 #include "RoadGeneratorSubsystem.generated.h"
 
 class UBlockMeshGenerator;
 class URoadMeshGenerator;
 class UIntersectionMeshGenerator;
 class USplineComponent;
+class UDynamicMeshComponent;
+class FRoadGenerationProgress;
+struct FCityModel;
+struct FCityModelBuildSettings;
 
 /**
- * 交点插入到连续分段的信息
+ * 切分得到的单条道路，游戏线程据此生成道路Actor并加入路网图
  */
-struct FConnectionInsertInfo
+struct FRoadSpawnPlan
 {
-	FConnectionInsertInfo()
+	FRoadSpawnPlan()
 	{
 	};
-	/**
-	 * 插入到二维数组ContinuousSegmentsGroups中一维的哪一个元素，即作为哪个连续SegmentsGroup的头或尾
-	 */
-	int32 GroupIndex = -1;
-	/**
-	 * 插入到连续SegmentsGroup的头部（true）或尾部（false），同时决定了插入位置，头部一定在原有元素之前，尾部一定在原有元素之后
-	 */
-	bool bConnectToGroupHead = true;
-	/**
-	* 连接点Transform
-	*/
-	FTransform ConnectionTrans;
+
+	TWeakObjectPtr<USplineComponent> Spline;
+
+	FRoadSegmentsGroup RoadInfo;
+
+	FTransform StartTransform;
 
 	/**
-	 * 连接的交汇路口全局ID
+	 * 道路起止交汇路口的全局ID，无衔接为INT32_ERROR
 	 */
-	int32 IntersectionGlobalIndex = INT32_ERROR;
+	int32 ConnectedIntersections[2] = {INT32_ERROR, INT32_ERROR};
 
 	/**
-	 * 连接的交汇路口的具体入口局部ID
+	 * 道路连接到起止交汇路口的入口局部ID，用于图邻接表构建
 	 */
-	int32 EntryLocalIndex = INT32_ERROR;
+	int32 EntryIndexOfIntersections[2] = {INT32_ERROR, INT32_ERROR};
+};
+
+/**
+ * 样条交点求交后端，由CityGenerator.Road.IntersectionBackend选择
+ */
+UENUM()
+enum class ERoadIntersectionBackend : uint8
+{
+	/** BVH剪枝后逐对求交 */
+	BVH,
+	/** Bentley–Ottmann扫描线，适合长直线多、稀疏的路网 */
+	SweepLine
 };
 
+/**
+ * 样条重采样方式，由CityGenerator.Road.ResampleMode选择
+ */
+UENUM()
+enum class ERoadResampleMode : uint8
+{
+	/** 按PolyLineSampleDistance定距采样（ConvertSplineToPolyLineWithDistances） */
+	Fixed,
+	/** 按局部曲率和弦高误差自适应步长，直线段稀疏、急弯处加密，单段长度不超过长段细分阈值 */
+	Adaptive
+};
 
 /**
  * 该类主要实现以下内容：
  * 1.承接CityGenerator类中用户输入的Spline信息，将其进行细分分段并转换为PolyLineSegment用于计算交点
  * 2.生成RoadActor和IntersectionActor，为其挂载的Generator传递核心Segment信息，由Generator负责结构细化和具体生成
+ * 重采样、求交、路口拆分、道路切分和环路搜索在UE::Tasks中基于FSplineSnapshot执行，游戏线程显示带取消按钮的进度条，
+ * 生成Actor和提交Mesh按CityGenerator.Road.SpawnBatchSize分批在游戏线程执行，取消时销毁本阶段已生成的Actor
  */
 UCLASS()
 class CITYGENERATOR_API URoadGeneratorSubsystem : public UEditorSubsystem
@@ -66,6 +95,7 @@ public:
 	bool bNeedRefreshSegmentData = true;
 	/**
 	 * 绑定OnComponentTransformChanged()，当SplineSegmentsInfo内的Spline移动时，设置bNeedRefreshSegmentData=true,需要重新刷新分段信息
+	 * 同时将该Spline记入DirtySplines，供GenerateIntersections增量更新
 	 * @param MovedComp GEditor回调返回的Component信息
 	 * @param MoveType 未使用
 	 */
@@ -97,15 +127,13 @@ public:
 public:
 	/**
 	 * 对外接口，选择性更新样条信息、计算交点生成Actor
+	 * 完整流程由CaptureCityModel复制样条，后台调用FCityModelBuilder::ResampleSplines和FindIntersections，
+	 * 再由ApplyCityModelSegments写回Segment、SpawnCityModelIntersections生成Actor
+	 * 已生成过交点且只有部分样条移动时（CityGenerator.Road.IncrementalIntersection开启），调用UpdateIntersectionsIncrementally
 	 */
 	UFUNCTION(BlueprintCallable)
 	void GenerateIntersections();
 
-	/**
-	* 四叉树网格计算最小网格边长
-	*/
-	const float MinimumQuadSize = 100.f;
-
 	/**
 	 * 交点合并阈值，此范围内的交点会被合并为同一点
 	 */
@@ -120,24 +148,61 @@ public:
 	void VisualizeSegmentByDebugline(bool bUpdateBeforeDraw = false, float Thickness = 30.0f,bool bFlushBeforeDraw=false);
 
 	/**
-	 * 模板函数，用于ResampleSpline函数中长直线段细分数据加入，以非POD（不能使用FMemoryCopy）为处理对象
-	 * 应当为Protected，为了满足单元测试需求设置为Public
+	 * 模板函数，用于FCityModelBuilder::ResampleSpline中长直线段细分数据加入，以非POD（不能使用FMemoryCopy）为处理对象
+	 * 为了满足单元测试需求设置为Public
 	 * @tparam T POD变量类型，在类中用于FTransform
 	 * @param TargetArray 原数组，原位改写
 	 * @param InsertMap 插入序号——插入数据数组表，插入数据数组为被插入到序号后边
 	 */
 	template <typename T>
-	void InsertElementsAtIndex(TArray<T>& TargetArray, const TMap<int32, TArray<T>>& InsertMap);
+	static void InsertElementsAtIndex(TArray<T>& TargetArray, const TMap<int32, TArray<T>>& InsertMap);
 
 protected:
 	bool bIntersectionsGenerated = false;
 	/**
 	* 初始化样条信息，从CityGeneratorSubsystem中获取有效的Spline信息，调用UpdateSplineSegments把样条转换为芬顿数据
+	* 不弹出进度条窗口，见ResampleRoadSplines
 	* @return 成功获取至少一条样条返回true
 	*/
 	UFUNCTION(BlueprintCallable)
 	bool InitialRoadSplines();
 
+	/**
+	 * InitialRoadSplines的实现，由CaptureCityModel复制样条，后台任务中调用FCityModelBuilder::ResampleSplines，
+	 * 再由ApplyCityModelSegments按样条顺序写入SegmentStore保证GlobalIndex连续
+	 * @param Progress 进度条，占用1个工作量
+	 * @return 成功获取至少一条样条且未被取消返回true
+	 */
+	bool ResampleRoadSplines(FRoadGenerationProgress& Progress);
+
+	/**
+	 * 由成员值和控制台变量生成FCityModelBuilder的参数，各阶段与GenerateFromCityModel使用同一组参数，只在游戏线程调用
+	 * @return 构建参数
+	 */
+	FCityModelBuildSettings MakeBuildSettings() const;
+
+	/**
+	 * 将完成FCityModelBuilder::ResampleSplines的模型写回SegmentStore、SplineSegmentsInfo、SegmentBVH和NextSegmentGlobalIndex，
+	 * 模型中有原始交点时一并写入CachedSegmentHits，写回后SegmentStore与当前样条一致，清空DirtySplines
+	 * @param InModel CityModel
+	 * @param InSourceSplines 与InModel.Splines一一对应的源样条
+	 */
+	void ApplyCityModelSegments(const FCityModel& InModel,
+	                            const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines);
+
+	/**
+	 * 按模型中的交汇路口分批生成Actor，写入CachedIntersections、CachedIntersectionGenerators、IDToIntersectionGenerator、
+	 * IntersectionCompOnSpline和DependencyTracker，不调用GenerateMesh，GenerateIntersections和MaterializeCityModel共用
+	 * @param InModel 已完成FCityModelBuilder::FindIntersections的模型
+	 * @param InSourceSplines 与InModel.Splines一一对应的源样条
+	 * @param Progress 进度条，占用1个工作量
+	 * @param OutIntersectionGlobalIndexes 模型路口ID到Generator GlobalIndex，生成失败为INT32_ERROR
+	 * @return 未被取消返回true
+	 */
+	bool SpawnCityModelIntersections(const FCityModel& InModel,
+	                                 const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines,
+	                                 FRoadGenerationProgress& Progress, TArray<int32>& OutIntersectionGlobalIndexes);
+
 	TSet<TWeakObjectPtr<USplineComponent>> RoadSplines;
 
 	/**
@@ -146,40 +211,190 @@ protected:
 	 */
 	void UpdateSplineSegments(USplineComponent* TargetSpline);
 
+	/**
+	 * 使用已经重采样的点更新单根样条的分段数据，GlobalIndex从NextSegmentGlobalIndex继续分配，只能在游戏线程调用
+	 * @param TargetSpline 需要更新数据的样条
+	 * @param ResamplePointsOnSpline ResampleSpline的结果
+	 */
+	void UpdateSplineSegments(USplineComponent* TargetSpline, const TArray<FTransform>& ResamplePointsOnSpline);
+
+	/**
+	 * 将已分配GlobalIndex的Segment写入SegmentStore和SplineSegmentsInfo，只能在游戏线程调用
+	 * @param TargetSpline 所属样条
+	 * @param ResamplePointsOnSpline ResampleSpline的结果
+	 * @param InSegments FSplinePolyLineSegment::MakeSegments的结果，GlobalIndex需大于已写入的最大值
+	 */
+	void AddSplineSegments(const TWeakObjectPtr<USplineComponent>& TargetSpline,
+	                       const TArray<FTransform>& ResamplePointsOnSpline, TArray<FSplinePolyLineSegment>&& InSegments);
+
 	//这个值50分段大概在1000cm
 	const float PolyLineSampleDistance = 200.0f;
 
 	/**
-	 * 用于将根据PolyLineSampleDistance值Spline进行细分重采样，
-	 * 主体函数是ConvertSplineToPolyLineWithDistances，在此基础上加入了对长直线的细分，避免在交点计算时发生大范围切断导致道路无法连接
-	 * @param TargetSpline 目标样条线
+	 * 使用CityGenerator.Road.ResampleMode选择的方式重采样，见ResampleSpline(TargetSpline,InMode)
+	 * @param TargetSpline 目标样条快照
 	 * @return 重采样的细分点Transform
 	 */
-	TArray<FTransform> ResampleSpline(const USplineComponent* TargetSpline);
+	TArray<FTransform> ResampleSpline(const FSplineSnapshot& TargetSpline);
 
 	/**
-	 * 根据SplineSegmentsInfo数据调用Get2DIntersection计算样条交点，使用四叉树和备忘录剪枝。
-	 * 后续可能会放在多线程做，因此保留返回值形式
-	 * @return 返回交点信息
+	 * 长段细分阈值，超过该长度的Segment会被继续细分，也是自适应采样的最大步长
+	 */
+	float GetSegmentMaxLength() const { return 10 * PolyLineSampleDistance; }
+
+	/**
+	 * 对InStore中[BeginIndex,EndIndex)范围的Segment查询BVH并求交，只读访问BVH，可在多线程中调用
+	 * 每对Segment只在GlobalIndex较小的一方遍历时处理，替代原有的ProcessedPairs备忘录
+	 * 过滤后的候选以SoA形式收集，调用URoadGeometryUtilities::Get2DIntersectionBatch批量求交
+	 * @param InBVH 由InStore构建的BVH
+	 * @param InStore 所有样条的Segment
+	 * @param BeginIndex 起始序号（含）
+	 * @param EndIndex 终止序号（不含）
+	 * @param OutHits 原位追加的原始交点
+	 * @param InQueryBeginIndex 本次查询的第一个Segment下标，小于它的Segment视为已处理，与其相交的Segment对由遍历方补算
 	 */
-	//UFUNCTION(BlueprintCallable)
-	[[nodiscard]] TArray<FSplineIntersection> FindAllIntersections();
+	static void FindSegmentHitsInRange(const FSegmentBVH& InBVH, const FSplineSegmentStore& InStore,
+	                                   int32 BeginIndex, int32 EndIndex, TArray<FSegmentPairHit>& OutHits,
+	                                   int32 InQueryBeginIndex = 0);
+
+	/**
+	 * 增量更新交点：只重新采样DirtySplines中的样条，在SegmentStore和SegmentBVH中移除旧Segment并追加新Segment，
+	 * 只对新Segment查询BVH求交，与缓存的其余原始交点合并后，和上次结果比较，仅销毁、生成发生变化的路口Actor
+	 * 样条集合发生变化或缺少缓存时返回false，由调用方走完整流程
+	 * @return 增量更新成功返回true
+	 */
+	bool UpdateIntersectionsIncrementally();
+
+	/**
+	 * 为单个交点拆分Segment并生成路口Actor，写入IDToIntersectionGenerator和IntersectionCompOnSpline，不调用GenerateMesh
+	 * 新生成的Actor以Generator的GlobalIndex命名，与保留的已有Actor不会重名
+	 * @param InIntersectionInfo 交点信息
+	 * @return 生成的Generator，拆分失败返回nullptr
+	 */
+	UIntersectionMeshGenerator* SpawnIntersectionActor(const FSplineIntersection& InIntersectionInfo);
+
+	/**
+	 * 使用已拆分好的Segment生成路口Actor，其余同上
+	 * @param InIntersectionInfo 交点信息
+	 * @param IntersectionBuildData TearIntersectionToSegments的结果，为空时视为拆分失败
+	 * @return 生成的Generator，拆分失败返回nullptr
+	 */
+	UIntersectionMeshGenerator* SpawnIntersectionActor(const FSplineIntersection& InIntersectionInfo,
+	                                                   const TArray<FIntersectionSegment>& IntersectionBuildData);
+
+	/**
+	 * 移除路口Generator在IDToIntersectionGenerator和IntersectionCompOnSpline中的记录并销毁其Actor
+	 * @param TargetGenerator 目标Generator
+	 */
+	void DestroyIntersectionActor(const TWeakObjectPtr<UIntersectionMeshGenerator>& TargetGenerator);
+
 	/**
-	 * 记录样条、样条分段数据
+	 * 上次调用GenerateIntersections之后移动过的样条
+	 */
+	TSet<TWeakObjectPtr<USplineComponent>> DirtySplines;
+
+	/**
+	 * 上次求交得到的全部原始交点，按(GlobalIndexA,GlobalIndexB)排序，增量更新时只替换涉及DirtySplines的部分
+	 */
+	TArray<FSegmentPairHit> CachedSegmentHits;
+
+	/**
+	 * 上次生成的交点信息，与CachedIntersectionGenerators一一对应，拆分失败的交点对应空指针
+	 */
+	TArray<FSplineIntersection> CachedIntersections;
+
+	TArray<TWeakObjectPtr<UIntersectionMeshGenerator>> CachedIntersectionGenerators;
+
+public:
+	/**
+	 * 用于将根据PolyLineSampleDistance值Spline进行细分重采样，实现见FCityModelBuilder::ResampleSpline，
+	 * 在此基础上加入了对长直线的细分，避免在交点计算时发生大范围切断导致道路无法连接
+	 * 只访问快照，通过FSplineCursorEvaluator求值，可在后台线程调用
+	 * 应当为Protected，为了满足单元测试需求设置为Public
+	 * @param TargetSpline 目标样条快照
+	 * @param InMode 采样方式
+	 * @return 重采样的细分点Transform
+	 */
+	TArray<FTransform> ResampleSpline(const FSplineSnapshot& TargetSpline, ERoadResampleMode InMode);
+
+	/**
+	 * 在游戏线程为TargetSpline创建快照后重采样，见ResampleSpline(FSplineSnapshot,InMode)
+	 */
+	TArray<FTransform> ResampleSpline(const USplineComponent* TargetSpline, ERoadResampleMode InMode);
+
+	/**
+	 * 使用InStore的二维端点构建BVH，BVH中的下标即InStore中的下标
+	 * 应当为Protected，为了满足单元测试需求设置为Public
+	 * @param InStore 所有样条的Segment
+	 * @return 构建完成的BVH
+	 */
+	static FSegmentBVH BuildSegmentBVH(const FSplineSegmentStore& InStore);
+
+	/**
+	 * BVH求交后端，按Segment分块在ParallelFor中执行（CityGenerator.Road.ParallelIntersection控制），
+	 * 每块独立缓冲，结果与线程数无关
+	 * 应当为Protected，为了满足单元测试需求设置为Public
+	 * 指定InQueryBeginIndex时只遍历[InQueryBeginIndex,Num)的Segment，并补上它们与之前Segment的交点，用于增量更新
+	 * @param InBVH 由InStore构建的BVH
+	 * @param InStore 所有样条的Segment
+	 * @param InQueryBeginIndex 需要查询的第一个Segment下标，为0时即完整求交
+	 * @return 按(GlobalIndexA,GlobalIndexB)排序的原始交点
+	 */
+	[[nodiscard]] static TArray<FSegmentPairHit> FindSegmentHitsByBVH(const FSegmentBVH& InBVH,
+	                                                                  const FSplineSegmentStore& InStore,
+	                                                                  int32 InQueryBeginIndex = 0);
+
+	/**
+	 * 扫描线求交后端，调用URoadGeometryUtilities::FindSegmentIntersectionsBySweepLine，保留同一样条相邻Segment的排除规则
+	 * 应当为Protected，为了满足单元测试需求设置为Public
+	 * @param InStore 所有样条的Segment
+	 * @return 按(GlobalIndexA,GlobalIndexB)排序的原始交点
+	 */
+	[[nodiscard]] static TArray<FSegmentPairHit> FindSegmentHitsBySweepLine(const FSplineSegmentStore& InStore);
+
+	/**
+	 * 将传入的连续SegmentIndex（有序）按照BreakPoints(可以无序)切分成多少个连续子数组，子数组不含断点元素，两数组要求元素唯一
+	 * 单元测试函数位于FRoadGeneratorSubsystemTest的TestGetContinuousIndexSeries，FCityModelBuilder切分道路时同样调用
+	 * @param AllSegmentIndex 连续有序的SegmentIndex，要求元素唯一
+	 * @param BreakPoints 断点数组，可无序，要求元素唯一，原位排序
+	 * @return 切分获得的子数组（不含断点元素）
+	 */
+	static TArray<TArray<uint32>> GetContinuousIndexSeries(const TArray<uint32>& AllSegmentIndex,
+	                                                       TArray<uint32>& BreakPoints);
+
+protected:
+	/**
+	 * 将原始交点聚类合并为交点信息，合并见FCityModelBuilder::MergeSegmentHits，这里把SplineId换回样条引用
+	 * @param InHits 原始交点，仅影响输出交点的排列顺序
+	 * @return 合并后的交点信息
+	 */
+	[[nodiscard]] TArray<FSplineIntersection> MergeSegmentHits(const TArray<FSegmentPairHit>& InHits) const;
+	/**
+	 * 记录样条、样条分段编号数据，端点坐标在SegmentStore中
 	 */
 	TMap<TWeakObjectPtr<USplineComponent>, TArray<FSplinePolyLineSegment>> SplineSegmentsInfo;
 
 	/**
-	 * 用于加速样条交点计算的四叉树
+	 * 所有样条Segment的SoA存储，由UpdateSplineSegments填充，按GlobalIndex升序，SegmentBVH查询返回的下标指向该存储
 	 */
-	TQuadTree<FSplinePolyLineSegment> SplineQuadTree{FBox2D()};
+	FSplineSegmentStore SegmentStore;
 
 	/**
-	 * 使用四叉树返回交点处重叠的Segment信息，用于道路切割
+	 * 下一个可用的Segment GlobalIndex，全量重采样时归零并按样条Segment数量前缀和分配，增量更新时继续递增
+	 */
+	uint32 NextSegmentGlobalIndex = 0;
+
+	/**
+	 * 用于加速样条交点计算和道路切割查询的BVH，只存储SegmentStore下标
+	 */
+	FSegmentBVH SegmentBVH;
+
+	/**
+	 * 使用BVH返回交点处重叠的Segment，用于道路切割
 	 * @param TargetIntersection 交点对象引用，需要交点对象的GetOccupiedBox
-	 * @return 返回四叉树查询获得的全部Segment信息
+	 * @return 返回BVH查询获得的Segment在SegmentStore中的下标
 	 */
-	TArray<FSplinePolyLineSegment> GetInteractionOccupiedSegments(
+	TArray<uint32> GetInteractionOccupiedSegments(
 		TWeakObjectPtr<UIntersectionMeshGenerator> TargetIntersection) const;
 
 	/**
@@ -189,6 +404,7 @@ protected:
 
 	/**
 	  * 根据样条交点产生的单个FSplineIntersection拆分为可以进行生成的基础信息FIntersectionSegment数组
+	  * 现场复制相交样条后调用FCityModelBuilder::TearIntersection，只能在游戏线程调用
 	  * @param InIntersectionInfo 传入交点信息
 	  * @param OutSegments 拆分为Segment数组
 	  * @param UniformDistance 统一采样距离，后续可能改写
@@ -211,35 +427,52 @@ public:
 	 * 3. 生成道路Actor，配置基础信息并将FConnectionInsertInfo结构体发送给道路Actor挂载的URoadMeshGenerator
 	 * 4. 向路网有向图中添加节点和边
 	 * 5，调用道路生成
+	 * 交汇路口增量更新过且CityGenerator.Road.DirtyPropagation开启时改为调用RegenerateDirtyRoads
 	 */
 	UFUNCTION(BlueprintCallable)
 	void GenerateRoads();
 
+
+
+protected:
+	bool bRoadsGenerated = false;
+
 	/**
-	 * 将传入的连续SegmentIndex（有序）按照BreakPoints(可以无序)切分成多少个连续子数组，子数组不含断点元素，两数组要求元素唯一
-	 * 单元测试函数位于FRoadGeneratorSubsystemTest的TestGetContinuousIndexSeries，函数本身应该是Protected，但是为了单元测试放在Public
-	 * @param AllSegmentIndex 连续有序的SegmentIndex，要求元素唯一
-	 * @param BreakPoints 断点数组，可无序，要求元素唯一
-	 * @return 切分获得的子数组（不含断点元素）
+	 * 交汇路口增量更新后调用，由DependencyTracker从PendingRoadEdit传播出脏集合，
+	 * 只移除脏道路（Actor和图中的边）并在受影响的样条上重新切分生成，其余道路跳过
+	 * @param Progress 进度条，占用3个工作量
+	 */
+	void RegenerateDirtyRoads(FRoadGenerationProgress& Progress);
+
+	/**
+	 * 多根样条的道路切分与生成，不调用GenerateMesh：
+	 * 1. 游戏线程由样条快照、SegmentStore和已生成的交汇路口构建CityModel，路口ID为模型内的连续序号
+	 * 2. 后台任务调用FCityModelBuilder::SplitRoads
+	 * 3. 游戏线程把路口ID换回GlobalIndex，按样条顺序分批调用SpawnRoadActor，图中边的加入顺序与串行一致
+	 * @param InSplines 目标样条
+	 * @param Progress 进度条，占用2个工作量
+	 * @param RoadCounter 道路Actor命名计数，原位递增
+	 * @param OutNewRoads 原位追加新生成的道路Generator，被取消时也包含已生成的部分，由调用方销毁
+	 * @return 未被取消返回true
 	 */
-	TArray<TArray<uint32>> GetContinuousIndexSeries(const TArray<uint32>& AllSegmentIndex, TArray<uint32>& BreakPoints);
+	bool GenerateRoadsOnSplines(const TArray<TWeakObjectPtr<USplineComponent>>& InSplines,
+	                            FRoadGenerationProgress& Progress, uint32& RoadCounter,
+	                            TArray<TWeakObjectPtr<URoadMeshGenerator>>& OutNewRoads);
 
-protected:
 	/**
-	 * 在已有的连续数组中找到给定点所属的Segment信息，用于确定衔接到路口的点应当作为哪一个连续SegmentsGroup的附属数据以及应当插入的位置
-	 * 具体数据插入位于RoadMeshGenerator，请勿使用该结果在本类中进行数据插入，Global新增会影响分割结果
-	 * @param InContinuousSegmentsGroups 已经分割的RoadSegmentIndex数组
-	 * @param InAllSegmentOnSpline 所在样条上的所有Segments，用于查找交点所在Segment
-	 * @param OwnerSegmentID 交点所在的Segment
-	 * @param PointTransWS 焦点位置
-	 * @return 
-	 */
-	FConnectionInsertInfo FindInsertIndexInExistedContinuousSegments(
-		const TArray<TArray<uint32>>& InContinuousSegmentsGroups,
-		const TArray<FSplinePolyLineSegment>&
-		InAllSegmentOnSpline,
-		const uint32 OwnerSegmentID,
-		const FVector& PointTransWS);
+	 * 根据切分结果生成道路Actor，写入IDToRoadGenerator、DependencyTracker并加入路网图，不调用GenerateMesh
+	 * @param InPlan 切分出的道路
+	 * @param RoadCounter 用于Actor命名的序号
+	 * @return 生成的Generator
+	 */
+	URoadMeshGenerator* SpawnRoadActor(const FRoadSpawnPlan& InPlan, uint32 RoadCounter);
+
+	/**
+	 * 移除道路在路网图中的双向边、DependencyTracker中的记录并销毁其Actor
+	 * @param RoadIndex 道路全局ID
+	 * @return DependencyTracker中存在该道路返回true
+	 */
+	bool DestroyRoadActor(int32 RoadIndex);
 
 #pragma endregion GenerateRoad
 
@@ -278,18 +511,64 @@ protected:
 	TMap<int32, TWeakObjectPtr<UBlockMeshGenerator>> IDToBlockGenerator;
 
 	/**
-	 * 删除外轮廓，需要ComponentOwner位置信息
-	 * @param OutBlockLoops 原地修改环、面信息
+	 * 全量重新生成时回收的上次结果，拓扑相同的对象复用Actor，只在生成阶段内非空，增量更新不经过回收池
+	 */
+	TGeneratedActorPool<UIntersectionMeshGenerator> IntersectionActorPool;
+
+	TGeneratedActorPool<URoadMeshGenerator> RoadActorPool;
+
+	TGeneratedActorPool<UBlockMeshGenerator> BlockActorPool;
+
+	bool bBlocksGenerated = false;
+
+	/**
+	 * 样条→交汇路口→道路→街区依赖关系，用于编辑后计算最小重建集合
+	 */
+	FRoadDependencyTracker DependencyTracker;
+
+	/**
+	 * 等待道路阶段处理的编辑：移动的样条、销毁和新生成的交汇路口
 	 */
-	void RemoveInvalidLoopInline(TArray<FBlockLinkInfo>& OutBlockLoops);
+	FRoadDirtySet PendingRoadEdit;
+
+	/**
+	 * 等待街区阶段处理的编辑：变化的交汇路口、移除和新生成的道路
+	 */
+	FRoadDirtySet PendingBlockEdit;
+
+	/**
+	 * 提取单个环路的街区轮廓和参考样条
+	 * @param InBlockLoop 环路信息
+	 * @param OutLoopPath 原位追加的轮廓点
+	 * @param OutRefsSplineGroup 原位追加的道路参考样条
+	 * @return 环路描述字符串，用于日志
+	 */
+	FString GetBlockLoopPath(const FBlockLinkInfo& InBlockLoop, TArray<FVector>& OutLoopPath,
+	                         TArray<FInterpCurveVector>& OutRefsSplineGroup);
+
+	/**
+	 * 提取环路轮廓并生成街区Actor，写入IDToBlockGenerator和DependencyTracker，不调用GenerateMesh
+	 * 轮廓提取需要读取道路和路口Generator，只能在游戏线程调用
+	 * @param InBlockLoop 环路信息
+	 * @param ActorIndex 用于Actor命名的序号
+	 * @return 生成的Generator，轮廓为空返回nullptr
+	 */
+	UBlockMeshGenerator* SpawnBlockActor(const FBlockLinkInfo& InBlockLoop, int32 ActorIndex);
+
+	/**
+	 * 移除街区在DependencyTracker中的记录并销毁其Actor
+	 * @param BlockIndex 街区全局ID
+	 */
+	void DestroyBlockActor(int32 BlockIndex);
 
 public:
 	/**
 	 * 对外接口，需要在交汇路口和道路生成之后调用，生成由道路和交汇路口围成的城区几何体具体功能包括：
-	 * 1. 从图中获取环/插入面的信息，提供数据提取依据
+	 * 1. 由RoadGraph和交汇路口位置构建CityModel，在后台任务中调用FCityModelBuilder::BuildGraph和FindBlocks获取环/插入面的信息
 	 * 2. 从URoadMeshGenerator中提取道路边线信息、从UIntersectionMeshGenerator中提取路口过渡段信息
 	 * 3. 生成街区Actor，配置基础信息并将上面提取到的新信息发送给UBlockMeshGenerator
 	 * 4. 调用街区生成
+	 * 街区已生成过时（CityGenerator.Road.DirtyPropagation开启）只重建受影响的街区，并输出跳过的数量
 	 */
 	UFUNCTION(BlueprintCallable)
 	void GenerateCityBlock();
@@ -301,11 +580,169 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void PrintGraphConnection();
 
+	/**
+	 * 当前已生成的交汇路口Generator，供命令行批量生成统计和导出Mesh使用
+	 */
+	TArray<TWeakObjectPtr<UIntersectionMeshGenerator>> GetIntersectionGenerators() const;
+
+	/**
+	 * 当前已生成的道路Generator
+	 */
+	TArray<TWeakObjectPtr<URoadMeshGenerator>> GetRoadGenerators() const;
+
+	/**
+	 * 当前已生成的街区Generator
+	 */
+	TArray<TWeakObjectPtr<UBlockMeshGenerator>> GetBlockGenerators() const;
+
+	/**
+	 * 交汇路口是否已完整生成，为false时调用GenerateRoads会弹窗询问并异步重新生成交汇路口
+	 */
+	bool AreIntersectionsGenerated() const { return bIntersectionsGenerated; }
+
 protected:
 #pragma endregion GenerateBlock
 
+#pragma region GenerateFromCityModel
+
+public:
+	/**
+	 * 对外接口，使用FCityModelBuilder在后台完成重采样、求交、拆分路口和切分道路，不访问UObject
+	 * 之后在游戏线程按模型结果生成交汇路口和道路Actor，再调用GenerateCityBlock生成街区
+	 * 流程与GenerateIntersections、GenerateRoads对应，使用同一组参数，生成后SegmentStore和交点缓存与模型一致，之后可以增量更新
+	 */
+	UFUNCTION(BlueprintCallable)
+	void GenerateFromCityModel();
+
+	/**
+	 * 从UCityGeneratorSubSystem复制样条曲线、变换和闭合信息到CityModel，只在游戏线程调用
+	 * @param OutModel 被重置并写入样条
+	 * @param OutSourceSplines 与OutModel.Splines一一对应的源样条
+	 * @return 至少复制一条样条返回true
+	 */
+	bool CaptureCityModel(FCityModel& OutModel, TArray<TWeakObjectPtr<USplineComponent>>& OutSourceSplines);
+
 protected:
-	bool IsIntegerInFloatFormat(float InFloatValue);
+	/**
+	 * 按CityModel中的路口和道路生成Actor并提交Mesh，写入IDToIntersectionGenerator、IDToRoadGenerator、RoadGraph和DependencyTracker，
+	 * 并由ApplyCityModelSegments写回SegmentStore和交点缓存，完成后与依次调用GenerateIntersections、GenerateRoads的状态相同
+	 * 进度占4个单位，取消时销毁本阶段已生成的Actor
+	 * @param InModel 已完成FCityModelBuilder::SplitRoads的模型，SegmentHits需要保留
+	 * @param InSourceSplines 与InModel.Splines一一对应的源样条
+	 * @param Progress 进度条
+	 * @return 全部完成返回true，被取消返回false
+	 */
+	bool MaterializeCityModel(const FCityModel& InModel, const TArray<TWeakObjectPtr<USplineComponent>>& InSourceSplines,
+	                          FRoadGenerationProgress& Progress);
+
+#pragma endregion GenerateFromCityModel
+
+#pragma region CityTile
+
+public:
+	/**
+	 * 按CityGenerator.Road.TileSize把交汇路口、道路和街区Mesh合并为每个瓦片一个UDynamicMeshComponent，保留各自材质
+	 * 合并后原Mesh组件隐藏，Generator和Actor保留用于增量更新；CityGenerator.Road.TileBatching开启时各生成阶段结束后自动调用
+	 */
+	UFUNCTION(BlueprintCallable)
+	void BuildCityTiles();
+
+	/**
+	 * 销毁全部瓦片Actor并恢复各Generator的Mesh组件显示
+	 */
+	UFUNCTION(BlueprintCallable)
+	void ClearCityTiles();
+
+	/**
+	 * 拾取接口，由瓦片组件和命中的三角形ID查找所属的交汇路口、道路或街区
+	 * @param InTileComponent 瓦片的UDynamicMeshComponent
+	 * @param TriangleID 命中的三角形ID
+	 * @return 三角形所在区间，不是瓦片组件或ID越界返回nullptr
+	 */
+	const FCityTileTriangleRange* FindCityTileSource(const UDynamicMeshComponent* InTileComponent,
+	                                                 int32 TriangleID) const;
+
+protected:
+	/**
+	 * 一个瓦片的输出组件和三角形区间表
+	 */
+	struct FCityTile
+	{
+		TWeakObjectPtr<UDynamicMeshComponent> Component;
+
+		TArray<FCityTileTriangleRange> TriangleRanges;
+	};
+
+	/**
+	 * 合并时记录的来源状态，和当前Generator比较得到需要重新合并的瓦片
+	 */
+	struct FCityTileSourceRecord
+	{
+		FIntPoint TileCoord = FIntPoint::ZeroValue;
+
+		uint32 MeshRevision = 0;
+	};
+
+	/**
+	 * 重新合并内容变化的瓦片：来源新增、移除、移动到其他瓦片或Mesh版本号变化
+	 * @param bForceRebuildAll 为true时重新合并全部瓦片
+	 */
+	void UpdateCityTiles(bool bForceRebuildAll);
+
+	/**
+	 * CityGenerator.Road.TileBatching开启时增量更新瓦片，各生成阶段成功结束时调用
+	 */
+	void UpdateCityTilesIfEnabled();
+
+	TMap<FIntPoint, FCityTile> CityTiles;
+
+	/**
+	 * 来源键（类型和GlobalIndex）-合并时状态
+	 */
+	TMap<uint64, FCityTileSourceRecord> CityTileSources;
+
+	/**
+	 * 当前瓦片使用的尺寸，尺寸变化时全部重建
+	 */
+	double CityTileSize = 0.0;
+
+#pragma endregion CityTile
+
+#pragma region RoadLOD
+
+public:
+	/**
+	 * 按视点到道路包围盒的距离切换道路显示的LOD，每CityGenerator.Road.LODDistance增加一级
+	 * 被瓦片合并隐藏的道路保持LOD0，保证瓦片合并使用完整精度
+	 * @param ViewLocation 视点世界坐标
+	 */
+	UFUNCTION(BlueprintCallable)
+	void UpdateRoadLODs(const FVector& ViewLocation);
+
+	/**
+	 * 把每条道路的LOD链烘焙为UStaticMesh资产并保存，材质槽与道路Mesh一致，LOD切换屏幕尺寸按CityGenerator.Road.LODDistance估算
+	 * 已存在的同名资产会被覆盖
+	 * @param InPackageFolder 资产目录
+	 */
+	UFUNCTION(BlueprintCallable)
+	void BakeRoadLODsToStaticMeshes(const FString& InPackageFolder = TEXT("/Game/CityGenerator/Roads"));
+
+protected:
+	/**
+	 * FTSTicker回调，以固定频率注册，每次读取CityGenerator.Road.LODUpdateInterval的当前值节流，
+	 * 间隔到达后以当前关卡编辑器视口位置更新道路LOD
+	 * @return 始终返回true保持注册
+	 */
+	bool TickRoadLODs(float DeltaTime);
+
+	FTSTicker::FDelegateHandle RoadLODTickerHandle;
+
+	/**
+	 * 上次自动更新道路LOD的时间
+	 */
+	double LastRoadLODUpdateTime = 0.0;
+
+#pragma endregion RoadLOD
 };
 
 /**
@@ -8,6 +8,80 @@
 #include "RoadGeometryUtilities.generated.h"
 
 class USplineComponent;
+
+/**
+ * XY平面上的三次贝塞尔曲线，控制点由样条分段的端点和切线换算得到，用于样条间的精确求交
+ */
+struct FCubicBezier2D
+{
+	FCubicBezier2D()
+	{
+	};
+
+	FCubicBezier2D(const FVector2D& InP0, const FVector2D& InP1, const FVector2D& InP2,
+	               const FVector2D& InP3) : P0(InP0), P1(InP1), P2(InP2), P3(InP3)
+	{
+	};
+
+	FVector2D P0 = FVector2D::ZeroVector;
+	FVector2D P1 = FVector2D::ZeroVector;
+	FVector2D P2 = FVector2D::ZeroVector;
+	FVector2D P3 = FVector2D::ZeroVector;
+
+	FVector2D GetLocation(double InT) const
+	{
+		const double U = 1.0 - InT;
+		return U * U * U * P0 + 3.0 * U * U * InT * P1 + 3.0 * U * InT * InT * P2 + InT * InT * InT * P3;
+	}
+
+	FVector2D GetDerivative(double InT) const
+	{
+		const double U = 1.0 - InT;
+		return 3.0 * U * U * (P1 - P0) + 6.0 * U * InT * (P2 - P1) + 3.0 * InT * InT * (P3 - P2);
+	}
+
+	/**
+	 * de Casteljau算法在参数中点处一分为二
+	 */
+	void SubdivideAtHalf(FCubicBezier2D& OutLeft, FCubicBezier2D& OutRight) const
+	{
+		const FVector2D P01 = (P0 + P1) * 0.5;
+		const FVector2D P12 = (P1 + P2) * 0.5;
+		const FVector2D P23 = (P2 + P3) * 0.5;
+		const FVector2D P012 = (P01 + P12) * 0.5;
+		const FVector2D P123 = (P12 + P23) * 0.5;
+		const FVector2D Middle = (P012 + P123) * 0.5;
+		OutLeft = FCubicBezier2D(P0, P01, P012, Middle);
+		OutRight = FCubicBezier2D(Middle, P123, P23, P3);
+	}
+
+	/**
+	 * 控制点包围盒，曲线必然位于其中
+	 */
+	FBox2D GetControlBounds() const
+	{
+		return FBox2D(FVector2D(FMath::Min(FMath::Min(P0.X, P1.X), FMath::Min(P2.X, P3.X)),
+		                        FMath::Min(FMath::Min(P0.Y, P1.Y), FMath::Min(P2.Y, P3.Y))),
+		              FVector2D(FMath::Max(FMath::Max(P0.X, P1.X), FMath::Max(P2.X, P3.X)),
+		                        FMath::Max(FMath::Max(P0.Y, P1.Y), FMath::Max(P2.Y, P3.Y))));
+	}
+
+	/**
+	 * 平直度，内部控制点到首尾弦线的最大距离，曲线与弦线的偏差不超过该值
+	 */
+	double GetFlatness() const
+	{
+		const FVector2D Chord = P3 - P0;
+		const double ChordLength = Chord.Size();
+		if (ChordLength < UE_DOUBLE_SMALL_NUMBER)
+		{
+			return FMath::Max(FVector2D::Distance(P1, P0), FVector2D::Distance(P2, P0));
+		}
+		return FMath::Max(FMath::Abs(FVector2D::CrossProduct(Chord, P1 - P0)),
+		                  FMath::Abs(FVector2D::CrossProduct(Chord, P2 - P0))) / ChordLength;
+	}
+};
+
 /**
  * 
  */
@@ -30,17 +104,58 @@ public:
 	                              const FVector2D& InSegmentBStart, const FVector2D& InSegmentBEnd,
 	                              FVector2D& OutIntersection);
 
+	/**
+	 * Get2DIntersection的批量版本，一条查询线段A与N条SoA布局的候选线段B求交，使用4路double SIMD完成快速排斥和叉积求解
+	 * 全程双精度且不使用乘加融合，同一输入在不同平台结果一致；尾部不足4条时补齐计算，只写回前N项
+	 * @param InSegmentAStart 查询线段A起点
+	 * @param InSegmentAEnd 查询线段A终点
+	 * @param InStartX 候选线段起点X
+	 * @param InStartY 候选线段起点Y
+	 * @param InEndX 候选线段终点X
+	 * @param InEndY 候选线段终点Y
+	 * @param OutHitMask 与候选一一对应，相交为1否则为0，长度不小于候选数量
+	 * @param OutT 交点在A上的参数，交点为AStart+t*(AEnd-AStart)，仅在OutHitMask为1时有效
+	 * @param OutS 交点在B上的参数，仅在OutHitMask为1时有效
+	 * @return 相交的候选数量
+	 */
+	static int32 Get2DIntersectionBatch(const FVector2D& InSegmentAStart, const FVector2D& InSegmentAEnd,
+	                                    TConstArrayView<double> InStartX, TConstArrayView<double> InStartY,
+	                                    TConstArrayView<double> InEndX, TConstArrayView<double> InEndY,
+	                                    TArrayView<uint8> OutHitMask, TArrayView<double> OutT,
+	                                    TArrayView<double> OutS);
+
 
 	/**
-	 * 使用贝塞尔样条拟合、使用Newton-Raphson法计算两条样条线的交点
+	 * 将样条分段转换为贝塞尔曲线后逐对求交，不依赖折线重采样；分段包围盒不相交时直接跳过
+	 * 同一样条自交时跳过分段与自身的比较，并丢弃相邻分段（含闭合样条首尾分段）在共享端点处的交点
 	 * @param TargetSplineA 待测试样条A
 	 * @param TargetSplineB 待测试样条B
-	 * @param IntersectionsIn2DSpace 交点数组
+	 * @param IntersectionsIn2DSpace 交点数组，原位追加，与已有元素距离小于5cm的交点不重复添加
 	 * @return 待测试样条A、B在样条全长内是否存在交点
 	 */
 	static bool Get2DIntersection(USplineComponent* TargetSplineA, USplineComponent* TargetSplineB,
 	                              TArray<FVector2D>& IntersectionsIn2DSpace);
 
+	/**
+	 * 递归de Casteljau细分求两条贝塞尔曲线的交点，控制点包围盒不相交的子曲线对被剪枝
+	 * 两条子曲线都足够平直时以弦线交点为初值，在原曲线上做Newton-Raphson精化；平行弦线（重合、相切）不输出交点
+	 * @param InCurveA 曲线A
+	 * @param InCurveB 曲线B
+	 * @param InTolerance 交点两曲线位置的最大允许距离，同时作为平直度判定的基准
+	 * @param OutParameters 交点参数(t,s)，t属于曲线A，s属于曲线B，原位追加
+	 * @return 本次追加的交点数量
+	 */
+	static int32 FindBezierIntersections(const FCubicBezier2D& InCurveA, const FCubicBezier2D& InCurveB,
+	                                     double InTolerance, TArray<FVector2D>& OutParameters);
+
+	/**
+	 * 将样条的一个分段转换为XY平面上的贝塞尔曲线，Linear类型控制点按直线处理
+	 * @param TargetSpline 目标样条
+	 * @param SegmentIndex 分段序号，闭合样条最后一段连接末点和首点
+	 * @return 世界空间的贝塞尔曲线
+	 */
+	static FCubicBezier2D GetSplineSegmentBezier2D(const USplineComponent* TargetSpline, int32 SegmentIndex);
+
 	/**
 	 * 以给定中心为原点**顺时针**排序给定点数组
 	 * 使用Atan2实现，修改值域范围为[0,2pi]，世界X轴正方向为0(2pi)，Y轴正方向为正旋转方向(pi/2)
@@ -68,6 +183,18 @@ public:
 	static void SimplifySplinePointsInline(TArray<FVector>& SplinePoints, bool bIgnoreZ = true,
 	                                       const float DisThreshold = 200.0f, const float AngleThreshold = 2.5f);
 
+	/**
+	 * 抽稀道路扫掠路径用于生成LOD，保留首尾点，返回保留点的下标以便沿用原Transform的旋转
+	 * 与SimplifySplinePointsInline一样采用长度和角度双控制：
+	 * 跳过的点到弦的距离不超过ChordError，弦方向与两端点朝向的夹角不超过AngleThreshold
+	 * @param InPath 扫掠路径
+	 * @param ChordError 弦高误差上限cm
+	 * @param AngleThreshold 弦与端点朝向的角度阈值°
+	 * @param OutKeptIndices 保留点的下标，升序
+	 */
+	static void SimplifySweepPathIndices(TConstArrayView<FTransform> InPath, double ChordError, float AngleThreshold,
+	                                     TArray<int32>& OutKeptIndices);
+
 	static void ShrinkLoopSpline(const USplineComponent* TargetSpline, float ShrinkValue);
 	
 	/**
@@ -89,4 +216,29 @@ public:
 	 * @param bTrimAtIntersection 是否在交点处焊接样条；true 移动其中一点并删除另一点，false交换两者位置
 	 */
 	static void ResolveTwistySplineSegments(USplineComponent* TargetSpline,bool bTrimAtIntersection=true);
+
+	/**
+	 * 将距离小于阈值的点聚为一类，使用边长为阈值的均匀网格哈希，只检查相邻3x3网格，使用并查集保证传递合并结果与输入顺序无关
+	 * 聚类编号按该类中最小点下标升序分配
+	 * @param InPoints 待聚类点
+	 * @param InMergeDistance 合并阈值，距离严格小于该值的两点属于同一类
+	 * @param OutClusterIndices 与InPoints一一对应的聚类编号
+	 * @return 聚类数量
+	 */
+	static int32 ClusterPoints2D(const TArray<FVector2D>& InPoints, double InMergeDistance,
+	                             TArray<int32>& OutClusterIndices);
+
+	/**
+	 * 使用Bentley–Ottmann扫描线计算线段集合中所有相交（含端点接触）的线段对，扫描方向为X轴正方向
+	 * 状态结构为按当前扫描位置Y值排序的有序数组，插入删除为内存移动，事件队列为二叉堆
+	 * 相交判定与Get2DIntersection一致，长度小于容差的退化线段会被忽略
+	 * @param InSegmentStarts 线段起点
+	 * @param InSegmentEnds 线段终点，与InSegmentStarts一一对应
+	 * @param InShouldSkipPair 过滤函数，返回true时该线段对不输出（例如同一样条上相邻的线段）
+	 * @param OutIntersectedPairs 相交线段对的下标，Key小于Value，不保证顺序
+	 */
+	static void FindSegmentIntersectionsBySweepLine(const TArray<FVector2D>& InSegmentStarts,
+	                                                const TArray<FVector2D>& InSegmentEnds,
+	                                                TFunctionRef<bool(int32, int32)> InShouldSkipPair,
+	                                                TArray<TPair<int32, int32>>& OutIntersectedPairs);
 };
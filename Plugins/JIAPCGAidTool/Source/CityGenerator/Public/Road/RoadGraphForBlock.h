@@ -13,6 +13,26 @@ struct FBlockLinkInfo
 	TArray<int32> IntersectionIndexes;
 };
 
+/**
+ * 路网图的一条有向边，在邻接表中的位置即出发节点的EntryLocalIndex，URoadGraph和FCityModel共用
+ */
+struct FRoadGraphEdge
+{
+	int32 ToNodeIndex;
+	int32 RoadIndex;
+
+	FRoadGraphEdge()
+	{
+		ToNodeIndex = INT32_ERROR;
+		RoadIndex = INT32_ERROR;
+	}
+
+	FRoadGraphEdge(int32 InToNodeIndex, int32 InRoadIndex) :
+		ToNodeIndex(InToNodeIndex), RoadIndex(InRoadIndex)
+	{
+	};
+};
+
 /**
  * 使用交汇口作为节点，道路作为边的图结构，使用邻接表实现，为街区生成提供基础数据
  * 提供基于平面嵌入的「最小逆时针环」枚举算法用于计算街区
@@ -23,6 +43,7 @@ class URoadGraph final : public UObject
 {
 	GENERATED_BODY()
 	friend class URoadGeneratorSubsystem;
+	friend class FRoadDependencyTracker;
 	friend class RoadGraphTest;
 
 public:
@@ -32,24 +53,27 @@ public:
 
 	virtual ~URoadGraph() override;
 
-protected:
-	struct FRoadEdge
-	{
-		int32 ToNodeIndex;
-		int32 RoadIndex;
-
-		FRoadEdge()
-		{
-			ToNodeIndex = INT32_ERROR;
-			RoadIndex = INT32_ERROR;
-		}
-
-		FRoadEdge(int32 InToNodeIndex, int32 InRoadIndex) :
-			ToNodeIndex(InToNodeIndex), RoadIndex(InRoadIndex)
-		{
-		};
-	};
+	/**
+	 * 将边放入邻接表的给定槽位，槽位不足时补齐无效边，URoadGraph和FCityModelBuilder共用
+	 * @param InOutGraph 邻接表
+	 * @param FromNodeIndex 起始节点序号
+	 * @param ToNodeIndex 终止节点序号
+	 * @param EdgeIndex 边序号
+	 * @param SlotIndexOfFromNode 要插入的邻接表位置、对应排序后的元素编号
+	 * @return 参数有效并写入返回true
+	 */
+	static bool AddEdgeInGivenSlot(TArray<TArray<FRoadGraphEdge>>& InOutGraph, int32 FromNodeIndex,
+	                               int32 ToNodeIndex, int32 EdgeIndex, int32 SlotIndexOfFromNode);
+
+	/**
+	 * 在已按极角排序的邻接表上模拟半边枚举所有面，到达下一节点后取道路所在槽位的下一个有效槽位继续
+	 * 结果包括外轮廓，无效边（INT32_ERROR）会被跳过，URoadGraph::GetSurfaceInGraph和FCityModelBuilder::FindBlocks共用
+	 * @param InGraph 邻接表
+	 * @return 环路数组，以边开始，首个顶点位于IntersectionIndexes.Last(0)
+	 */
+	static TArray<FBlockLinkInfo> FindSurfaces(const TArray<TArray<FRoadGraphEdge>>& InGraph);
 
+protected:
 	/**
 	 * 为了利用之前的保序数据提供的特殊接口,直接添加对应边到给定邻接表位置
 	 * 由于图中没有保存坐标，无法直接进行空间排序，使用该接口作为输入直接将之前已排序数据放入邻接表
@@ -112,22 +136,15 @@ protected:
 	 * 支持基于平面嵌入的「最小顺/逆时针环」枚举算法，图中不包括几何数据，传入的边必须经过排序
 	 * 给定一个道路网络（路口=顶点，道路=无向边），找出所有被道路完全包围、且内部不再被任何道路横穿的最小面域。
 	 * 模拟半边计算图中的插入面，会包括外轮廓边（可以配合点坐标使用Shoelace公式去除）
+	 * RemoveEdge留下的无效边会被跳过，见FindSurfaces
 	 * @return 外轮廓数组，以边开始，首个顶点位于IntersectionIndexes.Last(0)
 	 */
-	TArray<FBlockLinkInfo> GetSurfaceInGraph();
+	TArray<FBlockLinkInfo> GetSurfaceInGraph() const;
 
 	/**
 	 * 稀疏图，使用邻接表实现
 	 */
-	TArray<TArray<FRoadEdge>> Graph;
-
-	/**
-	 * 返回邻接表中相邻的下一条边，当传入最后一条边时返回首条边
-	 * @param NodeIndex 当前节点序号
-	 * @param CurrentEdgeIndex 当前边信息
-	 * @return 相邻的下一条边
-	 */
-	FRoadEdge* FindNextEdge(int32 NodeIndex, const FRoadEdge& CurrentEdgeIndex);
+	TArray<TArray<FRoadGraphEdge>> Graph;
 
 	/**
 	 * 邻接表记录的是从当前节点**出发**的EntryIndex，需要利用双向边特点查询道路从道路起点（FromNodeIndex）进入当前节点（CurrentNodeIndex）时的RoadIndex
@@ -142,13 +159,4 @@ protected:
 	 * 图中边总计算
 	 */
 	int32 EdgeCount = 0;
-
-	/**
-	 * 使用边的单Index模拟半边，当FromNode.VertexIndex<ToNode.VertexIndex时返回2*RoadIndex，否则返回2*RoadIndex+1；
-	 * @param FromNodeIndex 邻接表第一维参数（出发顶点）
-	 * @param ToNodeIndex 邻接表第二维中到达顶点参数
-	 * @param RoadIndex 邻接表第二维中的道路编号
-	 * @return 一维有向边序号
-	 */
-	int32 GetDirectionalEdgeIndex(int32 FromNodeIndex, int32 ToNodeIndex, int32 RoadIndex);
 };
@@ -7,6 +7,8 @@
 #include "RoadSegmentStruct.h"
 #include "Components/ActorComponent.h"
 #include "Components/SplineComponent.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "Road/RoadCrossSectionProfile.h"
 #include "RoadMeshGenerator.generated.h"
 
 
@@ -40,7 +42,7 @@ public:
 	void SetReferenceSpline(TWeakObjectPtr<USplineComponent> InReferenceSpline);
 
 	/**
-	 * 设置道路类型
+	 * 设置道路类型，横断面（车道、路缘石、人行道、中央分隔带）取FRoadCrossSectionProfile::MakePreset
 	 * @param InRoadType 道路枚举值，COLLECTORROADS=5m，ARTERIALROADS=10m,EXPRESSWAYS=20m
 	 */
 	void SetRoadType(ELaneType InRoadType);
@@ -51,7 +53,52 @@ public:
 	 */
 	void SetRoadInfo(const FRoadSegmentsGroup& InRoadWithConnect);
 
-	virtual bool GenerateMesh() override;
+	/**
+	 * IMeshGeneratorInterface接口，检查扫掠点、转换到局部空间并加载材质
+	 */
+	virtual bool PrepareBuild() override;
+
+	/**
+	 * IMeshGeneratorInterface接口，沿扫掠点扫掠截面，原生扫掠时可在任意线程调用
+	 * CityGenerator.Road.LODNum大于1时同时构建抽稀路径的LOD，写入结果的LODMeshes，在CommitMesh中保存
+	 */
+	virtual bool BuildMesh(FMeshBuildResult& OutResult) const override;
+
+	/**
+	 * IMeshGeneratorInterface接口，CityGenerator.Road.NativeSweep关闭时使用AppendSweepPolygon，在游戏线程构建
+	 */
+	virtual bool RequiresGameThreadBuild() const override { return !bUseNativeSweep; }
+
+	/**
+	 * IMeshGeneratorInterface接口，额外刷新材质并保存LOD和构建耗时，显示LOD0
+	 */
+	virtual void CommitMesh(FMeshBuildResult&& InResult) override;
+
+	/**
+	 * @return LOD数量，包括LOD0
+	 */
+	int32 GetLODNum() const { return FMath::Max(1, LODMeshes.Num()); }
+
+	int32 GetDisplayedLOD() const { return DisplayedLOD; }
+
+	/**
+	 * 切换UDynamicMeshComponent显示的LOD，与缓存交换Mesh，不重新构建，只在游戏线程调用
+	 * @param InLODIndex 目标LOD，越界时忽略
+	 */
+	void SetDisplayedLOD(int32 InLODIndex);
+
+	/**
+	 * 复制指定LOD的Mesh，用于烘焙静态网格体
+	 * @return LOD存在返回true
+	 */
+	bool CopyLODMesh(int32 InLODIndex, UE::Geometry::FDynamicMesh3& OutMesh) const;
+
+	/**
+	 * IMeshGeneratorInterface接口，额外清空扫掠点，SetRoadInfo以追加方式写入
+	 */
+	virtual void ResetForRegenerate() override;
+
+	TWeakObjectPtr<USplineComponent> GetReferenceSpline() const { return ReferenceSpline; }
 	virtual void SetMeshComponent(class UDynamicMeshComponent* InMeshComponent) override;
 
 
@@ -75,7 +122,55 @@ public:
 	 */
 	void GetConnectionOrderOfIntersection(int32& OutLocFromIndex, int32& OutLocEndIndex) const;
 
+	/**
+	 * 上次BuildMesh中扫掠和法线计算的耗时，不含材质加载，用于对比CityGenerator.Road.NativeSweep开关前后的性能
+	 */
+	double GetLastMeshBuildSeconds() const { return LastMeshBuildSeconds; }
+
 protected:
+	/**
+	 * CommitMesh时从构建结果中保存的耗时
+	 */
+	double LastMeshBuildSeconds = 0.0;
+
+	/**
+	 * 按PrepareBuild选择的扫掠方式沿路径扫掠截面，LOD0和各级LOD共用，保证各级外观一致
+	 * @param InPath 局部空间的扫掠路径
+	 * @param OutMesh 追加扫掠结果的Mesh
+	 * @return 使用AppendSweepPolygon但临时Mesh未创建时返回false
+	 */
+	bool SweepAlongPath(const TArray<FTransform>& InPath, UE::Geometry::FDynamicMesh3& OutMesh) const;
+
+	/**
+	 * PrepareBuild时读取的CityGenerator.Road.NativeSweep，BuildMesh不在工作线程读取控制台变量
+	 */
+	bool bUseNativeSweep = true;
+
+	/**
+	 * PrepareBuild时按道路类型取出的共享截面模板，CityGenerator.Road.LaneProfile关闭时为空，使用矩形截面
+	 */
+	TSharedPtr<const FRoadProfileTemplate> ProfileTemplate;
+
+	/**
+	 * PrepareBuild时读取的CityGenerator.Road.LODNum和LODChordError
+	 */
+	int32 RequestedLODNum = 1;
+
+	float LODChordError = 25.0f;
+
+	/**
+	 * 各级LOD的Mesh，当前显示的一级在UDynamicMeshComponent中，对应元素为空
+	 */
+	TArray<UE::Geometry::FDynamicMesh3> LODMeshes;
+
+	int32 DisplayedLOD = 0;
+
+	/**
+	 * 使用AppendSweepPolygon时的临时Mesh，在PrepareBuild中创建
+	 */
+	UPROPERTY(Transient)
+	TObjectPtr<UDynamicMesh> BuildScratchMesh = nullptr;
+
 	bool bIsLocalSpace = false;
 	/**
 	 * 世界空间转换局部空间，原位转换，配合上面的bIsLocalSpace进行标记，仅在生成时进行一次性转换（便于分帧操作）
@@ -121,8 +216,11 @@ protected:
 
 	const FString BackupMaterialPath{"/JIAPCGAidTool/CityGeneratorContent/Materials/MI_Road"};
 
-	void GetWSPointFromRoadCenterWithOffset(FVector& PointOnRoadCenter, float DistanceFromStart,
-	                                        const USplineComponent* OwnerSpline, bool bForwardOrderDir,
+	/**
+	 * 按给定的右向量将道路中心点偏移到边缘，右向量由FSplineCursorEvaluator求值结果提供
+	 */
+	void GetWSPointFromRoadCenterWithOffset(FVector& PointOnRoadCenter, const FVector& RightVectorWS,
+	                                        bool bForwardOrderDir,
 	                                        ECoordOffsetType OffsetType = ECoordOffsetType::LEFTEDGE,
 	                                        float CustomOffsetOnLeft = 0);
 	void GetWSPointFromRoadCenterWithOffset(FVector& PointOnRoadCenter, int32 ControlPointIndex,
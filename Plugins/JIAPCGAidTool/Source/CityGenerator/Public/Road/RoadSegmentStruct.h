@@ -8,7 +8,7 @@ class USplineComponent;
 
 
 /**
- * 记录Spline切分出的多段线信息,用于构建四叉树
+ * 记录Spline切分出的多段线编号信息，端点坐标保存在FSplineSegmentStore中，通过GlobalIndex查找
  */
 USTRUCT(BlueprintType)
 struct FSplinePolyLineSegment
@@ -16,20 +16,18 @@ struct FSplinePolyLineSegment
 	GENERATED_BODY()
 	FSplinePolyLineSegment()
 	{
-		//SegmentGlobalIndex++;
 	}
 
 public:
+	/**
+	 * GlobalIndex由调用方分配（URoadGeneratorSubsystem按样条Segment数量前缀和计算），构造本身不依赖全局状态，可在任意线程调用
+	 */
 	FSplinePolyLineSegment(TWeakObjectPtr<USplineComponent> InSplineRef, uint32 InSegmentIndex,
-	                       uint32 InLastSegmentIndex,
-	                       const FTransform& InStartTransform,
-	                       const FTransform& InEndTransform) : OwnerSpline(InSplineRef),
-	                                                           SegmentIndex(InSegmentIndex),
-	                                                           LastSegmentIndex(InLastSegmentIndex),
-	                                                           StartTransform(InStartTransform),
-	                                                           EndTransform(InEndTransform)
+	                       uint32 InLastSegmentIndex, uint32 InGlobalIndex) : OwnerSpline(InSplineRef),
+	                                                                          SegmentIndex(InSegmentIndex),
+	                                                                          LastSegmentIndex(InLastSegmentIndex),
+	                                                                          GlobalIndex(InGlobalIndex)
 	{
-		GlobalIndex = SegmentGlobalIndex++;
 	};
 
 	~FSplinePolyLineSegment()
@@ -37,7 +35,15 @@ public:
 		OwnerSpline = nullptr;
 	}
 
-	static void ResetGlobalIndex() { SegmentGlobalIndex = 0; }
+	/**
+	 * 为一条样条生成连续编号的Segment，GlobalIndex从InFirstGlobalIndex开始依次递增
+	 * @param InSplineRef 所属样条，只复制引用不解引用
+	 * @param InSegmentNum Segment数量，即重采样点数-1
+	 * @param InFirstGlobalIndex 第一个Segment的GlobalIndex
+	 * @return 生成的Segment数组
+	 */
+	static TArray<FSplinePolyLineSegment> MakeSegments(const TWeakObjectPtr<USplineComponent>& InSplineRef,
+	                                                   int32 InSegmentNum, uint32 InFirstGlobalIndex);
 	/**
 	 * 所属的Spline信息
 	 */
@@ -55,17 +61,6 @@ public:
 	 */
 	uint32 LastSegmentIndex = 0;
 
-	/**
-	 * Segment起点，世界空间位置；
-	 * @TODO后续需要重新考虑一下是不是必须Transform，FVector作为POD对象预处理效率更高
-	 */
-	FTransform StartTransform = FTransform::Identity;
-
-	/**
-	 * Segment终点，世界空间位置
-	 */
-	FTransform EndTransform = FTransform::Identity;
-
 	/**
 	 * 返回Segment全局ID，用于区分不同Segment
 	 * @return 返回ID值
@@ -73,10 +68,6 @@ public:
 	uint32 GetGlobalIndex() const { return GlobalIndex; }
 
 protected:
-	/**
-	 * 全局Segment递增序号
-	 */
-	static uint32 SegmentGlobalIndex;
 	/**
 	 * 自身的Segment编号
 	 */
@@ -126,6 +117,10 @@ public:
 	 */
 	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly)
 	FVector WorldLocation = FVector::Zero();
+	/**
+	 * 合并到该交点的原始交点，每个元素为(GlobalIndexA<<32|GlobalIndexB)，升序，增量更新时据此匹配上次的交点
+	 */
+	TArray<uint64> SourceHitPairs;
 };
 
 /**
@@ -227,6 +222,11 @@ public:
 	TArray<FVector2D> CrossSectionCoord;
 	float SampleLength = 500.0;
 
+	/**
+	 * 道路类型，用于从FRoadProfileLibrary取共享的横断面模板；CrossSectionCoord保留为同宽矩形，供宽度查询和AppendSweepPolygon使用
+	 */
+	ELaneType LaneType = ELaneType::COLLECTORROADS;
+
 protected:
 	static TArray<FVector2D> GetRectangle2DCoords(float Width, float Height, bool Clockwise = true)
 	{
@@ -283,12 +283,12 @@ struct FRoadSegmentsGroup
 	FTransform TailConnectionTrans;
 
 	/**
-	 * 道路构建时起始交会口的序号
+	 * 道路构建时起始交会口的序号，无衔接为INT32_ERROR
 	 */
-	int32 FromIntersectionIndex;
+	int32 FromIntersectionIndex = INT32_ERROR;
 
 	/**
-	 * 道路构建时终止交会口的序号
+	 * 道路构建时终止交会口的序号，无衔接为INT32_ERROR
 	 */
-	int32 ToIntersectionIndex;
+	int32 ToIntersectionIndex = INT32_ERROR;
 };
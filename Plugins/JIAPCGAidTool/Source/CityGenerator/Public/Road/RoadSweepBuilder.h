@@ -0,0 +1,63 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRoadProfileTemplate;
+
+namespace UE::Geometry
+{
+	class FDynamicMesh3;
+}
+
+/**
+ * 道路扫掠Mesh构建，替代UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendSweepPolygon+ComputeSplitNormals
+ * 截面每条边独立一组法线和UV（截面拐角处硬边），沿路径方向共享顶点，法线由截面边的外法线经路径点旋转直接求出，不再整体重算
+ * 截面坐标X对应路径点的Y轴（道路横向），Y对应Z轴（高度），与AppendSweepPolygon一致
+ * 截面先编译为FRoadProfileTemplate，扫掠只沿路径实例化模板；道路类型的模板由FRoadProfileLibrary缓存共享
+ * 不依赖UObject，可在任意线程调用
+ */
+struct CITYGENERATOR_API FRoadSweepBuilder
+{
+	/**
+	 * 追加扫掠Mesh，目标Mesh没有属性时启用法线和UV层
+	 * UV的U沿截面周长、V沿路径长度，均归一化到[0,1]，与AppendSweepPolygon默认UV范围一致
+	 * @param OutMesh 追加的目标Mesh
+	 * @param InCrossSection 截面凸多边形，至少3个点，顺逆时针均可，两端按扇形封口
+	 * @param InSweepPath 路径点，至少2个，Scale的Y、Z分量缩放截面
+	 * @param bCapped 是否为两端封口
+	 * @return 追加的三角形数量，输入无效返回0
+	 */
+	static int32 AppendSweep(UE::Geometry::FDynamicMesh3& OutMesh, TConstArrayView<FVector2D> InCrossSection,
+	                         TConstArrayView<FTransform> InSweepPath, bool bCapped = true);
+
+	/**
+	 * 沿路径实例化已编译的截面模板，两端按模板的封口三角形封口
+	 * @param InTemplate 截面模板，无效时返回0
+	 */
+	static int32 AppendSweep(UE::Geometry::FDynamicMesh3& OutMesh, const FRoadProfileTemplate& InTemplate,
+	                         TConstArrayView<FTransform> InSweepPath, bool bCapped = true);
+
+	/**
+	 * 把XY平面上的模板沿+Z挤出为柱体，替代AppendSimpleExtrudePolygon+AutoRepairNormals+ComputeSplitNormals
+	 * 即沿两点竖直路径扫掠，侧面和封口法线直接给出，不需要修复
+	 * @param InTemplate 截面模板，通常由FRoadProfileTemplate::CompileSimplePolygon编译
+	 * @param InHeight 挤出高度cm
+	 * @return 追加的三角形数量，输入无效返回0
+	 */
+	static int32 AppendExtrudedPolygon(UE::Geometry::FDynamicMesh3& OutMesh, const FRoadProfileTemplate& InTemplate,
+	                                   double InHeight);
+
+	/**
+	 * 预计追加的顶点和三角形数量，用于调用方统计和预分配
+	 */
+	static void GetSweepElementNum(int32 InSectionNum, int32 InPathNum, bool bCapped, int32& OutVertexNum,
+	                               int32& OutTriangleNum);
+
+	/**
+	 * 按模板预计追加的顶点和三角形数量
+	 */
+	static void GetSweepElementNum(const FRoadProfileTemplate& InTemplate, int32 InPathNum, bool bCapped,
+	                               int32& OutVertexNum, int32& OutTriangleNum);
+};
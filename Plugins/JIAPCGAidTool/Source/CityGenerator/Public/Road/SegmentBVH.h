@@ -0,0 +1,108 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 只存储Segment下标的扁平BVH，用于替代以完整FSplinePolyLineSegment为负载的四叉树
+ * 节点连续存放在数组中，端点以SoA形式保存，查询只返回uint32下标，调用方通过下标访问自己持有的Segment数组
+ */
+class CITYGENERATOR_API FSegmentBVH
+{
+public:
+	/**
+	 * 使用线段端点构建BVH，会覆盖之前的数据，线段下标即传入数组中的下标
+	 * 按质心包围盒最长轴的中位数二分，叶节点最多容纳MaxLeafSize条线段
+	 * @param InSegmentStarts 线段起点
+	 * @param InSegmentEnds 线段终点，与InSegmentStarts一一对应
+	 */
+	void Build(const TArray<FVector2D>& InSegmentStarts, const TArray<FVector2D>& InSegmentEnds);
+
+	/**
+	 * 清空节点和端点数据
+	 */
+	void Empty();
+
+	/**
+	 * 追加一条线段，下标为追加前的Num()；新线段不进入树结构，放在溢出列表中由Query线性检查
+	 * 溢出或移除的线段过多时应调用Build重建
+	 * @param InSegmentStart 线段起点
+	 * @param InSegmentEnd 线段终点
+	 * @return 新线段下标
+	 */
+	uint32 Append(const FVector2D& InSegmentStart, const FVector2D& InSegmentEnd);
+
+	/**
+	 * 标记移除一条线段，下标保持不变，Query不再返回该线段
+	 * @param SegmentIndex 线段下标
+	 */
+	void Remove(uint32 SegmentIndex);
+
+	/**
+	 * 查询包围盒与给定盒相交（含边界接触）的线段，结果追加到输出数组，不保证顺序
+	 * @param InQueryBox 查询范围
+	 * @param OutSegmentIndices 线段下标，原位追加
+	 */
+	void Query(const FBox2D& InQueryBox, TArray<uint32>& OutSegmentIndices) const;
+
+	int32 Num() const { return StartX.Num(); }
+
+	bool IsEmpty() const { return StartX.IsEmpty(); }
+
+	/**
+	 * 树结构之外的线段数量
+	 */
+	int32 GetOverflowNum() const { return OverflowSegmentIndices.Num(); }
+
+	/**
+	 * 已标记移除的线段数量
+	 */
+	int32 GetRemovedNum() const { return RemovedNum; }
+
+	bool IsRemoved(uint32 SegmentIndex) const { return RemovedFlags[SegmentIndex]; }
+
+	FVector2D GetStart(uint32 SegmentIndex) const { return FVector2D(StartX[SegmentIndex], StartY[SegmentIndex]); }
+
+	FVector2D GetEnd(uint32 SegmentIndex) const { return FVector2D(EndX[SegmentIndex], EndY[SegmentIndex]); }
+
+protected:
+	/**
+	 * BVH节点，Count大于0时为叶节点，FirstIndex指向LeafSegmentIndices；否则FirstIndex为左子节点，右子节点紧随其后
+	 */
+	struct FNode
+	{
+		double MinX = 0.0;
+		double MinY = 0.0;
+		double MaxX = 0.0;
+		double MaxY = 0.0;
+		int32 FirstIndex = 0;
+		int32 Count = 0;
+	};
+
+	static constexpr int32 MaxLeafSize = 4;
+
+	TArray<FNode> Nodes;
+
+	/**
+	 * 按叶节点顺序排列的线段下标
+	 */
+	TArray<uint32> LeafSegmentIndices;
+
+	/**
+	 * Build之后追加的线段下标
+	 */
+	TArray<uint32> OverflowSegmentIndices;
+
+	/**
+	 * 以线段下标为索引的移除标记
+	 */
+	TBitArray<> RemovedFlags;
+
+	int32 RemovedNum = 0;
+
+	TArray<double> StartX;
+	TArray<double> StartY;
+	TArray<double> EndX;
+	TArray<double> EndY;
+};
@@ -0,0 +1,92 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USplineComponent;
+struct FSplineCurves;
+
+/**
+ * 样条游标求值器，按距离单调递增的顺序求值时沿用上一次所在的区间，避免每次都在ReparamTable上二分查找
+ * 一次求值同时给出InputKey、世界空间Transform和切线，结果与USplineComponent的对应函数一致
+ * 距离回退时重新二分定位；实例不是线程安全的，每个线程各自构造，求值期间样条（或其快照）需保持有效且不被修改
+ */
+class CITYGENERATOR_API FSplineCursorEvaluator
+{
+public:
+	/**
+	 * 单次求值结果
+	 */
+	struct FSample
+	{
+		/**
+		 * 对应GetInputKeyValueAtDistanceAlongSpline
+		 */
+		float InputKey = 0.0f;
+		/**
+		 * 对应GetTransformAtDistanceAlongSpline(World)
+		 */
+		FTransform Transform = FTransform::Identity;
+		/**
+		 * 对应GetTangentAtDistanceAlongSpline(World)
+		 */
+		FVector TangentWS = FVector::ZeroVector;
+	};
+
+	/**
+	 * @param InSpline 目标样条，在构造时缓存其ComponentTransform和DefaultUpVector
+	 */
+	explicit FSplineCursorEvaluator(const USplineComponent* InSpline);
+
+	/**
+	 * 直接对曲线数据求值，不依赖USplineComponent，用于FCityModel
+	 * @param InCurves 曲线数据，需已调用UpdateSpline构建ReparamTable
+	 * @param InComponentTransform 曲线局部空间到世界空间的变换
+	 * @param InDefaultUpVectorLS 局部空间默认上方向，对应USplineComponent::DefaultUpVector
+	 */
+	FSplineCursorEvaluator(const FSplineCurves& InCurves, const FTransform& InComponentTransform,
+	                       const FVector& InDefaultUpVectorLS = FVector::UpVector);
+
+	bool IsValid() const { return nullptr != Curves; }
+
+	float GetSplineLength() const;
+
+	/**
+	 * 仅求InputKey，不计算Transform
+	 * @param Distance 沿样条的距离
+	 * @return 距离对应的InputKey
+	 */
+	float GetInputKeyAtDistance(float Distance);
+
+	/**
+	 * 求给定距离处的InputKey、Transform和切线
+	 * @param Distance 沿样条的距离
+	 * @param bUseScale 是否使用样条点上的Scale，与GetTransformAtDistanceAlongSpline的同名参数一致
+	 * @return 求值结果，求值器无效时返回默认值
+	 */
+	FSample Evaluate(float Distance, bool bUseScale = false);
+
+	/**
+	 * 游标回到样条起点
+	 */
+	void Reset();
+
+protected:
+	const FSplineCurves* Curves = nullptr;
+
+	FTransform ComponentTransform = FTransform::Identity;
+
+	FVector DefaultUpVectorLS = FVector::UpVector;
+
+	/**
+	 * 各曲线上一次命中的区间起点
+	 */
+	int32 ReparamCursor = 0;
+
+	int32 PositionCursor = 0;
+
+	int32 RotationCursor = 0;
+
+	int32 ScaleCursor = 0;
+};
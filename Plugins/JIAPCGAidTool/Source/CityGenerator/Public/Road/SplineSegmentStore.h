@@ -0,0 +1,215 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USplineComponent;
+
+/**
+ * 以SoA形式保存所有样条折线Segment的存储，由FCityModelBuilder::ResampleSplines或URoadGeneratorSubsystem::UpdateSplineSegments填充
+ * 求交和道路切割只访问连续的二维端点数组与编号数组；高度、旋转、缩放放在侧边数组，仅在构建道路Mesh时读取
+ * 存储下标与BVH下标一致，GlobalIndex按追加顺序递增
+ */
+class CITYGENERATOR_API FSplineSegmentStore
+{
+public:
+	/**
+	 * 追加一条样条的折线，相邻两点构成一个Segment，共InPolyLinePoints.Num()-1个
+	 * @param InSpline 所属样条
+	 * @param InPolyLinePoints 重采样得到的折线点，世界空间
+	 * @param InFirstGlobalIndex 第一个Segment的GlobalIndex，之后依次递增，必须大于已有的最大值
+	 * @return 该样条在存储中的SplineId，折线点不足两个时返回INDEX_NONE
+	 */
+	int32 AppendSpline(const TWeakObjectPtr<USplineComponent>& InSpline, const TArray<FTransform>& InPolyLinePoints,
+	                   uint32 InFirstGlobalIndex);
+
+	/**
+	 * 标记移除一条样条的所有Segment，存储下标保持不变，样条表中对应项置空
+	 * 被移除的Segment仍占用存储，直到调用Compact
+	 * @param SplineId AppendSpline返回的编号
+	 */
+	void RemoveSpline(int32 SplineId);
+
+	/**
+	 * 删除所有被标记移除的Segment与折线点，保持剩余Segment的相对顺序（即GlobalIndex仍然升序）
+	 * SplineId与存储下标会重新编号，调用后依赖下标的外部数据（如BVH）需要重建
+	 */
+	void Compact();
+
+	/**
+	 * 清空所有数据
+	 */
+	void Empty();
+
+	int32 Num() const { return StartX.Num(); }
+
+	bool IsEmpty() const { return StartX.IsEmpty(); }
+
+	bool IsRemoved(int32 Index) const { return RemovedFlags[Index]; }
+
+	/**
+	 * 已标记移除但尚未Compact的Segment数量
+	 */
+	int32 GetRemovedNum() const { return RemovedNum; }
+
+	/**
+	 * 样条第一个Segment的存储下标，同一样条的Segment连续存放
+	 */
+	int32 GetSplineFirstSegment(int32 SplineId) const { return SplineFirstSegments[SplineId]; }
+
+	int32 GetSplineSegmentNum(int32 SplineId) const { return SplineSegmentNums[SplineId]; }
+
+	int32 GetSplineNum() const { return Splines.Num(); }
+
+	FVector2D GetStart(int32 Index) const { return FVector2D(StartX[Index], StartY[Index]); }
+
+	FVector2D GetEnd(int32 Index) const { return FVector2D(EndX[Index], EndY[Index]); }
+
+	const TArray<double>& GetStartX() const { return StartX; }
+
+	const TArray<double>& GetStartY() const { return StartY; }
+
+	const TArray<double>& GetEndX() const { return EndX; }
+
+	const TArray<double>& GetEndY() const { return EndY; }
+
+	int32 GetSplineId(int32 Index) const { return SplineIds[Index]; }
+
+	uint32 GetSegmentIndex(int32 Index) const { return SegmentIndices[Index]; }
+
+	uint32 GetLastSegmentIndex(int32 Index) const { return LastSegmentIndices[Index]; }
+
+	uint32 GetGlobalIndex(int32 Index) const { return GlobalIndices[Index]; }
+
+	/**
+	 * 返回Segment所属样条
+	 */
+	const TWeakObjectPtr<USplineComponent>& GetSpline(int32 Index) const { return Splines[SplineIds[Index]]; }
+
+	/**
+	 * 查找样条的SplineId，多次追加同一样条时返回最后一次的编号
+	 * @param InSpline 目标样条
+	 * @return 未找到返回INDEX_NONE
+	 */
+	int32 FindSplineId(const TWeakObjectPtr<USplineComponent>& InSpline) const;
+
+	/**
+	 * 根据GlobalIndex二分查找存储下标
+	 * @param InGlobalIndex Segment全局编号
+	 * @return 未找到返回INDEX_NONE
+	 */
+	int32 IndexOfGlobalIndex(uint32 InGlobalIndex) const;
+
+	/**
+	 * 判断两个Segment是否为同一样条上首尾相连的Segment（含闭合样条首尾），此类Segment必然共享端点，不视为交点
+	 * @param IndexA 存储下标
+	 * @param IndexB 存储下标
+	 * @return 相连返回true
+	 */
+	bool IsAdjacent(int32 IndexA, int32 IndexB) const;
+
+	/**
+	 * 从侧边数组还原Segment起点Transform，仅用于道路Mesh构建
+	 */
+	FTransform GetStartTransform(int32 Index) const;
+
+	/**
+	 * 从侧边数组还原Segment终点Transform，仅用于道路Mesh构建
+	 */
+	FTransform GetEndTransform(int32 Index) const;
+
+	/**
+	 * Segment起点三维位置，仅用于可视化调试
+	 */
+	FVector GetStartLocation(int32 Index) const;
+
+	/**
+	 * Segment终点三维位置，仅用于可视化调试
+	 */
+	FVector GetEndLocation(int32 Index) const;
+
+protected:
+	/**
+	 * 求交热路径数据，每个Segment一项
+	 */
+	TArray<double> StartX;
+	TArray<double> StartY;
+	TArray<double> EndX;
+	TArray<double> EndY;
+	TArray<int32> SplineIds;
+	TArray<uint32> SegmentIndices;
+	/**
+	 * 所在样条最后一个Segment的SegmentIndex，用于排除ClosedLoop首尾相连的情况
+	 */
+	TArray<uint32> LastSegmentIndices;
+	TArray<uint32> GlobalIndices;
+
+	/**
+	 * 以SplineId为下标的样条表
+	 */
+	TArray<TWeakObjectPtr<USplineComponent>> Splines;
+	TArray<int32> SplineFirstSegments;
+	TArray<int32> SplineSegmentNums;
+
+	/**
+	 * 以存储下标为索引的移除标记
+	 */
+	TBitArray<> RemovedFlags;
+	int32 RemovedNum = 0;
+
+	/**
+	 * 侧边数据，Segment起点在折线点数组中的下标，终点为其后一项
+	 */
+	TArray<int32> StartPointIndices;
+	/**
+	 * 侧边数据，以折线点为下标，只有道路Mesh构建读取
+	 */
+	TArray<double> PointZ;
+	TArray<FQuat> PointRotations;
+	TArray<FVector> PointScales;
+};
+
+/**
+ * 两个Segment求交得到的原始交点，由FCityModelBuilder::MergeSegmentHits合并为交汇路口
+ * 多线程求交时每个线程各自持有一份缓冲，最后按分块顺序合并
+ */
+struct FSegmentPairHit
+{
+	FSegmentPairHit()
+	{
+	};
+
+	FSegmentPairHit(const FSplineSegmentStore& InStore, int32 InIndexA, int32 InIndexB,
+	                const FVector2D& InLocation) : SplineA(InStore.GetSpline(InIndexA)),
+	                                               SplineB(InStore.GetSpline(InIndexB)),
+	                                               SegmentIndexA(InStore.GetSegmentIndex(InIndexA)),
+	                                               SegmentIndexB(InStore.GetSegmentIndex(InIndexB)),
+	                                               GlobalIndexA(InStore.GetGlobalIndex(InIndexA)),
+	                                               GlobalIndexB(InStore.GetGlobalIndex(InIndexB)), Location(InLocation)
+	{
+	};
+
+	/**
+	 * 遍历方Segment所属样条，其GlobalIndex一定小于B
+	 */
+	TWeakObjectPtr<USplineComponent> SplineA;
+	/**
+	 * 被BVH查询到的Segment所属样条
+	 */
+	TWeakObjectPtr<USplineComponent> SplineB;
+
+	uint32 SegmentIndexA = 0;
+
+	uint32 SegmentIndexB = 0;
+	/**
+	 * 两个Segment的GlobalIndex，用于不同求交后端输出的统一排序
+	 */
+	uint32 GlobalIndexA = 0;
+
+	uint32 GlobalIndexB = 0;
+	/**
+	 * 交点二维位置
+	 */
+	FVector2D Location = FVector2D::ZeroVector;
+};
@@ -0,0 +1,77 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SplineComponent.h"
+#include "Road/SplineCursorEvaluator.h"
+
+/**
+ * 样条的只读快照，供后台任务计算采样、拆分路口和道路切分使用
+ * 在游戏线程复制曲线数据（与USplineComponent::SplineCurves相同）、世界变换和默认上方向，不持有UObject，
+ * 后台线程通过FSplineCursorEvaluator求值，生成过程中用户拖动原样条不影响计算
+ * 以下查询函数与USplineComponent的同名函数结果一致，坐标均为世界空间
+ */
+struct CITYGENERATOR_API FSplineSnapshot
+{
+	FSplineSnapshot()
+	{
+	};
+
+	/**
+	 * 复制样条曲线数据和世界变换，只能在游戏线程调用
+	 * @param InSpline 原样条
+	 * @return 原样条为空时返回无效快照
+	 */
+	static FSplineSnapshot Capture(const USplineComponent* InSpline);
+
+	bool IsValid() const { return !Curves.Position.Points.IsEmpty() && !Curves.ReparamTable.Points.IsEmpty(); }
+
+	/**
+	 * @return 引用本快照曲线数据的求值器，求值期间快照需保持有效
+	 */
+	FSplineCursorEvaluator MakeEvaluator() const
+	{
+		return FSplineCursorEvaluator(Curves, Transform, DefaultUpVector);
+	}
+
+	int32 GetNumberOfSplinePoints() const { return Curves.Position.Points.Num(); }
+
+	int32 GetNumberOfSplineSegments() const;
+
+	float GetSplineLength() const { return Curves.GetSplineLength(); }
+
+	/**
+	 * 闭合样条的PointIndex可以等于控制点数，对应样条全长
+	 */
+	float GetDistanceAlongSplineAtSplinePoint(int32 PointIndex) const;
+
+	float GetDistanceAlongSplineAtSplineInputKey(float InKey) const;
+
+	/**
+	 * 先在位置曲线上求最近点的InputKey，再换算为距离
+	 */
+	float GetDistanceAlongSplineAtLocation(const FVector& InLocationWS) const;
+
+	/**
+	 * 对应GetSplinePointType(PointIndex)==ESplinePointType::Linear，越界返回false
+	 */
+	bool IsLinearPoint(int32 PointIndex) const;
+
+	/**
+	 * 位置、旋转、缩放曲线和距离-InputKey重参数表，局部空间
+	 */
+	FSplineCurves Curves;
+
+	/**
+	 * 局部空间到世界空间的变换
+	 */
+	FTransform Transform = FTransform::Identity;
+
+	/**
+	 * 局部空间默认上方向
+	 */
+	FVector DefaultUpVector = FVector::UpVector;
+
+	bool bClosedLoop = false;
+};
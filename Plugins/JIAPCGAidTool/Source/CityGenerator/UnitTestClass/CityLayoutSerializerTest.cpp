@@ -0,0 +1,200 @@
+﻿#include "Misc/AutomationTest.h"
+#include "CityLayoutSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Road/CityModel.h"
+#include "Serialization/MemoryReader.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(CityLayoutSerializerTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.CityLayoutSerializerTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 比较两份布局，Tolerance为0时要求逐位相等
+ */
+bool IsSameCityLayout(const FCityLayout& A, const FCityLayout& B, double Tolerance)
+{
+	if (A.Splines.Num() != B.Splines.Num() || A.PointTypes != B.PointTypes || A.GetPointNum() != B.GetPointNum())
+	{
+		return false;
+	}
+	for (int32 i = 0; i < A.Splines.Num(); ++i)
+	{
+		const FCityLayoutSpline& SplineA = A.Splines[i];
+		const FCityLayoutSpline& SplineB = B.Splines[i];
+		if (SplineA.OwnerName != SplineB.OwnerName || SplineA.OwnerActorID != SplineB.OwnerActorID ||
+			SplineA.Index != SplineB.Index || SplineA.bClosedLoop != SplineB.bClosedLoop ||
+			SplineA.ActorTags != SplineB.ActorTags || SplineA.CompTags != SplineB.CompTags ||
+			SplineA.FirstPoint != SplineB.FirstPoint || SplineA.PointNum != SplineB.PointNum ||
+			!SplineA.OwnerTransform.Equals(SplineB.OwnerTransform, Tolerance))
+		{
+			return false;
+		}
+	}
+	for (int32 i = 0; i < A.GetPointNum(); ++i)
+	{
+		if (!A.PointLocations[i].Equals(B.PointLocations[i], Tolerance) ||
+			!A.PointTangents[i].Equals(B.PointTangents[i], Tolerance) ||
+			!A.PointRotations[i].Equals(B.PointRotations[i], Tolerance))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Json→二进制→布局应逐位一致，布局→Json→布局在数值精度内一致
+ */
+bool TestRoundTrip(const FCityLayout& InLayout, int32 CaseIndex)
+{
+	TArray<uint8> Bytes;
+	FCityLayout BinaryLayout;
+	if (!FCityLayoutSerializer::WriteBinary(InLayout, Bytes) || !FCityLayoutSerializer::ReadBinary(Bytes, BinaryLayout)
+		|| !IsSameCityLayout(InLayout, BinaryLayout, 0.0))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayoutSerializerTest-RoundTrip]Binary Test Failed On Case %d"), CaseIndex);
+		return false;
+	}
+	FString JsonStr;
+	FCityLayout JsonLayout;
+	if (!FCityLayoutSerializer::WriteJson(InLayout, JsonStr) || !FCityLayoutSerializer::ReadJson(JsonStr, JsonLayout)
+		|| !IsSameCityLayout(InLayout, JsonLayout, 1e-6))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayoutSerializerTest-RoundTrip]Json Test Failed On Case %d"), CaseIndex);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * 流式读取UTF-8 Json，逐条拼接后应与DOM读取一致
+ */
+bool TestStreaming(const FCityLayout& InLayout, int32 CaseIndex)
+{
+	FString JsonStr;
+	FCityLayout DomLayout;
+	if (!FCityLayoutSerializer::WriteJson(InLayout, JsonStr) || !FCityLayoutSerializer::ReadJson(JsonStr, DomLayout))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayoutSerializerTest-Streaming]Write Json Failed On Case %d"), CaseIndex);
+		return false;
+	}
+	const FTCHARToUTF8 Utf8Str(*JsonStr);
+	TArray<uint8> Bytes(reinterpret_cast<const uint8*>(Utf8Str.Get()), Utf8Str.Length());
+	FMemoryReader Reader(Bytes);
+	FCityLayout StreamLayout;
+	const bool bSucceeded = FCityLayoutSerializer::ReadJsonStreaming(
+		Reader, [&StreamLayout](const FCityLayout& InSplineLayout)
+		{
+			FCityLayoutSpline Spline = InSplineLayout.Splines[0];
+			StreamLayout.AddSpline(MoveTemp(Spline), InSplineLayout.PointTypes, InSplineLayout.PointLocations,
+			                       InSplineLayout.PointTangents, InSplineLayout.PointRotations);
+			return true;
+		});
+	if (!bSucceeded || !IsSameCityLayout(DomLayout, StreamLayout, 0.0))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityLayoutSerializerTest-Streaming]Test Failed On Case %d"), CaseIndex);
+		return false;
+	}
+	return true;
+}
+
+bool CityLayoutSerializerTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+	//Case0-2:仓库中的样例Json
+	const FString SampleDir = FPaths::ProjectPluginsDir() / TEXT("JIAPCGAidTool/Samples");
+	const TArray<FString> SampleFiles{
+		TEXT("CitySpline.json"), TEXT("CitySpline2.json"), TEXT("ThreeRoadModel.json")
+	};
+	for (int32 i = 0; i < SampleFiles.Num(); ++i)
+	{
+		FCityLayout SampleLayout;
+		if (!FCityLayoutSerializer::LoadFromFile(SampleDir / SampleFiles[i], SampleLayout) || SampleLayout.IsEmpty())
+		{
+			AddError(FString::Printf(TEXT("[CityLayoutSerializerTest]Load Sample %s Failed"), *SampleFiles[i]));
+			bSuccess = false;
+			continue;
+		}
+		bSuccess &= TestRoundTrip(SampleLayout, i);
+		bSuccess &= TestStreaming(SampleLayout, i);
+		//样例文件按DOM读取的结果应与LoadFromFile的流式读取一致
+		FString SampleStr;
+		FCityLayout DomLayout;
+		if (!FFileHelper::LoadFileToString(SampleStr, *(SampleDir / SampleFiles[i])) ||
+			!FCityLayoutSerializer::ReadJson(SampleStr, DomLayout) || !IsSameCityLayout(DomLayout, SampleLayout, 0.0))
+		{
+			AddError(FString::Printf(TEXT("[CityLayoutSerializerTest]Streaming Sample %s Mismatch"), *SampleFiles[i]));
+			bSuccess = false;
+		}
+	}
+	//Case3:标签、闭合样条、同一Actor上的多条样条
+	FCityLayout TaggedLayout;
+	const FGuid SharedOwner = FGuid::NewGuid();
+	FCityLayoutSpline LoopSpline;
+	LoopSpline.OwnerName = TEXT("道路Owner");
+	LoopSpline.OwnerActorID = SharedOwner;
+	LoopSpline.OwnerTransform = FTransform(FRotator(0, 30, 0), FVector(100.25, -3.5, 7), FVector(1, 2, 1));
+	LoopSpline.bClosedLoop = true;
+	LoopSpline.ActorTags = {TEXT("City"), TEXT("Arterial")};
+	LoopSpline.CompTags = {TEXT("City")};
+	TaggedLayout.AddSpline(MoveTemp(LoopSpline), {0, 1, 3},
+	                       {FVector(0, 0, 0), FVector(1000.125, 0, 0), FVector(0, 1000, 0)},
+	                       {FVector(1, 0, 0), FVector(0, 1, 0), FVector(-1, -1, 0)},
+	                       {FRotator(0, 0, 0), FRotator(0, 90, 0), FRotator(0, -135, 0)});
+	FCityLayoutSpline OpenSpline;
+	OpenSpline.OwnerName = TEXT("RoadOwner");
+	OpenSpline.OwnerActorID = SharedOwner;
+	OpenSpline.Index = 1;
+	TaggedLayout.AddSpline(MoveTemp(OpenSpline), {1, 1}, {FVector(0, 0, 0), FVector(0, 500, 0)},
+	                       {FVector(0, 500, 0), FVector(0, 500, 0)}, {FRotator(0, 90, 0), FRotator(0, 90, 0)});
+	bSuccess &= TestRoundTrip(TaggedLayout, 3);
+	bSuccess &= TestStreaming(TaggedLayout, 3);
+	//Case4:空布局
+	bSuccess &= TestRoundTrip(FCityLayout(), 4);
+	bSuccess &= TestStreaming(FCityLayout(), 4);
+	//流式读取直接填充CityModel，回调返回false时停止
+	{
+		FString JsonStr;
+		FCityLayoutSerializer::WriteJson(TaggedLayout, JsonStr);
+		const FTCHARToUTF8 Utf8Str(*JsonStr);
+		TArray<uint8> JsonBytes(reinterpret_cast<const uint8*>(Utf8Str.Get()), Utf8Str.Length());
+		FMemoryReader Reader(JsonBytes);
+		FCityModel Model;
+		const bool bSucceeded = FCityLayoutSerializer::ReadJsonStreaming(
+			Reader, [&Model](const FCityLayout& InSplineLayout)
+			{
+				Model.AddSpline(FCityModelSpline::MakeFromLayout(InSplineLayout, 0));
+				return false;
+			});
+		if (!bSucceeded || Model.Splines.Num() != 1 || Model.Splines[0].GetNumberOfSplinePoints() != 3 ||
+			!Model.Splines[0].bClosedLoop || Model.Splines[0].GetSplineLength() <= 0.0f)
+		{
+			AddError("[CityLayoutSerializerTest]Streaming Into CityModel Failed");
+			bSuccess = false;
+		}
+	}
+	//Case5:损坏的文件，读取失败时的错误日志是预期的
+	AddExpectedError(TEXT("[CityLayout]Read Binary Failed"), EAutomationExpectedErrorFlags::Contains, 0);
+	TArray<uint8> Bytes;
+	FCityLayout BrokenLayout;
+	FCityLayoutSerializer::WriteBinary(TaggedLayout, Bytes);
+	Bytes.SetNum(Bytes.Num() / 2);
+	if (FCityLayoutSerializer::ReadBinary(Bytes, BrokenLayout) || !BrokenLayout.IsEmpty())
+	{
+		AddError("[CityLayoutSerializerTest]Truncated File Should Be Rejected");
+		bSuccess = false;
+	}
+	Bytes.Reset();
+	Bytes.Append({'n', 'o', 't', 'a', 'f', 'i', 'l', 'e'});
+	if (FCityLayoutSerializer::ReadBinary(Bytes, BrokenLayout))
+	{
+		AddError("[CityLayoutSerializerTest]Wrong Magic Should Be Rejected");
+		bSuccess = false;
+	}
+	if (!bSuccess)
+	{
+		AddError("[CityLayoutSerializerTest]Test Failed");
+	}
+	return bSuccess;
+}
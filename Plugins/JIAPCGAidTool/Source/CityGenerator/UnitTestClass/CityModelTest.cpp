@@ -0,0 +1,127 @@
+﻿#include "Misc/AutomationTest.h"
+#include "Road/CityModel.h"
+#include "Road/CityModelBuilder.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(CityModelTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.CityModelTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 由折线控制点构建CityModel并完整运行FCityModelBuilder，比较路口、道路、街区数量
+ */
+bool TestBuildCityModel(const TArray<TArray<FVector>>& InLines, int32 ExpectedIntersections, int32 ExpectedRoads,
+                        int32 ExpectedBlocks, int32 CaseIndex, FCityModel& OutModel)
+{
+	OutModel.Reset();
+	for (const TArray<FVector>& Line : InLines)
+	{
+		OutModel.AddSpline(FCityModelSpline::MakeFromPoints(Line, false, true));
+	}
+	const FCityModelBuilder Builder;
+	Builder.Build(OutModel);
+	if (OutModel.Intersections.Num() != ExpectedIntersections || OutModel.Roads.Num() != ExpectedRoads ||
+		OutModel.Blocks.Num() != ExpectedBlocks)
+	{
+		UE_LOG(LogTemp, Error,
+		       TEXT("[CityModelTest-Build]Test Failed On Case %d,Intersections %d,Roads %d,Blocks %d"), CaseIndex,
+		       OutModel.Intersections.Num(), OutModel.Roads.Num(), OutModel.Blocks.Num());
+		return false;
+	}
+	return true;
+}
+
+/**
+ * 检查ID连续、道路两端衔接的入口与路口入口方向一致、街区每条道路都在图中
+ */
+bool TestCityModelConsistency(const FCityModel& InModel, int32 CaseIndex)
+{
+	for (int32 i = 0; i < InModel.Intersections.Num(); ++i)
+	{
+		if (InModel.Intersections[i].ID != i || InModel.Intersections[i].Entries.IsEmpty())
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityModelTest-Consistency]Test Failed On Case %d,Intersection %d"),
+			       CaseIndex, i);
+			return false;
+		}
+	}
+	for (int32 i = 0; i < InModel.Roads.Num(); ++i)
+	{
+		const FCityModelRoad& Road = InModel.Roads[i];
+		if (Road.ID != i || Road.RoadInfo.ContinuousSegmentsTrans.Num() < 2)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityModelTest-Consistency]Test Failed On Case %d,Road %d"), CaseIndex, i);
+			return false;
+		}
+		for (int32 k = 0; k < 2; ++k)
+		{
+			if (Road.ConnectedIntersections[k] == INT32_ERROR)
+			{
+				continue;
+			}
+			const FCityModelEntry& Entry = InModel.Intersections[Road.ConnectedIntersections[k]].Entries[
+				Road.EntryIndexOfIntersections[k]];
+			//道路头部衔接驶出端，尾部衔接驶入端
+			if (Entry.SplineID != Road.SplineID || Entry.bIsFlowIn != (k == 1))
+			{
+				UE_LOG(LogTemp, Error, TEXT("[CityModelTest-Consistency]Test Failed On Case %d,Road %d End %d"),
+				       CaseIndex, i, k);
+				return false;
+			}
+		}
+	}
+	for (const FCityModelBlock& Block : InModel.Blocks)
+	{
+		if (Block.Loop.RoadIndexes.Num() != Block.Loop.IntersectionIndexes.Num() || Block.Contour.Num() < 3)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityModelTest-Consistency]Test Failed On Case %d,Block %d"), CaseIndex,
+			       Block.ID);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CityModelTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+	FCityModel Model;
+	//Case0:十字交叉，一个路口四个入口，四条道路都只有一端衔接路口，不构成街区
+	bSuccess &= TestBuildCityModel({
+		                               {FVector(-6000, 0, 0), FVector(6000, 0, 0)},
+		                               {FVector(0, -6000, 0), FVector(0, 6000, 0)}
+	                               }, 1, 4, 0, 0, Model);
+	bSuccess &= TestCityModelConsistency(Model, 0);
+	if (Model.Intersections.Num() == 1 && Model.Intersections[0].Entries.Num() != 4)
+	{
+		AddError("[CityModelTest]Cross Intersection Should Have 4 Entries");
+		bSuccess = false;
+	}
+	//Case1:3x3井字路网，每条样条切分为4段，中间两段两端衔接路口，围成4个街区
+	TArray<TArray<FVector>> GridLines;
+	//路口间距远大于两倍入口距离，去除路口占用的Segment后相邻路口之间仍有连续分段
+	for (const double Offset : {-8000.0, 0.0, 8000.0})
+	{
+		GridLines.Add({FVector(Offset, -12000, 0), FVector(Offset, 12000, 0)});
+		GridLines.Add({FVector(-12000, Offset, 0), FVector(12000, Offset, 0)});
+	}
+	bSuccess &= TestBuildCityModel(GridLines, 9, 24, 4, 1, Model);
+	bSuccess &= TestCityModelConsistency(Model, 1);
+	for (const FCityModelBlock& Block : Model.Blocks)
+	{
+		if (Block.Loop.RoadIndexes.Num() != 4)
+		{
+			AddError(FString::Printf(TEXT("[CityModelTest]Block %d Should Have 4 Roads"), Block.ID));
+			bSuccess = false;
+		}
+	}
+	//Case2:不相交的样条
+	bSuccess &= TestBuildCityModel({
+		                               {FVector(0, 0, 0), FVector(5000, 0, 0)},
+		                               {FVector(0, 2000, 0), FVector(5000, 2000, 0)}
+	                               }, 0, 0, 0, 2, Model);
+	if (!bSuccess)
+	{
+		AddError("[CityModelTest]Test Failed");
+	}
+	return bSuccess;
+}
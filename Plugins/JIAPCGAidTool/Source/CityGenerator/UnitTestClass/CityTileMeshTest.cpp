@@ -0,0 +1,162 @@
+﻿#include "Misc/AutomationTest.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "Materials/Material.h"
+#include "Road/CityTileMesh.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(CityTileMeshTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.CityTileMeshTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 构建XY平面上的条带Mesh，每个四边形两个三角形，可选写入交替的MaterialID
+ */
+UE::Geometry::FDynamicMesh3 MakeStripMesh(int32 QuadNum, bool bAlternateMaterialID)
+{
+	using namespace UE::Geometry;
+	FDynamicMesh3 Mesh;
+	for (int32 i = 0; i <= QuadNum; ++i)
+	{
+		Mesh.AppendVertex(FVector3d(i * 100.0, 0.0, 0.0));
+		Mesh.AppendVertex(FVector3d(i * 100.0, 100.0, 0.0));
+	}
+	for (int32 i = 0; i < QuadNum; ++i)
+	{
+		Mesh.AppendTriangle(2 * i, 2 * i + 2, 2 * i + 1);
+		Mesh.AppendTriangle(2 * i + 1, 2 * i + 2, 2 * i + 3);
+	}
+	if (bAlternateMaterialID)
+	{
+		Mesh.EnableAttributes();
+		Mesh.Attributes()->EnableMaterialID();
+		for (const int32 TriangleID : Mesh.TriangleIndicesItr())
+		{
+			Mesh.Attributes()->GetMaterialID()->SetValue(TriangleID, TriangleID % 2);
+		}
+	}
+	return Mesh;
+}
+
+/**
+ * 追加后检查区间、三角形数量和二分查找结果
+ */
+bool TestTriangleRanges(const FCityTileMesh& InTileMesh, const TArray<int32>& ExpectedTriangleNums, int32 CaseIndex)
+{
+	if (InTileMesh.TriangleRanges.Num() != ExpectedTriangleNums.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityTileMeshTest-Range]Test Failed On Case %d,Range Num %d"), CaseIndex,
+		       InTileMesh.TriangleRanges.Num());
+		return false;
+	}
+	int32 FirstTriangle = 0;
+	for (int32 i = 0; i < ExpectedTriangleNums.Num(); ++i)
+	{
+		const FCityTileTriangleRange& Range = InTileMesh.TriangleRanges[i];
+		if (Range.FirstTriangle != FirstTriangle || Range.TriangleNum != ExpectedTriangleNums[i])
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CityTileMeshTest-Range]Test Failed On Case %d,Range %d"), CaseIndex, i);
+			return false;
+		}
+		for (int32 TriangleID = Range.FirstTriangle; TriangleID < Range.FirstTriangle + Range.TriangleNum; ++
+		     TriangleID)
+		{
+			if (InTileMesh.FindRangeByTriangle(TriangleID) != &Range)
+			{
+				UE_LOG(LogTemp, Error, TEXT("[CityTileMeshTest-Range]Test Failed On Case %d,Triangle %d"),
+				       CaseIndex, TriangleID);
+				return false;
+			}
+		}
+		FirstTriangle += Range.TriangleNum;
+	}
+	if (InTileMesh.Mesh.TriangleCount() != FirstTriangle || nullptr != InTileMesh.FindRangeByTriangle(FirstTriangle)
+		|| nullptr != InTileMesh.FindRangeByTriangle(-1))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityTileMeshTest-Range]Test Failed On Case %d,Triangle Count %d"), CaseIndex,
+		       InTileMesh.Mesh.TriangleCount());
+		return false;
+	}
+	return true;
+}
+
+bool TestTileCoord(const FVector& InLocation, double InTileSize, const FIntPoint& ExpectedCoord, int32 CaseIndex)
+{
+	const FIntPoint TileCoord = FCityTileMesh::GetTileCoord(InLocation, InTileSize);
+	if (TileCoord != ExpectedCoord)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CityTileMeshTest-TileCoord]Test Failed On Case %d,Result %s"), CaseIndex,
+		       *TileCoord.ToString());
+		return false;
+	}
+	return true;
+}
+
+bool CityTileMeshTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+	UMaterialInterface* SurfaceMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+	UMaterialInterface* DecalMaterial = UMaterial::GetDefaultMaterial(MD_DeferredDecal);
+	FCityTileMesh TileMesh;
+	//Case0:没有MaterialID的道路和两种材质交替的街区，偏移后追加，三角形区间连续
+	const FTransform RoadToTile(FVector(1000.0, 0.0, 0.0));
+	TileMesh.AppendSource(ECityTileSourceType::Road, 7, MakeStripMesh(3, false), RoadToTile, {SurfaceMaterial});
+	TileMesh.AppendSource(ECityTileSourceType::Block, 2, MakeStripMesh(2, true), FTransform::Identity,
+	                      {DecalMaterial, SurfaceMaterial});
+	bSuccess &= TestTriangleRanges(TileMesh, {6, 4}, 0);
+	//材质按指针去重，街区的MaterialID 0/1映射到瓦片的1/0
+	if (TileMesh.Materials.Num() != 2 || TileMesh.Materials[0] != SurfaceMaterial || TileMesh.Materials[1] !=
+		DecalMaterial)
+	{
+		AddError("[CityTileMeshTest]Materials Should Be Deduplicated In Append Order");
+		bSuccess = false;
+	}
+	const UE::Geometry::FDynamicMeshMaterialAttribute* MaterialIDs = TileMesh.Mesh.Attributes()->GetMaterialID();
+	for (int32 TriangleID = 0; TriangleID < 6; ++TriangleID)
+	{
+		if (MaterialIDs->GetValue(TriangleID) != 0)
+		{
+			AddError(FString::Printf(TEXT("[CityTileMeshTest]Road Triangle %d Should Use Material 0"), TriangleID));
+			bSuccess = false;
+		}
+	}
+	for (int32 TriangleID = 6; TriangleID < 10; ++TriangleID)
+	{
+		const int32 ExpectedID = (TriangleID - 6) % 2 == 0 ? 1 : 0;
+		if (MaterialIDs->GetValue(TriangleID) != ExpectedID)
+		{
+			AddError(FString::Printf(TEXT("[CityTileMeshTest]Block Triangle %d Should Use Material %d"), TriangleID,
+			                         ExpectedID));
+			bSuccess = false;
+		}
+	}
+	//来源变换作用于顶点
+	if (!TileMesh.Mesh.GetVertex(0).Equals(FVector3d(1000.0, 0.0, 0.0)))
+	{
+		AddError("[CityTileMeshTest]Source Transform Should Be Applied To Vertices");
+		bSuccess = false;
+	}
+	const FCityTileTriangleRange* PickedRange = TileMesh.FindRangeByTriangle(8);
+	if (nullptr == PickedRange || PickedRange->SourceType != ECityTileSourceType::Block || PickedRange->SourceIndex
+		!= 2)
+	{
+		AddError("[CityTileMeshTest]Triangle 8 Should Belong To Block 2");
+		bSuccess = false;
+	}
+	//Case1:空Mesh不产生区间，没有材质的来源使用空材质槽
+	TileMesh.AppendSource(ECityTileSourceType::Intersection, 0, UE::Geometry::FDynamicMesh3(), FTransform::Identity,
+	                      {});
+	TileMesh.AppendSource(ECityTileSourceType::Intersection, 1, MakeStripMesh(1, false), FTransform::Identity, {});
+	bSuccess &= TestTriangleRanges(TileMesh, {6, 4, 2}, 1);
+	if (TileMesh.Materials.Num() != 3 || nullptr != TileMesh.Materials[2])
+	{
+		AddError("[CityTileMeshTest]Source Without Materials Should Add A Null Slot");
+		bSuccess = false;
+	}
+	TileMesh.Reset();
+	bSuccess &= TestTriangleRanges(TileMesh, {}, 2);
+	//瓦片坐标向下取整，负坐标落在-1
+	bSuccess &= TestTileCoord(FVector(0.0, 0.0, 0.0), 1000.0, FIntPoint(0, 0), 0);
+	bSuccess &= TestTileCoord(FVector(999.0, 1000.0, 50.0), 1000.0, FIntPoint(0, 1), 1);
+	bSuccess &= TestTileCoord(FVector(-1.0, -1000.0, 0.0), 1000.0, FIntPoint(-1, -1), 2);
+	bSuccess &= TestTileCoord(FVector(-1001.0, 2500.0, 0.0), 1000.0, FIntPoint(-2, 2), 3);
+	return bSuccess;
+}
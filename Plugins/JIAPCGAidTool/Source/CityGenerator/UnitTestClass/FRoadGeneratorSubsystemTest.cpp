@@ -1,6 +1,7 @@
 ﻿#include "Kismet/KismetStringLibrary.h"
 #include "Misc/AutomationTest.h"
 #include "Road/RoadGeneratorSubsystem.h"
+#include "Components/SplineComponent.h"
 #if WITH_DEV_AUTOMATION_TESTS
 IMPLEMENT_COMPLEX_AUTOMATION_TEST(FRoadGeneratorSubsystemTest,
                                   "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.FRoadGeneratorSubsystemTest",
@@ -227,6 +228,204 @@ bool TestInsertElementsAtIndex_Trans(URoadGeneratorSubsystem* Subsystem)
 	return true;
 }
 
+/**
+ * 将折线点转换为Segment追加到存储，闭合时追加末点到首点的Segment，GlobalIndex与存储下标一致
+ */
+void AppendPolyLineSegments(USplineComponent* OwnerSpline, const TArray<FVector>& PolyLinePoints, bool bClosedLoop,
+                            FSplineSegmentStore& OutStore)
+{
+	TArray<FTransform> PolyLineTransforms;
+	for (const FVector& PolyLinePoint : PolyLinePoints)
+	{
+		PolyLineTransforms.Emplace(PolyLinePoint);
+	}
+	if (bClosedLoop)
+	{
+		PolyLineTransforms.Emplace(PolyLinePoints[0]);
+	}
+	OutStore.AppendSpline(OwnerSpline, PolyLineTransforms, OutStore.Num());
+}
+
+bool TestSweepLineMatchBVH(URoadGeneratorSubsystem* Subsystem)
+{
+	FSplineSegmentStore AllSegments;
+	TArray<USplineComponent*> TestSplines;
+	auto CreateTestSpline = [&TestSplines]()-> USplineComponent*
+	{
+		TestSplines.Emplace(NewObject<USplineComponent>(GetTransientPackage()));
+		return TestSplines.Last();
+	};
+	//Case:长直线网格，横竖各4条，含端点落在另一条线上的T形交点
+	for (int32 i = 0; i < 4; ++i)
+	{
+		AppendPolyLineSegments(CreateTestSpline(), {
+			                       FVector(0, i * 1000.0, 0), FVector(1500.0, i * 1000.0, 0),
+			                       FVector(3000.0, i * 1000.0, 0)
+		                       }, false, AllSegments);
+		AppendPolyLineSegments(CreateTestSpline(), {
+			                       FVector(i * 1000.0, 0, 0), FVector(i * 1000.0, 3000.0, 0)
+		                       }, false, AllSegments);
+	}
+	//Case:正弦折线穿过网格，折线顶点与网格线重合
+	TArray<FVector> WavePoints;
+	for (int32 i = 0; i <= 30; ++i)
+	{
+		WavePoints.Emplace(i * 100.0, 1500.0 + 1000.0 * FMath::Sin(i * 0.5), 0);
+	}
+	AppendPolyLineSegments(CreateTestSpline(), WavePoints, false, AllSegments);
+	//Case:自相交的闭合样条（8字形）
+	AppendPolyLineSegments(CreateTestSpline(), {
+		                       FVector(500, 500, 0), FVector(2500, 2500, 0), FVector(2500, 500, 0),
+		                       FVector(500, 2500, 0)
+	                       }, true, AllSegments);
+	//Case:斜线经过网格交点，多条线段交于同一点
+	AppendPolyLineSegments(CreateTestSpline(), {FVector(-500, -500, 0), FVector(3500, 3500, 0)}, false,
+	                       AllSegments);
+
+	const FSegmentBVH BVH = URoadGeneratorSubsystem::BuildSegmentBVH(AllSegments);
+	const TArray<FSegmentPairHit> BVHHits = Subsystem->FindSegmentHitsByBVH(BVH, AllSegments);
+	const TArray<FSegmentPairHit> SweepLineHits = Subsystem->FindSegmentHitsBySweepLine(AllSegments);
+	for (USplineComponent* TestSpline : TestSplines)
+	{
+		TestSpline->MarkAsGarbage();
+	}
+	UE_LOG(LogTemp, Display, TEXT("[TestSweepLineMatchBVH]BVH Hits %d,SweepLine Hits %d"),
+	       BVHHits.Num(), SweepLineHits.Num());
+	if (BVHHits.IsEmpty() || BVHHits.Num() != SweepLineHits.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unmatch Hit Count"));
+		return false;
+	}
+	for (int32 i = 0; i < BVHHits.Num(); ++i)
+	{
+		if (BVHHits[i].GlobalIndexA != SweepLineHits[i].GlobalIndexA ||
+			BVHHits[i].GlobalIndexB != SweepLineHits[i].GlobalIndexB ||
+			!BVHHits[i].Location.Equals(SweepLineHits[i].Location, 0.01))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Unmatch Hit At %d,BVH(%u,%u),SweepLine(%u,%u)"), i,
+			       BVHHits[i].GlobalIndexA, BVHHits[i].GlobalIndexB, SweepLineHits[i].GlobalIndexA,
+			       SweepLineHits[i].GlobalIndexB);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * 折线各段中点到样条的最大距离，近似弦高误差
+ */
+double GetMaxChordError(const USplineComponent* Spline, const TArray<FTransform>& PolyLine)
+{
+	double MaxError = 0.0;
+	for (int32 i = 1; i < PolyLine.Num(); ++i)
+	{
+		const FVector ChordMid = 0.5 * (PolyLine[i - 1].GetLocation() + PolyLine[i].GetLocation());
+		const FVector OnSpline = Spline->FindLocationClosestToWorldLocation(ChordMid, ESplineCoordinateSpace::World);
+		MaxError = FMath::Max(MaxError, FVector::Dist(ChordMid, OnSpline));
+	}
+	return MaxError;
+}
+
+bool TestAdaptiveResample(URoadGeneratorSubsystem* Subsystem)
+{
+	auto CreateSpline = [](const TArray<FVector>& Points, bool bClosedLoop)-> USplineComponent*
+	{
+		USplineComponent* Spline = NewObject<USplineComponent>(GetTransientPackage());
+		Spline->ClearSplinePoints(false);
+		for (const FVector& Point : Points)
+		{
+			Spline->AddSplinePoint(Point, ESplineCoordinateSpace::World, false);
+		}
+		Spline->SetClosedLoop(bClosedLoop, false);
+		Spline->UpdateSpline();
+		return Spline;
+	};
+	const IConsoleVariable* ChordErrorVar = IConsoleManager::Get().FindConsoleVariable(
+		TEXT("CityGenerator.Road.AdaptiveChordError"));
+	const double ChordTolerance = nullptr != ChordErrorVar ? ChordErrorVar->GetFloat() : 5.0;
+	bool bSuccess = true;
+	//Case0:长直线，自适应采样段数应明显少于定距采样
+	USplineComponent* StraightSpline = CreateSpline({FVector(0, 0, 0), FVector(6000, 0, 0), FVector(12000, 0, 0)},
+	                                                false);
+	const TArray<FTransform> StraightFixed = Subsystem->ResampleSpline(StraightSpline, ERoadResampleMode::Fixed);
+	const TArray<FTransform> StraightAdaptive = Subsystem->ResampleSpline(StraightSpline,
+	                                                                      ERoadResampleMode::Adaptive);
+	UE_LOG(LogTemp, Display, TEXT("[TestAdaptiveResample]Straight Segments Fixed %d,Adaptive %d"),
+	       StraightFixed.Num() - 1, StraightAdaptive.Num() - 1);
+	if (StraightAdaptive.Num() < 2 || StraightAdaptive.Num() >= StraightFixed.Num() ||
+		!StraightAdaptive.Last().GetLocation().Equals(FVector(12000, 0, 0), 0.1))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[TestAdaptiveResample]Test Failed On Case 0"));
+		bSuccess = false;
+	}
+	//Case1:小半径闭合环，弦高误差不超过容差，且两端闭合
+	USplineComponent* LoopSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(600, 600, 0), FVector(0, 1200, 0), FVector(-600, 600, 0)
+	}, true);
+	const TArray<FTransform> LoopFixed = Subsystem->ResampleSpline(LoopSpline, ERoadResampleMode::Fixed);
+	const TArray<FTransform> LoopAdaptive = Subsystem->ResampleSpline(LoopSpline, ERoadResampleMode::Adaptive);
+	const double FixedLoopError = GetMaxChordError(LoopSpline, LoopFixed);
+	const double AdaptiveLoopError = GetMaxChordError(LoopSpline, LoopAdaptive);
+	UE_LOG(LogTemp, Display,
+	       TEXT("[TestAdaptiveResample]Loop Segments Fixed %d(Max Chord Error %f),Adaptive %d(Max Chord Error %f)"),
+	       LoopFixed.Num() - 1, FixedLoopError, LoopAdaptive.Num() - 1, AdaptiveLoopError);
+	if (AdaptiveLoopError > ChordTolerance * 1.5 ||
+		!LoopAdaptive[0].GetLocation().Equals(LoopAdaptive.Last().GetLocation(), 0.1))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[TestAdaptiveResample]Test Failed On Case 1"));
+		bSuccess = false;
+	}
+	//Case2:两条曲线相交，两种采样得到的交点数相同、位置偏差在容差量级
+	USplineComponent* WaveSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(1000, 800, 0), FVector(2000, -800, 0), FVector(3000, 800, 0), FVector(4000, 0, 0)
+	}, false);
+	USplineComponent* ArcSpline = CreateSpline({FVector(500, -1500, 0), FVector(2000, 1200, 0),
+		                                           FVector(3500, -1500, 0)}, false);
+	TArray<TArray<FSegmentPairHit>> HitsOfModes;
+	for (const ERoadResampleMode Mode : {ERoadResampleMode::Fixed, ERoadResampleMode::Adaptive})
+	{
+		FSplineSegmentStore Store;
+		Store.AppendSpline(WaveSpline, Subsystem->ResampleSpline(WaveSpline, Mode), 0);
+		Store.AppendSpline(ArcSpline, Subsystem->ResampleSpline(ArcSpline, Mode), Store.Num());
+		const double StartTime = FPlatformTime::Seconds();
+		const FSegmentBVH BVH = URoadGeneratorSubsystem::BuildSegmentBVH(Store);
+		UE_LOG(LogTemp, Display, TEXT("[TestAdaptiveResample]%s Segments %d,Build BVH Cost %f ms"),
+		       *UEnum::GetValueAsString(Mode), Store.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		HitsOfModes.Emplace(Subsystem->FindSegmentHitsByBVH(BVH, Store));
+	}
+	if (HitsOfModes[0].IsEmpty() || HitsOfModes[0].Num() != HitsOfModes[1].Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[TestAdaptiveResample]Test Failed On Case 2,Hits Fixed %d,Adaptive %d"),
+		       HitsOfModes[0].Num(), HitsOfModes[1].Num());
+		bSuccess = false;
+	}
+	else
+	{
+		double MaxHitOffset = 0.0;
+		for (const FSegmentPairHit& FixedHit : HitsOfModes[0])
+		{
+			double ClosestOffset = TNumericLimits<double>::Max();
+			for (const FSegmentPairHit& AdaptiveHit : HitsOfModes[1])
+			{
+				ClosestOffset = FMath::Min(ClosestOffset, FVector2D::Distance(FixedHit.Location, AdaptiveHit.Location));
+			}
+			MaxHitOffset = FMath::Max(MaxHitOffset, ClosestOffset);
+		}
+		UE_LOG(LogTemp, Display, TEXT("[TestAdaptiveResample]Max Hit Offset Between Modes %f"), MaxHitOffset);
+		//两种折线各自偏离样条，交点偏差取决于交角，放宽到容差的20倍
+		if (MaxHitOffset > ChordTolerance * 20.0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[TestAdaptiveResample]Test Failed On Case 2,Hit Offset %f"), MaxHitOffset);
+			bSuccess = false;
+		}
+	}
+	for (USplineComponent* Spline : {StraightSpline, LoopSpline, WaveSpline, ArcSpline})
+	{
+		Spline->MarkAsGarbage();
+	}
+	return bSuccess;
+}
+
 void FRoadGeneratorSubsystemTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
 {
 	OutBeautifiedNames.Add(TEXT("FRoadGeneratorSubsystemTest_TestName"));
@@ -300,6 +499,24 @@ bool FRoadGeneratorSubsystemTest::RunTest(const FString& Parameters)
 			bPassAllTest &= false;
 		}
 	}
+
+	//TestFor FindSegmentHitsBySweepLine()
+	{
+		if (!TestSweepLineMatchBVH(TestingTarget))
+		{
+			AddError("[FindSegmentHitsBySweepLine] Result Differs From BVH Backend");
+			bPassAllTest &= false;
+		}
+	}
+
+	//TestFor ResampleSpline(Adaptive)
+	{
+		if (!TestAdaptiveResample(TestingTarget))
+		{
+			AddError("[ResampleSpline] Adaptive Mode Failed");
+			bPassAllTest &= false;
+		}
+	}
 	return bPassAllTest;
 }
 #endif
@@ -0,0 +1,198 @@
+﻿#include "Misc/AutomationTest.h"
+#include "Algo/Reverse.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "Road/RoadCrossSectionProfile.h"
+#include "Road/RoadSweepBuilder.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(RoadCrossSectionProfileTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.RoadCrossSectionProfileTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 预设宽度与SetRoadType一致，编译后封口三角形面积之和等于轮廓面积，且轮廓宽度等于预设宽度
+ */
+bool CompileProfileTest()
+{
+	int32 CaseCounter = 0;
+	const TPair<ELaneType, double> Presets[] = {
+		{ELaneType::COLLECTORROADS, 500.0}, {ELaneType::ARTERIALROADS, 1000.0}, {ELaneType::EXPRESSWAYS, 2000.0}
+	};
+	for (const TPair<ELaneType, double>& Preset : Presets)
+	{
+		const FRoadCrossSectionProfile Profile = FRoadCrossSectionProfile::MakePreset(Preset.Key);
+		FRoadProfileTemplate Template;
+		if (!FMath::IsNearlyEqual(Profile.GetTotalWidth(), Preset.Value, 0.01) ||
+			!FRoadProfileTemplate::CompileProfile(Profile, Template) ||
+			!FMath::IsNearlyEqual(Template.Bounds.GetSize().X, Preset.Value, 0.01))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-CompileProfileTest]Test Failed On Case %d"),
+			       CaseCounter);
+			return false;
+		}
+		double PolygonArea = 0.0;
+		for (int32 i = 0; i < Template.Points.Num(); ++i)
+		{
+			const FVector2D& Current = Template.Points[i];
+			const FVector2D& Next = Template.Points[(i + 1) % Template.Points.Num()];
+			PolygonArea += 0.5 * (Current.X * Next.Y - Next.X * Current.Y);
+		}
+		double CapArea = 0.0;
+		for (int32 i = 0; i + 2 < Template.CapTriangles.Num(); i += 3)
+		{
+			const FVector2D& A = Template.Points[Template.CapTriangles[i]];
+			const FVector2D& B = Template.Points[Template.CapTriangles[i + 1]];
+			const FVector2D& C = Template.Points[Template.CapTriangles[i + 2]];
+			CapArea += 0.5 * FMath::Abs(FVector2D::CrossProduct(B - A, C - A));
+		}
+		//轮廓逆时针，面积为正
+		if (PolygonArea <= 0.0 || !FMath::IsNearlyEqual(PolygonArea, CapArea, 0.01))
+		{
+			UE_LOG(LogTemp, Error,
+			       TEXT("[RoadCrossSectionProfileTest-CompileProfileTest]Test Failed On Case %d,Area %f,Cap %f"),
+			       CaseCounter, PolygonArea, CapArea);
+			return false;
+		}
+		CaseCounter++;
+	}
+	UE_LOG(LogTemp, Display, TEXT("CompileProfileTest PASSED"));
+	return true;
+}
+
+/**
+ * 同一道路类型多次获取返回同一份模板
+ */
+bool ProfileLibraryTest()
+{
+	const TSharedRef<const FRoadProfileTemplate> First = FRoadProfileLibrary::GetTemplate(ELaneType::ARTERIALROADS);
+	const TSharedRef<const FRoadProfileTemplate> Second = FRoadProfileLibrary::GetTemplate(ELaneType::ARTERIALROADS);
+	if (&First.Get() != &Second.Get() || !First->IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-ProfileLibraryTest]Test Failed On Case 0"));
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("ProfileLibraryTest PASSED"));
+	return true;
+}
+
+/**
+ * 沿路径实例化模板，数量与GetSweepElementNum一致且Mesh闭合
+ */
+bool SweepProfileTest()
+{
+	using namespace UE::Geometry;
+	TArray<FTransform> SweepPath;
+	for (int32 i = 0; i < 5; ++i)
+	{
+		SweepPath.Emplace(FRotator(0.0, i * 10.0, 0.0), FVector(i * 500.0, i * 50.0, 0.0));
+	}
+	const TSharedRef<const FRoadProfileTemplate> Template = FRoadProfileLibrary::GetTemplate(ELaneType::EXPRESSWAYS);
+	FDynamicMesh3 Mesh;
+	const int32 TriangleNum = FRoadSweepBuilder::AppendSweep(Mesh, *Template, SweepPath);
+	int32 ExpectedVertexNum = 0;
+	int32 ExpectedTriangleNum = 0;
+	FRoadSweepBuilder::GetSweepElementNum(*Template, SweepPath.Num(), true, ExpectedVertexNum, ExpectedTriangleNum);
+	if (TriangleNum != ExpectedTriangleNum || Mesh.VertexCount() != ExpectedVertexNum || !Mesh.IsClosed())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-SweepProfileTest]Test Failed,Vertex %d,Triangle %d"),
+		       Mesh.VertexCount(), Mesh.TriangleCount());
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("SweepProfileTest PASSED"));
+	return true;
+}
+
+/**
+ * 十字形交汇路口轮廓（非凸），顺逆时针输入都输出n-2个三角形且面积之和等于轮廓面积；挤出后Mesh闭合，顶面法线朝上
+ */
+bool EarClipExtrudeTest()
+{
+	using namespace UE::Geometry;
+	int32 CaseCounter = 0;
+	TArray<FVector2D> CrossShape{
+		{100, -100}, {300, -100}, {300, 100}, {100, 100}, {100, 300}, {-100, 300}, {-100, 100}, {-300, 100},
+		{-300, -100}, {-100, -100}, {-100, -300}, {100, -300}
+	};
+	const double CrossArea = 5 * 200.0 * 200.0;
+	for (int32 Direction = 0; Direction < 2; ++Direction)
+	{
+		if (Direction == 1)
+		{
+			Algo::Reverse(CrossShape);
+		}
+		TArray<int32> Triangles;
+		if (!FRoadProfileTemplate::EarClipPolygon(CrossShape, Triangles) || Triangles.Num() != 3 * (CrossShape.Num() -
+			2))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-EarClipExtrudeTest]Test Failed On Case %d"),
+			       CaseCounter);
+			return false;
+		}
+		double TriangleArea = 0.0;
+		for (int32 i = 0; i + 2 < Triangles.Num(); i += 3)
+		{
+			const FVector2D& A = CrossShape[Triangles[i]];
+			//逆时针输出，有向面积为正
+			TriangleArea += 0.5 * FVector2D::CrossProduct(CrossShape[Triangles[i + 1]] - A,
+			                                              CrossShape[Triangles[i + 2]] - A);
+		}
+		if (!FMath::IsNearlyEqual(TriangleArea, CrossArea, 0.01))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-EarClipExtrudeTest]Test Failed On Case %d,Area %f"),
+			       CaseCounter, TriangleArea);
+			return false;
+		}
+		CaseCounter++;
+	}
+	//自相交的蝴蝶结轮廓面积为0，应返回false
+	TArray<int32> Triangles;
+	const TArray<FVector2D> BowTie{{0, 0}, {100, 100}, {100, 0}, {0, 100}};
+	if (FRoadProfileTemplate::EarClipPolygon(BowTie, Triangles))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-EarClipExtrudeTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	FRoadProfileTemplate Template;
+	FDynamicMesh3 Mesh;
+	if (!FRoadProfileTemplate::CompileSimplePolygon(CrossShape, Template, 15.0f) ||
+		FRoadSweepBuilder::AppendExtrudedPolygon(Mesh, Template, 30.0) == 0 || !Mesh.IsClosed())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadCrossSectionProfileTest-EarClipExtrudeTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	const FDynamicMeshNormalOverlay* Normals = Mesh.Attributes()->PrimaryNormals();
+	for (const int32 TriangleID : Mesh.TriangleIndicesItr())
+	{
+		const FVector3d Centroid = Mesh.GetTriCentroid(TriangleID);
+		FVector3f ElementNormals[3];
+		Normals->GetTriElements(TriangleID, ElementNormals[0], ElementNormals[1], ElementNormals[2]);
+		//顶面三角形几何法线和Overlay法线都朝上
+		if (FMath::IsNearlyEqual(Centroid.Z, 30.0) && (Mesh.GetTriNormal(TriangleID).Z < 0.99 || ElementNormals[0].Z
+			< 0.99))
+		{
+			UE_LOG(LogTemp, Error,
+			       TEXT("[RoadCrossSectionProfileTest-EarClipExtrudeTest]Test Failed On Case %d,Triangle %d"),
+			       CaseCounter, TriangleID);
+			return false;
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("EarClipExtrudeTest PASSED"));
+	return true;
+}
+
+bool RoadCrossSectionProfileTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+	bSuccess &= CompileProfileTest();
+	bSuccess &= ProfileLibraryTest();
+	bSuccess &= SweepProfileTest();
+	bSuccess &= EarClipExtrudeTest();
+	if (!bSuccess)
+	{
+		AddError(TEXT("RoadCrossSectionProfileTest Failed"));
+	}
+	return bSuccess;
+}
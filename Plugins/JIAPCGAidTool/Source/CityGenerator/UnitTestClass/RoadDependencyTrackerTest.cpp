@@ -0,0 +1,103 @@
+﻿#include "Misc/AutomationTest.h"
+#include "Components/SplineComponent.h"
+#include "Road/RoadDependencyTracker.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(RoadDependencyTrackerTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.RoadDependencyTrackerTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 比较脏集合中的ID
+ */
+bool CheckDirtyIndexes(const TSet<int32>& InDirtyIndexes, TArray<int32> InExpected, const TCHAR* Name)
+{
+	TArray<int32> DirtyIndexes = InDirtyIndexes.Array();
+	DirtyIndexes.Sort();
+	InExpected.Sort();
+	if (DirtyIndexes != InExpected)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadDependencyTrackerTest]Unmatch Dirty %s,Get %d Expect %d"), Name,
+		       DirtyIndexes.Num(), InExpected.Num());
+		return false;
+	}
+	return true;
+}
+
+bool RoadDependencyTrackerTest::RunTest(const FString& Parameters)
+{
+	//三条样条两两相交形成三角形街区，另有一条A上的断头路和一个无关街区
+	TWeakObjectPtr<USplineComponent> SplineA = NewObject<USplineComponent>();
+	TWeakObjectPtr<USplineComponent> SplineB = NewObject<USplineComponent>();
+	TWeakObjectPtr<USplineComponent> SplineC = NewObject<USplineComponent>();
+	FRoadDependencyTracker Tracker;
+	Tracker.AddIntersection(0, {SplineA, SplineB});
+	Tracker.AddIntersection(1, {SplineB, SplineC});
+	Tracker.AddIntersection(2, {SplineA, SplineC});
+	Tracker.AddRoad(10, SplineA, 0, 2);
+	Tracker.AddRoad(11, SplineB, 0, 1);
+	Tracker.AddRoad(12, SplineC, 1, 2);
+	Tracker.AddRoad(13, SplineA, INT32_ERROR, 0);
+	FBlockLinkInfo Triangle;
+	Triangle.RoadIndexes = {10, 11, 12};
+	Triangle.IntersectionIndexes = {0, 1, 2};
+	FBlockLinkInfo Unrelated;
+	Unrelated.RoadIndexes = {20, 21};
+	Unrelated.IntersectionIndexes = {5, 6};
+	Tracker.AddBlock(100, Triangle);
+	Tracker.AddBlock(101, Unrelated);
+
+	bool bSuccess = true;
+	//Case1:交汇路口1变化，只影响B、C上的道路和三角形街区
+	FRoadDirtySet IntersectionSeed;
+	IntersectionSeed.Intersections.Emplace(1);
+	const FRoadDirtySet IntersectionDirty = Tracker.CollectDirtySet(IntersectionSeed, nullptr);
+	bSuccess &= CheckDirtyIndexes(IntersectionDirty.Roads, {11, 12}, TEXT("Roads"));
+	bSuccess &= CheckDirtyIndexes(IntersectionDirty.Blocks, {100}, TEXT("Blocks"));
+	bSuccess &= IntersectionDirty.Splines.Num() == 2 && !IntersectionDirty.Splines.Contains(SplineA);
+	if (!bSuccess)
+	{
+		AddError("[RoadDependencyTrackerTest]Wrong Dirty Set From Intersection");
+		return false;
+	}
+	//Case2:样条A移动，A上的两个路口相交的样条全部受影响
+	FRoadDirtySet SplineSeed;
+	SplineSeed.Splines.Emplace(SplineA);
+	const FRoadDirtySet SplineDirty = Tracker.CollectDirtySet(SplineSeed, nullptr);
+	bSuccess &= CheckDirtyIndexes(SplineDirty.Intersections, {0, 2}, TEXT("Intersections"));
+	bSuccess &= CheckDirtyIndexes(SplineDirty.Roads, {10, 11, 12, 13}, TEXT("Roads"));
+	bSuccess &= CheckDirtyIndexes(SplineDirty.Blocks, {100}, TEXT("Blocks"));
+	if (!bSuccess)
+	{
+		AddError("[RoadDependencyTrackerTest]Wrong Dirty Set From Spline");
+		return false;
+	}
+	//Case3:道路种子只影响街区
+	FRoadDirtySet RoadSeed;
+	RoadSeed.Roads.Emplace(21);
+	bSuccess &= CheckDirtyIndexes(Tracker.CollectDirtySet(RoadSeed, nullptr).Blocks, {101}, TEXT("Blocks"));
+	//Case4:起点不同的相同环路可以找到已有街区
+	FBlockLinkInfo RotatedTriangle;
+	RotatedTriangle.RoadIndexes = {12, 10, 11};
+	RotatedTriangle.IntersectionIndexes = {2, 0, 1};
+	bSuccess &= Tracker.FindBlockByLoop(RotatedTriangle) == 100;
+	RotatedTriangle.RoadIndexes[0] = 14;
+	bSuccess &= Tracker.FindBlockByLoop(RotatedTriangle) == INDEX_NONE;
+	//Case5:移除后不再传播
+	Tracker.RemoveRoad(12);
+	Tracker.RemoveIntersection(1);
+	int32 FromIntersection = INT32_ERROR;
+	int32 ToIntersection = INT32_ERROR;
+	bSuccess &= !Tracker.GetRoadEnds(12, FromIntersection, ToIntersection);
+	bSuccess &= Tracker.GetRoadEnds(11, FromIntersection, ToIntersection) && FromIntersection == 0 && ToIntersection
+		== 1;
+	FRoadDirtySet SplineCSeed;
+	SplineCSeed.Splines.Emplace(SplineC);
+	bSuccess &= CheckDirtyIndexes(Tracker.CollectDirtySet(SplineCSeed, nullptr).Roads, {10, 13}, TEXT("Roads"));
+	if (!bSuccess)
+	{
+		AddError("[RoadDependencyTrackerTest]Wrong Result After Remove");
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("[RoadDependencyTrackerTest]All Tests Passed!"));
+	return true;
+}
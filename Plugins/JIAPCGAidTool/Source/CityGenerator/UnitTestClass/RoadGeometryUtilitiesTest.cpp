@@ -1,4 +1,5 @@
-﻿#include "Kismet/KismetStringLibrary.h"
+﻿#include "Components/SplineComponent.h"
+#include "Kismet/KismetStringLibrary.h"
 #include "Misc/AutomationTest.h"
 #include "Road/RoadGeometryUtilities.h"
 
@@ -6,6 +7,116 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(RoadGeometryUtilitiesTest,
                                  "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.RoadGeometryUtilitiesTest",
                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
+/**
+ * 旧版样条求交，在每对分段上以约70x55的网格播种Newton-Raphson迭代，仅用于和Get2DIntersection对比性能与结果
+ */
+static bool Get2DIntersectionBySeededNewton(USplineComponent* TargetSplineA, USplineComponent* TargetSplineB,
+                                            TArray<FVector2D>& IntersectionsIn2DSpace)
+{
+	TArray<FVector2D> Results;
+
+	struct FSplineBezierSegment
+	{
+	public:
+		FVector P0, P1, P2, P3;
+
+		FVector GetLocation(float InputKeyFromPreControlPoint) const
+		{
+			return FMath::CubicInterp(P0, (P1 - P0) * 3.0f, P3, (P3 - P2) * 3.0f, InputKeyFromPreControlPoint);
+		}
+
+		FVector GetDerivative(float InputKeyFromPreControlPoint) const
+		{
+			float InputKeyFromNextControlPoint = 1.0f - InputKeyFromPreControlPoint;
+			return 3.0f * InputKeyFromNextControlPoint * InputKeyFromNextControlPoint * (P1 - P0) +
+				6.0f * InputKeyFromNextControlPoint * InputKeyFromPreControlPoint * (P2 - P1) +
+				3.0f * InputKeyFromPreControlPoint * InputKeyFromPreControlPoint * (P3 - P2);
+		}
+	};
+
+	auto Newton2DSolver = [](const FSplineBezierSegment& A, const FSplineBezierSegment& B, FVector2D Seed,
+	                         FVector2D& Intersection, float Tolerance, int32 MaxIteration)-> bool
+	{
+		FVector2D ApproximateResult = Seed;
+		for (int32 i = 0; i < MaxIteration; ++i)
+		{
+			FVector LocationInA = A.GetLocation(ApproximateResult.X);
+			FVector LocationInB = B.GetLocation(ApproximateResult.Y);
+			FVector2D VectorAToB{(LocationInA - LocationInB).X, (LocationInA - LocationInB).Y};
+			if (VectorAToB.SizeSquared() < Tolerance * Tolerance)
+			{
+				Intersection = ApproximateResult;
+				return true;
+			}
+			FVector DerivativeInA = A.GetDerivative(ApproximateResult.X);
+			FVector DerivativeInB = B.GetDerivative(ApproximateResult.Y);
+			//UE不支持直接逆矩阵与向量相乘，所以构造一个矩阵意义不大
+			FMatrix2x2d Jacobian{DerivativeInA.X, -DerivativeInB.X, DerivativeInA.Y, -DerivativeInB.Y};
+			float Determinant = Jacobian.Determinant();
+			//雅可比矩阵行列式绝对值表示两条曲线速度向量形成的平行四变相面颊越大越好，值小会造成牛顿步爆炸；或者理解成矩阵可逆
+			if (FMath::Abs(Determinant) < 1e-6f)
+			{
+				return false;
+			}
+			float InvDet = 1.0f / Determinant;
+			FVector2D Delta{
+				(-DerivativeInB.Y * VectorAToB.X - (-DerivativeInB.X) * VectorAToB.Y) * InvDet,
+				(-DerivativeInA.Y * VectorAToB.X + DerivativeInA.X * VectorAToB.Y) * InvDet
+			};
+			ApproximateResult -= Delta;
+			//Clamp在[0,1]
+			ApproximateResult.X = FMath::Clamp(ApproximateResult.X, 0.0f, 1.0f);
+			ApproximateResult.Y = FMath::Clamp(ApproximateResult.Y, 0.0f, 1.0f);
+		}
+		return false;
+	};
+
+	auto GetSegment = [](const USplineComponent* S, int32 Index)-> FSplineBezierSegment
+	{
+		FSplineBezierSegment Sg;
+		Sg.P0 = S->GetLocationAtSplineInputKey(Index, ESplineCoordinateSpace::World);
+		Sg.P3 = S->GetLocationAtSplineInputKey(Index + 1, ESplineCoordinateSpace::World);
+		// 切线控制点
+		Sg.P1 = Sg.P0 + S->GetTangentAtSplineInputKey(Index, ESplineCoordinateSpace::World) / 3.f;
+		Sg.P2 = Sg.P3 - S->GetTangentAtSplineInputKey(Index + 1, ESplineCoordinateSpace::World) / 3.f;
+		return Sg;
+	};
+
+	//Newton-Raphson求三次贝塞尔线段交点
+	const int32 NumOfSegmentA = TargetSplineA->GetNumberOfSplineSegments();
+	const int32 NumOfSegmentB = TargetSplineB->GetNumberOfSplineSegments();
+	for (int32 SegIndexA = 0; SegIndexA < NumOfSegmentA; ++SegIndexA)
+	{
+		FSplineBezierSegment CurrentSegmentA = GetSegment(TargetSplineA, SegIndexA);
+		for (int32 SegIndexB = 0; SegIndexB < NumOfSegmentB; ++SegIndexB)
+		{
+			FSplineBezierSegment CurrentSegmentB = GetSegment(TargetSplineB, SegIndexB);
+			for (float SeedT = 0.05f; SeedT < 1.f; SeedT += 0.013f)
+			{
+				for (float SeedS = 0.05f; SeedS < 1.f; SeedS += 0.017f)
+				{
+					FVector2D TS;
+					if (Newton2DSolver(CurrentSegmentA, CurrentSegmentB, FVector2D(SeedT, SeedS), TS, 0.01f, 100))
+					{
+						FVector2D P{CurrentSegmentA.GetLocation(TS.X).X, CurrentSegmentA.GetLocation(TS.X).Y};
+						// 去重
+						bool bNew = true;
+						for (const auto& Ex : IntersectionsIn2DSpace)
+							if (FVector2D::DistSquared(Ex, P) < 25.f)
+							{
+								bNew = false;
+								break;
+							}
+						if (bNew)
+							IntersectionsIn2DSpace.Emplace(P);
+					}
+				}
+			}
+		}
+	}
+	return !IntersectionsIn2DSpace.IsEmpty();
+}
+
 bool IsParallelTest()
 {
 	int32 CaseCounter = 0;
@@ -335,6 +446,380 @@ bool SimplifySplinePointsInlineTest()
 	return true;
 }
 
+bool ClusterPoints2DTest()
+{
+	int32 CaseCounter = 0;
+	TArray<int32> ClusterIndices;
+	//Case0:空输入
+	if (URoadGeometryUtilities::ClusterPoints2D(TArray<FVector2D>(), 200.0, ClusterIndices) != 0 ||
+		!ClusterIndices.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-ClusterPoints2DTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case1:链式传递合并，首尾距离超过阈值但仍为同一类；跨网格边界的点也能合并
+	TArray<FVector2D> ChainPoints{
+		FVector2D(0, 0), FVector2D(150, 0), FVector2D(300, 0), FVector2D(450, 0), FVector2D(-10, -10)
+	};
+	if (URoadGeometryUtilities::ClusterPoints2D(ChainPoints, 200.0, ClusterIndices) != 1 ||
+		ClusterIndices != TArray<int32>{0, 0, 0, 0, 0})
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-ClusterPoints2DTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case2:传递合并与输入顺序无关，中间点最后出现时仍能连接两侧
+	TArray<FVector2D> BridgePoints{
+		FVector2D(0, 0), FVector2D(5000, 5000), FVector2D(300, 0), FVector2D(150, 0), FVector2D(5100, 5000)
+	};
+	if (URoadGeometryUtilities::ClusterPoints2D(BridgePoints, 200.0, ClusterIndices) != 2 ||
+		ClusterIndices != TArray<int32>{0, 1, 0, 0, 1})
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-ClusterPoints2DTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case3:距离等于阈值不合并
+	TArray<FVector2D> BoundaryPoints{FVector2D(0, 0), FVector2D(200, 0)};
+	if (URoadGeometryUtilities::ClusterPoints2D(BoundaryPoints, 200.0, ClusterIndices) != 2)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-ClusterPoints2DTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("ClusterPoints2DTest PASSED"));
+	return true;
+}
+
+bool Get2DIntersectionBatchTest()
+{
+	//随机线段与轴对齐线段混合，覆盖平行、共线、端点接触和尾部不足4条的情况
+	FRandomStream RandomStream(20240715);
+	constexpr int32 CandidateNum = 4099;
+	TArray<double> StartX, StartY, EndX, EndY;
+	for (int32 i = 0; i < CandidateNum; ++i)
+	{
+		FVector2D Start(RandomStream.FRandRange(-2000.0, 2000.0), RandomStream.FRandRange(-2000.0, 2000.0));
+		FVector2D End(RandomStream.FRandRange(-2000.0, 2000.0), RandomStream.FRandRange(-2000.0, 2000.0));
+		switch (i % 8)
+		{
+		case 0:
+			//与查询线段平行
+			End = Start + FVector2D(1000.0, 0.0);
+			break;
+		case 1:
+			//端点落在查询线段上
+			Start = FVector2D(FMath::RoundToDouble(RandomStream.FRandRange(-1000.0, 1000.0)), 0.0);
+			break;
+		default:
+			break;
+		}
+		StartX.Emplace(Start.X);
+		StartY.Emplace(Start.Y);
+		EndX.Emplace(End.X);
+		EndY.Emplace(End.Y);
+	}
+	const FVector2D QueryStart(-1000.0, 0.0);
+	const FVector2D QueryEnd(1000.0, 0.0);
+	for (int32 TestNum : {0, 1, 3, 4, 5, CandidateNum})
+	{
+		TArray<uint8> HitMask;
+		TArray<double> T, S;
+		HitMask.SetNumUninitialized(TestNum);
+		T.SetNumUninitialized(TestNum);
+		S.SetNumUninitialized(TestNum);
+		const int32 HitNum = URoadGeometryUtilities::Get2DIntersectionBatch(
+			QueryStart, QueryEnd, MakeArrayView(StartX.GetData(), TestNum), MakeArrayView(StartY.GetData(), TestNum),
+			MakeArrayView(EndX.GetData(), TestNum), MakeArrayView(EndY.GetData(), TestNum), HitMask, T, S);
+		int32 MaskCount = 0;
+		for (int32 i = 0; i < TestNum; ++i)
+		{
+			FVector2D ScalarResult;
+			const bool bScalarHit = URoadGeometryUtilities::Get2DIntersection(
+				QueryStart, QueryEnd, FVector2D(StartX[i], StartY[i]), FVector2D(EndX[i], EndY[i]), ScalarResult);
+			MaskCount += HitMask[i];
+			if (bScalarHit != (HitMask[i] != 0))
+			{
+				//标量版本参数为float，只允许在参数边界附近存在差异
+				const bool bNearBoundary = FMath::Abs(T[i]) < 1e-5 || FMath::Abs(T[i] - 1.0) < 1e-5 ||
+					FMath::Abs(S[i]) < 1e-5 || FMath::Abs(S[i] - 1.0) < 1e-5;
+				if (!bNearBoundary)
+				{
+					UE_LOG(LogTemp, Error,
+					       TEXT("[RoadGeometryUtilitiesTest-Get2DIntersectionBatchTest]Unmatch Hit At %d,t=%f,s=%f"),
+					       i, T[i], S[i]);
+					return false;
+				}
+				continue;
+			}
+			if (bScalarHit && !ScalarResult.Equals(QueryStart + (QueryEnd - QueryStart) * T[i], 0.01))
+			{
+				UE_LOG(LogTemp, Error,
+				       TEXT("[RoadGeometryUtilitiesTest-Get2DIntersectionBatchTest]Unmatch Location At %d"), i);
+				return false;
+			}
+		}
+		if (MaskCount != HitNum)
+		{
+			UE_LOG(LogTemp, Error,
+			       TEXT("[RoadGeometryUtilitiesTest-Get2DIntersectionBatchTest]Hit Count %d Differs From Mask %d"),
+			       HitNum, MaskCount);
+			return false;
+		}
+	}
+
+	//微基准：同一批候选重复求交，输出每秒处理的线段对数量
+	constexpr int32 RepeatNum = 256;
+	TArray<uint8> HitMask;
+	TArray<double> T, S;
+	HitMask.SetNumUninitialized(CandidateNum);
+	T.SetNumUninitialized(CandidateNum);
+	S.SetNumUninitialized(CandidateNum);
+	int64 ScalarHitNum = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Repeat = 0; Repeat < RepeatNum; ++Repeat)
+	{
+		for (int32 i = 0; i < CandidateNum; ++i)
+		{
+			FVector2D ScalarResult;
+			ScalarHitNum += URoadGeometryUtilities::Get2DIntersection(
+				QueryStart, QueryEnd, FVector2D(StartX[i], StartY[i]), FVector2D(EndX[i], EndY[i]), ScalarResult);
+		}
+	}
+	const double ScalarSeconds = FPlatformTime::Seconds() - StartTime;
+	int64 BatchHitNum = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Repeat = 0; Repeat < RepeatNum; ++Repeat)
+	{
+		BatchHitNum += URoadGeometryUtilities::Get2DIntersectionBatch(QueryStart, QueryEnd, StartX, StartY, EndX, EndY,
+		                                                              HitMask, T, S);
+	}
+	const double BatchSeconds = FPlatformTime::Seconds() - StartTime;
+	const double PairNum = static_cast<double>(CandidateNum) * RepeatNum;
+	UE_LOG(LogTemp, Display,
+	       TEXT("[Get2DIntersectionBatchTest]Scalar %.2f MPairs/s(%lld Hits),Batch %.2f MPairs/s(%lld Hits)"),
+	       PairNum / FMath::Max(ScalarSeconds, UE_SMALL_NUMBER) / 1e6, ScalarHitNum,
+	       PairNum / FMath::Max(BatchSeconds, UE_SMALL_NUMBER) / 1e6, BatchHitNum);
+	UE_LOG(LogTemp, Display, TEXT("Get2DIntersectionBatchTest PASSED"));
+	return true;
+}
+
+bool FindBezierIntersectionsTest()
+{
+	int32 CaseCounter = 0;
+	TArray<FVector2D> Parameters;
+	//Case0:两条直线形式的曲线垂直相交于中点
+	const FCubicBezier2D HorizontalLine(FVector2D(0, 0), FVector2D(100, 0), FVector2D(200, 0), FVector2D(300, 0));
+	const FCubicBezier2D VerticalLine(FVector2D(150, -150), FVector2D(150, -50), FVector2D(150, 50),
+	                                  FVector2D(150, 150));
+	if (URoadGeometryUtilities::FindBezierIntersections(HorizontalLine, VerticalLine, 0.01, Parameters) != 1 ||
+		!Parameters[0].Equals(FVector2D(0.5, 0.5), 1e-4))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case1:S形曲线与直线交于首尾和中点，y(t)=900t(1-t)(1-2t)
+	Parameters.Reset();
+	const FCubicBezier2D SCurve(FVector2D(0, 0), FVector2D(100, 300), FVector2D(200, -300), FVector2D(300, 0));
+	const FCubicBezier2D LongLine(FVector2D(-10, 0), FVector2D(100, 0), FVector2D(200, 0), FVector2D(310, 0));
+	if (URoadGeometryUtilities::FindBezierIntersections(SCurve, LongLine, 0.01, Parameters) != 3)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	Parameters.Sort([](const FVector2D& A, const FVector2D& B) { return A.X < B.X; });
+	if (!FMath::IsNearlyEqual(Parameters[0].X, 0.0, 1e-4) || !FMath::IsNearlyEqual(Parameters[1].X, 0.5, 1e-4) ||
+		!FMath::IsNearlyEqual(Parameters[2].X, 1.0, 1e-4))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case2:包围盒不相交
+	Parameters.Reset();
+	const FCubicBezier2D FarCurve(FVector2D(0, 1000), FVector2D(100, 1300), FVector2D(200, 700),
+	                              FVector2D(300, 1000));
+	if (URoadGeometryUtilities::FindBezierIntersections(SCurve, FarCurve, 0.01, Parameters) != 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case3:随机曲线与密集折线暴力求交结果比较
+	FRandomStream RandomStream(20240801);
+	auto RandomPoint = [&RandomStream]()
+	{
+		return FVector2D(RandomStream.FRandRange(-1000.0, 1000.0), RandomStream.FRandRange(-1000.0, 1000.0));
+	};
+	constexpr int32 PolyLineSegmentNum = 1000;
+	for (int32 Iteration = 0; Iteration < 50; ++Iteration)
+	{
+		const FCubicBezier2D CurveA(RandomPoint(), RandomPoint(), RandomPoint(), RandomPoint());
+		const FCubicBezier2D CurveB(RandomPoint(), RandomPoint(), RandomPoint(), RandomPoint());
+		Parameters.Reset();
+		URoadGeometryUtilities::FindBezierIntersections(CurveA, CurveB, 0.01, Parameters);
+		TArray<FVector2D> BruteForceHits;
+		for (int32 i = 0; i < PolyLineSegmentNum; ++i)
+		{
+			const FVector2D StartA = CurveA.GetLocation(static_cast<double>(i) / PolyLineSegmentNum);
+			const FVector2D EndA = CurveA.GetLocation(static_cast<double>(i + 1) / PolyLineSegmentNum);
+			for (int32 j = 0; j < PolyLineSegmentNum; ++j)
+			{
+				FVector2D Hit;
+				if (URoadGeometryUtilities::Get2DIntersection(
+					StartA, EndA, CurveB.GetLocation(static_cast<double>(j) / PolyLineSegmentNum),
+					CurveB.GetLocation(static_cast<double>(j + 1) / PolyLineSegmentNum), Hit) && !BruteForceHits.
+					ContainsByPredicate([&Hit](const FVector2D& Existed) { return Existed.Equals(Hit, 1.0); }))
+				{
+					BruteForceHits.Emplace(Hit);
+				}
+			}
+		}
+		bool bMatched = BruteForceHits.Num() == Parameters.Num();
+		for (const FVector2D& Parameter : Parameters)
+		{
+			const FVector2D Location = CurveA.GetLocation(Parameter.X);
+			bMatched &= BruteForceHits.ContainsByPredicate([&Location](const FVector2D& Hit)
+			{
+				return Hit.Equals(Location, 5.0);
+			});
+		}
+		if (!bMatched)
+		{
+			UE_LOG(LogTemp, Error,
+			       TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Random Case %d Failed,Result %d,BruteForce %d"),
+			       Iteration, Parameters.Num(), BruteForceHits.Num());
+			return false;
+		}
+	}
+	CaseCounter++;
+
+	//Case4:样条级别求交，与旧版网格播种Newton求解器比较结果并输出耗时
+	auto CreateSpline = [](const TArray<FVector>& Points)-> USplineComponent*
+	{
+		USplineComponent* Spline = NewObject<USplineComponent>(GetTransientPackage());
+		Spline->ClearSplinePoints(false);
+		for (const FVector& Point : Points)
+		{
+			Spline->AddSplinePoint(Point, ESplineCoordinateSpace::World, false);
+		}
+		Spline->UpdateSpline();
+		return Spline;
+	};
+	USplineComponent* WaveSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(1000, 800, 0), FVector(2000, -800, 0), FVector(3000, 800, 0), FVector(4000, 0, 0)
+	});
+	USplineComponent* CrossSpline = CreateSpline({
+		FVector(-500, 100, 0), FVector(1500, -200, 0), FVector(2500, 300, 0), FVector(4500, -100, 0)
+	});
+	TArray<FVector2D> SubdivisionResult;
+	double StartTime = FPlatformTime::Seconds();
+	URoadGeometryUtilities::Get2DIntersection(WaveSpline, CrossSpline, SubdivisionResult);
+	const double SubdivisionSeconds = FPlatformTime::Seconds() - StartTime;
+	TArray<FVector2D> SeededNewtonResult;
+	StartTime = FPlatformTime::Seconds();
+	Get2DIntersectionBySeededNewton(WaveSpline, CrossSpline, SeededNewtonResult);
+	const double SeededNewtonSeconds = FPlatformTime::Seconds() - StartTime;
+	//波浪样条自身不交叉，自交查询不应把相邻分段的共享控制点当作交点
+	TArray<FVector2D> SelfResult;
+	URoadGeometryUtilities::Get2DIntersection(WaveSpline, WaveSpline, SelfResult);
+	WaveSpline->MarkAsGarbage();
+	CrossSpline->MarkAsGarbage();
+	if (!SelfResult.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error,
+		       TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Test Failed On Case %d,Self Query %d Hits"),
+		       CaseCounter, SelfResult.Num());
+		return false;
+	}
+	UE_LOG(LogTemp, Display,
+	       TEXT("[FindBezierIntersectionsTest]Subdivision %d Hits In %f ms,SeededNewton %d Hits In %f ms"),
+	       SubdivisionResult.Num(), SubdivisionSeconds * 1000.0, SeededNewtonResult.Num(),
+	       SeededNewtonSeconds * 1000.0);
+	//旧版求解器可能因播种不足漏解，只要求其结果都能在新结果中找到
+	bool bContainsSeededResult = !SubdivisionResult.IsEmpty();
+	for (const FVector2D& SeededHit : SeededNewtonResult)
+	{
+		bContainsSeededResult &= SubdivisionResult.ContainsByPredicate([&SeededHit](const FVector2D& Hit)
+		{
+			return Hit.Equals(SeededHit, 5.0);
+		});
+	}
+	if (!bContainsSeededResult)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-FindBezierIntersectionsTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("FindBezierIntersectionsTest PASSED"));
+	return true;
+}
+
+bool SimplifySweepPathIndicesTest()
+{
+	int32 CaseCounter = 0;
+	TArray<int32> KeptIndices;
+	//Case0:直线只保留首尾
+	TArray<FTransform> StraightPath;
+	for (int32 i = 0; i < 10; ++i)
+	{
+		StraightPath.Emplace(FRotator::ZeroRotator, FVector(i * 500.0, 0, 0));
+	}
+	URoadGeometryUtilities::SimplifySweepPathIndices(StraightPath, 25.0, 5.0f, KeptIndices);
+	if (KeptIndices != TArray<int32>{0, 9})
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-SimplifySweepPathIndicesTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	CaseCounter++;
+	//Case1:半径100m的四分之一圆弧，每3°一个点，跳过的点到弦的距离不超过弦高误差
+	const double Radius = 10000.0;
+	const double ChordError = 25.0;
+	TArray<FTransform> ArcPath;
+	for (int32 i = 0; i <= 30; ++i)
+	{
+		const double Degree = i * 3.0;
+		const FVector Location(Radius * FMath::Sin(FMath::DegreesToRadians(Degree)),
+		                       Radius * (1.0 - FMath::Cos(FMath::DegreesToRadians(Degree))), 0.0);
+		ArcPath.Emplace(FRotator(0, Degree, 0), Location);
+	}
+	URoadGeometryUtilities::SimplifySweepPathIndices(ArcPath, ChordError, 5.0f, KeptIndices);
+	if (KeptIndices.Num() <= 2 || KeptIndices.Num() >= ArcPath.Num() || KeptIndices[0] != 0 ||
+		KeptIndices.Last() != ArcPath.Num() - 1)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadGeometryUtilitiesTest-SimplifySweepPathIndicesTest]Test Failed On Case %d"),
+		       CaseCounter);
+		return false;
+	}
+	for (int32 k = 1; k < KeptIndices.Num(); ++k)
+	{
+		const FVector ChordStart = ArcPath[KeptIndices[k - 1]].GetLocation();
+		const FVector ChordEnd = ArcPath[KeptIndices[k]].GetLocation();
+		for (int32 i = KeptIndices[k - 1] + 1; i < KeptIndices[k]; ++i)
+		{
+			if (FMath::PointDistToSegment(ArcPath[i].GetLocation(), ChordStart, ChordEnd) > ChordError)
+			{
+				UE_LOG(LogTemp, Error,
+				       TEXT("[RoadGeometryUtilitiesTest-SimplifySweepPathIndicesTest]Test Failed On Case %d,Point %d"),
+				       CaseCounter, i);
+				return false;
+			}
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("SimplifySweepPathIndicesTest PASSED"));
+	return true;
+}
+
 bool RoadGeometryUtilitiesTest::RunTest(const FString& Parameters)
 {
 	bool bSuccess = true;
@@ -350,5 +835,29 @@ bool RoadGeometryUtilitiesTest::RunTest(const FString& Parameters)
 	{
 		return false;
 	}
+	//扫掠路径抽稀测试
+	bSuccess &= SimplifySweepPathIndicesTest();
+	if (!bSuccess)
+	{
+		return false;
+	}
+	//交点聚类函数测试
+	bSuccess &= ClusterPoints2DTest();
+	if (!bSuccess)
+	{
+		return false;
+	}
+	//批量线段求交测试
+	bSuccess &= Get2DIntersectionBatchTest();
+	if (!bSuccess)
+	{
+		return false;
+	}
+	//贝塞尔曲线求交测试
+	bSuccess &= FindBezierIntersectionsTest();
+	if (!bSuccess)
+	{
+		return false;
+	}
 	return bSuccess;
 }
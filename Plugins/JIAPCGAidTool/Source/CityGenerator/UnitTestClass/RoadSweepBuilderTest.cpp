@@ -0,0 +1,104 @@
+﻿#include "Misc/AutomationTest.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "Road/RoadSweepBuilder.h"
+#include "VectorUtil.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(RoadSweepBuilderTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.RoadSweepBuilderTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 扫掠后检查顶点、三角形数量与GetSweepElementNum一致，Mesh闭合，且每个三角形的几何法线与Overlay法线同向
+ */
+bool TestSweep(const TArray<FVector2D>& InCrossSection, const TArray<FTransform>& InPath, int32 CaseIndex)
+{
+	using namespace UE::Geometry;
+	FDynamicMesh3 Mesh;
+	const int32 TriangleNum = FRoadSweepBuilder::AppendSweep(Mesh, InCrossSection, InPath);
+	int32 ExpectedVertexNum = 0;
+	int32 ExpectedTriangleNum = 0;
+	FRoadSweepBuilder::GetSweepElementNum(InCrossSection.Num(), InPath.Num(), true, ExpectedVertexNum,
+	                                      ExpectedTriangleNum);
+	if (TriangleNum != ExpectedTriangleNum || Mesh.TriangleCount() != ExpectedTriangleNum || Mesh.VertexCount() !=
+		ExpectedVertexNum || !Mesh.IsClosed())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[RoadSweepBuilderTest-Sweep]Test Failed On Case %d,Vertex %d,Triangle %d"),
+		       CaseIndex, Mesh.VertexCount(), Mesh.TriangleCount());
+		return false;
+	}
+	const FDynamicMeshNormalOverlay* Normals = Mesh.Attributes()->PrimaryNormals();
+	for (const int32 TriangleID : Mesh.TriangleIndicesItr())
+	{
+		if (!Normals->IsSetTriangle(TriangleID) || !Mesh.Attributes()->PrimaryUV()->IsSetTriangle(TriangleID))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[RoadSweepBuilderTest-Sweep]Test Failed On Case %d,Triangle %d Not Set"),
+			       CaseIndex, TriangleID);
+			return false;
+		}
+		const FVector3d TriangleNormal = Mesh.GetTriNormal(TriangleID);
+		FVector3f ElementNormals[3];
+		Normals->GetTriElements(TriangleID, ElementNormals[0], ElementNormals[1], ElementNormals[2]);
+		for (const FVector3f& ElementNormal : ElementNormals)
+		{
+			if (TriangleNormal.Dot(FVector3d(ElementNormal)) < 0.5)
+			{
+				UE_LOG(LogTemp, Error,
+				       TEXT("[RoadSweepBuilderTest-Sweep]Test Failed On Case %d,Triangle %d Normal Mismatch"),
+				       CaseIndex, TriangleID);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool RoadSweepBuilderTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+	//与FLaneMeshInfo一致的矩形截面，宽400高20
+	const TArray<FVector2D> RoadSection{{200.0, 20.0}, {-200.0, 20.0}, {-200.0, 0.0}, {200.0, 0.0}};
+	//Case0:沿X的直线
+	const TArray<FTransform> StraightPath{
+		FTransform(FVector(0.0, 0.0, 0.0)), FTransform(FVector(500.0, 0.0, 0.0)), FTransform(FVector(1000.0, 0.0, 0.0))
+	};
+	bSuccess &= TestSweep(RoadSection, StraightPath, 0);
+	//Case1:反向绕序的截面和90度转弯
+	TArray<FVector2D> ReversedSection = RoadSection;
+	Algo::Reverse(ReversedSection);
+	TArray<FTransform> TurnPath;
+	for (int32 i = 0; i <= 6; ++i)
+	{
+		const double Angle = i * 15.0;
+		const FRotator Rotation(0.0, Angle, 0.0);
+		TurnPath.Emplace(Rotation, FVector(1000.0 * FMath::Sin(FMath::DegreesToRadians(Angle)),
+		                                   1000.0 * (1.0 - FMath::Cos(FMath::DegreesToRadians(Angle))), 0.0));
+	}
+	bSuccess &= TestSweep(ReversedSection, TurnPath, 1);
+	//路面朝上：直线路径中顶部两个三角形的法线为+Z
+	UE::Geometry::FDynamicMesh3 Mesh;
+	FRoadSweepBuilder::AppendSweep(Mesh, RoadSection, StraightPath);
+	int32 UpFacingNum = 0;
+	for (const int32 TriangleID : Mesh.TriangleIndicesItr())
+	{
+		UpFacingNum += Mesh.GetTriNormal(TriangleID).Z > 0.99 ? 1 : 0;
+	}
+	if (UpFacingNum != 4)
+	{
+		AddError(FString::Printf(TEXT("[RoadSweepBuilderTest]Road Top Should Have 4 Up Facing Triangles,Got %d"),
+		                         UpFacingNum));
+		bSuccess = false;
+	}
+	//Case2:无效输入不写入
+	UE::Geometry::FDynamicMesh3 EmptyMesh;
+	const TArray<FTransform> SinglePointPath{StraightPath[0]};
+	const TArray<FVector2D> LineSection{{0.0, 0.0}, {1.0, 0.0}};
+	if (0 != FRoadSweepBuilder::AppendSweep(EmptyMesh, RoadSection, SinglePointPath) ||
+		0 != FRoadSweepBuilder::AppendSweep(EmptyMesh, LineSection, StraightPath) ||
+		EmptyMesh.TriangleCount() != 0)
+	{
+		AddError("[RoadSweepBuilderTest]Invalid Input Should Append Nothing");
+		bSuccess = false;
+	}
+	return bSuccess;
+}
@@ -0,0 +1,129 @@
+﻿#include "Misc/AutomationTest.h"
+#include "Road/SegmentBVH.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(SegmentBVHTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.SegmentBVHTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 比较BVH查询与暴力遍历结果，RemovedIndices中的线段不应被返回
+ */
+bool CheckBVHQueryMatchBruteForce(const FSegmentBVH& BVH, const TArray<FVector2D>& Starts,
+                                  const TArray<FVector2D>& Ends, const FBox2D& QueryBox,
+                                  const TSet<int32>& RemovedIndices = TSet<int32>())
+{
+	TArray<uint32> BVHResult;
+	BVH.Query(QueryBox, BVHResult);
+	BVHResult.Sort();
+	TArray<uint32> BruteForceResult;
+	for (int32 i = 0; i < Starts.Num(); ++i)
+	{
+		FBox2D SegmentBox(ForceInit);
+		SegmentBox += Starts[i];
+		SegmentBox += Ends[i];
+		if (SegmentBox.Intersect(QueryBox) && !RemovedIndices.Contains(i))
+		{
+			BruteForceResult.Emplace(i);
+		}
+	}
+	if (BVHResult != BruteForceResult)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[SegmentBVHTest]Unmatch Query Result At %s,BVH %d,BruteForce %d"),
+		       *QueryBox.ToString(), BVHResult.Num(), BruteForceResult.Num());
+		return false;
+	}
+	return true;
+}
+
+bool SegmentBVHTest::RunTest(const FString& Parameters)
+{
+	//Case0:空BVH
+	FSegmentBVH BVH;
+	TArray<uint32> EmptyResult;
+	BVH.Query(FBox2D(FVector2D(-1.0), FVector2D(1.0)), EmptyResult);
+	if (!EmptyResult.IsEmpty())
+	{
+		AddError("[SegmentBVHTest]Empty BVH Returns Segments");
+		return false;
+	}
+	//Case1:随机线段+网格线段（含大量重合质心和共享端点），随机查询与暴力结果比较
+	FRandomStream RandomStream(20240601);
+	TArray<FVector2D> Starts;
+	TArray<FVector2D> Ends;
+	for (int32 i = 0; i < 2000; ++i)
+	{
+		const FVector2D Start(RandomStream.FRandRange(-50000.0, 50000.0), RandomStream.FRandRange(-50000.0, 50000.0));
+		Starts.Emplace(Start);
+		Ends.Emplace(Start + FVector2D(RandomStream.FRandRange(-500.0, 500.0), RandomStream.FRandRange(-500.0, 500.0)));
+	}
+	for (int32 i = 0; i < 20; ++i)
+	{
+		for (int32 j = 0; j < 20; ++j)
+		{
+			Starts.Emplace(FVector2D(i * 200.0, j * 200.0));
+			Ends.Emplace(FVector2D((i + 1) * 200.0, j * 200.0));
+			Starts.Emplace(FVector2D(i * 200.0, j * 200.0));
+			Ends.Emplace(FVector2D(i * 200.0, (j + 1) * 200.0));
+		}
+	}
+	BVH.Build(Starts, Ends);
+	if (BVH.Num() != Starts.Num())
+	{
+		AddError("[SegmentBVHTest]Lose Segments After Build");
+		return false;
+	}
+	for (int32 i = 0; i < 200; ++i)
+	{
+		const FVector2D Center(RandomStream.FRandRange(-50000.0, 50000.0), RandomStream.FRandRange(-50000.0, 50000.0));
+		const FVector2D Extent(RandomStream.FRandRange(0.0, 3000.0), RandomStream.FRandRange(0.0, 3000.0));
+		if (!CheckBVHQueryMatchBruteForce(BVH, Starts, Ends, FBox2D(Center - Extent, Center + Extent)))
+		{
+			AddError(FString::Printf(TEXT("[SegmentBVHTest]Random Query %d Failed"), i));
+			return false;
+		}
+	}
+	//Case2:查询盒恰好接触网格线段端点
+	if (!CheckBVHQueryMatchBruteForce(BVH, Starts, Ends, FBox2D(FVector2D(200.0, 200.0), FVector2D(200.0, 200.0))))
+	{
+		AddError("[SegmentBVHTest]Touching Query Failed");
+		return false;
+	}
+	//Case3:移除部分线段并追加新线段（溢出列表），随机查询与暴力结果比较
+	TSet<int32> RemovedIndices;
+	for (int32 i = 0; i < Starts.Num(); i += 3)
+	{
+		BVH.Remove(i);
+		RemovedIndices.Emplace(i);
+	}
+	for (int32 i = 0; i < 300; ++i)
+	{
+		const FVector2D Start(RandomStream.FRandRange(-50000.0, 50000.0), RandomStream.FRandRange(-50000.0, 50000.0));
+		const FVector2D End = Start + FVector2D(RandomStream.FRandRange(-500.0, 500.0),
+		                                        RandomStream.FRandRange(-500.0, 500.0));
+		if (BVH.Append(Start, End) != static_cast<uint32>(Starts.Num()))
+		{
+			AddError("[SegmentBVHTest]Wrong Appended Index");
+			return false;
+		}
+		Starts.Emplace(Start);
+		Ends.Emplace(End);
+	}
+	if (BVH.GetOverflowNum() != 300 || BVH.GetRemovedNum() != RemovedIndices.Num())
+	{
+		AddError("[SegmentBVHTest]Wrong Overflow Or Removed Num");
+		return false;
+	}
+	for (int32 i = 0; i < 200; ++i)
+	{
+		const FVector2D Center(RandomStream.FRandRange(-50000.0, 50000.0), RandomStream.FRandRange(-50000.0, 50000.0));
+		const FVector2D Extent(RandomStream.FRandRange(0.0, 3000.0), RandomStream.FRandRange(0.0, 3000.0));
+		if (!CheckBVHQueryMatchBruteForce(BVH, Starts, Ends, FBox2D(Center - Extent, Center + Extent),
+		                                  RemovedIndices))
+		{
+			AddError(FString::Printf(TEXT("[SegmentBVHTest]Query After Remove/Append %d Failed"), i));
+			return false;
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("[SegmentBVHTest]All Tests Passed!"));
+	return true;
+}
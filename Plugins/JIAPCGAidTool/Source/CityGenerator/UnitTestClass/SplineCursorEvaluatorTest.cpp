@@ -0,0 +1,144 @@
+﻿#include "Misc/AutomationTest.h"
+#include "Components/SplineComponent.h"
+#include "Road/SplineCursorEvaluator.h"
+#include "Road/SplineSnapshot.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(SplineCursorEvaluatorTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.SplineCursorEvaluatorTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * 以USplineComponent自身的求值结果为基准，比较给定距离序列上的InputKey、Transform和切线
+ */
+bool CompareWithSplineComponent(const USplineComponent* Spline, const TArray<float>& Distances, int32 CaseIndex)
+{
+	FSplineCursorEvaluator Evaluator(Spline);
+	if (!Evaluator.IsValid() || !FMath::IsNearlyEqual(Evaluator.GetSplineLength(), Spline->GetSplineLength()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[SplineCursorEvaluatorTest-Compare]Invalid Evaluator On Case %d"), CaseIndex);
+		return false;
+	}
+	for (const float Distance : Distances)
+	{
+		const FSplineCursorEvaluator::FSample Sample = Evaluator.Evaluate(Distance, true);
+		const float ExpectedKey = Spline->GetInputKeyValueAtDistanceAlongSpline(Distance);
+		const FTransform ExpectedTrans = Spline->GetTransformAtDistanceAlongSpline(
+			Distance, ESplineCoordinateSpace::World, true);
+		const FVector ExpectedTangent = Spline->GetTangentAtDistanceAlongSpline(
+			Distance, ESplineCoordinateSpace::World);
+		if (!FMath::IsNearlyEqual(Sample.InputKey, ExpectedKey, 1e-4f) ||
+			!Sample.Transform.Equals(ExpectedTrans, 0.01) || !Sample.TangentWS.Equals(ExpectedTangent, 0.01))
+		{
+			UE_LOG(LogTemp, Error,
+			       TEXT("[SplineCursorEvaluatorTest-Compare]Test Failed On Case %d At Distance %f,Key %f Expected %f"),
+			       CaseIndex, Distance, Sample.InputKey, ExpectedKey);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SplineCursorEvaluatorTest::RunTest(const FString& Parameters)
+{
+	auto CreateSpline = [](const TArray<FVector>& Points, bool bClosedLoop,
+	                       ESplinePointType::Type PointType)-> USplineComponent*
+	{
+		USplineComponent* Spline = NewObject<USplineComponent>(GetTransientPackage());
+		Spline->ClearSplinePoints(false);
+		for (const FVector& Point : Points)
+		{
+			Spline->AddSplinePoint(Point, ESplineCoordinateSpace::World, false);
+		}
+		for (int32 i = 0; i < Points.Num(); ++i)
+		{
+			Spline->SetSplinePointType(i, PointType, false);
+		}
+		Spline->SetClosedLoop(bClosedLoop, false);
+		Spline->UpdateSpline();
+		return Spline;
+	};
+	auto MakeDistances = [](float Length, float Step)-> TArray<float>
+	{
+		TArray<float> Distances;
+		//单调递增，包含起点、终点以及超出范围的值
+		Distances.Add(-10.0f);
+		for (float Distance = 0.0f; Distance <= Length; Distance += Step)
+		{
+			Distances.Add(Distance);
+		}
+		Distances.Add(Length);
+		Distances.Add(Length + 10.0f);
+		//回退和跳跃访问
+		Distances.Append({Length * 0.5f, Length * 0.1f, Length * 0.9f, Length * 0.3f, 0.0f});
+		return Distances;
+	};
+	bool bSuccess = true;
+	//Case0:曲线
+	USplineComponent* CurveSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(1000, 800, 100), FVector(2000, -800, 0), FVector(3000, 800, -100),
+		FVector(4000, 0, 0)
+	}, false, ESplinePointType::Curve);
+	bSuccess &= CompareWithSplineComponent(CurveSpline, MakeDistances(CurveSpline->GetSplineLength(), 37.0f), 0);
+	//Case1:折线，控制点处InputKey应为整数
+	USplineComponent* LinearSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(1500, 0, 0), FVector(1500, 1500, 0), FVector(3000, 2000, 0)
+	}, false, ESplinePointType::Linear);
+	bSuccess &= CompareWithSplineComponent(LinearSpline, MakeDistances(LinearSpline->GetSplineLength(), 50.0f), 1);
+	//Case2:闭合样条，包含最后一点回到第一点的区间
+	USplineComponent* LoopSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(2000, 0, 0), FVector(2000, 2000, 0), FVector(0, 2000, 0)
+	}, true, ESplinePointType::Curve);
+	bSuccess &= CompareWithSplineComponent(LoopSpline, MakeDistances(LoopSpline->GetSplineLength(), 41.0f), 2);
+	//Case3:带旋转、缩放的组件变换和点上的Scale
+	USplineComponent* TransformedSpline = CreateSpline({
+		FVector(0, 0, 0), FVector(1000, 500, 0), FVector(2000, 0, 300)
+	}, false, ESplinePointType::Curve);
+	TransformedSpline->SetScaleAtSplinePoint(1, FVector(2.0, 1.0, 1.0), false);
+	TransformedSpline->SetWorldTransform(FTransform(FRotator(0, 30, 10), FVector(500, -200, 50), FVector(1.5)));
+	TransformedSpline->UpdateSpline();
+	bSuccess &= CompareWithSplineComponent(TransformedSpline,
+	                                       MakeDistances(TransformedSpline->GetSplineLength(), 29.0f), 3);
+	//Case4:仅求InputKey与Evaluate共用游标
+	FSplineCursorEvaluator Evaluator(CurveSpline);
+	const float HalfLength = CurveSpline->GetSplineLength() * 0.5f;
+	if (!FMath::IsNearlyEqual(Evaluator.GetInputKeyAtDistance(HalfLength),
+	                          CurveSpline->GetInputKeyValueAtDistanceAlongSpline(HalfLength), 1e-4f))
+	{
+		AddError("[SplineCursorEvaluatorTest]Wrong InputKey");
+		bSuccess = false;
+	}
+	Evaluator.Reset();
+	if (!FMath::IsNearlyEqual(Evaluator.GetInputKeyAtDistance(0.0f), 0.0f))
+	{
+		AddError("[SplineCursorEvaluatorTest]Wrong InputKey After Reset");
+		bSuccess = false;
+	}
+	//Case5:快照不持有UObject，位置反求距离与原样条一致
+	for (const USplineComponent* Spline : {CurveSpline, LoopSpline, TransformedSpline})
+	{
+		const FSplineSnapshot Snapshot = FSplineSnapshot::Capture(Spline);
+		FSplineCursorEvaluator SnapshotEvaluator = Snapshot.MakeEvaluator();
+		for (float Ratio : {0.0f, 0.23f, 0.5f, 0.77f, 1.0f})
+		{
+			const float Distance = Spline->GetSplineLength() * Ratio;
+			const FVector Location = Spline->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+			const float Expected = Spline->GetDistanceAlongSplineAtLocation(Location, ESplineCoordinateSpace::World);
+			if (!FMath::IsNearlyEqual(Snapshot.GetDistanceAlongSplineAtLocation(Location), Expected, 0.1f) ||
+				!SnapshotEvaluator.Evaluate(Distance).Transform.GetLocation().Equals(Location, 0.01))
+			{
+				AddError(FString::Printf(TEXT("[SplineCursorEvaluatorTest]Snapshot Mismatch At Distance %f"), Distance));
+				bSuccess = false;
+			}
+		}
+	}
+	if (FSplineCursorEvaluator(nullptr).IsValid())
+	{
+		AddError("[SplineCursorEvaluatorTest]Evaluator Should Be Invalid For Null Spline");
+		bSuccess = false;
+	}
+	if (!bSuccess)
+	{
+		AddError("[SplineCursorEvaluatorTest]Test Failed");
+	}
+	return bSuccess;
+}
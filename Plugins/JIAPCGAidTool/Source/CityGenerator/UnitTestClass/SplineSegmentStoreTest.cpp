@@ -0,0 +1,88 @@
+﻿#include "Misc/AutomationTest.h"
+#include "Road/SplineSegmentStore.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(SplineSegmentStoreTest,
+                                 "PCGDemo.JIAPCGAidTool.Source.CityGenerator.UnitTestClass.SplineSegmentStoreTest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool SplineSegmentStoreTest::RunTest(const FString& Parameters)
+{
+	FSplineSegmentStore Store;
+	//Case0:折线点不足两个不产生Segment
+	if (Store.AppendSpline(nullptr, {FTransform(FVector(1.0, 2.0, 3.0))}, 0) != INDEX_NONE || !Store.IsEmpty())
+	{
+		AddError("[SplineSegmentStoreTest]Single Point Creates Segment");
+		return false;
+	}
+	//Case1:两条折线，第二条为闭合折线（末点与首点重合），GlobalIndex不连续
+	const FQuat TestRotation(FRotator(0.0, 45.0, 0.0));
+	TArray<FTransform> OpenPolyLine{
+		FTransform(FVector(0.0, 0.0, 10.0)), FTransform(TestRotation, FVector(100.0, 0.0, 20.0)),
+		FTransform(FVector(200.0, 50.0, 30.0))
+	};
+	TArray<FTransform> ClosedPolyLine{
+		FTransform(FVector(0.0, 0.0, 0.0)), FTransform(FVector(100.0, 0.0, 0.0)),
+		FTransform(FVector(100.0, 100.0, 0.0)), FTransform(FVector(0.0, 100.0, 0.0)),
+		FTransform(FVector(0.0, 0.0, 0.0))
+	};
+	const int32 OpenSplineId = Store.AppendSpline(nullptr, OpenPolyLine, 0);
+	const int32 ClosedSplineId = Store.AppendSpline(nullptr, ClosedPolyLine, 10);
+	if (Store.Num() != 6 || OpenSplineId != 0 || ClosedSplineId != 1)
+	{
+		AddError(FString::Printf(TEXT("[SplineSegmentStoreTest]Unexpected Segment Num %d"), Store.Num()));
+		return false;
+	}
+	if (!Store.GetStart(1).Equals(FVector2D(100.0, 0.0)) || !Store.GetEnd(1).Equals(FVector2D(200.0, 50.0)) ||
+		Store.GetSplineId(3) != ClosedSplineId || Store.GetSegmentIndex(3) != 1 || Store.GetLastSegmentIndex(3) != 3)
+	{
+		AddError("[SplineSegmentStoreTest]Wrong Segment Data");
+		return false;
+	}
+	//Case2:GlobalIndex查找
+	if (Store.IndexOfGlobalIndex(1) != 1 || Store.IndexOfGlobalIndex(12) != 4 || Store.IndexOfGlobalIndex(5) !=
+		INDEX_NONE)
+	{
+		AddError("[SplineSegmentStoreTest]Wrong GlobalIndex Lookup");
+		return false;
+	}
+	//Case3:相邻判定，包括闭合折线首尾Segment，不同折线不相邻
+	if (!Store.IsAdjacent(0, 1) || !Store.IsAdjacent(2, 5) || Store.IsAdjacent(2, 4) || Store.IsAdjacent(1, 2))
+	{
+		AddError("[SplineSegmentStoreTest]Wrong Adjacent Result");
+		return false;
+	}
+	//Case4:侧边数组还原Transform
+	const FTransform RestoredEnd = Store.GetEndTransform(0);
+	if (!RestoredEnd.GetLocation().Equals(FVector(100.0, 0.0, 20.0)) ||
+		!RestoredEnd.GetRotation().Equals(TestRotation) ||
+		!Store.GetStartTransform(1).Equals(RestoredEnd))
+	{
+		AddError("[SplineSegmentStoreTest]Wrong Restored Transform");
+		return false;
+	}
+	//Case5:移除开放折线后追加新折线，Compact保持顺序并重排下标
+	Store.RemoveSpline(OpenSplineId);
+	if (Store.Num() != 6 || Store.GetRemovedNum() != 2 || !Store.IsRemoved(1) || Store.IsRemoved(2))
+	{
+		AddError("[SplineSegmentStoreTest]Wrong Removed Flags");
+		return false;
+	}
+	const int32 AppendedSplineId = Store.AppendSpline(nullptr, OpenPolyLine, 20);
+	Store.Compact();
+	if (Store.Num() != 6 || Store.GetRemovedNum() != 0 || Store.GetSplineId(0) != 0 || Store.GetSplineId(4) != 1 ||
+		Store.GetGlobalIndex(0) != 10 || Store.GetGlobalIndex(4) != 20 || AppendedSplineId != 2 ||
+		Store.GetSplineFirstSegment(1) != 4 || Store.IndexOfGlobalIndex(21) != 5 ||
+		!Store.GetEndTransform(4).Equals(RestoredEnd) || !Store.GetStartLocation(2).Equals(FVector(100.0, 100.0, 0.0)))
+	{
+		AddError("[SplineSegmentStoreTest]Wrong Data After Compact");
+		return false;
+	}
+	Store.Empty();
+	if (!Store.IsEmpty() || Store.FindSplineId(nullptr) != INDEX_NONE)
+	{
+		AddError("[SplineSegmentStoreTest]Store Not Empty After Empty()");
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("[SplineSegmentStoreTest]All Tests Passed!"));
+	return true;
+}
@@ -2,13 +2,31 @@
 
 
 #include "NotifyUtilities.h"
+#include "Framework/Application/SlateApplication.h"
 #include "Framework/Notifications/NotificationManager.h"
+#include "Misc/App.h"
 #include "Widgets/Notifications/SNotificationList.h"
 DEFINE_LOG_CATEGORY(JIAPCGAidTool)
 
 EAppReturnType::Type UNotifyUtilities::ShowMsgDialog(EAppMsgType::Type MsgType, const FString& DisplayMessage,
                                                      bool bShowMsgAsWarning)
 {
+	//命令行、无人值守模式下没有人可以点击对话框，只写日志并返回不执行后续操作的选项
+	if (IsRunningCommandlet() || FApp::IsUnattended())
+	{
+		UE_LOG(JIAPCGAidTool, Warning, TEXT("[Headless Dialog]%s"), *DisplayMessage);
+		switch (MsgType)
+		{
+		case EAppMsgType::Ok:
+			return EAppReturnType::Ok;
+		case EAppMsgType::YesNo:
+		case EAppMsgType::YesNoYesAll:
+		case EAppMsgType::YesNoYesAllNoAll:
+			return EAppReturnType::No;
+		default:
+			return EAppReturnType::Cancel;
+		}
+	}
 	FText TitleText = bShowMsgAsWarning
 		                  ? FText::FromStringView(TEXT("Warning"))
 		                  : FText::FromStringView(TEXT("Message"));
@@ -17,6 +35,12 @@ EAppReturnType::Type UNotifyUtilities::ShowMsgDialog(EAppMsgType::Type MsgType,
 
 void UNotifyUtilities::ShowPopupMsgAtCorner(const FString& Message)
 {
+	//-nullrhi等无界面运行时Slate未初始化，只写日志
+	if (IsRunningCommandlet() || !FSlateApplication::IsInitialized())
+	{
+		UE_LOG(JIAPCGAidTool, Display, TEXT("%s"), *Message);
+		return;
+	}
 	//主标题设置
 	FNotificationInfo NotificationInfo(INVTEXT("JiaPCGAidTool"));
 	NotificationInfo.bUseLargeFont = true;